@@ -4,6 +4,7 @@
 #
 # FFTW_FOUND       = system has FFTW lib
 # FFTW_LIBRARY     = full path to the FFTW library
+# FFTWF_LIBRARY    = full path to the single-precision FFTW library, if found
 # FFTW_INCLUDE_DIR = where to find headers
 #
 set(FFTW_LIBRARY_NAMES fftw3 libfftw3 fftw3-3 libfftw3-3 fftw3l libfftw3l fftw3l-3 libfftw3l-3 fftw3q libfftw3q fftw3q-3 libfftw3q-3 )
@@ -21,6 +22,19 @@ find_library(FFTW_LIBRARY
     "$ENV{LIB}"
 )
 
+find_library(FFTWF_LIBRARY
+  NAMES fftw3f libfftw3f fftw3f-3 libfftw3f-3
+  PATHS
+    /usr/lib
+	/usr/lib/fftw
+	/usr/lib/fftw3
+    /usr/local/lib
+    /usr/local/lib/fftw
+	/usr/local/lib/fftw3
+    "$ENV{LIB_DIR}/lib"
+    "$ENV{LIB}"
+)
+
 FIND_PATH(FFTW_INCLUDE_DIR NAMES fftw3.h PATHS
   /usr/include
   /usr/include/fftw
@@ -0,0 +1,278 @@
+/************************************************************************
+
+    backgrounddecoder.cpp
+
+    ld-analyse - TBC output analysis
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-analyse is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "backgrounddecoder.h"
+
+BackgroundDecoder::BackgroundDecoder(QObject *parent)
+    : QThread(parent), stopping(false), imageCache(CACHE_FRAMES), thumbnailSourceVideo(nullptr),
+      inFlightFrame(-1), inFlightThumbnail(false), hitCount(0), missCount(0), decodedCount(0)
+{
+}
+
+BackgroundDecoder::~BackgroundDecoder()
+{
+    stop();
+}
+
+// Public methods -----------------------------------------------------------------------------------------------------
+
+// Stop the thread
+void BackgroundDecoder::stop()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        frameRequests.clear();
+        thumbnailRequests.clear();
+        condition.wakeAll();
+    }
+    wait();
+}
+
+// Discard all requests and cached images, and wait until the thread is idle
+void BackgroundDecoder::clear()
+{
+    QMutexLocker locker(&mutex);
+
+    frameRequests.clear();
+    thumbnailRequests.clear();
+    waitUntilIdle();
+
+    if (hitCount + missCount > 0) {
+        qDebug() << "BackgroundDecoder::clear(): Decoded" << decodedCount << "frames in the background, cache hits:"
+                 << hitCount << "misses:" << missCount;
+    }
+
+    imageCache.clear();
+    configuration = Configuration();
+    thumbnailSourceVideo = nullptr;
+    hitCount = 0;
+    missCount = 0;
+    decodedCount = 0;
+}
+
+// Change how frames are decoded
+void BackgroundDecoder::configure(const Configuration &_configuration)
+{
+    QMutexLocker locker(&mutex);
+
+    // Wait for the frame being decoded (if any), since it's using the renderer
+    frameRequests.clear();
+    while (inFlightFrame != -1) condition.wait(&mutex);
+
+    configuration = _configuration;
+    renderer.updateConfiguration(configuration.videoParameters, configuration.palConfiguration,
+                                 configuration.ntscConfiguration, configuration.outputConfiguration);
+    imageCache.clear();
+}
+
+// Replace the frames waiting to be decoded
+void BackgroundDecoder::setFrameRequests(const QVector<FrameRequest> &_frameRequests)
+{
+    QMutexLocker locker(&mutex);
+
+    if (configuration.sourceVideo == nullptr) return;
+
+    frameRequests = _frameRequests;
+    if (!isRunning()) start(QThread::LowPriority);
+    condition.wakeAll();
+}
+
+// Replace the thumbnails waiting to be generated
+void BackgroundDecoder::setThumbnailRequests(SourceVideo &sourceVideo, const LdDecodeMetaData::VideoParameters &videoParameters,
+                                             const QVector<ThumbnailRequest> &_thumbnailRequests)
+{
+    QMutexLocker locker(&mutex);
+
+    thumbnailRequests.clear();
+    waitUntilIdle();
+
+    thumbnailSourceVideo = &sourceVideo;
+    thumbnailVideoParameters = videoParameters;
+    thumbnailRequests = _thumbnailRequests;
+    if (!isRunning()) start(QThread::LowPriority);
+    condition.wakeAll();
+}
+
+// Return true if the image for a frame is cached
+bool BackgroundDecoder::isCached(qint32 frameNumber)
+{
+    QMutexLocker locker(&mutex);
+    return imageCache.contains(frameNumber) || inFlightFrame == frameNumber;
+}
+
+// Get the image for a frame if it's cached, waiting for it if the thread is
+// decoding it now
+bool BackgroundDecoder::getImage(qint32 frameNumber, QImage &image)
+{
+    QMutexLocker locker(&mutex);
+
+    while (inFlightFrame == frameNumber) condition.wait(&mutex);
+
+    const QImage *cachedImage = imageCache.object(frameNumber);
+    if (cachedImage == nullptr) {
+        missCount++;
+        return false;
+    }
+
+    hitCount++;
+    image = *cachedImage;
+    return true;
+}
+
+// Add an image decoded elsewhere to the cache
+void BackgroundDecoder::insertImage(qint32 frameNumber, const QImage &image)
+{
+    QMutexLocker locker(&mutex);
+    imageCache.insert(frameNumber, new QImage(image));
+}
+
+// Protected methods --------------------------------------------------------------------------------------------------
+
+void BackgroundDecoder::run()
+{
+    // Working buffers, reused from frame to frame
+    QVector<SourceField> chromaFields;
+    QVector<ComponentFrame> componentFrames;
+    SourceVideo::Data fieldData;
+
+    QMutexLocker locker(&mutex);
+
+    while (true) {
+        // Wait until there's something to do
+        while (!stopping && frameRequests.isEmpty() && thumbnailRequests.isEmpty()) condition.wait(&mutex);
+        if (stopping) break;
+
+        if (!frameRequests.isEmpty()) {
+            // Decode the next frame, unless it's already cached
+            FrameRequest request = frameRequests.takeFirst();
+            if (imageCache.contains(request.frameNumber)) continue;
+
+            // Decode without holding the lock. While inFlightFrame is set,
+            // the configuration and renderer won't change.
+            inFlightFrame = request.frameNumber;
+            const Configuration frameConfiguration = configuration;
+            locker.unlock();
+            QImage frameImage = decodeFrame(frameConfiguration, request, chromaFields, componentFrames);
+            locker.relock();
+
+            imageCache.insert(request.frameNumber, new QImage(frameImage));
+            decodedCount++;
+            inFlightFrame = -1;
+        } else {
+            // Generate the next thumbnail
+            const ThumbnailRequest request = thumbnailRequests.takeFirst();
+            SourceVideo &sourceVideo = *thumbnailSourceVideo;
+            const LdDecodeMetaData::VideoParameters videoParameters = thumbnailVideoParameters;
+
+            inFlightThumbnail = true;
+            locker.unlock();
+            sourceVideo.readVideoField(request.fieldNumber, fieldData);
+            const QImage thumbnail = generateThumbnail(videoParameters, fieldData);
+            emit thumbnailReady(request.index, thumbnail);
+            locker.relock();
+
+            inFlightThumbnail = false;
+        }
+
+        condition.wakeAll();
+    }
+}
+
+// Private methods ----------------------------------------------------------------------------------------------------
+
+// Wait until the thread isn't working on anything (mutex must be held)
+void BackgroundDecoder::waitUntilIdle()
+{
+    while (inFlightFrame != -1 || inFlightThumbnail) condition.wait(&mutex);
+}
+
+// Load and decode a frame, in the same way as TbcSource
+QImage BackgroundDecoder::decodeFrame(const Configuration &frameConfiguration, FrameRequest &request,
+                                      QVector<SourceField> &chromaFields, QVector<ComponentFrame> &componentFrames)
+{
+    const LdDecodeMetaData::VideoParameters &videoParameters = frameConfiguration.videoParameters;
+    QVector<SourceField> &fields = request.fields;
+
+    // Load the fields, adding the separate chroma if needed
+    SourceField::loadFieldData(*frameConfiguration.sourceVideo, videoParameters, request.fieldNumbers, fields);
+    if (frameConfiguration.chromaSourceVideo != nullptr) {
+        chromaFields = fields;
+        SourceField::loadFieldData(*frameConfiguration.chromaSourceVideo, videoParameters, request.fieldNumbers, chromaFields);
+        FrameRenderer::combineSources(fields, chromaFields, request.startIndex, request.endIndex);
+    }
+
+    QImage frameImage;
+    if (frameConfiguration.chromaOn) {
+        componentFrames.resize(1);
+        renderer.decodeFrames(fields, request.startIndex, request.endIndex, componentFrames);
+        frameImage = renderer.generateChromaImage(componentFrames[0]);
+    } else {
+        frameImage = renderer.generateSourceImage(fields[request.startIndex], fields[request.startIndex + 1]);
+    }
+
+    if (frameConfiguration.dropoutsOn) {
+        FrameRenderer::highlightDropouts(frameImage, fields[request.startIndex].field, fields[request.startIndex + 1].field);
+    }
+
+    return frameImage;
+}
+
+// Make a thumbnail of the active area of a field, averaging the samples
+// that fall into each pixel
+QImage BackgroundDecoder::generateThumbnail(const LdDecodeMetaData::VideoParameters &videoParameters,
+                                            const SourceVideo::Data &fieldData)
+{
+    QImage thumbnail(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, QImage::Format_Grayscale8);
+
+    const qint32 activeWidth = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
+    const qint32 activeLines = videoParameters.lastActiveFieldLine - videoParameters.firstActiveFieldLine;
+    if (activeWidth <= 0 || activeLines <= 0 || fieldData.size() < videoParameters.fieldWidth * videoParameters.fieldHeight) {
+        thumbnail.fill(Qt::black);
+        return thumbnail;
+    }
+
+    for (qint32 y = 0; y < THUMBNAIL_HEIGHT; y++) {
+        const qint32 startLine = videoParameters.firstActiveFieldLine + ((y * activeLines) / THUMBNAIL_HEIGHT);
+        const qint32 endLine = qMax(startLine + 1, videoParameters.firstActiveFieldLine + (((y + 1) * activeLines) / THUMBNAIL_HEIGHT));
+        uchar *outputLine = thumbnail.scanLine(y);
+
+        for (qint32 x = 0; x < THUMBNAIL_WIDTH; x++) {
+            const qint32 startX = videoParameters.activeVideoStart + ((x * activeWidth) / THUMBNAIL_WIDTH);
+            const qint32 endX = qMax(startX + 1, videoParameters.activeVideoStart + (((x + 1) * activeWidth) / THUMBNAIL_WIDTH));
+
+            qint64 total = 0;
+            for (qint32 line = startLine; line < endLine; line++) {
+                const quint16 *inputLine = fieldData.constData() + (line * videoParameters.fieldWidth);
+                for (qint32 i = startX; i < endX; i++) total += inputLine[i];
+            }
+
+            // Take just the MSB of the average
+            const qint64 count = static_cast<qint64>(endLine - startLine) * (endX - startX);
+            outputLine[x] = static_cast<uchar>((total / count) / 256);
+        }
+    }
+
+    return thumbnail;
+}
@@ -0,0 +1,174 @@
+/************************************************************************
+
+    backgrounddecoder.h
+
+    ld-analyse - TBC output analysis
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-analyse is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef BACKGROUNDDECODER_H
+#define BACKGROUNDDECODER_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <QDebug>
+
+// TBC library includes
+#include "sourcevideo.h"
+#include "lddecodemetadata.h"
+
+// Chroma decoder includes
+#include "sourcefield.h"
+
+#include "framerenderer.h"
+
+// Decodes frames of a TBC source in the background, ahead of the frame being
+// shown, so that scrubbing through a source doesn't wait for the chroma
+// decoder on every frame. Decoded images are kept in a least-recently-used
+// cache, which TbcSource also adds the frames it decodes itself to.
+//
+// It also generates a strip of small thumbnails of the whole source.
+//
+// The metadata isn't thread-safe, so TbcSource resolves the metadata for each
+// request with SourceField::loadFieldMetadata before passing it in; the
+// thread only reads field data, with SourceVideo::readVideoField.
+class BackgroundDecoder : public QThread
+{
+    Q_OBJECT
+public:
+    explicit BackgroundDecoder(QObject *parent = nullptr);
+    ~BackgroundDecoder() override;
+
+    // Prevent copying or assignment
+    BackgroundDecoder(const BackgroundDecoder &) = delete;
+    BackgroundDecoder& operator=(const BackgroundDecoder &) = delete;
+
+    // The number of decoded frames to keep
+    static constexpr qint32 CACHE_FRAMES = 32;
+
+    // The size of a thumbnail, in pixels
+    static constexpr qint32 THUMBNAIL_WIDTH = 96;
+    static constexpr qint32 THUMBNAIL_HEIGHT = 72;
+
+    // How to decode frames. This must match what TbcSource does for the
+    // frame being shown.
+    struct Configuration {
+        // The source to read fields from, and an optional separate chroma
+        // source to add to them
+        SourceVideo *sourceVideo = nullptr;
+        SourceVideo *chromaSourceVideo = nullptr;
+
+        LdDecodeMetaData::VideoParameters videoParameters;
+        PalColour::Configuration palConfiguration;
+        Comb::Configuration ntscConfiguration;
+        OutputWriter::Configuration outputConfiguration;
+
+        bool chromaOn = false;
+        bool dropoutsOn = false;
+    };
+
+    // A frame to decode, with fields from SourceField::loadFieldMetadata
+    struct FrameRequest {
+        qint32 frameNumber;
+        QVector<SourceField> fields;
+        QVector<qint32> fieldNumbers;
+        qint32 startIndex;
+        qint32 endIndex;
+    };
+
+    // A frame to make a thumbnail of, from one of its fields
+    struct ThumbnailRequest {
+        qint32 index;
+        qint32 fieldNumber;
+    };
+
+    // Stop the thread. This is called automatically on destruction.
+    void stop();
+
+    // Discard all requests and cached images, and wait until the thread is
+    // idle (so the sources can be closed or reopened)
+    void clear();
+
+    // Change how frames are decoded, discarding cached images. This waits
+    // for any frame being decoded to finish, and reconfigures the thread's
+    // chroma decoder from the calling thread (as FFTW planning isn't
+    // thread-safe, all of it must be done from the GUI thread).
+    void configure(const Configuration &configuration);
+
+    // Replace the frames waiting to be decoded
+    void setFrameRequests(const QVector<FrameRequest> &frameRequests);
+
+    // Replace the thumbnails waiting to be generated
+    void setThumbnailRequests(SourceVideo &sourceVideo, const LdDecodeMetaData::VideoParameters &videoParameters,
+                              const QVector<ThumbnailRequest> &thumbnailRequests);
+
+    // Return true if the image for a frame is cached
+    bool isCached(qint32 frameNumber);
+
+    // Get the image for a frame if it's cached, waiting for it if the thread
+    // is decoding it now
+    bool getImage(qint32 frameNumber, QImage &image);
+
+    // Add an image decoded elsewhere to the cache
+    void insertImage(qint32 frameNumber, const QImage &image);
+
+signals:
+    void thumbnailReady(qint32 index, QImage thumbnail);
+
+protected:
+    void run() override;
+
+private:
+    // All guarded by mutex
+    QMutex mutex;
+    QWaitCondition condition;
+    bool stopping;
+
+    Configuration configuration;
+    QVector<FrameRequest> frameRequests;
+    QCache<qint32, QImage> imageCache;
+
+    SourceVideo *thumbnailSourceVideo;
+    LdDecodeMetaData::VideoParameters thumbnailVideoParameters;
+    QVector<ThumbnailRequest> thumbnailRequests;
+
+    // The frame the thread is decoding now, or -1
+    qint32 inFlightFrame;
+    // True while the thread is generating a thumbnail
+    bool inFlightThumbnail;
+
+    // Only used by the thread, or while it's idle
+    FrameRenderer renderer;
+
+    // Statistics
+    qint32 hitCount;
+    qint32 missCount;
+    qint32 decodedCount;
+
+    void waitUntilIdle();
+    QImage decodeFrame(const Configuration &frameConfiguration, FrameRequest &request,
+                       QVector<SourceField> &chromaFields, QVector<ComponentFrame> &componentFrames);
+    static QImage generateThumbnail(const LdDecodeMetaData::VideoParameters &videoParameters, const SourceVideo::Data &fieldData);
+};
+
+#endif // BACKGROUNDDECODER_H
@@ -0,0 +1,175 @@
+/************************************************************************
+
+    framerenderer.cpp
+
+    ld-analyse - TBC output analysis
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-analyse is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "framerenderer.h"
+
+// Public methods -----------------------------------------------------------------------------------------------------
+
+// Configure the chroma decoder and output writer for the source
+void FrameRenderer::updateConfiguration(const LdDecodeMetaData::VideoParameters &_videoParameters,
+                                        const PalColour::Configuration &palConfiguration,
+                                        const Comb::Configuration &ntscConfiguration,
+                                        const OutputWriter::Configuration &outputConfiguration)
+{
+    videoParameters = _videoParameters;
+
+    // Configure the chroma decoder
+    if (videoParameters.system == PAL || videoParameters.system == PAL_M) {
+        palColour.updateConfiguration(videoParameters, palConfiguration);
+    } else {
+        ntscColour.updateConfiguration(videoParameters, ntscConfiguration);
+    }
+
+    // Configure the OutputWriter.
+    // Because we have padding disabled, this won't change the VideoParameters.
+    LdDecodeMetaData::VideoParameters outputVideoParameters = videoParameters;
+    outputWriter.updateConfiguration(outputVideoParameters, outputConfiguration);
+}
+
+// Decode the frame in inputFields[startIndex..endIndex) to components
+void FrameRenderer::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
+                                 QVector<ComponentFrame> &componentFrames)
+{
+    if (videoParameters.system == PAL || videoParameters.system == PAL_M) {
+        // PAL source
+        palColour.decodeFrames(inputFields, startIndex, endIndex, componentFrames);
+    } else {
+        // NTSC source
+        ntscColour.decodeFrames(inputFields, startIndex, endIndex, componentFrames);
+    }
+}
+
+// Create an image from a decoded frame
+QImage FrameRenderer::generateChromaImage(const ComponentFrame &componentFrame) const
+{
+    // Create a QImage
+    const qint32 frameHeight = (videoParameters.fieldHeight * 2) - 1;
+    QImage frameImage = QImage(videoParameters.fieldWidth, frameHeight, QImage::Format_RGB888);
+
+    // Convert component video to RGB
+    OutputFrame outputFrame;
+    outputWriter.convert(componentFrame, outputFrame);
+
+    // Get a pointer to the RGB data
+    const quint16 *rgbPointer = outputFrame.data();
+
+    // Fill the QImage with black
+    frameImage.fill(Qt::black);
+
+    // Copy the RGB16-16-16 data into the RGB888 QImage
+    const qint32 activeHeight = videoParameters.lastActiveFrameLine - videoParameters.firstActiveFrameLine;
+    const qint32 activeWidth = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
+    for (qint32 y = 0; y < activeHeight; y++) {
+        const quint16 *inputLine = rgbPointer + (y * activeWidth * 3);
+        uchar *outputLine = frameImage.scanLine(y + videoParameters.firstActiveFrameLine)
+                            + (videoParameters.activeVideoStart * 3);
+
+        // Take just the MSB of the RGB input data
+        for (qint32 i = 0; i < activeWidth * 3; i++) {
+            *outputLine++ = static_cast<uchar>((*inputLine++) / 256);
+        }
+    }
+
+    return frameImage;
+}
+
+// Create an image from the raw samples of a frame's two fields
+QImage FrameRenderer::generateSourceImage(const SourceField &firstField, const SourceField &secondField) const
+{
+    // Create a QImage
+    const qint32 frameHeight = (videoParameters.fieldHeight * 2) - 1;
+    QImage frameImage = QImage(videoParameters.fieldWidth, frameHeight, QImage::Format_RGB888);
+
+    // Get pointers to the 16-bit greyscale data
+    const quint16 *firstFieldPointer = firstField.data.data();
+    const quint16 *secondFieldPointer = secondField.data.data();
+
+    // Copy the raw 16-bit grayscale data into the RGB888 QImage
+    for (qint32 y = 0; y < frameHeight; y++) {
+        const quint16 *inputLine = ((y % 2) ? secondFieldPointer : firstFieldPointer)
+                                   + (videoParameters.fieldWidth * (y / 2));
+        uchar *outputLine = frameImage.scanLine(y);
+
+        for (qint32 x = 0; x < videoParameters.fieldWidth; x++) {
+            // Take just the MSB of the input data
+            const uchar pixelValue = static_cast<uchar>(inputLine[x] / 256);
+
+            *outputLine++ = pixelValue; // R
+            *outputLine++ = pixelValue; // G
+            *outputLine++ = pixelValue; // B
+        }
+    }
+
+    return frameImage;
+}
+
+// Draw a frame's dropouts over its image
+void FrameRenderer::highlightDropouts(QImage &frameImage, const LdDecodeMetaData::Field &firstField,
+                                      const LdDecodeMetaData::Field &secondField)
+{
+    // Create a painter object
+    QPainter imagePainter;
+    imagePainter.begin(&frameImage);
+
+    // Draw the drop out data for the first field
+    imagePainter.setPen(Qt::red);
+    for (qint32 dropOutIndex = 0; dropOutIndex < firstField.dropOuts.size(); dropOutIndex++) {
+        qint32 startx = firstField.dropOuts.startx(dropOutIndex);
+        qint32 endx = firstField.dropOuts.endx(dropOutIndex);
+        qint32 fieldLine = firstField.dropOuts.fieldLine(dropOutIndex);
+
+        imagePainter.drawLine(startx, ((fieldLine - 1) * 2), endx, ((fieldLine - 1) * 2));
+    }
+
+    // Draw the drop out data for the second field
+    imagePainter.setPen(Qt::blue);
+    for (qint32 dropOutIndex = 0; dropOutIndex < secondField.dropOuts.size(); dropOutIndex++) {
+        qint32 startx = secondField.dropOuts.startx(dropOutIndex);
+        qint32 endx = secondField.dropOuts.endx(dropOutIndex);
+        qint32 fieldLine = secondField.dropOuts.fieldLine(dropOutIndex);
+
+        imagePainter.drawLine(startx, ((fieldLine - 1) * 2) + 1, endx, ((fieldLine - 1) * 2) + 1);
+    }
+
+    // End the painter object
+    imagePainter.end();
+}
+
+// Add separate chroma fields to luma fields, removing the chroma offset
+void FrameRenderer::combineSources(QVector<SourceField> &inputFields, const QVector<SourceField> &chromaInputFields,
+                                   qint32 startIndex, qint32 endIndex)
+{
+    // Separate chroma is offset (see chroma_to_u16 in vhsdecode/chroma.py)
+    static constexpr qint32 CHROMA_OFFSET = 32767;
+
+    for (qint32 fieldIndex = startIndex; fieldIndex < endIndex; fieldIndex++) {
+        auto &sourceData = inputFields[fieldIndex].data;
+        const auto &chromaData = chromaInputFields[fieldIndex].data;
+
+        for (qint32 i = 0; i < sourceData.size(); i++) {
+            qint32 sum = static_cast<qint32>(sourceData[i]) + static_cast<qint32>(chromaData[i]) - CHROMA_OFFSET;
+            sourceData[i] = static_cast<quint16>(qBound(0, sum, 65535));
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/************************************************************************
+
+    framerenderer.h
+
+    ld-analyse - TBC output analysis
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-analyse is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef FRAMERENDERER_H
+#define FRAMERENDERER_H
+
+#include <QImage>
+#include <QPainter>
+#include <QVector>
+
+// TBC library includes
+#include "lddecodemetadata.h"
+
+// Chroma decoder includes
+#include "componentframe.h"
+#include "palcolour.h"
+#include "comb.h"
+#include "outputwriter.h"
+#include "sourcefield.h"
+
+// Turns the fields of a TBC source into RGB QImages for display, either
+// directly or through the chroma decoder. TbcSource uses one of these for the
+// frame being shown, and BackgroundDecoder uses another to decode frames
+// ahead of time.
+class FrameRenderer
+{
+public:
+    // Configure the chroma decoder and output writer for the source
+    void updateConfiguration(const LdDecodeMetaData::VideoParameters &videoParameters,
+                             const PalColour::Configuration &palConfiguration,
+                             const Comb::Configuration &ntscConfiguration,
+                             const OutputWriter::Configuration &outputConfiguration);
+
+    // Decode the frame in inputFields[startIndex..endIndex) to components
+    void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
+                      QVector<ComponentFrame> &componentFrames);
+
+    // Create an image from a decoded frame
+    QImage generateChromaImage(const ComponentFrame &componentFrame) const;
+
+    // Create an image from the raw samples of a frame's two fields
+    QImage generateSourceImage(const SourceField &firstField, const SourceField &secondField) const;
+
+    // Draw a frame's dropouts over its image
+    static void highlightDropouts(QImage &frameImage, const LdDecodeMetaData::Field &firstField,
+                                  const LdDecodeMetaData::Field &secondField);
+
+    // Add separate chroma fields to luma fields, removing the chroma offset
+    static void combineSources(QVector<SourceField> &inputFields, const QVector<SourceField> &chromaInputFields,
+                               qint32 startIndex, qint32 endIndex);
+
+private:
+    LdDecodeMetaData::VideoParameters videoParameters;
+
+    // Chroma decoder objects
+    PalColour palColour;
+    Comb ntscColour;
+    OutputWriter outputWriter;
+};
+
+#endif // FRAMERENDERER_H
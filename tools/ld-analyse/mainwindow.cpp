@@ -46,6 +46,10 @@ MainWindow::MainWindow(QString inputFilenameParam, QWidget *parent) :
     videoParametersDialog = new VideoParametersDialog(this);
     chromaDecoderConfigDialog = new ChromaDecoderConfigDialog(this);
 
+    // Add the thumbnail strip above the frame slider
+    thumbnailStrip = new ThumbnailStrip(this);
+    ui->verticalLayout_3->insertWidget(0, thumbnailStrip);
+
     // Add a status bar to show the state of the source video file
     ui->statusBar->addWidget(&sourceVideoStatus);
     ui->statusBar->addWidget(&fieldNumberStatus);
@@ -81,6 +85,10 @@ MainWindow::MainWindow(QString inputFilenameParam, QWidget *parent) :
     connect(&tbcSource, &TbcSource::finishedLoading, this, &MainWindow::on_finishedLoading);
     connect(&tbcSource, &TbcSource::finishedSaving, this, &MainWindow::on_finishedSaving);
 
+    // Connect the thumbnail strip to the TbcSource thumbnails, and to the frame selection
+    connect(&tbcSource, &TbcSource::thumbnailReady, thumbnailStrip, &ThumbnailStrip::setThumbnail);
+    connect(thumbnailStrip, &ThumbnailStrip::frameSelected, this, &MainWindow::thumbnailStripFrameSelectedSignalHandler);
+
     // Load the window geometry and settings from the configuration
     restoreGeometry(configuration.getMainWindowGeometry());
     scaleFactor = configuration.getMainWindowScaleFactor();
@@ -195,6 +203,7 @@ void MainWindow::updateGuiLoaded()
     ui->frameHorizontalSlider->setMaximum(tbcSource.getNumberOfFrames());
     ui->frameHorizontalSlider->setPageStep(tbcSource.getNumberOfFrames() / 100);
     ui->frameHorizontalSlider->setValue(1);
+    thumbnailStrip->setSource(tbcSource.getNumberOfFrames(), tbcSource.getThumbnailFrameNumbers());
 
     // Allow the next and previous frame buttons to auto-repeat
     ui->previousPushButton->setAutoRepeat(true);
@@ -257,6 +266,7 @@ void MainWindow::updateGuiUnloaded()
     currentFrameNumber = 1;
     ui->frameHorizontalSlider->setValue(currentFrameNumber);
     currentFrameNumber = 1;
+    thumbnailStrip->clear();
 
     // Set the window title
     this->setWindowTitle(tr("ld-analyse"));
@@ -328,6 +338,7 @@ void MainWindow::showFrame()
 {
     // Load the frame
     tbcSource.loadFrame(currentFrameNumber);
+    thumbnailStrip->setCurrentFrame(currentFrameNumber);
 
     // Show the field numbers
     fieldNumberStatus.setText(" -  Fields: " + QString::number(tbcSource.getFirstFieldNumber()) + "/" +
@@ -536,7 +547,7 @@ void MainWindow::on_actionOpen_TBC_file_triggered()
     QString inputFileName = QFileDialog::getOpenFileName(this,
                 tr("Open TBC file"),
                 configuration.getSourceDirectory()+tr("/ldsample.tbc"),
-                tr("TBC output (*.tbc);;All Files (*)"));
+                tr("TBC output (*.tbc *.tbcpatch);;All Files (*)"));
 
     // Was a filename specified?
     if (!inputFileName.isEmpty() && !inputFileName.isNull()) {
@@ -1085,6 +1096,15 @@ void MainWindow::chromaDecoderConfigChangedSignalHandler()
     updateFrame();
 }
 
+// Handle a frame being selected on the thumbnail strip
+void MainWindow::thumbnailStripFrameSelectedSignalHandler(qint32 frameNumber)
+{
+    if (!tbcSource.getIsSourceLoaded()) return;
+
+    // Move the slider, which will show the frame
+    ui->frameHorizontalSlider->setValue(frameNumber);
+}
+
 // TbcSource class signal handlers ------------------------------------------------------------------------------------
 
 // Signal handler for busy signal from TbcSource class
@@ -48,6 +48,7 @@
 #include "chromadecoderconfigdialog.h"
 #include "configuration.h"
 #include "tbcsource.h"
+#include "thumbnailstrip.h"
 
 namespace Ui {
 class MainWindow;
@@ -109,6 +110,7 @@ private slots:
     void mouseMoveEvent(QMouseEvent *event);
     void videoParametersChangedSignalHandler(const LdDecodeMetaData::VideoParameters &videoParameters);
     void chromaDecoderConfigChangedSignalHandler();
+    void thumbnailStripFrameSelectedSignalHandler(qint32 frameNumber);
 
     // Tbc Source signal handlers
     void on_busy(QString infoMessage);
@@ -132,6 +134,9 @@ private:
     VideoParametersDialog *videoParametersDialog;
     ChromaDecoderConfigDialog *chromaDecoderConfigDialog;
 
+    // Thumbnails above the frame slider
+    ThumbnailStrip *thumbnailStrip;
+
     // Class globals
     Configuration configuration;
     QLabel sourceVideoStatus;
@@ -32,11 +32,16 @@ TbcSource::TbcSource(QObject *parent) : QObject(parent)
     resetState();
 
     // Configure the chroma decoder
-    palConfiguration = palColour.getConfiguration();
+    palConfiguration = PalColour::Configuration();
     palConfiguration.chromaFilter = PalColour::transform2DFilter;
-    ntscConfiguration = ntscColour.getConfiguration();
+    // The background decoder runs at low priority, so let Transform PAL use all the CPUs
+    palConfiguration.transformThreads = QThread::idealThreadCount();
+    ntscConfiguration = Comb::Configuration();
     outputConfiguration.pixelFormat = OutputWriter::PixelFormat::RGB48;
     outputConfiguration.paddingAmount = 1;
+
+    // Pass on thumbnails from the background decoder
+    connect(&backgroundDecoder, &BackgroundDecoder::thumbnailReady, this, &TbcSource::thumbnailReady);
 }
 
 // Public methods -----------------------------------------------------------------------------------------------------
@@ -44,6 +49,7 @@ TbcSource::TbcSource(QObject *parent) : QObject(parent)
 // Method to load a TBC source file
 void TbcSource::loadSource(QString sourceFilename)
 {
+    backgroundDecoder.clear();
     resetState();
 
     // Set the current file name
@@ -66,6 +72,7 @@ void TbcSource::loadSource(QString sourceFilename)
 // Method to unload a TBC source file
 void TbcSource::unloadSource()
 {
+    backgroundDecoder.clear();
     sourceVideo.close();
     if (sourceMode != ONE_SOURCE) chromaSourceVideo.close();
     resetState();
@@ -111,6 +118,7 @@ void TbcSource::setHighlightDropouts(bool _state)
 {
     invalidateFrameCache();
     dropoutsOn = _state;
+    configureBackgroundDecoder();
 }
 
 // Method to set the chroma decoder mode (true = on)
@@ -118,6 +126,7 @@ void TbcSource::setChromaDecoder(bool _state)
 {
     invalidateFrameCache();
     chromaOn = _state;
+    configureBackgroundDecoder();
 }
 
 // Method to set the field order (true = reversed, false = normal)
@@ -128,6 +137,8 @@ void TbcSource::setFieldOrder(bool _state)
 
     if (reverseFoOn) ldDecodeMetaData.setIsFirstFieldFirst(false);
     else ldDecodeMetaData.setIsFirstFieldFirst(true);
+
+    configureBackgroundDecoder();
 }
 
 // Method to get the state of the highlight dropouts mode
@@ -161,6 +172,7 @@ void TbcSource::setSourceMode(TbcSource::SourceMode _sourceMode)
 
     invalidateFrameCache();
     sourceMode = _sourceMode;
+    configureBackgroundDecoder();
 }
 
 // Load the metadata for a frame
@@ -168,6 +180,9 @@ void TbcSource::loadFrame(qint32 frameNumber)
 {
     // If there's no source, or we've already loaded that frame, nothing to do
     if (!sourceReady || loadedFrameNumber == frameNumber) return;
+
+    // Note which way the user is moving through the source
+    if (loadedFrameNumber != -1) scrubDirection = (frameNumber < loadedFrameNumber) ? -1 : 1;
     loadedFrameNumber = frameNumber;
     inputFieldsValid = false;
     invalidateFrameCache();
@@ -193,6 +208,8 @@ void TbcSource::loadFrame(qint32 frameNumber)
     // Get the field metadata
     firstField = ldDecodeMetaData.getField(firstFieldNumber);
     secondField = ldDecodeMetaData.getField(secondFieldNumber);
+    firstFieldDropOuts = DropOutIndex(firstField.dropOuts);
+    secondFieldDropOuts = DropOutIndex(secondField.dropOuts);
 }
 
 // Method to get a QImage from a frame number
@@ -203,41 +220,23 @@ QImage TbcSource::getFrameImage()
     // Check cached QImage
     if (frameCacheValid) return frameCache;
 
-    // Get a QImage for the frame
-    QImage frameImage = generateQImage();
-
-    // Highlight dropouts
-    if (dropoutsOn) {
-        // Create a painter object
-        QPainter imagePainter;
-        imagePainter.begin(&frameImage);
-
-        // Draw the drop out data for the first field
-        imagePainter.setPen(Qt::red);
-        for (qint32 dropOutIndex = 0; dropOutIndex < firstField.dropOuts.size(); dropOutIndex++) {
-            qint32 startx = firstField.dropOuts.startx(dropOutIndex);
-            qint32 endx = firstField.dropOuts.endx(dropOutIndex);
-            qint32 fieldLine = firstField.dropOuts.fieldLine(dropOutIndex);
+    // Use the background decoder's image if it has one, or decode it now
+    QImage frameImage;
+    if (!backgroundDecoder.getImage(loadedFrameNumber, frameImage)) {
+        frameImage = generateQImage();
 
-            imagePainter.drawLine(startx, ((fieldLine - 1) * 2), endx, ((fieldLine - 1) * 2));
-        }
-
-        // Draw the drop out data for the second field
-        imagePainter.setPen(Qt::blue);
-        for (qint32 dropOutIndex = 0; dropOutIndex < secondField.dropOuts.size(); dropOutIndex++) {
-            qint32 startx = secondField.dropOuts.startx(dropOutIndex);
-            qint32 endx = secondField.dropOuts.endx(dropOutIndex);
-            qint32 fieldLine = secondField.dropOuts.fieldLine(dropOutIndex);
+        // Highlight dropouts
+        if (dropoutsOn) FrameRenderer::highlightDropouts(frameImage, firstField, secondField);
 
-            imagePainter.drawLine(startx, ((fieldLine - 1) * 2) + 1, endx, ((fieldLine - 1) * 2) + 1);
-        }
-
-        // End the painter object
-        imagePainter.end();
+        backgroundDecoder.insertImage(loadedFrameNumber, frameImage);
     }
 
     frameCache = frameImage;
     frameCacheValid = true;
+
+    // Start decoding the frames that are likely to be shown next
+    requestBackgroundFrames();
+
     return frameImage;
 }
 
@@ -367,6 +366,7 @@ void TbcSource::setVideoParameters(const LdDecodeMetaData::VideoParameters &vide
 
     // Reconfigure the chroma decoder
     configureChromaDecoder();
+    configureBackgroundDecoder();
 }
 
 // Get scan line data from the frame
@@ -399,13 +399,14 @@ TbcSource::ScanLineData TbcSource::getScanLineData(qint32 scanLine)
     const SourceVideo::Data &fieldData = lineNumber.isFirstField() ? inputFields[inputStartIndex].data
                                                                    : inputFields[inputStartIndex + 1].data;
     const ComponentFrame &componentFrame = getComponentFrame();
-    DropOuts &dropouts = lineNumber.isFirstField() ? firstField.dropOuts
-                                                   : secondField.dropOuts;
+    const DropOutIndex &dropouts = lineNumber.isFirstField() ? firstFieldDropOuts
+                                                             : secondFieldDropOuts;
 
     scanLineData.composite.resize(videoParameters.fieldWidth);
     scanLineData.luma.resize(videoParameters.fieldWidth);
     scanLineData.isDropout.resize(videoParameters.fieldWidth);
 
+    DropOutIndex::Cursor dropoutCursor(dropouts, lineNumber.field1());
     for (qint32 xPosition = 0; xPosition < videoParameters.fieldWidth; xPosition++) {
         // Get the 16-bit composite value for the current pixel (frame data is numbered 0-624 or 0-524)
         scanLineData.composite[xPosition] = fieldData[(lineNumber.field0() * videoParameters.fieldWidth) + xPosition];
@@ -413,12 +414,7 @@ TbcSource::ScanLineData TbcSource::getScanLineData(qint32 scanLine)
         // Get the decoded luma value for the current pixel (only computed in the active region)
         scanLineData.luma[xPosition] = static_cast<qint32>(componentFrame.y(scanLine - 1)[xPosition]);
 
-        scanLineData.isDropout[xPosition] = false;
-        for (qint32 doCount = 0; doCount < dropouts.size(); doCount++) {
-            if (dropouts.fieldLine(doCount) == lineNumber.field1()) {
-                if (xPosition >= dropouts.startx(doCount) && xPosition <= dropouts.endx(doCount)) scanLineData.isDropout[xPosition] = true;
-            }
-        }
+        scanLineData.isDropout[xPosition] = dropoutCursor.contains(xPosition);
     }
 
     return scanLineData;
@@ -523,6 +519,7 @@ void TbcSource::setChromaConfiguration(const PalColour::Configuration &_palConfi
     outputConfiguration = _outputConfiguration;
 
     configureChromaDecoder();
+    configureBackgroundDecoder();
 }
 
 const PalColour::Configuration &TbcSource::getPalConfiguration()
@@ -584,6 +581,11 @@ qint32 TbcSource::startOfChapter(qint32 currentFrameNumber)
     return 1;
 }
 
+// Return the frame numbers of the thumbnails
+QVector<qint32> TbcSource::getThumbnailFrameNumbers()
+{
+    return thumbnailFrameNumbers;
+}
 
 // Private methods ----------------------------------------------------------------------------------------------------
 
@@ -596,6 +598,9 @@ void TbcSource::resetState()
     reverseFoOn = false;
     sourceReady = false;
     sourceMode = ONE_SOURCE;
+    scrubDirection = 1;
+    thumbnailFrameNumbers.clear();
+    thumbnailRequests.clear();
 
     // Cache state
     loadedFrameNumber = -1;
@@ -617,26 +622,59 @@ void TbcSource::invalidateFrameCache()
 // Configure the chroma decoder for its settings and the VideoParameters
 void TbcSource::configureChromaDecoder()
 {
-    // Configure the chroma decoder
-    LdDecodeMetaData::VideoParameters videoParameters = ldDecodeMetaData.getVideoParameters();
-    if (videoParameters.system == PAL || videoParameters.system == PAL_M) {
-        palColour.updateConfiguration(videoParameters, palConfiguration);
-    } else {
-        ntscColour.updateConfiguration(videoParameters, ntscConfiguration);
-    }
+    frameRenderer.updateConfiguration(ldDecodeMetaData.getVideoParameters(), palConfiguration, ntscConfiguration,
+                                      outputConfiguration);
+}
 
-    // Configure the OutputWriter.
-    // Because we have padding disabled, this won't change the VideoParameters.
-    outputWriter.updateConfiguration(videoParameters, outputConfiguration);
+// Configure the background decoder to decode frames in the same way as the
+// loaded frame, discarding any frames it has already decoded
+void TbcSource::configureBackgroundDecoder()
+{
+    if (!sourceReady) return;
+
+    BackgroundDecoder::Configuration decoderConfiguration;
+    decoderConfiguration.sourceVideo = (sourceMode == CHROMA_SOURCE) ? &chromaSourceVideo : &sourceVideo;
+    decoderConfiguration.chromaSourceVideo = (sourceMode == BOTH_SOURCES) ? &chromaSourceVideo : nullptr;
+    decoderConfiguration.videoParameters = ldDecodeMetaData.getVideoParameters();
+    decoderConfiguration.palConfiguration = palConfiguration;
+    decoderConfiguration.ntscConfiguration = ntscConfiguration;
+    decoderConfiguration.outputConfiguration = outputConfiguration;
+    decoderConfiguration.chromaOn = chromaOn;
+    decoderConfiguration.dropoutsOn = dropoutsOn;
+
+    backgroundDecoder.configure(decoderConfiguration);
 }
 
-// Ensure the SourceFields for the current frame are loaded
-void TbcSource::loadInputFields()
+// Ask the background decoder for the frames after the loaded frame in the
+// direction the user is moving, and a few before it
+void TbcSource::requestBackgroundFrames()
 {
-    if (inputFieldsValid) return;
+    QVector<qint32> frameNumbers;
+    for (qint32 i = 1; i <= BACKGROUND_AHEAD_FRAMES; i++) frameNumbers.append(loadedFrameNumber + (i * scrubDirection));
+    for (qint32 i = 1; i <= BACKGROUND_BEHIND_FRAMES; i++) frameNumbers.append(loadedFrameNumber - (i * scrubDirection));
 
-    // Work out how many frames ahead/behind we need to fetch
     qint32 lookBehind, lookAhead;
+    getLookBehindAhead(lookBehind, lookAhead);
+
+    // Look up the metadata here, as it can't be used from the decoder's thread
+    QVector<BackgroundDecoder::FrameRequest> frameRequests;
+    const qint32 numberOfFrames = getNumberOfFrames();
+    for (qint32 frameNumber : frameNumbers) {
+        if (frameNumber < 1 || frameNumber > numberOfFrames || backgroundDecoder.isCached(frameNumber)) continue;
+
+        BackgroundDecoder::FrameRequest request;
+        request.frameNumber = frameNumber;
+        SourceField::loadFieldMetadata(ldDecodeMetaData, frameNumber, 1, lookBehind, lookAhead,
+                                       request.fields, request.fieldNumbers, request.startIndex, request.endIndex);
+        frameRequests.append(request);
+    }
+
+    backgroundDecoder.setFrameRequests(frameRequests);
+}
+
+// Work out how many frames ahead/behind the chroma decoder needs
+void TbcSource::getLookBehindAhead(qint32 &lookBehind, qint32 &lookAhead)
+{
     if (getSystem() == PAL || getSystem() == PAL_M) {
         lookBehind = palConfiguration.getLookBehind();
         lookAhead = palConfiguration.getLookAhead();
@@ -644,38 +682,37 @@ void TbcSource::loadInputFields()
         lookBehind = ntscConfiguration.getLookBehind();
         lookAhead = ntscConfiguration.getLookAhead();
     }
+}
+
+// Ensure the SourceFields for the current frame are loaded
+void TbcSource::loadInputFields()
+{
+    if (inputFieldsValid) return;
+
+    // Work out how many frames ahead/behind we need to fetch
+    qint32 lookBehind, lookAhead;
+    getLookBehindAhead(lookBehind, lookAhead);
+
+    // Read the fields with readVideoField (through loadFieldData), since the
+    // background decoder may be reading from the same sources
+    QVector<qint32> fieldNumbers;
+    SourceField::loadFieldMetadata(ldDecodeMetaData, loadedFrameNumber, 1, lookBehind, lookAhead,
+                                   inputFields, fieldNumbers, inputStartIndex, inputEndIndex);
+    const LdDecodeMetaData::VideoParameters &videoParameters = ldDecodeMetaData.getVideoParameters();
 
     if (sourceMode == CHROMA_SOURCE) {
         // Load chroma directly into inputFields
-        SourceField::loadFields(chromaSourceVideo, ldDecodeMetaData,
-                                loadedFrameNumber, 1, lookBehind, lookAhead,
-                                inputFields, inputStartIndex, inputEndIndex);
+        SourceField::loadFieldData(chromaSourceVideo, videoParameters, fieldNumbers, inputFields);
     } else {
         // Load the only source, or luma, into inputFields
-        SourceField::loadFields(sourceVideo, ldDecodeMetaData,
-                                loadedFrameNumber, 1, lookBehind, lookAhead,
-                                inputFields, inputStartIndex, inputEndIndex);
+        SourceField::loadFieldData(sourceVideo, videoParameters, fieldNumbers, inputFields);
     }
 
     if (sourceMode == BOTH_SOURCES) {
-        // Load chroma into chromaInputFields
-        SourceField::loadFields(chromaSourceVideo, ldDecodeMetaData,
-                                loadedFrameNumber, 1, lookBehind, lookAhead,
-                                chromaInputFields, inputStartIndex, inputEndIndex);
-
-        // Separate chroma is offset (see chroma_to_u16 in vhsdecode/chroma.py)
-        static constexpr qint32 CHROMA_OFFSET = 32767;
-
-        // Add chroma to luma, removing the offset
-        for (qint32 fieldIndex = inputStartIndex; fieldIndex < inputEndIndex; fieldIndex++) {
-            auto &sourceData = inputFields[fieldIndex].data;
-            const auto &chromaData = chromaInputFields[fieldIndex].data;
-
-            for (qint32 i = 0; i < sourceData.size(); i++) {
-                qint32 sum = static_cast<qint32>(sourceData[i]) + static_cast<qint32>(chromaData[i]) - CHROMA_OFFSET;
-                sourceData[i] = static_cast<quint16>(qBound(0, sum, 65535));
-            }
-        }
+        // Load chroma into chromaInputFields, and add it to luma
+        chromaInputFields = inputFields;
+        SourceField::loadFieldData(chromaSourceVideo, videoParameters, fieldNumbers, chromaInputFields);
+        FrameRenderer::combineSources(inputFields, chromaInputFields, inputStartIndex, inputEndIndex);
     }
 
     inputFieldsValid = true;
@@ -690,13 +727,7 @@ void TbcSource::decodeFrame()
 
     // Decode the current frame to components
     componentFrames.resize(1);
-    if (getSystem() == PAL || getSystem() == PAL_M) {
-        // PAL source
-        palColour.decodeFrames(inputFields, inputStartIndex, inputEndIndex, componentFrames);
-    } else {
-        // NTSC source
-        ntscColour.decodeFrames(inputFields, inputStartIndex, inputEndIndex, componentFrames);
-    }
+    frameRenderer.decodeFrames(inputFields, inputStartIndex, inputEndIndex, componentFrames);
 
     decodedFrameValid = true;
 }
@@ -719,65 +750,17 @@ QImage TbcSource::generateQImage()
                     " (" << videoParameters.fieldWidth << "x" << frameHeight << ")";
     }
 
-    // Create a QImage
-    QImage frameImage = QImage(videoParameters.fieldWidth, frameHeight, QImage::Format_RGB888);
-
     if (chromaOn) {
         // Chroma decode the current frame
         decodeFrame();
 
-        // Convert component video to RGB
-        OutputFrame outputFrame;
-        outputWriter.convert(componentFrames[0], outputFrame);
-
-        // Get a pointer to the RGB data
-        const quint16 *rgbPointer = outputFrame.data();
-
-        // Fill the QImage with black
-        frameImage.fill(Qt::black);
-
-        // Copy the RGB16-16-16 data into the RGB888 QImage
-        const qint32 activeHeight = videoParameters.lastActiveFrameLine - videoParameters.firstActiveFrameLine;
-        const qint32 activeWidth = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
-        for (qint32 y = 0; y < activeHeight; y++) {
-            const quint16 *inputLine = rgbPointer + (y * activeWidth * 3);
-            uchar *outputLine = frameImage.scanLine(y + videoParameters.firstActiveFrameLine)
-                                + (videoParameters.activeVideoStart * 3);
-
-            // Take just the MSB of the RGB input data
-            for (qint32 i = 0; i < activeWidth * 3; i++) {
-                *outputLine++ = static_cast<uchar>((*inputLine++) / 256);
-            }
-        }
+        return frameRenderer.generateChromaImage(componentFrames[0]);
     } else {
         // Load SourceFields for the current frame
         loadInputFields();
 
-        // Get pointers to the 16-bit greyscale data
-        const quint16 *firstFieldPointer = inputFields[inputStartIndex].data.data();
-        const quint16 *secondFieldPointer = inputFields[inputStartIndex + 1].data.data();
-
-        // Copy the raw 16-bit grayscale data into the RGB888 QImage
-        for (qint32 y = 0; y < frameHeight; y++) {
-            for (qint32 x = 0; x < videoParameters.fieldWidth; x++) {
-                // Take just the MSB of the input data
-                qint32 pixelOffset = (videoParameters.fieldWidth * (y / 2)) + x;
-                uchar pixelValue;
-                if (y % 2) {
-                    pixelValue = static_cast<uchar>(secondFieldPointer[pixelOffset] / 256);
-                } else {
-                    pixelValue = static_cast<uchar>(firstFieldPointer[pixelOffset] / 256);
-                }
-
-                qint32 xpp = x * 3;
-                *(frameImage.scanLine(y) + xpp + 0) = static_cast<uchar>(pixelValue); // R
-                *(frameImage.scanLine(y) + xpp + 1) = static_cast<uchar>(pixelValue); // G
-                *(frameImage.scanLine(y) + xpp + 2) = static_cast<uchar>(pixelValue); // B
-            }
-        }
+        return frameRenderer.generateSourceImage(inputFields[inputStartIndex], inputFields[inputStartIndex + 1]);
     }
-
-    return frameImage;
 }
 
 // Generate the data points for the Drop-out and SNR analysis graphs, and the chapter map.
@@ -814,61 +797,16 @@ void TbcSource::generateData()
         const LdDecodeMetaData::Field &firstField = ldDecodeMetaData.getField(ldDecodeMetaData.getFirstFieldNumber(frameNumber + 1));
         const LdDecodeMetaData::Field &secondField = ldDecodeMetaData.getField(ldDecodeMetaData.getSecondFieldNumber(frameNumber + 1));
 
-        // Get the first field DOs
-        if (firstField.dropOuts.size() > 0) {
-            // Calculate the total length of the dropouts
-            for (qint32 i = 0; i < firstField.dropOuts.size(); i++) {
-                doLength += static_cast<double>(firstField.dropOuts.endx(i) - firstField.dropOuts.startx(i));
-            }
-        }
-
-        // Get the second field DOs
-        if (secondField.dropOuts.size() > 0) {
-            // Calculate the total length of the dropouts
-            for (qint32 i = 0; i < secondField.dropOuts.size(); i++) {
-                doLength += static_cast<double>(secondField.dropOuts.endx(i) - secondField.dropOuts.startx(i));
-            }
-        }
+        // Get the total length of the first and second field DOs
+        doLength += static_cast<double>(firstField.dropOuts.totalLength());
+        doLength += static_cast<double>(secondField.dropOuts.totalLength());
 
-        // Get the first field visible DOs
+        // Get the total length of the first and second field visible DOs
         const LdDecodeMetaData::VideoParameters &videoParameters = ldDecodeMetaData.getVideoParameters();
-
-        if (firstField.dropOuts.size() > 0) {
-            // Calculate the total length of the visible dropouts
-            for (qint32 i = 0; i < firstField.dropOuts.size(); i++) {
-                // Does the drop out start in the visible area?
-                if ((firstField.dropOuts.fieldLine(i) >= videoParameters.firstActiveFieldLine) &&
-                    (firstField.dropOuts.fieldLine(i) <= videoParameters.lastActiveFieldLine)) {
-                    if (firstField.dropOuts.startx(i) >= videoParameters.activeVideoStart) {
-                        qint32 startx = firstField.dropOuts.startx(i);
-                        qint32 endx;
-                        if (firstField.dropOuts.endx(i) < videoParameters.activeVideoEnd) endx = firstField.dropOuts.endx(i);
-                        else endx = videoParameters.activeVideoEnd;
-
-                        visibleDoLength += static_cast<double>(endx - startx);
-                    }
-                }
-            }
-        }
-
-        // Get the second field visible DOs
-        if (secondField.dropOuts.size() > 0) {
-            // Calculate the total length of the visible dropouts
-            for (qint32 i = 0; i < secondField.dropOuts.size(); i++) {
-                // Does the drop out start in the visible area?
-                if ((secondField.dropOuts.fieldLine(i) >= videoParameters.firstActiveFieldLine) &&
-                    (secondField.dropOuts.fieldLine(i) <= videoParameters.lastActiveFieldLine)) {
-                    if (secondField.dropOuts.startx(i) >= videoParameters.activeVideoStart) {
-                        qint32 startx = secondField.dropOuts.startx(i);
-                        qint32 endx;
-                        if (secondField.dropOuts.endx(i) < videoParameters.activeVideoEnd) endx = secondField.dropOuts.endx(i);
-                        else endx = videoParameters.activeVideoEnd;
-
-                        visibleDoLength += static_cast<double>(endx - startx);
-                    }
-                }
-            }
-        }
+        visibleDoLength += static_cast<double>(firstField.dropOuts.visibleLength(videoParameters.firstActiveFieldLine, videoParameters.lastActiveFieldLine,
+                                                                                 videoParameters.activeVideoStart, videoParameters.activeVideoEnd));
+        visibleDoLength += static_cast<double>(secondField.dropOuts.visibleLength(videoParameters.firstActiveFieldLine, videoParameters.lastActiveFieldLine,
+                                                                                  videoParameters.activeVideoStart, videoParameters.activeVideoEnd));
 
         // Get the first field SNRs
         if (firstField.vitsMetrics.inUse) {
@@ -1002,25 +940,38 @@ bool TbcSource::startBackgroundLoad(QString sourceFilename)
     currentJsonFilename = jsonFileName;
 
     // Configure the chroma decoder
-    if (videoParameters.system == PAL || videoParameters.system == PAL_M) {
-        palColour.updateConfiguration(videoParameters, palConfiguration);
-    } else {
-        if (isChromaTbc || sourceMode != ONE_SOURCE) {
-            // Enable phase compensation by default, since this is probably a videotape source
-            ntscConfiguration.phaseCompensation = true;
-        }
-        ntscColour.updateConfiguration(videoParameters, ntscConfiguration);
+    if (videoParameters.system != PAL && videoParameters.system != PAL_M && (isChromaTbc || sourceMode != ONE_SOURCE)) {
+        // Enable phase compensation by default, since this is probably a videotape source
+        ntscConfiguration.phaseCompensation = true;
     }
+    configureChromaDecoder();
 
     // Analyse the metadata
     emit busy("Generating graph data and chapter map...");
     generateData();
 
+    // Pick frames spread evenly through the source to make thumbnails of
+    const qint32 numFrames = ldDecodeMetaData.getNumberOfFrames();
+    const qint32 thumbnailCount = qMin(THUMBNAIL_COUNT, numFrames);
+    for (qint32 i = 0; i < thumbnailCount; i++) {
+        const qint32 frameNumber = (thumbnailCount > 1) ? 1 + ((i * (numFrames - 1)) / (thumbnailCount - 1)) : 1;
+        const qint32 fieldNumber = ldDecodeMetaData.getFirstFieldNumber(frameNumber);
+
+        thumbnailFrameNumbers.append(frameNumber);
+        if (fieldNumber != -1) thumbnailRequests.append(BackgroundDecoder::ThumbnailRequest { i, fieldNumber });
+    }
+
     return true;
 }
 
 void TbcSource::finishBackgroundLoad()
 {
+    if (future.result()) {
+        // Start background decoding, and generate the thumbnails
+        configureBackgroundDecoder();
+        backgroundDecoder.setThumbnailRequests(sourceVideo, ldDecodeMetaData.getVideoParameters(), thumbnailRequests);
+    }
+
     // Send a finished loading message to the main window
     emit finishedLoading(future.result());
 }
@@ -35,6 +35,7 @@
 // TBC library includes
 #include "sourcevideo.h"
 #include "lddecodemetadata.h"
+#include "dropoutindex.h"
 #include "linenumber.h"
 #include "vbidecoder.h"
 #include "videoiddecoder.h"
@@ -46,6 +47,9 @@
 #include "palcolour.h"
 #include "comb.h"
 
+#include "framerenderer.h"
+#include "backgrounddecoder.h"
+
 class TbcSource : public QObject
 {
     Q_OBJECT
@@ -138,10 +142,13 @@ public:
     qint32 startOfNextChapter(qint32 currentFrameNumber);
     qint32 startOfChapter(qint32 currentFrameNumber);
 
+    QVector<qint32> getThumbnailFrameNumbers();
+
 signals:
     void busy(QString information);
     void finishedLoading(bool success);
     void finishedSaving(bool success);
+    void thumbnailReady(qint32 index, QImage thumbnail);
 
 private slots:
     void finishBackgroundLoad();
@@ -170,10 +177,8 @@ private:
     QString currentJsonFilename;
     QString lastIOError;
 
-    // Chroma decoder objects
-    PalColour palColour;
-    Comb ntscColour;
-    OutputWriter outputWriter;
+    // Chroma decoder for the loaded frame
+    FrameRenderer frameRenderer;
 
     // VBI decoders
     VbiDecoder vbiDecoder;
@@ -187,6 +192,7 @@ private:
     // Metadata for the loaded frame
     qint32 firstFieldNumber, secondFieldNumber;
     LdDecodeMetaData::Field firstField, secondField;
+    DropOutIndex firstFieldDropOuts, secondFieldDropOuts;
     qint32 loadedFrameNumber;
 
     // Source fields needed to decode the loaded frame
@@ -211,9 +217,26 @@ private:
     // Chapter map
     QVector<qint32> chapterMap;
 
+    // Background decoding of the frames around the loaded frame, in the
+    // direction the user is moving through the source (+1 or -1)
+    static constexpr qint32 BACKGROUND_AHEAD_FRAMES = 4;
+    static constexpr qint32 BACKGROUND_BEHIND_FRAMES = 1;
+    qint32 scrubDirection;
+
+    // Thumbnails of the whole source
+    static constexpr qint32 THUMBNAIL_COUNT = 200;
+    QVector<qint32> thumbnailFrameNumbers;
+    QVector<BackgroundDecoder::ThumbnailRequest> thumbnailRequests;
+
+    // This must come after the sources, so it stops before they're destroyed
+    BackgroundDecoder backgroundDecoder;
+
     void resetState();
     void invalidateFrameCache();
     void configureChromaDecoder();
+    void configureBackgroundDecoder();
+    void requestBackgroundFrames();
+    void getLookBehindAhead(qint32 &lookBehind, qint32 &lookAhead);
     void loadInputFields();
     void decodeFrame();
     QImage generateQImage();
@@ -0,0 +1,129 @@
+/************************************************************************
+
+    thumbnailstrip.cpp
+
+    ld-analyse - TBC output analysis
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-analyse is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "thumbnailstrip.h"
+
+ThumbnailStrip::ThumbnailStrip(QWidget *parent)
+    : QWidget(parent), numberOfFrames(0), currentFrameNumber(1)
+{
+    setFixedHeight(STRIP_HEIGHT);
+}
+
+// Set the number of frames in the source, and the frames the thumbnails will
+// show (the thumbnails themselves arrive later, through setThumbnail)
+void ThumbnailStrip::setSource(qint32 _numberOfFrames, const QVector<qint32> &thumbnailFrameNumbers)
+{
+    numberOfFrames = _numberOfFrames;
+    frameNumbers = thumbnailFrameNumbers;
+    thumbnails.clear();
+    thumbnails.resize(frameNumbers.size());
+    update();
+}
+
+// Remove the source
+void ThumbnailStrip::clear()
+{
+    setSource(0, QVector<qint32>());
+}
+
+void ThumbnailStrip::setCurrentFrame(qint32 frameNumber)
+{
+    currentFrameNumber = frameNumber;
+    update();
+}
+
+void ThumbnailStrip::setThumbnail(qint32 index, QImage thumbnail)
+{
+    if (index < 0 || index >= thumbnails.size()) return;
+
+    thumbnails[index] = thumbnail;
+    update();
+}
+
+// Protected methods --------------------------------------------------------------------------------------------------
+
+void ThumbnailStrip::paintEvent(QPaintEvent *event)
+{
+    (void)event;
+
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+    if (numberOfFrames < 1 || thumbnails.isEmpty()) return;
+
+    // Show as many thumbnails as will fit across the strip, picking the one
+    // nearest the middle of each slot
+    const qint32 thumbnailWidth = (height() * 4) / 3;
+    const qint32 slotCount = qMax(1, width() / thumbnailWidth);
+    for (qint32 slot = 0; slot < slotCount; slot++) {
+        const qint32 left = (slot * width()) / slotCount;
+        const qint32 right = ((slot + 1) * width()) / slotCount;
+        const QRect slotRect(left, 0, right - left, height());
+        const qint32 frameNumber = frameNumberAt(slotRect.center().x());
+
+        qint32 index = 0;
+        for (qint32 i = 1; i < frameNumbers.size(); i++) {
+            if (qAbs(frameNumbers[i] - frameNumber) < qAbs(frameNumbers[index] - frameNumber)) index = i;
+        }
+
+        if (!thumbnails[index].isNull()) painter.drawImage(slotRect, thumbnails[index]);
+    }
+
+    // Mark the current frame
+    painter.setPen(Qt::red);
+    const qint32 x = positionOf(currentFrameNumber);
+    painter.drawLine(x, 0, x, height() - 1);
+}
+
+void ThumbnailStrip::mousePressEvent(QMouseEvent *event)
+{
+    if (numberOfFrames < 1 || event->button() != Qt::LeftButton) return;
+
+    emit frameSelected(frameNumberAt(mapFromGlobal(QCursor::pos()).x()));
+}
+
+void ThumbnailStrip::mouseMoveEvent(QMouseEvent *event)
+{
+    if (numberOfFrames < 1 || !(event->buttons() & Qt::LeftButton)) return;
+
+    emit frameSelected(frameNumberAt(mapFromGlobal(QCursor::pos()).x()));
+}
+
+// Private methods ----------------------------------------------------------------------------------------------------
+
+// Map a position on the strip to a frame number
+qint32 ThumbnailStrip::frameNumberAt(qint32 x)
+{
+    if (width() <= 1) return 1;
+
+    const qint32 boundedX = qBound(0, x, width() - 1);
+    return 1 + static_cast<qint32>((static_cast<qint64>(boundedX) * (numberOfFrames - 1)) / (width() - 1));
+}
+
+// Map a frame number to a position on the strip
+qint32 ThumbnailStrip::positionOf(qint32 frameNumber)
+{
+    if (numberOfFrames <= 1) return 0;
+
+    return static_cast<qint32>((static_cast<qint64>(frameNumber - 1) * (width() - 1)) / (numberOfFrames - 1));
+}
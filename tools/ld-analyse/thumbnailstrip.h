@@ -0,0 +1,71 @@
+/************************************************************************
+
+    thumbnailstrip.h
+
+    ld-analyse - TBC output analysis
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-analyse is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef THUMBNAILSTRIP_H
+#define THUMBNAILSTRIP_H
+
+#include <QWidget>
+#include <QImage>
+#include <QPainter>
+#include <QMouseEvent>
+#include <QCursor>
+#include <QVector>
+
+// A strip of thumbnails spread evenly through the source, with a marker for
+// the current frame. Clicking on the strip selects the nearest frame.
+class ThumbnailStrip : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ThumbnailStrip(QWidget *parent = nullptr);
+
+    // The height of the strip, in pixels
+    static constexpr qint32 STRIP_HEIGHT = 48;
+
+    void setSource(qint32 numberOfFrames, const QVector<qint32> &thumbnailFrameNumbers);
+    void clear();
+    void setCurrentFrame(qint32 frameNumber);
+
+public slots:
+    void setThumbnail(qint32 index, QImage thumbnail);
+
+signals:
+    void frameSelected(qint32 frameNumber);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    qint32 numberOfFrames;
+    qint32 currentFrameNumber;
+    QVector<qint32> frameNumbers;
+    QVector<QImage> thumbnails;
+
+    qint32 frameNumberAt(qint32 x);
+    qint32 positionOf(qint32 frameNumber);
+};
+
+#endif // THUMBNAILSTRIP_H
@@ -35,8 +35,8 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
 #include <utility>
-#include <vector>
 
 // Indexes for the candidates considered in 3D adaptive mode
 enum CandidateIndex : qint32 {
@@ -81,7 +81,7 @@ constexpr double cos4fsc(const qint32 i) {
 // Public methods -----------------------------------------------------------------------------------------------------
 
 Comb::Comb()
-    : configurationSet(false)
+    : configurationSet(false), scratchArena(&ownScratchArena), leadingFrames(0), reusedFrames(0)
 {
 }
 
@@ -130,6 +130,12 @@ void Comb::updateConfiguration(const LdDecodeMetaData::VideoParameters &_videoPa
         qCritical() << "Data is not in 4fsc sample rate, color decoding will not work properly!";
     }
 
+    // Discard any existing FrameBuffers, since they depend on the parameters
+    for (qint32 i = 0; i < 3; i++) {
+        doubleFrameBuffers[i].reset();
+        floatFrameBuffers[i].reset();
+    }
+
     configurationSet = true;
 }
 
@@ -139,12 +145,46 @@ void Comb::decodeFrames(const QVector<SourceField> &inputFields, qint32 startInd
     assert(configurationSet);
     assert((componentFrames.size() * 2) == (endIndex - startIndex));
 
+    if (configuration.singlePrecision) {
+        decodeFramesWith<float>(inputFields, startIndex, endIndex, componentFrames);
+    } else {
+        decodeFramesWith<double>(inputFields, startIndex, endIndex, componentFrames);
+    }
+}
+
+void Comb::setScratchArena(ScratchArena *arena)
+{
+    scratchArena = arena;
+}
+
+qint64 Comb::getLeadingFrames() const
+{
+    return leadingFrames;
+}
+
+qint64 Comb::getReusedFrames() const
+{
+    return reusedFrames;
+}
+
+// Private methods ----------------------------------------------------------------------------------------------------
+
+template <typename SampleType>
+void Comb::decodeFramesWith(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
+                            QVector<ComponentFrame> &componentFrames)
+{
     // Buffers for the next, current and previous frame.
-    // Because we only need three of these, we allocate them upfront then
-    // rotate the pointers below.
-    auto nextFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
-    auto currentFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
-    auto previousFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
+    // Because we only need three of these, we allocate them once then rotate
+    // the pointers below.
+    std::unique_ptr<FrameBuffer<SampleType>> *frameBuffers = getFrameBuffers<SampleType>();
+    for (qint32 i = 0; i < 3; i++) {
+        if (!frameBuffers[i]) {
+            frameBuffers[i] = std::make_unique<FrameBuffer<SampleType>>(videoParameters, configuration);
+        }
+    }
+    auto &nextFrameBuffer = frameBuffers[0];
+    auto &currentFrameBuffer = frameBuffers[1];
+    auto &previousFrameBuffer = frameBuffers[2];
 
     // Decode each pair of fields into a frame.
     // To support 3D operation, where we need to see three input frames at a time,
@@ -164,14 +204,28 @@ void Comb::decodeFrames(const QVector<SourceField> &inputFields, qint32 startInd
 
         // If there's another input field, bring it into nextFrameBuffer
         if (fieldIndex + 3 < inputFields.size()) {
-            // Load fields into the buffer
-            nextFrameBuffer->loadFields(inputFields[fieldIndex + 2], inputFields[fieldIndex + 3]);
-
-            // Extract chroma using 1D filter
-            nextFrameBuffer->split1D();
-
-            // Extract chroma using 2D filter
-            nextFrameBuffer->split2D();
+            const SourceField &firstField = inputFields[fieldIndex + 2];
+            const SourceField &secondField = inputFields[fieldIndex + 3];
+
+            if (fieldIndex < startIndex) leadingFrames++;
+
+            if (fieldIndex < startIndex && previousFrameBuffer->hasFields(firstField, secondField)) {
+                // The previous call's lookahead/last frame is this call's
+                // lookbehind/first frame, and it's already been split. This
+                // only happens when this Comb decoded the previous batch too.
+                // (previousFrameBuffer isn't needed until we reach startIndex.)
+                std::swap(nextFrameBuffer, previousFrameBuffer);
+                reusedFrames++;
+            } else if (!nextFrameBuffer->hasFields(firstField, secondField)) {
+                // Load fields into the buffer
+                nextFrameBuffer->loadFields(firstField, secondField);
+
+                // Extract chroma using 1D filter
+                nextFrameBuffer->split1D();
+
+                // Extract chroma using 2D filter
+                nextFrameBuffer->split2D();
+            }
         }
 
         if (fieldIndex < startIndex) {
@@ -196,11 +250,11 @@ void Comb::decodeFrames(const QVector<SourceField> &inputFields, qint32 startInd
             // Extract Y from baseband and I/Q
             currentFrameBuffer->adjustY();
         }
-        currentFrameBuffer->filterIQ();
+        currentFrameBuffer->filterIQ(*scratchArena);
 
         // Apply noise reduction
-        currentFrameBuffer->doCNR();
-        currentFrameBuffer->doYNR();
+        currentFrameBuffer->doCNR(*scratchArena);
+        currentFrameBuffer->doYNR(*scratchArena);
 
         // Transform I/Q to U/V
         currentFrameBuffer->transformIQ(configuration.chromaGain, configuration.chromaPhase);
@@ -212,9 +266,19 @@ void Comb::decodeFrames(const QVector<SourceField> &inputFields, qint32 startInd
     }
 }
 
-// Private methods ----------------------------------------------------------------------------------------------------
+// Return the persistent FrameBuffers for the given sample type
+template <typename SampleType>
+std::unique_ptr<Comb::FrameBuffer<SampleType>> *Comb::getFrameBuffers()
+{
+    if constexpr (std::is_same<SampleType, float>::value) {
+        return floatFrameBuffers;
+    } else {
+        return doubleFrameBuffers;
+    }
+}
 
-Comb::FrameBuffer::FrameBuffer(const LdDecodeMetaData::VideoParameters &videoParameters_,
+template <typename SampleType>
+Comb::FrameBuffer<SampleType>::FrameBuffer(const LdDecodeMetaData::VideoParameters &videoParameters_,
                                const Configuration &configuration_)
     : videoParameters(videoParameters_), configuration(configuration_)
 {
@@ -223,6 +287,23 @@ Comb::FrameBuffer::FrameBuffer(const LdDecodeMetaData::VideoParameters &videoPar
 
     // Set the IRE scale
     irescale = (videoParameters.white16bIre - videoParameters.black16bIre) / 100;
+
+    // Clear clpbuffer.
+    // The split functions only write to the active area, so the rest of the
+    // buffer stays clear while the FrameBuffer is reused.
+    for (qint32 buf = 0; buf < 3; buf++) {
+        for (qint32 y = 0; y < MAX_HEIGHT; y++) {
+            for (qint32 x = 0; x < MAX_WIDTH; x++) {
+                clpbuffer[buf].pixel[y][x] = 0.0;
+            }
+        }
+    }
+
+    // Nothing loaded yet
+    firstFieldSeqNo = -1;
+    secondFieldSeqNo = -1;
+    isSplit = false;
+    componentFrame = nullptr;
 }
 
 /*
@@ -238,7 +319,8 @@ Comb::FrameBuffer::FrameBuffer(const LdDecodeMetaData::VideoParameters &videoPar
  * getLinePhase returns true if the color burst is rising at the leading edge.
  */
 
-inline qint32 Comb::FrameBuffer::getFieldID(qint32 lineNumber) const
+template <typename SampleType>
+inline qint32 Comb::FrameBuffer<SampleType>::getFieldID(qint32 lineNumber) const
 {
     bool isFirstField = ((lineNumber % 2) == 0);
 
@@ -246,7 +328,8 @@ inline qint32 Comb::FrameBuffer::getFieldID(qint32 lineNumber) const
 }
 
 // NOTE:  lineNumber is presumed to be starting at 1.  (This lines up with how splitIQ calls it)
-inline bool Comb::FrameBuffer::getLinePhase(qint32 lineNumber) const
+template <typename SampleType>
+inline bool Comb::FrameBuffer<SampleType>::getLinePhase(qint32 lineNumber) const
 {
     qint32 fieldID = getFieldID(lineNumber);
     bool isPositivePhaseOnEvenLines = (fieldID == 1) || (fieldID == 4);
@@ -258,34 +341,60 @@ inline bool Comb::FrameBuffer::getLinePhase(qint32 lineNumber) const
 }
 
 // Interlace two source fields into the framebuffer.
-void Comb::FrameBuffer::loadFields(const SourceField &firstField, const SourceField &secondField)
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::loadFields(const SourceField &firstField, const SourceField &secondField)
 {
-    // Interlace the input fields and place in the frame buffer
+    // Interlace the input fields and place in the frame buffer.
+    // (rawbuffer keeps its allocation when the FrameBuffer is reused.)
+    const qint32 width = videoParameters.fieldWidth;
+    rawbuffer.resize((frameHeight + 1) * width);
     qint32 fieldLine = 0;
-    rawbuffer.clear();
     for (qint32 frameLine = 0; frameLine < frameHeight; frameLine += 2) {
-        rawbuffer.append(firstField.data.mid(fieldLine * videoParameters.fieldWidth, videoParameters.fieldWidth));
-        rawbuffer.append(secondField.data.mid(fieldLine * videoParameters.fieldWidth, videoParameters.fieldWidth));
+        std::copy_n(firstField.data.constData() + (fieldLine * width), width, rawbuffer.data() + (frameLine * width));
+        std::copy_n(secondField.data.constData() + (fieldLine * width), width, rawbuffer.data() + ((frameLine + 1) * width));
         fieldLine++;
     }
 
-    // Set the phase IDs for the frame
+    // Set the sequence numbers and phase IDs for the frame
+    firstFieldSeqNo = firstField.field.seqNo;
+    secondFieldSeqNo = secondField.field.seqNo;
     firstFieldPhaseID = firstField.field.fieldPhaseID;
     secondFieldPhaseID = secondField.field.fieldPhaseID;
 
-    // Clear clpbuffer
-    for (qint32 buf = 0; buf < 3; buf++) {
-        for (qint32 y = 0; y < MAX_HEIGHT; y++) {
-            for (qint32 x = 0; x < MAX_WIDTH; x++) {
-                clpbuffer[buf].pixel[y][x] = 0.0;
-            }
-        }
-    }
+    // Not split yet
+    isSplit = false;
 
     // No component frame yet
     componentFrame = nullptr;
 }
 
+// Return true if the given fields have already been loaded and split into this framebuffer.
+template <typename SampleType>
+bool Comb::FrameBuffer<SampleType>::hasFields(const SourceField &firstField, const SourceField &secondField) const
+{
+    if (!isSplit
+        || firstField.field.seqNo != firstFieldSeqNo || secondField.field.seqNo != secondFieldSeqNo
+        || firstField.field.fieldPhaseID != firstFieldPhaseID || secondField.field.fieldPhaseID != secondFieldPhaseID) {
+        return false;
+    }
+
+    // The metadata matches, but check the data too -- the black frames used
+    // for padding outside the input file have the metadata of a real frame
+    const qint32 width = videoParameters.fieldWidth;
+    qint32 fieldLine = 0;
+    for (qint32 frameLine = 0; frameLine < frameHeight; frameLine += 2) {
+        const quint16 *firstLine = firstField.data.constData() + (fieldLine * width);
+        const quint16 *secondLine = secondField.data.constData() + (fieldLine * width);
+        if (!std::equal(firstLine, firstLine + width, rawbuffer.constData() + (frameLine * width))
+            || !std::equal(secondLine, secondLine + width, rawbuffer.constData() + ((frameLine + 1) * width))) {
+            return false;
+        }
+        fieldLine++;
+    }
+
+    return true;
+}
+
 // Extract chroma into clpbuffer[0] using a 1D bandpass filter.
 //
 // The filter is [-0.25, 0, 0.5, 0, -0.25], a gentle bandpass centred on fSC.
@@ -294,17 +403,24 @@ void Comb::FrameBuffer::loadFields(const SourceField &firstField, const SourceFi
 //
 // This also acts as an alias removal pre-filter for the quadrature detector in
 // splitIQ, so we use its result for split2D rather than the raw signal.
-void Comb::FrameBuffer::split1D()
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::split1D()
 {
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
         // Get a pointer to the line's data
         const quint16 *line = rawbuffer.data() + (lineNumber * videoParameters.fieldWidth);
 
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            double tc1 = (line[h] - ((line[h - 2] + line[h + 2]) / 2.0)) / 2.0;
+        if constexpr (std::is_same<SampleType, float>::value) {
+            // Use the vectorised implementation
+            CombKernels::split1D(line, clpbuffer[0].pixel[lineNumber],
+                                 videoParameters.activeVideoStart, videoParameters.activeVideoEnd);
+        } else {
+            for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                double tc1 = (line[h] - ((line[h - 2] + line[h + 2]) / 2.0)) / 2.0;
 
-            // Record the 1D C value
-            clpbuffer[0].pixel[lineNumber][h] = tc1;
+                // Record the 1D C value
+                clpbuffer[0].pixel[lineNumber][h] = tc1;
+            }
         }
     }
 }
@@ -319,77 +435,90 @@ void Comb::FrameBuffer::split1D()
 // The "3-line adaptive" part means that we look at both surrounding lines to
 // estimate how similar they are to this one. We can then compute the 2D chroma
 // value as a blend of the two differences, weighted by similarity.
-void Comb::FrameBuffer::split2D()
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::split2D()
 {
     // Dummy black line
-    static constexpr double blackLine[MAX_WIDTH] = {0};
+    static constexpr SampleType blackLine[MAX_WIDTH] = {0};
+
+    // Map the difference into a weighting 0-1 (see below)
+    const double kRange = 45 * irescale;
 
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
         // Get pointers to the surrounding lines of 1D chroma.
         // If a line we need is outside the active area, use blackLine instead.
-        const double *previousLine = blackLine;
+        const SampleType *previousLine = blackLine;
         if (lineNumber - 2 >= videoParameters.firstActiveFrameLine) {
             previousLine = clpbuffer[0].pixel[lineNumber - 2];
         }
-        const double *currentLine = clpbuffer[0].pixel[lineNumber];
-        const double *nextLine = blackLine;
+        const SampleType *currentLine = clpbuffer[0].pixel[lineNumber];
+        const SampleType *nextLine = blackLine;
         if (lineNumber + 2 < videoParameters.lastActiveFrameLine) {
             nextLine = clpbuffer[0].pixel[lineNumber + 2];
         }
 
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            double kp, kn;
-
-            // Summing the differences of the *absolute* values of the 1D chroma samples
-            // will give us a low value if the two lines are nearly in phase (strong Y)
-            // or nearly 180 degrees out of phase (strong C) -- i.e. the two cases where
-            // the 2D filter is probably usable. Also give a small bonus if
-            // there's a large signal (we think).
-            kp  = fabs(fabs(currentLine[h]) - fabs(previousLine[h]));
-            kp += fabs(fabs(currentLine[h - 1]) - fabs(previousLine[h - 1]));
-            kp -= (fabs(currentLine[h]) + fabs(previousLine[h - 1])) * .10;
-            kn  = fabs(fabs(currentLine[h]) - fabs(nextLine[h]));
-            kn += fabs(fabs(currentLine[h - 1]) - fabs(nextLine[h - 1]));
-            kn -= (fabs(currentLine[h]) + fabs(nextLine[h - 1])) * .10;
-
-            // Map the difference into a weighting 0-1.
-            // 1 means in phase or unknown; 0 means out of phase (more than kRange difference).
-            const double kRange = 45 * irescale;
-            kp = qBound(0.0, 1 - (kp / kRange), 1.0);
-            kn = qBound(0.0, 1 - (kn / kRange), 1.0);
-
-            double sc = 1.0;
-
-            if ((kn > 0) || (kp > 0)) {
-                // At least one of the next/previous lines has a good phase relationship.
-
-                // If one of them is much better than the other, only use that one
-                if (kn > (3 * kp)) kp = 0;
-                else if (kp > (3 * kn)) kn = 0;
-
-                sc = (2.0 / (kn + kp));
-                if (sc < 1.0) sc = 1.0;
-            } else {
-                // Neither line has a good phase relationship.
-
-                // But are they similar to each other? If so, we can use both of them!
-                if ((fabs(fabs(previousLine[h]) - fabs(nextLine[h])) - fabs((nextLine[h] + previousLine[h]) * .2)) <= 0) {
-                    kn = kp = 1;
+        if constexpr (std::is_same<SampleType, float>::value) {
+            // Use the vectorised implementation
+            CombKernels::split2D(previousLine, currentLine, nextLine, clpbuffer[1].pixel[lineNumber],
+                                 videoParameters.activeVideoStart, videoParameters.activeVideoEnd,
+                                 static_cast<float>(kRange));
+        } else {
+            for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                double kp, kn;
+
+                // Summing the differences of the *absolute* values of the 1D chroma samples
+                // will give us a low value if the two lines are nearly in phase (strong Y)
+                // or nearly 180 degrees out of phase (strong C) -- i.e. the two cases where
+                // the 2D filter is probably usable. Also give a small bonus if
+                // there's a large signal (we think).
+                kp  = fabs(fabs(currentLine[h]) - fabs(previousLine[h]));
+                kp += fabs(fabs(currentLine[h - 1]) - fabs(previousLine[h - 1]));
+                kp -= (fabs(currentLine[h]) + fabs(previousLine[h - 1])) * .10;
+                kn  = fabs(fabs(currentLine[h]) - fabs(nextLine[h]));
+                kn += fabs(fabs(currentLine[h - 1]) - fabs(nextLine[h - 1]));
+                kn -= (fabs(currentLine[h]) + fabs(nextLine[h - 1])) * .10;
+
+                // Map the difference into a weighting 0-1.
+                // 1 means in phase or unknown; 0 means out of phase (more than kRange difference).
+                kp = qBound(0.0, 1 - (kp / kRange), 1.0);
+                kn = qBound(0.0, 1 - (kn / kRange), 1.0);
+
+                double sc = 1.0;
+
+                if ((kn > 0) || (kp > 0)) {
+                    // At least one of the next/previous lines has a good phase relationship.
+
+                    // If one of them is much better than the other, only use that one
+                    if (kn > (3 * kp)) kp = 0;
+                    else if (kp > (3 * kn)) kn = 0;
+
+                    sc = (2.0 / (kn + kp));
+                    if (sc < 1.0) sc = 1.0;
+                } else {
+                    // Neither line has a good phase relationship.
+
+                    // But are they similar to each other? If so, we can use both of them!
+                    if ((fabs(fabs(previousLine[h]) - fabs(nextLine[h])) - fabs((nextLine[h] + previousLine[h]) * .2)) <= 0) {
+                        kn = kp = 1;
+                    }
+
+                    // Else kn = kp = 0, so we won't extract any chroma for this sample.
+                    // (Some NTSC decoders fall back to the 1D chroma in this situation.)
                 }
 
-                // Else kn = kp = 0, so we won't extract any chroma for this sample.
-                // (Some NTSC decoders fall back to the 1D chroma in this situation.)
-            }
-
-            // Compute the weighted sum of differences, giving the 2D chroma value
-            double tc1;
-            tc1  = ((currentLine[h] - previousLine[h]) * kp * sc);
-            tc1 += ((currentLine[h] - nextLine[h]) * kn * sc);
-            tc1 /= 4;
+                // Compute the weighted sum of differences, giving the 2D chroma value
+                double tc1;
+                tc1  = ((currentLine[h] - previousLine[h]) * kp * sc);
+                tc1 += ((currentLine[h] - nextLine[h]) * kn * sc);
+                tc1 /= 4;
 
-            clpbuffer[1].pixel[lineNumber][h] = tc1;
+                clpbuffer[1].pixel[lineNumber][h] = tc1;
+            }
         }
     }
+
+    // The 1D and 2D results are now available for reuse
+    isSplit = true;
 }
 
 // Extract chroma into clpbuffer[2] using an adaptive 3D filter.
@@ -398,30 +527,56 @@ void Comb::FrameBuffer::split2D()
 // should have a 180 degree phase relationship to the current sample, and look
 // like they have similar luma/chroma content. It then picks the most similar
 // candidate.
-void Comb::FrameBuffer::split3D(const FrameBuffer &previousFrame, const FrameBuffer &nextFrame)
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::split3D(const FrameBuffer &previousFrame, const FrameBuffer &nextFrame)
 {
-    for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            // Select the best candidate
-            qint32 bestIndex;
-            double bestSample;
-            getBestCandidate(lineNumber, h, previousFrame, nextFrame, bestIndex, bestSample);
-
-            if (bestIndex < CAND_PREV_FIELD) {
-                // A 1D or 2D candidate was best.
-                // Use split2D's output, to save duplicating the line-blending heuristics here.
-                clpbuffer[2].pixel[lineNumber][h] = clpbuffer[1].pixel[lineNumber][h];
+    if constexpr (std::is_same<SampleType, float>::value) {
+        // Use the vectorised implementation, which evaluates the same
+        // candidates as getBestCandidate for a whole line at a time
+        for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+            CombKernels::Candidate3D candidates[NUM_CANDIDATES];
+            qint32 numCandidates = 0;
+            if (configuration.adaptive) {
+                getLineCandidates(lineNumber, previousFrame, nextFrame, candidates);
+                numCandidates = NUM_CANDIDATES;
             } else {
-                // Compute a 3D result.
-                // This sample is Y + C; the candidate is (ideally) Y - C. So compute C as ((Y + C) - (Y - C)) / 2.
-                clpbuffer[2].pixel[lineNumber][h] = (clpbuffer[0].pixel[lineNumber][h] - bestSample) / 2;
+                // Adaptive mode is disabled - do 3D against the previous frame
+                candidates[0] = getLineCandidate(lineNumber, previousFrame, lineNumber, 0, 0);
+                numCandidates = 1;
+            }
+
+            CombKernels::split3D(rawbuffer.data() + (lineNumber * videoParameters.fieldWidth),
+                                 clpbuffer[0].pixel[lineNumber], clpbuffer[1].pixel[lineNumber],
+                                 candidates, numCandidates, configuration.adaptive ? CAND_PREV_FIELD : 0,
+                                 clpbuffer[2].pixel[lineNumber],
+                                 videoParameters.activeVideoStart, videoParameters.activeVideoEnd,
+                                 static_cast<float>(irescale));
+        }
+    } else {
+        for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+            for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                // Select the best candidate
+                qint32 bestIndex;
+                double bestSample;
+                getBestCandidate(lineNumber, h, previousFrame, nextFrame, bestIndex, bestSample);
+
+                if (bestIndex < CAND_PREV_FIELD) {
+                    // A 1D or 2D candidate was best.
+                    // Use split2D's output, to save duplicating the line-blending heuristics here.
+                    clpbuffer[2].pixel[lineNumber][h] = clpbuffer[1].pixel[lineNumber][h];
+                } else {
+                    // Compute a 3D result.
+                    // This sample is Y + C; the candidate is (ideally) Y - C. So compute C as ((Y + C) - (Y - C)) / 2.
+                    clpbuffer[2].pixel[lineNumber][h] = (clpbuffer[0].pixel[lineNumber][h] - bestSample) / 2;
+                }
             }
         }
     }
 }
 
 // Evaluate all candidates for 3D decoding for a given position, and return the best one
-void Comb::FrameBuffer::getBestCandidate(qint32 lineNumber, qint32 h,
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::getBestCandidate(qint32 lineNumber, qint32 h,
                                          const FrameBuffer &previousFrame, const FrameBuffer &nextFrame,
                                          qint32 &bestIndex, double &bestSample) const
 {
@@ -468,9 +623,10 @@ void Comb::FrameBuffer::getBestCandidate(qint32 lineNumber, qint32 h,
 }
 
 // Evaluate a candidate for 3D decoding
-Comb::FrameBuffer::Candidate Comb::FrameBuffer::getCandidate(qint32 refLineNumber, qint32 refH,
-                                                             const FrameBuffer &frameBuffer, qint32 lineNumber, qint32 h,
-                                                             double adjustPenalty) const
+template <typename SampleType>
+typename Comb::FrameBuffer<SampleType>::Candidate Comb::FrameBuffer<SampleType>::getCandidate(qint32 refLineNumber, qint32 refH,
+                                                                                              const FrameBuffer &frameBuffer, qint32 lineNumber, qint32 h,
+                                                                                              double adjustPenalty) const
 {
     Candidate result;
     result.sample = frameBuffer.clpbuffer[0].pixel[lineNumber][h];
@@ -525,6 +681,59 @@ Comb::FrameBuffer::Candidate Comb::FrameBuffer::getCandidate(qint32 refLineNumbe
     return result;
 }
 
+// Describe the candidates that getBestCandidate would evaluate for each sample
+// in a line, for the vectorised 3D filter
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::getLineCandidates(qint32 lineNumber,
+                                                      const FrameBuffer &previousFrame, const FrameBuffer &nextFrame,
+                                                      CombKernels::Candidate3D *candidates) const
+{
+    // Bias the comparison so that we prefer 3D results, then 2D, then 1D
+    static constexpr double LINE_BONUS = -2.0;
+    static constexpr double FIELD_BONUS = LINE_BONUS - 2.0;
+    static constexpr double FRAME_BONUS = FIELD_BONUS - 2.0;
+
+    candidates[CAND_LEFT]  = getLineCandidate(lineNumber, *this, lineNumber, -2, 0);
+    candidates[CAND_RIGHT] = getLineCandidate(lineNumber, *this, lineNumber, 2, 0);
+    candidates[CAND_UP]    = getLineCandidate(lineNumber, *this, lineNumber - 2, 0, LINE_BONUS);
+    candidates[CAND_DOWN]  = getLineCandidate(lineNumber, *this, lineNumber + 2, 0, LINE_BONUS);
+
+    if (getLinePhase(lineNumber) == getLinePhase(lineNumber - 1)) {
+        candidates[CAND_PREV_FIELD] = getLineCandidate(lineNumber, previousFrame, lineNumber - 1, 0, FIELD_BONUS);
+        candidates[CAND_NEXT_FIELD] = getLineCandidate(lineNumber, *this, lineNumber + 1, 0, FIELD_BONUS);
+    } else {
+        candidates[CAND_PREV_FIELD] = getLineCandidate(lineNumber, *this, lineNumber - 1, 0, FIELD_BONUS);
+        candidates[CAND_NEXT_FIELD] = getLineCandidate(lineNumber, nextFrame, lineNumber + 1, 0, FIELD_BONUS);
+    }
+
+    candidates[CAND_PREV_FRAME] = getLineCandidate(lineNumber, previousFrame, lineNumber, 0, FRAME_BONUS);
+    candidates[CAND_NEXT_FRAME] = getLineCandidate(lineNumber, nextFrame, lineNumber, 0, FRAME_BONUS);
+}
+
+// Describe a candidate line for the vectorised 3D filter, applying the same
+// viability tests as getCandidate. The phase test doesn't depend on the
+// position within the line, so it's only done once.
+template <typename SampleType>
+CombKernels::Candidate3D Comb::FrameBuffer<SampleType>::getLineCandidate(qint32 refLineNumber,
+                                                                         const FrameBuffer &frameBuffer, qint32 lineNumber,
+                                                                         qint32 offset, double adjustPenalty) const
+{
+    CombKernels::Candidate3D result;
+    result.line = frameBuffer.rawbuffer.data() + (lineNumber * videoParameters.fieldWidth);
+    result.chroma1D = frameBuffer.clpbuffer[0].pixel[lineNumber];
+    result.chroma2D = frameBuffer.clpbuffer[1].pixel[lineNumber];
+    result.offset = offset;
+    result.adjustPenalty = static_cast<float>(adjustPenalty);
+
+    const qint32 refH = videoParameters.activeVideoStart;
+    const qint32 wantPhase = (2 + (getLinePhase(refLineNumber) ? 2 : 0) + refH) % 4;
+    const qint32 havePhase = ((frameBuffer.getLinePhase(lineNumber) ? 2 : 0) + refH + offset) % 4;
+    result.viable = lineNumber >= videoParameters.firstActiveFrameLine && lineNumber < videoParameters.lastActiveFrameLine
+                    && wantPhase == havePhase;
+
+    return result;
+}
+
 namespace {
     // Information about a line we're decoding.
     struct BurstInfo {
@@ -566,7 +775,8 @@ namespace {
 }
 
 // Split I and Q, taking burst phase into account.
-void Comb::FrameBuffer::splitIQlocked()
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::splitIQlocked()
 {
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
         // Get a pointer to the line's data
@@ -600,7 +810,8 @@ void Comb::FrameBuffer::splitIQlocked()
 }
 
 // Spilt the I and Q
-void Comb::FrameBuffer::splitIQ()
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::splitIQ()
 {
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
         // Get a pointer to the line's data
@@ -612,54 +823,63 @@ void Comb::FrameBuffer::splitIQ()
 
         bool linePhase = getLinePhase(lineNumber);
 
-        double si = 0, sq = 0;
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            qint32 phase = h % 4;
+        if constexpr (std::is_same<SampleType, float>::value) {
+            // Use the vectorised implementation
+            CombKernels::splitIQ(line, clpbuffer[configuration.dimensions - 1].pixel[lineNumber], linePhase,
+                                 Y, I, Q, videoParameters.activeVideoStart, videoParameters.activeVideoEnd);
+        } else {
+            double si = 0, sq = 0;
+            for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                qint32 phase = h % 4;
 
-            double cavg = clpbuffer[configuration.dimensions - 1].pixel[lineNumber][h];
+                double cavg = clpbuffer[configuration.dimensions - 1].pixel[lineNumber][h];
 
-            if (linePhase) cavg = -cavg;
+                if (linePhase) cavg = -cavg;
 
-            switch (phase) {
-                case 0: sq = cavg; break;
-                case 1: si = -cavg; break;
-                case 2: sq = -cavg; break;
-                case 3: si = cavg; break;
-                default: break;
-            }
+                switch (phase) {
+                    case 0: sq = cavg; break;
+                    case 1: si = -cavg; break;
+                    case 2: sq = -cavg; break;
+                    case 3: si = cavg; break;
+                    default: break;
+                }
 
-            Y[h] = line[h];
-            I[h] = si;
-            Q[h] = sq;
+                Y[h] = line[h];
+                I[h] = si;
+                Q[h] = sq;
+            }
         }
     }
 }
 
 // Filter the IQ from the component frame
-void Comb::FrameBuffer::filterIQ()
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::filterIQ(ScratchArena &scratchArena)
 {
     auto iqFilter = makeFIRFilter(c_colorlp_b);
 
     // Temporary output buffer for the filter
+    ScratchArena::Scope scope(scratchArena);
     const int width = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
-    std::vector<double> tempBuf(width);
+    double *tempBuf = scratchArena.allocate<double>(width);
 
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
         double *I = componentFrame->u(lineNumber) + videoParameters.activeVideoStart;
         double *Q = componentFrame->v(lineNumber) + videoParameters.activeVideoStart;
 
         // Apply filter to I
-        iqFilter.apply(I, tempBuf.data(), width);
-        std::copy(tempBuf.begin(), tempBuf.end(), I);
+        iqFilter.apply(I, tempBuf, width);
+        std::copy_n(tempBuf, width, I);
 
         // Apply filter to Q
-        iqFilter.apply(Q, tempBuf.data(), width);
-        std::copy(tempBuf.begin(), tempBuf.end(), Q);
+        iqFilter.apply(Q, tempBuf, width);
+        std::copy_n(tempBuf, width, Q);
     }
 }
 
 // Remove the colour data from the baseband (Y)
-void Comb::FrameBuffer::adjustY()
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::adjustY()
 {
     // remove color data from baseband (Y)
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
@@ -695,48 +915,34 @@ void Comb::FrameBuffer::adjustY()
  * which removes small high frequency noise.
  */
 
-void Comb::FrameBuffer::doCNR()
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::doCNR(ScratchArena &scratchArena)
 {
     if (configuration.cNRLevel == 0) return;
 
     // nr_c is the coring level
     const double nr_c = configuration.cNRLevel * irescale;
 
-    // High-pass filters for I/Q
-    auto iFilter(f_nrc);
-    auto qFilter(f_nrc);
-
-    // Filter delay (since it's a symmetric FIR filter)
-    const qint32 delay = c_nrc_b.size() / 2;
+    // High-pass filter for I/Q
+    const auto nrFilter = makeFIRFilter(c_nrc_b);
 
     // High-pass result
-    // TODO: Cache arrays instead of reallocating every field.
-    std::vector<double> hpI(videoParameters.activeVideoEnd + delay);
-    std::vector<double> hpQ(videoParameters.activeVideoEnd + delay);
-
+    ScratchArena::Scope scope(scratchArena);
+    const qint32 width = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
+    double *hpI = scratchArena.allocate<double>(width);
+    double *hpQ = scratchArena.allocate<double>(width);
 
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
-        double *I = componentFrame->u(lineNumber);
-        double *Q = componentFrame->v(lineNumber);
+        double *I = componentFrame->u(lineNumber) + videoParameters.activeVideoStart;
+        double *Q = componentFrame->v(lineNumber) + videoParameters.activeVideoStart;
 
-        // Feed zeros into the filter outside the active area
-        for (qint32 h = videoParameters.activeVideoStart - delay; h < videoParameters.activeVideoStart; h++) {
-            iFilter.feed(0.0);
-            qFilter.feed(0.0);
-        }
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            hpI[h] = iFilter.feed(I[h]);
-            hpQ[h] = qFilter.feed(Q[h]);
-        }
-        for (qint32 h = videoParameters.activeVideoEnd; h < videoParameters.activeVideoEnd + delay; h++) {
-            hpI[h] = iFilter.feed(0.0);
-            hpQ[h] = qFilter.feed(0.0);
-        }
+        // Filter the active area of the line, treating samples outside it as 0
+        nrFilter.apply(I, hpI, width);
+        nrFilter.apply(Q, hpQ, width);
 
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            // Offset to cover the filter delay
-            double ai = hpI[h + delay];
-            double aq = hpQ[h + delay];
+        for (qint32 h = 0; h < width; h++) {
+            double ai = hpI[h];
+            double aq = hpQ[h];
 
             // Clip the filter strength
             if (fabs(ai) > nr_c) {
@@ -752,7 +958,8 @@ void Comb::FrameBuffer::doCNR()
     }
 }
 
-void Comb::FrameBuffer::doYNR()
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::doYNR(ScratchArena &scratchArena)
 {
     if (configuration.yNRLevel == 0) return;
 
@@ -760,31 +967,21 @@ void Comb::FrameBuffer::doYNR()
     double nr_y = configuration.yNRLevel * irescale;
 
     // High-pass filter for Y
-    auto yFilter(f_nr);
-
-    // Filter delay (since it's a symmetric FIR filter)
-    const qint32 delay = c_nr_b.size() / 2;
+    const auto nrFilter = makeFIRFilter(c_nr_b);
 
     // High-pass result
-    std::vector<double> hpY(videoParameters.activeVideoEnd + delay);
+    ScratchArena::Scope scope(scratchArena);
+    const qint32 width = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
+    double *hpY = scratchArena.allocate<double>(width);
 
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
-        double *Y = componentFrame->y(lineNumber);
+        double *Y = componentFrame->y(lineNumber) + videoParameters.activeVideoStart;
 
-        // Feed zeros into the filter outside the active area
-        for (qint32 h = videoParameters.activeVideoStart - delay; h < videoParameters.activeVideoStart; h++) {
-            yFilter.feed(0.0);
-        }
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            hpY[h] = yFilter.feed(Y[h]);
-        }
-        for (qint32 h = videoParameters.activeVideoEnd; h < videoParameters.activeVideoEnd + delay; h++) {
-            hpY[h] = yFilter.feed(0.0);
-        }
+        // Filter the active area of the line, treating samples outside it as 0
+        nrFilter.apply(Y, hpY, width);
 
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            // Offset to cover the filter delay
-            double a = hpY[h + delay];
+        for (qint32 h = 0; h < width; h++) {
+            double a = hpY[h];
 
             // Clip the filter strength
             if (fabs(a) > nr_y) {
@@ -797,7 +994,8 @@ void Comb::FrameBuffer::doYNR()
 }
 
 // Transform I/Q into U/V, and apply chroma gain
-void Comb::FrameBuffer::transformIQ(double chromaGain, double chromaPhase)
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::transformIQ(double chromaGain, double chromaPhase)
 {
     // Compute components for the rotation vector
     const double theta = ((33 + chromaPhase) * M_PI) / 180;
@@ -820,7 +1018,8 @@ void Comb::FrameBuffer::transformIQ(double chromaGain, double chromaPhase)
 }
 
 // Overlay the 3D filter map onto the output
-void Comb::FrameBuffer::overlayMap(const FrameBuffer &previousFrame, const FrameBuffer &nextFrame)
+template <typename SampleType>
+void Comb::FrameBuffer<SampleType>::overlayMap(const FrameBuffer &previousFrame, const FrameBuffer &nextFrame)
 {
     qDebug() << "Comb::FrameBuffer::overlayMap(): Overlaying map onto output";
 
@@ -33,10 +33,14 @@
 #include <QFile>
 #include <QtMath>
 
+#include <memory>
+
 #include "lddecodemetadata.h"
 
+#include "combkernels.h"
 #include "componentframe.h"
 #include "decoder.h"
+#include "scratcharena.h"
 #include "sourcefield.h"
 
 class Comb
@@ -53,6 +57,11 @@ public:
         bool showMap = false;
         bool phaseCompensation = false;
 
+        // Use single-precision intermediate buffers and vectorised kernels.
+        // This is faster, but the output may differ very slightly from the
+        // double-precision path.
+        bool singlePrecision = false;
+
         double cNRLevel = 0.0;
         double yNRLevel = 1.0;
 
@@ -68,6 +77,17 @@ public:
     void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                       QVector<ComponentFrame> &componentFrames);
 
+    // Allocate temporary buffers from arena, rather than the Comb's own arena.
+    // arena must remain valid for as long as the Comb is used.
+    void setScratchArena(ScratchArena *arena);
+
+    // Statistics on reusing frames between calls to decodeFrames: the total
+    // number of leading frames (the first frame and, in 3D mode, the
+    // look-behind frame), and how many of those were reused from the
+    // previous call rather than loaded and split again
+    qint64 getLeadingFrames() const;
+    qint64 getReusedFrames() const;
+
     // Maximum frame size
     static constexpr qint32 MAX_WIDTH = 910;
     static constexpr qint32 MAX_HEIGHT = 525;
@@ -80,12 +100,43 @@ private:
     Configuration configuration;
     LdDecodeMetaData::VideoParameters videoParameters;
 
-    // An input frame in the process of being decoded
+    // Arena for temporary buffers
+    ScratchArena ownScratchArena;
+    ScratchArena *scratchArena;
+
+    // Decode frames using FrameBuffers with the given sample type
+    template <typename SampleType>
+    void decodeFramesWith(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
+                          QVector<ComponentFrame> &componentFrames);
+
+    // Forward declaration for the FrameBuffer pointers below
+    template <typename SampleType>
+    class FrameBuffer;
+
+    // FrameBuffers for the next, current and previous frame, with the given sample type.
+    // These are kept between calls to decodeFrames, so their allocations are
+    // reused, and a frame that has already been loaded and split can be
+    // reused if the next call's leading frames follow on from this call's.
+    // DecoderPool hands batches to whichever thread asks first, so with more
+    // than one thread that is uncommon; see getReusedFrames.
+    template <typename SampleType>
+    std::unique_ptr<FrameBuffer<SampleType>> *getFrameBuffers();
+    std::unique_ptr<FrameBuffer<double>> doubleFrameBuffers[3];
+    std::unique_ptr<FrameBuffer<float>> floatFrameBuffers[3];
+
+    // Statistics for getLeadingFrames and getReusedFrames
+    qint64 leadingFrames;
+    qint64 reusedFrames;
+
+    // An input frame in the process of being decoded.
+    // SampleType is the type used for the intermediate chroma samples.
+    template <typename SampleType>
     class FrameBuffer {
     public:
         FrameBuffer(const LdDecodeMetaData::VideoParameters &videoParameters_, const Configuration &configuration_);
 
         void loadFields(const SourceField &firstField, const SourceField &secondField);
+        bool hasFields(const SourceField &firstField, const SourceField &secondField) const;
 
         void split1D();
         void split2D();
@@ -97,11 +148,11 @@ private:
 
         void splitIQ();
         void splitIQlocked();
-        void filterIQ();
+        void filterIQ(ScratchArena &scratchArena);
         void filterIQFull();
         void adjustY();
-        void doCNR();
-        void doYNR();
+        void doCNR(ScratchArena &scratchArena);
+        void doYNR(ScratchArena &scratchArena);
         void transformIQ(double chromaGain, double chromaPhase);
 
         void overlayMap(const FrameBuffer &previousFrame, const FrameBuffer &nextFrame);
@@ -119,13 +170,18 @@ private:
         // Baseband samples (interlaced to form a complete frame)
         SourceVideo::Data rawbuffer;
 
-        // Chroma phase of the frame's two fields
+        // Sequence numbers and chroma phase of the frame's two fields
+        qint32 firstFieldSeqNo;
+        qint32 secondFieldSeqNo;
         qint32 firstFieldPhaseID;
         qint32 secondFieldPhaseID;
 
+        // True if split1D and split2D have been applied to the loaded fields
+        bool isSplit;
+
         // 1D, 2D and 3D-filtered chroma samples
         struct Sample {
-            double pixel[MAX_HEIGHT][MAX_WIDTH];
+            SampleType pixel[MAX_HEIGHT][MAX_WIDTH];
         } clpbuffer[3];
 
         // Result of evaluating a 3D candidate
@@ -145,6 +201,11 @@ private:
         Candidate getCandidate(qint32 refLineNumber, qint32 refH,
                                const FrameBuffer &frameBuffer, qint32 lineNumber, qint32 h,
                                double adjustPenalty) const;
+        void getLineCandidates(qint32 lineNumber, const FrameBuffer &previousFrame, const FrameBuffer &nextFrame,
+                               CombKernels::Candidate3D *candidates) const;
+        CombKernels::Candidate3D getLineCandidate(qint32 refLineNumber,
+                                                  const FrameBuffer &frameBuffer, qint32 lineNumber,
+                                                  qint32 offset, double adjustPenalty) const;
     };
 };
 
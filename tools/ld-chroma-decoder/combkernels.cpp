@@ -0,0 +1,439 @@
+/************************************************************************
+
+    combkernels.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "combkernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+// AVX2 is only available through GCC/Clang target attributes on x86
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define COMBKERNELS_AVX2
+#include <immintrin.h>
+#endif
+
+// Scalar implementations -------------------------------------------------------------------------------------------
+
+void CombKernels::split1DScalar(const quint16 *line, float *output, qint32 start, qint32 end)
+{
+    for (qint32 h = start; h < end; h++) {
+        output[h] = (line[h] - ((line[h - 2] + line[h + 2]) * 0.5f)) * 0.5f;
+    }
+}
+
+// Compute a single sample of 2D chroma
+static inline float split2DSample(const float *previousLine, const float *currentLine, const float *nextLine,
+                                  qint32 h, float kRange)
+{
+    float kp, kn;
+
+    kp  = std::fabs(std::fabs(currentLine[h]) - std::fabs(previousLine[h]));
+    kp += std::fabs(std::fabs(currentLine[h - 1]) - std::fabs(previousLine[h - 1]));
+    kp -= (std::fabs(currentLine[h]) + std::fabs(previousLine[h - 1])) * 0.10f;
+    kn  = std::fabs(std::fabs(currentLine[h]) - std::fabs(nextLine[h]));
+    kn += std::fabs(std::fabs(currentLine[h - 1]) - std::fabs(nextLine[h - 1]));
+    kn -= (std::fabs(currentLine[h]) + std::fabs(nextLine[h - 1])) * 0.10f;
+
+    kp = std::max(0.0f, std::min(1.0f - (kp / kRange), 1.0f));
+    kn = std::max(0.0f, std::min(1.0f - (kn / kRange), 1.0f));
+
+    float sc = 1.0f;
+
+    if ((kn > 0) || (kp > 0)) {
+        if (kn > (3 * kp)) kp = 0;
+        else if (kp > (3 * kn)) kn = 0;
+
+        sc = std::max(2.0f / (kn + kp), 1.0f);
+    } else {
+        if ((std::fabs(std::fabs(previousLine[h]) - std::fabs(nextLine[h]))
+             - std::fabs((nextLine[h] + previousLine[h]) * 0.2f)) <= 0) {
+            kn = kp = 1;
+        }
+    }
+
+    return (((currentLine[h] - previousLine[h]) * kp * sc) + ((currentLine[h] - nextLine[h]) * kn * sc)) * 0.25f;
+}
+
+void CombKernels::split2DScalar(const float *previousLine, const float *currentLine, const float *nextLine,
+                                float *output, qint32 start, qint32 end, float kRange)
+{
+    for (qint32 h = start; h < end; h++) {
+        output[h] = split2DSample(previousLine, currentLine, nextLine, h, kRange);
+    }
+}
+
+// Compute the penalty for a viable 3D candidate at sample h, as in
+// Comb::FrameBuffer::getCandidate
+static inline float candidatePenalty(const quint16 *line, const float *chroma2D,
+                                     const CombKernels::Candidate3D &candidate, qint32 h, float irescale)
+{
+    const qint32 ch = h + candidate.offset;
+
+    // Penalty based on mean luma difference in IRE over surrounding three samples
+    float yPenalty = 0.0f;
+    for (qint32 offset = -1; offset < 2; offset++) {
+        const float refY = line[h + offset] - chroma2D[h + offset];
+        const float candidateY = candidate.line[ch + offset] - candidate.chroma2D[ch + offset];
+        yPenalty += std::fabs(refY - candidateY);
+    }
+    yPenalty = yPenalty / 3 / irescale;
+
+    // Penalty based on mean I/Q difference in IRE over surrounding three
+    // samples (the reference and candidate are 180 degrees out of phase, so
+    // negate one)
+    static constexpr float weights[] = {0.5f, 1.0f, 0.5f};
+    float iqPenalty = 0.0f;
+    for (qint32 offset = -1; offset < 2; offset++) {
+        iqPenalty += std::fabs(chroma2D[h + offset] + candidate.chroma2D[ch + offset]) * weights[offset + 1];
+    }
+    iqPenalty = (iqPenalty / 2 / irescale) * 0.28f;
+
+    return (yPenalty + iqPenalty) + candidate.adjustPenalty;
+}
+
+// Penalty for a candidate that isn't viable
+static constexpr float NON_VIABLE_PENALTY = 1000.0f;
+
+void CombKernels::split3DScalar(const quint16 *line, const float *chroma1D, const float *chroma2D,
+                                const Candidate3D *candidates, qint32 numCandidates, qint32 num2DCandidates,
+                                float *output, qint32 start, qint32 end, float irescale)
+{
+    for (qint32 h = start; h < end; h++) {
+        // Find the candidate with the lowest penalty
+        qint32 bestIndex = 0;
+        float bestPenalty = 0.0f;
+        for (qint32 i = 0; i < numCandidates; i++) {
+            const float penalty = candidates[i].viable ? candidatePenalty(line, chroma2D, candidates[i], h, irescale)
+                                                       : NON_VIABLE_PENALTY;
+            if (i == 0 || penalty < bestPenalty) {
+                bestIndex = i;
+                bestPenalty = penalty;
+            }
+        }
+
+        if (bestIndex < num2DCandidates) {
+            output[h] = chroma2D[h];
+        } else {
+            const Candidate3D &best = candidates[bestIndex];
+            output[h] = (chroma1D[h] - best.chroma1D[h + best.offset]) / 2;
+        }
+    }
+}
+
+// Demodulate samples [start, end) of a line, carrying the most recent I and Q
+// values in si and sq
+static inline void splitIQSamples(const quint16 *line, const float *chroma, bool invert,
+                                  double *Y, double *I, double *Q, qint32 start, qint32 end,
+                                  double &si, double &sq)
+{
+    for (qint32 h = start; h < end; h++) {
+        double cavg = chroma[h];
+        if (invert) cavg = -cavg;
+
+        switch (h % 4) {
+            case 0: sq = cavg; break;
+            case 1: si = -cavg; break;
+            case 2: sq = -cavg; break;
+            case 3: si = cavg; break;
+            default: break;
+        }
+
+        Y[h] = line[h];
+        I[h] = si;
+        Q[h] = sq;
+    }
+}
+
+void CombKernels::splitIQScalar(const quint16 *line, const float *chroma, bool invert,
+                                double *Y, double *I, double *Q, qint32 start, qint32 end)
+{
+    double si = 0, sq = 0;
+    splitIQSamples(line, chroma, invert, Y, I, Q, start, end, si, sq);
+}
+
+// AVX2 implementations ---------------------------------------------------------------------------------------------
+
+#ifdef COMBKERNELS_AVX2
+
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+
+// Load 8 unsigned 16-bit samples as floats
+AVX2_FUNCTION static inline __m256 load8u16(const quint16 *data)
+{
+    const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(raw));
+}
+
+AVX2_FUNCTION static inline __m256 abs8(__m256 x)
+{
+    return _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)));
+}
+
+AVX2_FUNCTION static void split1DAVX2(const quint16 *line, float *output, qint32 start, qint32 end)
+{
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    qint32 h = start;
+    for (; h + 8 <= end; h += 8) {
+        const __m256 centre = load8u16(line + h);
+        const __m256 sides = _mm256_add_ps(load8u16(line + h - 2), load8u16(line + h + 2));
+        const __m256 result = _mm256_mul_ps(_mm256_sub_ps(centre, _mm256_mul_ps(sides, half)), half);
+        _mm256_storeu_ps(output + h, result);
+    }
+
+    // Remaining samples
+    CombKernels::split1DScalar(line, output, h, end);
+}
+
+AVX2_FUNCTION static void split2DAVX2(const float *previousLine, const float *currentLine, const float *nextLine,
+                                      float *output, qint32 start, qint32 end, float kRange)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 three = _mm256_set1_ps(3.0f);
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    const __m256 tenth = _mm256_set1_ps(0.10f);
+    const __m256 fifth = _mm256_set1_ps(0.2f);
+    const __m256 range = _mm256_set1_ps(kRange);
+
+    qint32 h = start;
+    for (; h + 8 <= end; h += 8) {
+        const __m256 c = _mm256_loadu_ps(currentLine + h);
+        const __m256 p = _mm256_loadu_ps(previousLine + h);
+        const __m256 n = _mm256_loadu_ps(nextLine + h);
+        const __m256 absC = abs8(c);
+        const __m256 absP = abs8(p);
+        const __m256 absN = abs8(n);
+        const __m256 absC1 = abs8(_mm256_loadu_ps(currentLine + h - 1));
+        const __m256 absP1 = abs8(_mm256_loadu_ps(previousLine + h - 1));
+        const __m256 absN1 = abs8(_mm256_loadu_ps(nextLine + h - 1));
+
+        // Line similarity, as in split2DSample
+        __m256 kp = _mm256_add_ps(abs8(_mm256_sub_ps(absC, absP)), abs8(_mm256_sub_ps(absC1, absP1)));
+        kp = _mm256_sub_ps(kp, _mm256_mul_ps(_mm256_add_ps(absC, absP1), tenth));
+        __m256 kn = _mm256_add_ps(abs8(_mm256_sub_ps(absC, absN)), abs8(_mm256_sub_ps(absC1, absN1)));
+        kn = _mm256_sub_ps(kn, _mm256_mul_ps(_mm256_add_ps(absC, absN1), tenth));
+
+        kp = _mm256_max_ps(zero, _mm256_min_ps(_mm256_sub_ps(one, _mm256_div_ps(kp, range)), one));
+        kn = _mm256_max_ps(zero, _mm256_min_ps(_mm256_sub_ps(one, _mm256_div_ps(kn, range)), one));
+
+        // Lanes where at least one line has a good phase relationship
+        const __m256 anyGood = _mm256_or_ps(_mm256_cmp_ps(kn, zero, _CMP_GT_OQ), _mm256_cmp_ps(kp, zero, _CMP_GT_OQ));
+
+        // ... if one is much better than the other, only use that one
+        const __m256 knBetter = _mm256_cmp_ps(kn, _mm256_mul_ps(three, kp), _CMP_GT_OQ);
+        const __m256 kpBetter = _mm256_andnot_ps(knBetter, _mm256_cmp_ps(kp, _mm256_mul_ps(three, kn), _CMP_GT_OQ));
+        const __m256 kpGood = _mm256_andnot_ps(knBetter, kp);
+        const __m256 knGood = _mm256_andnot_ps(kpBetter, kn);
+        const __m256 scGood = _mm256_max_ps(_mm256_div_ps(two, _mm256_add_ps(knGood, kpGood)), one);
+
+        // Lanes where neither is good, but the two lines are similar to each other
+        const __m256 similarity = _mm256_sub_ps(abs8(_mm256_sub_ps(absP, absN)),
+                                                abs8(_mm256_mul_ps(_mm256_add_ps(n, p), fifth)));
+        const __m256 kBad = _mm256_and_ps(_mm256_cmp_ps(similarity, zero, _CMP_LE_OQ), one);
+
+        kp = _mm256_blendv_ps(kBad, kpGood, anyGood);
+        kn = _mm256_blendv_ps(kBad, knGood, anyGood);
+        const __m256 sc = _mm256_blendv_ps(one, scGood, anyGood);
+
+        // Compute the weighted sum of differences
+        const __m256 tp = _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(c, p), kp), sc);
+        const __m256 tn = _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(c, n), kn), sc);
+        _mm256_storeu_ps(output + h, _mm256_mul_ps(_mm256_add_ps(tp, tn), quarter));
+    }
+
+    // Remaining samples
+    CombKernels::split2DScalar(previousLine, currentLine, nextLine, output, h, end, kRange);
+}
+
+// Compute the penalties for a viable 3D candidate at samples h to h + 7, as in candidatePenalty
+AVX2_FUNCTION static inline __m256 candidatePenalty8(const __m256 refY[3], const __m256 refC[3],
+                                                     const CombKernels::Candidate3D &candidate, qint32 h,
+                                                     __m256 irescale)
+{
+    const qint32 ch = h + candidate.offset;
+    const __m256 weights[] = {_mm256_set1_ps(0.5f), _mm256_set1_ps(1.0f), _mm256_set1_ps(0.5f)};
+
+    __m256 yPenalty = _mm256_setzero_ps();
+    __m256 iqPenalty = _mm256_setzero_ps();
+    for (qint32 offset = -1; offset < 2; offset++) {
+        const __m256 candidateC = _mm256_loadu_ps(candidate.chroma2D + ch + offset);
+        const __m256 candidateY = _mm256_sub_ps(load8u16(candidate.line + ch + offset), candidateC);
+        yPenalty = _mm256_add_ps(yPenalty, abs8(_mm256_sub_ps(refY[offset + 1], candidateY)));
+        iqPenalty = _mm256_add_ps(iqPenalty, _mm256_mul_ps(abs8(_mm256_add_ps(refC[offset + 1], candidateC)),
+                                                           weights[offset + 1]));
+    }
+    yPenalty = _mm256_div_ps(_mm256_div_ps(yPenalty, _mm256_set1_ps(3.0f)), irescale);
+    iqPenalty = _mm256_mul_ps(_mm256_div_ps(_mm256_div_ps(iqPenalty, _mm256_set1_ps(2.0f)), irescale),
+                              _mm256_set1_ps(0.28f));
+
+    return _mm256_add_ps(_mm256_add_ps(yPenalty, iqPenalty), _mm256_set1_ps(candidate.adjustPenalty));
+}
+
+AVX2_FUNCTION static void split3DAVX2(const quint16 *line, const float *chroma1D, const float *chroma2D,
+                                      const CombKernels::Candidate3D *candidates, qint32 numCandidates,
+                                      qint32 num2DCandidates, float *output, qint32 start, qint32 end, float irescale)
+{
+    const __m256 irescale8 = _mm256_set1_ps(irescale);
+    const __m256 nonViable = _mm256_set1_ps(NON_VIABLE_PENALTY);
+    const __m256 allOnes = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    qint32 h = start;
+    for (; h + 8 <= end; h += 8) {
+        // Reference luma and chroma around each sample
+        __m256 refY[3], refC[3];
+        for (qint32 offset = -1; offset < 2; offset++) {
+            refC[offset + 1] = _mm256_loadu_ps(chroma2D + h + offset);
+            refY[offset + 1] = _mm256_sub_ps(load8u16(line + h + offset), refC[offset + 1]);
+        }
+
+        // Find the candidate with the lowest penalty in each lane
+        __m256 bestPenalty = _mm256_setzero_ps();
+        __m256 bestSample = _mm256_setzero_ps();
+        __m256 bestIs2D = _mm256_setzero_ps();
+        for (qint32 i = 0; i < numCandidates; i++) {
+            const CombKernels::Candidate3D &candidate = candidates[i];
+            const __m256 penalty = candidate.viable ? candidatePenalty8(refY, refC, candidate, h, irescale8) : nonViable;
+            const __m256 sample = _mm256_loadu_ps(candidate.chroma1D + h + candidate.offset);
+            const __m256 is2D = (i < num2DCandidates) ? allOnes : _mm256_setzero_ps();
+
+            if (i == 0) {
+                bestPenalty = penalty;
+                bestSample = sample;
+                bestIs2D = is2D;
+            } else {
+                const __m256 better = _mm256_cmp_ps(penalty, bestPenalty, _CMP_LT_OQ);
+                bestPenalty = _mm256_blendv_ps(bestPenalty, penalty, better);
+                bestSample = _mm256_blendv_ps(bestSample, sample, better);
+                bestIs2D = _mm256_blendv_ps(bestIs2D, is2D, better);
+            }
+        }
+
+        const __m256 result3D = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(chroma1D + h), bestSample),
+                                              _mm256_set1_ps(0.5f));
+        _mm256_storeu_ps(output + h, _mm256_blendv_ps(result3D, refC[1], bestIs2D));
+    }
+
+    // Remaining samples
+    CombKernels::split3DScalar(line, chroma1D, chroma2D, candidates, numCandidates, num2DCandidates,
+                               output, h, end, irescale);
+}
+
+AVX2_FUNCTION static void splitIQAVX2(const quint16 *line, const float *chroma, bool invert,
+                                      double *Y, double *I, double *Q, qint32 start, qint32 end)
+{
+    // Process samples until we reach a multiple of 4 (with at least one
+    // sample before it), so that each vector below starts at phase 0 and
+    // the previous sample is always in the line
+    double si = 0, sq = 0;
+    qint32 h = qMin(end, (start + 4) & ~3);
+    splitIQSamples(line, chroma, invert, Y, I, Q, start, h, si, sq);
+
+    // In each group of four samples, I is set from the odd phases and Q from
+    // the even phases; the other channel holds the value from the previous
+    // sample. (_mm256_set_pd takes lanes in reverse order.)
+    const double sign = invert ? -1.0 : 1.0;
+    const __m256d iSigns = _mm256_set_pd(sign, -sign, -sign, sign);
+    const __m256d qSigns = _mm256_set_pd(-sign, -sign, sign, sign);
+
+    for (; h + 4 <= end; h += 4) {
+        const __m256d current = _mm256_cvtps_pd(_mm_loadu_ps(chroma + h));
+        const __m256d previous = _mm256_cvtps_pd(_mm_loadu_ps(chroma + h - 1));
+
+        const __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(line + h));
+        _mm256_storeu_pd(Y + h, _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(raw)));
+        _mm256_storeu_pd(I + h, _mm256_mul_pd(_mm256_blend_pd(previous, current, 0b1010), iSigns));
+        _mm256_storeu_pd(Q + h, _mm256_mul_pd(_mm256_blend_pd(current, previous, 0b1010), qSigns));
+    }
+
+    // Remaining samples
+    if (h < end) {
+        si = I[h - 1];
+        sq = Q[h - 1];
+        splitIQSamples(line, chroma, invert, Y, I, Q, h, end, si, sq);
+    }
+}
+
+#endif
+
+// Dispatching versions ---------------------------------------------------------------------------------------------
+
+bool CombKernels::haveAVX2()
+{
+#ifdef COMBKERNELS_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+void CombKernels::split1D(const quint16 *line, float *output, qint32 start, qint32 end)
+{
+#ifdef COMBKERNELS_AVX2
+    if (haveAVX2()) {
+        split1DAVX2(line, output, start, end);
+        return;
+    }
+#endif
+    split1DScalar(line, output, start, end);
+}
+
+void CombKernels::split2D(const float *previousLine, const float *currentLine, const float *nextLine,
+                          float *output, qint32 start, qint32 end, float kRange)
+{
+#ifdef COMBKERNELS_AVX2
+    if (haveAVX2()) {
+        split2DAVX2(previousLine, currentLine, nextLine, output, start, end, kRange);
+        return;
+    }
+#endif
+    split2DScalar(previousLine, currentLine, nextLine, output, start, end, kRange);
+}
+
+void CombKernels::split3D(const quint16 *line, const float *chroma1D, const float *chroma2D,
+                          const Candidate3D *candidates, qint32 numCandidates, qint32 num2DCandidates,
+                          float *output, qint32 start, qint32 end, float irescale)
+{
+#ifdef COMBKERNELS_AVX2
+    if (haveAVX2()) {
+        split3DAVX2(line, chroma1D, chroma2D, candidates, numCandidates, num2DCandidates, output, start, end, irescale);
+        return;
+    }
+#endif
+    split3DScalar(line, chroma1D, chroma2D, candidates, numCandidates, num2DCandidates, output, start, end, irescale);
+}
+
+void CombKernels::splitIQ(const quint16 *line, const float *chroma, bool invert,
+                          double *Y, double *I, double *Q, qint32 start, qint32 end)
+{
+#ifdef COMBKERNELS_AVX2
+    if (haveAVX2()) {
+        splitIQAVX2(line, chroma, invert, Y, I, Q, start, end);
+        return;
+    }
+#endif
+    splitIQScalar(line, chroma, invert, Y, I, Q, start, end);
+}
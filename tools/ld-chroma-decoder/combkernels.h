@@ -0,0 +1,84 @@
+/************************************************************************
+
+    combkernels.h
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef COMBKERNELS_H
+#define COMBKERNELS_H
+
+#include <QtGlobal>
+
+// Single-precision kernels for the NTSC comb filter.
+//
+// Each function processes samples [start, end) of a line. The dispatching
+// versions use AVX2 if the CPU supports it, and the scalar versions otherwise;
+// the output of the two is the same, to within rounding.
+namespace CombKernels {
+    // Extract 1D chroma from a line of composite samples (see Comb::FrameBuffer::split1D)
+    void split1D(const quint16 *line, float *output, qint32 start, qint32 end);
+    void split1DScalar(const quint16 *line, float *output, qint32 start, qint32 end);
+
+    // Extract 2D chroma from three lines of 1D chroma (see Comb::FrameBuffer::split2D)
+    void split2D(const float *previousLine, const float *currentLine, const float *nextLine,
+                 float *output, qint32 start, qint32 end, float kRange);
+    void split2DScalar(const float *previousLine, const float *currentLine, const float *nextLine,
+                       float *output, qint32 start, qint32 end, float kRange);
+
+    // A candidate line for the 3D filter (see Comb::FrameBuffer::getCandidate).
+    // Each sample h of the reference line is compared with sample h + offset
+    // of the candidate line.
+    struct Candidate3D {
+        const quint16 *line;
+        const float *chroma1D;
+        const float *chroma2D;
+        qint32 offset;
+        float adjustPenalty;
+
+        // False if the candidate is outside the active area or has the wrong
+        // phase (which is the same for every sample in a line); the line and
+        // chroma2D pointers aren't used in this case
+        bool viable;
+    };
+
+    // Extract 3D chroma for a line by choosing the best of numCandidates
+    // candidates for each sample (see Comb::FrameBuffer::split3D). If one of
+    // the first num2DCandidates is best, the 2D chroma is used.
+    void split3D(const quint16 *line, const float *chroma1D, const float *chroma2D,
+                 const Candidate3D *candidates, qint32 numCandidates, qint32 num2DCandidates,
+                 float *output, qint32 start, qint32 end, float irescale);
+    void split3DScalar(const quint16 *line, const float *chroma1D, const float *chroma2D,
+                       const Candidate3D *candidates, qint32 numCandidates, qint32 num2DCandidates,
+                       float *output, qint32 start, qint32 end, float irescale);
+
+    // Demodulate a line of chroma into I and Q, and copy the composite
+    // samples into Y (see Comb::FrameBuffer::splitIQ). If invert is true, the
+    // chroma phase is inverted.
+    void splitIQ(const quint16 *line, const float *chroma, bool invert,
+                 double *Y, double *I, double *Q, qint32 start, qint32 end);
+    void splitIQScalar(const quint16 *line, const float *chroma, bool invert,
+                       double *Y, double *I, double *Q, qint32 start, qint32 end);
+
+    // Return true if the dispatching versions will use AVX2
+    bool haveAVX2();
+}
+
+#endif // COMBKERNELS_H
@@ -36,6 +36,12 @@ qint32 Decoder::getLookAhead() const
     return 0;
 }
 
+void DecoderThread::getFrameReuse(qint64 &leadingFrames, qint64 &reusedFrames) const
+{
+    leadingFrames = 0;
+    reusedFrames = 0;
+}
+
 DecoderThread::DecoderThread(QAtomicInt& _abort, DecoderPool& _decoderPool, QObject *parent)
     : QThread(parent), abort(_abort), decoderPool(_decoderPool), outputWriter(_decoderPool.getOutputWriter())
 {
@@ -48,29 +54,76 @@ void DecoderThread::run()
     QVector<ComponentFrame> componentFrames;
     QVector<OutputFrame> outputFrames;
 
+    // Timing statistics (nullptr if not enabled)
+    DecoderStats::Thread *stats = decoderPool.addStatsThread();
+
+    // Number of heap allocations made by the scratch arena so far
+    qint64 scratchAllocations = scratchArena.getHeapAllocations();
+
+    // Frames reused by the decoder so far
+    qint64 leadingFrames = 0, reusedFrames = 0;
+
+    // The input fields' buffers before loading the current batch
+    QVector<const quint16 *> previousInputData;
+
     while (!abort) {
         // Get the next batch of fields to process
+        previousInputData.resize(inputFields.size());
+        for (qint32 i = 0; i < inputFields.size(); i++) {
+            previousInputData[i] = inputFields[i].data.constData();
+        }
         qint32 startFrameNumber, startIndex, endIndex;
-        if (!decoderPool.getInputFrames(startFrameNumber, inputFields, startIndex, endIndex)) {
+        if (!decoderPool.getInputFrames(startFrameNumber, inputFields, startIndex, endIndex, stats)) {
             // No more input frames -- exit
             break;
         }
 
+        // If an input field's buffer changes, loading it had to allocate a new one
+        qint32 inputAllocations = 0;
+        for (qint32 i = 0; i < inputFields.size(); i++) {
+            if (i >= previousInputData.size() || inputFields[i].data.constData() != previousInputData[i]) inputAllocations++;
+        }
+
         // Adjust the temporary arrays to the right size
         const qint32 numFrames = (endIndex - startIndex) / 2;
         componentFrames.resize(numFrames);
         outputFrames.resize(numFrames);
 
         // Decode the fields to component frames
-        decodeFrames(inputFields, startIndex, endIndex, componentFrames);
+        {
+            DecoderStats::Timer timer(stats, DecoderStats::DECODE);
+            decodeFrames(inputFields, startIndex, endIndex, componentFrames);
+        }
 
         // Convert the component frames to the output format
-        for (qint32 i = 0; i < numFrames; i++) {
-            outputWriter.convert(componentFrames[i], outputFrames[i]);
+        qint32 outputAllocations = 0;
+        {
+            DecoderStats::Timer timer(stats, DecoderStats::CONVERT);
+            for (qint32 i = 0; i < numFrames; i++) {
+                // If the output frame's buffer changes, convert had to allocate a new one
+                const quint16 *previousData = outputFrames[i].constData();
+                outputWriter.convert(componentFrames[i], outputFrames[i]);
+                if (outputFrames[i].constData() != previousData) outputAllocations++;
+            }
         }
 
+        // Record the buffer allocations made during this batch
+        if (stats != nullptr) {
+            const qint64 batchAllocations = scratchArena.getHeapAllocations() - scratchAllocations
+                                           + inputAllocations + outputAllocations;
+            stats->recordAllocations(batchAllocations, scratchArena.getCapacity());
+        }
+        scratchAllocations = scratchArena.getHeapAllocations();
+
+        // Record the frames reused from the previous batch
+        qint64 newLeadingFrames, newReusedFrames;
+        getFrameReuse(newLeadingFrames, newReusedFrames);
+        if (stats != nullptr) stats->recordFrameReuse(newLeadingFrames - leadingFrames, newReusedFrames - reusedFrames);
+        leadingFrames = newLeadingFrames;
+        reusedFrames = newReusedFrames;
+
         // Write the frames to the output file
-        if (!decoderPool.putOutputFrames(startFrameNumber, outputFrames)) {
+        if (!decoderPool.putOutputFrames(startFrameNumber, outputFrames, stats)) {
             abort = true;
             break;
         }
@@ -35,6 +35,7 @@
 
 #include "componentframe.h"
 #include "outputwriter.h"
+#include "scratcharena.h"
 #include "sourcefield.h"
 
 class DecoderPool;
@@ -57,6 +58,10 @@ class DecoderPool;
 // This means that you can have state shared between all the decoder threads,
 // in SecamDecoder, or specific to each thread, in SecamThread -- and
 // DecoderPool doesn't need to know anything specific about the decoder.
+//
+// Each DecoderThread has a ScratchArena, which SecamThread should pass to its
+// decoder for temporary buffers, so they don't need to be allocated from the
+// heap for each frame.
 class Decoder {
 public:
     virtual ~Decoder() = default;
@@ -98,12 +103,20 @@ protected:
     virtual void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                               QVector<ComponentFrame> &componentFrames) = 0;
 
+    // Get the total number of leading frames that decodeFrames has prepared,
+    // and how many of those it reused from the previous batch (for
+    // statistics). The default is for decoders that don't reuse frames.
+    virtual void getFrameReuse(qint64 &leadingFrames, qint64 &reusedFrames) const;
+
     // Decoder pool
     QAtomicInt &abort;
     DecoderPool &decoderPool;
 
     // Output writer
     OutputWriter &outputWriter;
+
+    // Arena for the decoder's temporary buffers
+    ScratchArena scratchArena;
 };
 
 #endif
@@ -29,10 +29,12 @@
 DecoderPool::DecoderPool(Decoder &_decoder, QString _inputFileName,
                          LdDecodeMetaData &_ldDecodeMetaData,
                          OutputWriter::Configuration &_outputConfig, QString _outputFileName,
-                         qint32 _startFrame, qint32 _length, qint32 _maxThreads)
+                         qint32 _startFrame, qint32 _length, qint32 _maxThreads, qint32 _prefetchMegabytes,
+                         QString _statsFileName)
     : decoder(_decoder), inputFileName(_inputFileName),
       outputConfig(_outputConfig), outputFileName(_outputFileName),
       startFrame(_startFrame), length(_length), maxThreads(_maxThreads),
+      prefetchMegabytes(_prefetchMegabytes), statsFileName(_statsFileName),
       abort(false), ldDecodeMetaData(_ldDecodeMetaData)
 {
 }
@@ -114,8 +116,37 @@ bool DecoderPool::process()
     inputFrameNumber = startFrame;
     outputFrameNumber = startFrame;
     lastFrameNumber = length + (startFrame - 1);
+    outputFinished = false;
     totalTimer.start();
 
+    // Work out a reasonable batch size to provide work for all threads.
+    // This assumes that the synchronisation to get a new batch is less
+    // expensive than computing a single frame, so a batch size of 1 is
+    // reasonable.
+    maxBatchSize = qMin(DEFAULT_BATCH_SIZE, qMax(1, length / maxThreads));
+
+    // Size the output ring. This must be at least one batch, so the worker
+    // with the next frame to be written can always put its batch.
+    outputRing.clear();
+    outputRing.resize(maxBatchSize * maxThreads * OUTPUT_RING_BATCHES);
+    spareFrames.clear();
+    spareFrames.reserve(outputRing.size() + (maxBatchSize * maxThreads));
+    lastStatsTime = 0;
+
+    // Start collecting timing statistics, if enabled
+    if (!statsFileName.isEmpty()) decoderStats.reset(new DecoderStats);
+
+    // Start reading ahead in the input file, if enabled and the input isn't
+    // memory-mapped or stdin
+    if (prefetchMegabytes > 0 && FieldPrefetcher::isUseful(sourceVideo)) {
+        fieldPrefetcher.reset(new FieldPrefetcher(sourceVideo, prefetchMegabytes, ldDecodeMetaData.getNumberOfFields()));
+        fieldPrefetcher->start();
+    }
+
+    // Start the thread to write the output
+    WriterThread writerThread(*this);
+    writerThread.start();
+
     // Start a vector of filtering threads to process the video
     QVector<QThread *> threads;
     threads.resize(maxThreads);
@@ -130,6 +161,24 @@ bool DecoderPool::process()
         delete threads[i];
     }
 
+    // Wait for the writer to write the remaining frames
+    finishOutput();
+    writerThread.wait();
+
+    // Stop reading ahead
+    if (fieldPrefetcher) {
+        qDebug() << "DecoderPool::process(): Prefetcher hits:" << fieldPrefetcher->getHitCount()
+                 << "misses:" << fieldPrefetcher->getMissCount();
+        fieldPrefetcher.reset();
+    }
+
+    // Write the timing statistics
+    bool statsWritten = true;
+    if (decoderStats) {
+        qInfo().noquote() << "Stage times:" << decoderStats->getSummary();
+        statsWritten = decoderStats->writeReport(statsFileName, outputFrameNumber - startFrame);
+    }
+
     // Did any of the threads abort?
     if (abort) {
         sourceVideo.close();
@@ -138,8 +187,7 @@ bool DecoderPool::process()
     }
 
     // Check we've processed all the frames, now the workers have finished
-    if (inputFrameNumber != (lastFrameNumber + 1) || outputFrameNumber != (lastFrameNumber + 1)
-        || !pendingOutputFrames.empty()) {
+    if (inputFrameNumber != (lastFrameNumber + 1) || outputFrameNumber != (lastFrameNumber + 1)) {
         qCritical() << "Incorrect state at end of processing";
         sourceVideo.close();
         targetVideo.close();
@@ -156,18 +204,22 @@ bool DecoderPool::process()
     // Close the target video
     targetVideo.close();
 
-    return true;
+    // Fail if the statistics report couldn't be written
+    return statsWritten;
 }
 
-bool DecoderPool::getInputFrames(qint32 &startFrameNumber, QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex)
+DecoderStats::Thread *DecoderPool::addStatsThread()
 {
-    QMutexLocker locker(&inputMutex);
+    if (!decoderStats) return nullptr;
+    return decoderStats->addThread();
+}
 
-    // Work out a reasonable batch size to provide work for all threads.
-    // This assumes that the synchronisation to get a new batch is less
-    // expensive than computing a single frame, so a batch size of 1 is
-    // reasonable.
-    const qint32 maxBatchSize = qMin(DEFAULT_BATCH_SIZE, qMax(1, length / maxThreads));
+bool DecoderPool::getInputFrames(qint32 &startFrameNumber, QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex,
+                                 DecoderStats::Thread *stats)
+{
+    DecoderStats::Timer waitTimer(stats, DecoderStats::INPUT_WAIT);
+    QMutexLocker locker(&inputMutex);
+    waitTimer.stop();
 
     // Work out how many frames will be in this batch
     qint32 batchFrames = qMin(maxBatchSize, lastFrameNumber + 1 - inputFrameNumber);
@@ -181,66 +233,135 @@ bool DecoderPool::getInputFrames(qint32 &startFrameNumber, QVector<SourceField>
     inputFrameNumber += batchFrames;
 
     // Load the fields
-    SourceField::loadFields(sourceVideo, ldDecodeMetaData,
-                            startFrameNumber, batchFrames, decoderLookBehind, decoderLookAhead,
-                            fields, startIndex, endIndex);
+    DecoderStats::Timer loadTimer(stats, DecoderStats::FIELD_LOAD);
+    if (fieldPrefetcher) {
+        SourceField::loadFields(*fieldPrefetcher, ldDecodeMetaData,
+                                startFrameNumber, batchFrames, decoderLookBehind, decoderLookAhead,
+                                fields, startIndex, endIndex);
+    } else {
+        SourceField::loadFields(sourceVideo, ldDecodeMetaData,
+                                startFrameNumber, batchFrames, decoderLookBehind, decoderLookAhead,
+                                fields, startIndex, endIndex);
+    }
 
     return true;
 }
 
-bool DecoderPool::putOutputFrames(qint32 startFrameNumber, const QVector<OutputFrame> &outputFrames)
+bool DecoderPool::putOutputFrames(qint32 startFrameNumber, QVector<OutputFrame> &outputFrames,
+                                  DecoderStats::Thread *stats)
 {
     QMutexLocker locker(&outputMutex);
 
     for (qint32 i = 0; i < outputFrames.size(); i++) {
-        if (!putOutputFrame(startFrameNumber + i, outputFrames[i])) {
-            return false;
+        const qint32 frameNumber = startFrameNumber + i;
+
+        // Wait until there's space in the ring for this frame
+        if (frameNumber >= outputFrameNumber + outputRing.size()) {
+            DecoderStats::Timer waitTimer(stats, DecoderStats::OUTPUT_WAIT);
+            while (frameNumber >= outputFrameNumber + outputRing.size() && !abort) {
+                outputCondition.wait(&outputMutex);
+            }
+        }
+        if (abort) return false;
+
+        // Move the frame into the ring. (Assigning it would share its buffer,
+        // so the worker would have to allocate a new one for its next frame.)
+        OutputSlot &slot = outputRing[frameNumber % outputRing.size()];
+        slot.frame.swap(outputFrames[i]);
+        slot.filled = true;
+
+        // Give the worker a spare buffer to reuse
+        if (!spareFrames.isEmpty()) {
+            outputFrames[i].swap(spareFrames.last());
+            spareFrames.removeLast();
         }
     }
 
+    // Wake the writer thread
+    outputCondition.wakeAll();
+
     return true;
 }
 
-// Write one output frame. You must hold outputMutex to call this.
-//
-// The worker threads will complete frames in an arbitrary order, so we can't
-// just write the frames to the output file directly. Instead, we keep a map of
-// frames that haven't yet been written; when a new frame comes in, we check
-// whether we can now write some of them out.
+// Tell the writer thread that no more frames will be put into the ring.
+void DecoderPool::finishOutput()
+{
+    QMutexLocker locker(&outputMutex);
+
+    outputFinished = true;
+    outputCondition.wakeAll();
+}
+
+// Writer thread: write frames from the output ring to the output file in order.
 //
-// Returns true on success, false on failure.
-bool DecoderPool::putOutputFrame(qint32 frameNumber, const OutputFrame &outputFrame)
+// The worker threads will complete frames in an arbitrary order, so they put
+// them into the ring; this waits for the next frame to be available, takes it
+// out of the ring, and writes it without holding outputMutex, so workers
+// aren't held up by slow output.
+void DecoderPool::writeOutputFrames()
 {
-    // Put this frame into the map
-    pendingOutputFrames[frameNumber] = outputFrame;
+    DecoderStats::Thread *stats = addStatsThread();
+    OutputFrame outputData;
+
+    while (true) {
+        // Wait for the next frame, and take it out of the ring
+        {
+            QMutexLocker locker(&outputMutex);
+
+            if (outputFrameNumber > lastFrameNumber) break;
+
+            OutputSlot &slot = outputRing[outputFrameNumber % outputRing.size()];
+            while (!slot.filled && !outputFinished && !abort) {
+                outputCondition.wait(&outputMutex);
+            }
+            if (!slot.filled) break;
+
+            // Keep the last frame's buffer for a worker to reuse
+            if (!outputData.isEmpty()) {
+                spareFrames.append(OutputFrame());
+                spareFrames.last().swap(outputData);
+            }
+
+            outputData.swap(slot.frame);
+            slot.filled = false;
+            outputFrameNumber++;
+
+            // Wake any workers waiting for space
+            outputCondition.wakeAll();
+        }
 
-    // Write out as many frames as possible
-    while (pendingOutputFrames.contains(outputFrameNumber)) {
-        const OutputFrame& outputData = pendingOutputFrames.value(outputFrameNumber);
+        DecoderStats::Timer writeTimer(stats, DecoderStats::WRITE);
 
         // Write the frame header (if there is one)
         const QByteArray frameHeader = outputWriter.getFrameHeader();
-        if (frameHeader.size() != 0 && targetVideo.write(frameHeader) == -1) {
-            qCritical() << "Writing to the output video file failed";
-            return false;
-        }
+        bool writeFailed = (frameHeader.size() != 0 && targetVideo.write(frameHeader) == -1);
 
         // Write the frame data
-        if (targetVideo.write(reinterpret_cast<const char *>(outputData.data()), outputData.size() * 2) == -1) {
-            qCritical() << "Writing to the output video file failed";
-            return false;
+        if (!writeFailed) {
+            writeFailed = (targetVideo.write(reinterpret_cast<const char *>(outputData.data()), outputData.size() * 2) == -1);
         }
 
-        pendingOutputFrames.remove(outputFrameNumber);
-        outputFrameNumber++;
+        if (writeFailed) {
+            qCritical() << "Writing to the output video file failed";
+
+            // Stop the workers
+            QMutexLocker locker(&outputMutex);
+            abort = true;
+            outputCondition.wakeAll();
+            break;
+        }
 
         const qint32 outputCount = outputFrameNumber - startFrame;
         if ((outputCount % 32) == 0) {
             // Show an update to the user
             double fps = outputCount / (static_cast<double>(totalTimer.elapsed()) / 1000.0);
             qInfo() << outputCount << "frames processed -" << fps << "FPS";
+
+            // Show the timing statistics every so often
+            if (decoderStats && totalTimer.elapsed() - lastStatsTime >= STATS_INTERVAL) {
+                qInfo().noquote() << "Stage times:" << decoderStats->getSummary();
+                lastStatsTime = totalTimer.elapsed();
+            }
         }
     }
-
-    return true;
 }
@@ -28,15 +28,18 @@
 #include <QObject>
 #include <QAtomicInt>
 #include <QElapsedTimer>
-#include <QMap>
 #include <QMutex>
 #include <QThread>
 #include <QVector>
+#include <QWaitCondition>
+#include <memory>
 
+#include "fieldprefetcher.h"
 #include "lddecodemetadata.h"
 #include "sourcevideo.h"
 
 #include "decoder.h"
+#include "decoderstats.h"
 #include "outputwriter.h"
 #include "sourcefield.h"
 
@@ -46,7 +49,8 @@ public:
     explicit DecoderPool(Decoder &decoder, QString inputFileName,
                          LdDecodeMetaData &ldDecodeMetaData,
                          OutputWriter::Configuration &outputConfig, QString outputFileName,
-                         qint32 startFrame, qint32 length, qint32 maxThreads);
+                         qint32 startFrame, qint32 length, qint32 maxThreads, qint32 prefetchMegabytes,
+                         QString statsFileName = QString());
 
     // Decode fields to frames as specified by the constructor args.
     // Returns true on success; on failure, prints a message and returns false.
@@ -57,6 +61,10 @@ public:
         return outputWriter;
     }
 
+    // For worker threads: get an object to record the thread's timing
+    // statistics in, or nullptr if statistics are not enabled.
+    DecoderStats::Thread *addStatsThread();
+
     // For worker threads: get the next batch of data from the input file.
     //
     // fields will be resized and filled with pairs of SourceFields; entries
@@ -71,22 +79,51 @@ public:
     //
     // Returns true if a frame was returned, false if the end of the input has
     // been reached.
-    bool getInputFrames(qint32 &startFrameNumber, QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex);
+    bool getInputFrames(qint32 &startFrameNumber, QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex,
+                        DecoderStats::Thread *stats = nullptr);
 
     // For worker threads: return decoded frames to write to the output file.
     //
     // outputFrames should contain RGB48, YUV444P16, or GRAY16 output frames,
     // with the first frame being startFrameNumber.
     //
+    // The frames are moved into the output ring, waiting for space if the
+    // ring is full; the writer thread writes them to the output file in order.
+    // Where possible, each frame in outputFrames is replaced with one that
+    // has already been written, so its buffer can be reused.
+    //
     // Returns true on success, false on failure.
-    bool putOutputFrames(qint32 startFrameNumber, const QVector<OutputFrame> &outputFrames);
+    bool putOutputFrames(qint32 startFrameNumber, QVector<OutputFrame> &outputFrames,
+                         DecoderStats::Thread *stats = nullptr);
 
 private:
-    bool putOutputFrame(qint32 frameNumber, const OutputFrame &outputFrame);
+    // Thread that writes frames from the output ring to the output file
+    class WriterThread : public QThread
+    {
+    public:
+        WriterThread(DecoderPool &_decoderPool) : decoderPool(_decoderPool) {}
+
+    protected:
+        void run() override {
+            decoderPool.writeOutputFrames();
+        }
+
+    private:
+        DecoderPool &decoderPool;
+    };
+
+    void writeOutputFrames();
+    void finishOutput();
 
     // Default batch size, in frames
     static constexpr qint32 DEFAULT_BATCH_SIZE = 16;
 
+    // Minimum interval between showing timing statistics, in milliseconds
+    static constexpr qint64 STATS_INTERVAL = 10000;
+
+    // Number of batches the output ring can hold per thread
+    static constexpr qint32 OUTPUT_RING_BATCHES = 2;
+
     // Parameters
     Decoder &decoder;
     QString inputFileName;
@@ -95,6 +132,11 @@ private:
     qint32 startFrame;
     qint32 length;
     qint32 maxThreads;
+    qint32 prefetchMegabytes;
+    QString statsFileName;
+
+    // Timing statistics, if enabled
+    std::unique_ptr<DecoderStats> decoderStats;
 
     // Atomic abort flag shared by worker threads; workers watch this, and shut
     // down as soon as possible if it becomes true
@@ -104,18 +146,37 @@ private:
     QMutex inputMutex;
     qint32 decoderLookBehind;
     qint32 decoderLookAhead;
+    qint32 maxBatchSize;
     qint32 inputFrameNumber;
     qint32 lastFrameNumber;
     LdDecodeMetaData &ldDecodeMetaData;
     SourceVideo sourceVideo;
+    std::unique_ptr<FieldPrefetcher> fieldPrefetcher;
 
-    // Output stream information (all guarded by outputMutex while threads are running)
+    // Output ring (all guarded by outputMutex while threads are running).
+    // Completed frames are stored in the slot for (frameNumber % size), and
+    // workers wait for space if a frame is beyond the end of the ring, so the
+    // number of frames waiting to be written is bounded.
+    // outputCondition is signalled when a slot is filled or emptied.
     QMutex outputMutex;
+    QWaitCondition outputCondition;
+    struct OutputSlot {
+        bool filled = false;
+        OutputFrame frame;
+    };
+    QVector<OutputSlot> outputRing;
     qint32 outputFrameNumber;
-    QMap<qint32, OutputFrame> pendingOutputFrames;
+    bool outputFinished;
+
+    // Frames that have been written, whose buffers can be reused by workers
+    // (guarded by outputMutex)
+    QVector<OutputFrame> spareFrames;
+
+    // Output stream information (only used by the writer thread while threads are running)
     OutputWriter outputWriter;
     QFile targetVideo;
     QElapsedTimer totalTimer;
+    qint64 lastStatsTime;
 };
 
 #endif // DECODERPOOL_H
@@ -0,0 +1,319 @@
+/************************************************************************
+
+    decoderstats.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "decoderstats.h"
+
+#include "jsonio.h"
+
+#include <QDebug>
+#include <QStringList>
+#include <fstream>
+
+static const char *STAGE_NAMES[DecoderStats::NUM_STAGES] = {
+    "inputWait",
+    "fieldLoad",
+    "decode",
+    "convert",
+    "outputWait",
+    "write",
+};
+
+const char *DecoderStats::getStageName(Stage stage)
+{
+    return STAGE_NAMES[stage];
+}
+
+void DecoderStats::StageTotals::add(const StageTotals &other)
+{
+    count += other.count;
+    totalNsecs += other.totalNsecs;
+    maxNsecs = qMax(maxNsecs, other.maxNsecs);
+    for (qint32 i = 0; i < NUM_BUCKETS; i++) {
+        histogram[i] += other.histogram[i];
+    }
+}
+
+void DecoderStats::AllocationTotals::add(const AllocationTotals &other)
+{
+    batches += other.batches;
+    allocations += other.allocations;
+    allocationsAfterFirstBatch += other.allocationsAfterFirstBatch;
+    scratchBytes += other.scratchBytes;
+}
+
+void DecoderStats::FrameReuseTotals::add(const FrameReuseTotals &other)
+{
+    leadingFrames += other.leadingFrames;
+    reusedFrames += other.reusedFrames;
+}
+
+void DecoderStats::Thread::record(Stage stage, qint64 nsecs)
+{
+    // Find the histogram bucket
+    qint64 usecs = nsecs / 1000;
+    qint32 bucket = 0;
+    while (usecs > 1 && bucket < NUM_BUCKETS - 1) {
+        usecs >>= 1;
+        bucket++;
+    }
+
+    QMutexLocker locker(&mutex);
+
+    StageTotals &stageTotals = totals[stage];
+    stageTotals.count++;
+    stageTotals.totalNsecs += nsecs;
+    stageTotals.maxNsecs = qMax(stageTotals.maxNsecs, nsecs);
+    stageTotals.histogram[bucket]++;
+}
+
+std::array<DecoderStats::StageTotals, DecoderStats::NUM_STAGES> DecoderStats::Thread::getTotals() const
+{
+    QMutexLocker locker(&mutex);
+    return totals;
+}
+
+void DecoderStats::Thread::recordAllocations(qint64 allocations, qint64 scratchBytes)
+{
+    QMutexLocker locker(&mutex);
+
+    if (allocationTotals.batches != 0) allocationTotals.allocationsAfterFirstBatch += allocations;
+    allocationTotals.batches++;
+    allocationTotals.allocations += allocations;
+    allocationTotals.scratchBytes = scratchBytes;
+}
+
+DecoderStats::AllocationTotals DecoderStats::Thread::getAllocationTotals() const
+{
+    QMutexLocker locker(&mutex);
+    return allocationTotals;
+}
+
+void DecoderStats::Thread::recordFrameReuse(qint64 leadingFrames, qint64 reusedFrames)
+{
+    QMutexLocker locker(&mutex);
+
+    frameReuseTotals.leadingFrames += leadingFrames;
+    frameReuseTotals.reusedFrames += reusedFrames;
+}
+
+DecoderStats::FrameReuseTotals DecoderStats::Thread::getFrameReuseTotals() const
+{
+    QMutexLocker locker(&mutex);
+    return frameReuseTotals;
+}
+
+DecoderStats::Timer::Timer(Thread *_thread, Stage _stage)
+    : thread(_thread), stage(_stage)
+{
+    if (thread != nullptr) timer.start();
+}
+
+DecoderStats::Timer::~Timer()
+{
+    stop();
+}
+
+void DecoderStats::Timer::stop()
+{
+    if (thread != nullptr) thread->record(stage, timer.nsecsElapsed());
+    thread = nullptr;
+}
+
+DecoderStats::DecoderStats()
+{
+    totalTimer.start();
+}
+
+DecoderStats::Thread *DecoderStats::addThread()
+{
+    QMutexLocker locker(&threadsMutex);
+
+    threads.emplace_back(new Thread);
+    return threads.back().get();
+}
+
+// Add up the allocation totals for all threads
+DecoderStats::AllocationTotals DecoderStats::getAllocationTotals() const
+{
+    AllocationTotals totals;
+
+    QMutexLocker locker(&threadsMutex);
+    for (const auto &thread : threads) {
+        totals.add(thread->getAllocationTotals());
+    }
+
+    return totals;
+}
+
+// Add up the frame reuse totals for all threads
+DecoderStats::FrameReuseTotals DecoderStats::getFrameReuseTotals() const
+{
+    FrameReuseTotals totals;
+
+    QMutexLocker locker(&threadsMutex);
+    for (const auto &thread : threads) {
+        totals.add(thread->getFrameReuseTotals());
+    }
+
+    return totals;
+}
+
+QString DecoderStats::getSummary() const
+{
+    // Add up the totals for all threads
+    std::array<StageTotals, NUM_STAGES> totals;
+    {
+        QMutexLocker locker(&threadsMutex);
+        for (const auto &thread : threads) {
+            const auto threadTotals = thread->getTotals();
+            for (qint32 stage = 0; stage < NUM_STAGES; stage++) {
+                totals[stage].add(threadTotals[stage]);
+            }
+        }
+    }
+
+    // Show each stage's share of the total thread time
+    qint64 allNsecs = 0;
+    for (const StageTotals &stageTotals : totals) allNsecs += stageTotals.totalNsecs;
+    if (allNsecs == 0) allNsecs = 1;
+
+    QStringList parts;
+    for (qint32 stage = 0; stage < NUM_STAGES; stage++) {
+        parts.append(QString("%1 %2s (%3%)")
+                     .arg(STAGE_NAMES[stage])
+                     .arg(totals[stage].totalNsecs / 1e9, 0, 'f', 2)
+                     .arg((100.0 * totals[stage].totalNsecs) / allNsecs, 0, 'f', 1));
+    }
+
+    const AllocationTotals allocationTotals = getAllocationTotals();
+    parts.append(QString("buffer allocations %1 (%2 after first batch)")
+                 .arg(allocationTotals.allocations)
+                 .arg(allocationTotals.allocationsAfterFirstBatch));
+
+    const FrameReuseTotals frameReuseTotals = getFrameReuseTotals();
+    if (frameReuseTotals.leadingFrames != 0) {
+        parts.append(QString("leading frames reused %1 of %2")
+                     .arg(frameReuseTotals.reusedFrames)
+                     .arg(frameReuseTotals.leadingFrames));
+    }
+
+    return parts.join(", ");
+}
+
+// Write a StageTotals object to JSON
+static void writeStageTotals(JsonWriter &writer, const DecoderStats::StageTotals &stageTotals)
+{
+    writer.beginObject();
+    writer.writeMember("count", stageTotals.count);
+    writer.writeMember("totalSeconds", stageTotals.totalNsecs / 1e9);
+    writer.writeMember("maxSeconds", stageTotals.maxNsecs / 1e9);
+    writer.writeMember("histogram");
+    writer.beginArray();
+    for (qint64 value : stageTotals.histogram) {
+        writer.writeElement();
+        writer.write(value);
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+// Write an array of StageTotals to JSON, as an object with one member per stage
+static void writeStages(JsonWriter &writer, const std::array<DecoderStats::StageTotals, DecoderStats::NUM_STAGES> &totals)
+{
+    writer.beginObject();
+    for (qint32 stage = 0; stage < DecoderStats::NUM_STAGES; stage++) {
+        writer.writeMember(DecoderStats::getStageName(static_cast<DecoderStats::Stage>(stage)));
+        writeStageTotals(writer, totals[stage]);
+    }
+    writer.endObject();
+}
+
+bool DecoderStats::writeReport(const QString &fileName, qint32 numFrames) const
+{
+    std::ofstream reportFile(fileName.toStdString());
+    if (reportFile.fail()) {
+        qCritical() << "Could not open" << fileName << "for writing";
+        return false;
+    }
+
+    const AllocationTotals allocationTotals = getAllocationTotals();
+    const FrameReuseTotals frameReuseTotals = getFrameReuseTotals();
+
+    QMutexLocker locker(&threadsMutex);
+
+    std::array<StageTotals, NUM_STAGES> totals;
+    std::vector<std::array<StageTotals, NUM_STAGES>> threadTotals;
+    for (const auto &thread : threads) {
+        threadTotals.push_back(thread->getTotals());
+        for (qint32 stage = 0; stage < NUM_STAGES; stage++) {
+            totals[stage].add(threadTotals.back()[stage]);
+        }
+    }
+
+    JsonWriter writer(reportFile);
+    writer.beginObject();
+
+    // Keep members in alphabetical order
+    writer.writeMember("allocations");
+    writer.beginObject();
+    writer.writeMember("afterFirstBatch", allocationTotals.allocationsAfterFirstBatch);
+    writer.writeMember("batches", allocationTotals.batches);
+    writer.writeMember("scratchBytes", allocationTotals.scratchBytes);
+    writer.writeMember("total", allocationTotals.allocations);
+    writer.endObject();
+    writer.writeMember("bucketMicroseconds");
+    writer.beginArray();
+    for (qint32 i = 0; i < NUM_BUCKETS; i++) {
+        writer.writeElement();
+        writer.write(static_cast<qint64>(1) << i);
+    }
+    writer.endArray();
+    writer.writeMember("frameReuse");
+    writer.beginObject();
+    writer.writeMember("leadingFrames", frameReuseTotals.leadingFrames);
+    writer.writeMember("reusedFrames", frameReuseTotals.reusedFrames);
+    writer.endObject();
+    writer.writeMember("frames", numFrames);
+    writer.writeMember("stages");
+    writeStages(writer, totals);
+    writer.writeMember("threads");
+    writer.beginArray();
+    for (const auto &thread : threadTotals) {
+        writer.writeElement();
+        writeStages(writer, thread);
+    }
+    writer.endArray();
+    writer.writeMember("totalSeconds", totalTimer.nsecsElapsed() / 1e9);
+
+    writer.endObject();
+    reportFile << "\n";
+
+    reportFile.close();
+    if (reportFile.fail()) {
+        qCritical() << "Writing to" << fileName << "failed";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,157 @@
+/************************************************************************
+
+    decoderstats.h
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef DECODERSTATS_H
+#define DECODERSTATS_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+#include <array>
+#include <memory>
+#include <vector>
+
+// Timing statistics for the stages of DecoderPool's processing.
+//
+// Each worker thread records the time it spends in each stage into its own
+// Thread object, with a histogram of how long each occurrence took. The
+// totals can be summarised while the decoder is running, and written out as
+// a JSON report at the end.
+//
+// Worker threads also record the number of buffers they had to allocate for
+// each batch of frames: blocks added to the scratch arena, and new buffers for
+// input fields and output frames. (Small allocations, such as the fields'
+// metadata, aren't counted.) Once a thread's buffers have reached their full
+// size (normally after its first batch), this should be zero.
+//
+// Decoders that keep frames between batches also record how many of each
+// batch's leading frames they could reuse from the thread's previous batch.
+class DecoderStats
+{
+public:
+    enum Stage {
+        INPUT_WAIT = 0,     // Waiting for access to the input
+        FIELD_LOAD,         // Reading fields and metadata from the input
+        DECODE,             // Decoding fields into component frames
+        CONVERT,            // Converting component frames to the output format
+        OUTPUT_WAIT,        // Waiting for access to the output
+        WRITE,              // Writing frames to the output
+        NUM_STAGES
+    };
+
+    // Histogram bucket i counts times in [2^i, 2^(i+1)) microseconds
+    // (with bucket 0 also counting shorter times, and the last bucket also
+    // counting longer ones)
+    static constexpr qint32 NUM_BUCKETS = 24;
+
+    struct StageTotals {
+        qint64 count = 0;
+        qint64 totalNsecs = 0;
+        qint64 maxNsecs = 0;
+        std::array<qint64, NUM_BUCKETS> histogram {};
+
+        void add(const StageTotals &other);
+    };
+
+    struct AllocationTotals {
+        qint64 batches = 0;
+        qint64 allocations = 0;
+        qint64 allocationsAfterFirstBatch = 0;
+        qint64 scratchBytes = 0;
+
+        void add(const AllocationTotals &other);
+    };
+
+    struct FrameReuseTotals {
+        qint64 leadingFrames = 0;
+        qint64 reusedFrames = 0;
+
+        void add(const FrameReuseTotals &other);
+    };
+
+    // Statistics for one worker thread
+    class Thread
+    {
+    public:
+        void record(Stage stage, qint64 nsecs);
+        std::array<StageTotals, NUM_STAGES> getTotals() const;
+
+        // Record the buffer allocations made while processing a batch, and the
+        // size of the thread's scratch arena afterwards
+        void recordAllocations(qint64 allocations, qint64 scratchBytes);
+        AllocationTotals getAllocationTotals() const;
+
+        // Record the leading frames the decoder prepared for a batch, and
+        // how many of those it reused from the previous batch
+        void recordFrameReuse(qint64 leadingFrames, qint64 reusedFrames);
+        FrameReuseTotals getFrameReuseTotals() const;
+
+    private:
+        mutable QMutex mutex;
+        std::array<StageTotals, NUM_STAGES> totals;
+        AllocationTotals allocationTotals;
+        FrameReuseTotals frameReuseTotals;
+    };
+
+    // Time a stage, recording it when the object goes out of scope.
+    // thread may be nullptr, in which case nothing is recorded.
+    class Timer
+    {
+    public:
+        Timer(Thread *thread, Stage stage);
+        ~Timer();
+
+        // Record the time now, rather than at the end of the scope
+        void stop();
+
+    private:
+        Thread *thread;
+        Stage stage;
+        QElapsedTimer timer;
+    };
+
+    DecoderStats();
+
+    // Create statistics for a new worker thread
+    Thread *addThread();
+
+    // Return a one-line summary of the time spent in each stage so far
+    QString getSummary() const;
+
+    // Write a JSON report of all the statistics
+    bool writeReport(const QString &fileName, qint32 numFrames) const;
+
+    static const char *getStageName(Stage stage);
+
+private:
+    AllocationTotals getAllocationTotals() const;
+    FrameReuseTotals getFrameReuseTotals() const;
+
+    QElapsedTimer totalTimer;
+    mutable QMutex threadsMutex;
+    std::vector<std::unique_ptr<Thread>> threads;
+};
+
+#endif // DECODERSTATS_H
@@ -42,8 +42,10 @@
 #include "ntscdecoder.h"
 #include "outputwriter.h"
 #include "palcolour.h"
+#include "palkernels.h"
 #include "paldecoder.h"
 #include "transformpal.h"
+#include "transformpal3d.h"
 
 // Load the thresholds file for the Transform decoders, if specified. We must
 // do this after PalColour has been configured, so we know how many values to
@@ -194,6 +196,18 @@ int main(int argc, char *argv[])
                                      QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to select the amount of input to read ahead
+    QCommandLineOption prefetchOption(QStringList() << "prefetch",
+                                      QCoreApplication::translate("main", "Specify the amount of input to read ahead in the background, in MB (0 to disable; default 64)"),
+                                      QCoreApplication::translate("main", "megabytes"));
+    parser.addOption(prefetchOption);
+
+    // Option to collect timing statistics for each stage of processing
+    QCommandLineOption stageStatsOption(QStringList() << "stage-stats",
+                                        QCoreApplication::translate("main", "Show timing statistics for each processing stage, and write a JSON report of them to the specified file"),
+                                        QCoreApplication::translate("main", "filename"));
+    parser.addOption(stageStatsOption);
+
     // Option to override calculated firstActiveFieldLine in our video parameters (-ffll)
     QCommandLineOption firstFieldLineOption(QStringList() << "ffll" << "first_active_field_line",
                                             QCoreApplication::translate("main", "The first visible line of a field. Range 1-259 for NTSC (default: 20), 2-308 for PAL (default: 22)"),
@@ -242,6 +256,11 @@ int main(int argc, char *argv[])
                                            QCoreApplication::translate("main", "NTSC: Adjust phase per-line using burst phase"));
     parser.addOption(ntscPhaseCompOption);
 
+    // Option to use the single-precision comb filter
+    QCommandLineOption ntscFloatOption(QStringList() << "ntsc-float",
+                                       QCoreApplication::translate("main", "NTSC: Use faster single-precision filtering (output differs very slightly)"));
+    parser.addOption(ntscFloatOption);
+
     // -- PAL decoder options --
 
     // Option to use Simple PAL UV filter
@@ -249,6 +268,17 @@ int main(int argc, char *argv[])
                                            QCoreApplication::translate("main", "Transform: Use 1D UV filter (default 2D)"));
     parser.addOption(simplePALOption);
 
+    // Option to use the single-precision PALcolour filter
+    QCommandLineOption palFloatOption(QStringList() << "pal-float",
+                                      QCoreApplication::translate("main", "PAL: Use faster single-precision filtering in the PALcolour 2D filter (output differs very slightly)"));
+    parser.addOption(palFloatOption);
+
+    // Option to limit the instruction set used by the PALcolour filter
+    QCommandLineOption palIsaOption(QStringList() << "pal-isa",
+                                    QCoreApplication::translate("main", "PAL: Limit the PALcolour 2D filter to an instruction set (scalar, avx2, avx512; default best available)"),
+                                    QCoreApplication::translate("main", "isa"));
+    parser.addOption(palIsaOption);
+
     // Option to select the Transform PAL threshold
     QCommandLineOption transformThresholdOption(QStringList() << "transform-threshold",
                                                 QCoreApplication::translate("main", "Transform: Uniform similarity threshold (default 0.4)"),
@@ -261,6 +291,17 @@ int main(int argc, char *argv[])
                                                  QCoreApplication::translate("main", "file"));
     parser.addOption(transformThresholdsOption);
 
+    // Option to use single-precision FFTs for Transform PAL 3D
+    QCommandLineOption transformFloatOption(QStringList() << "transform-float",
+                                            QCoreApplication::translate("main", "Transform: Use faster single-precision FFTs in transform3d (output differs very slightly)"));
+    parser.addOption(transformFloatOption);
+
+    // Option to select the number of threads used within each frame by Transform PAL
+    QCommandLineOption transformThreadsOption(QStringList() << "transform-threads",
+                                              QCoreApplication::translate("main", "Transform: Number of threads to use within each frame (default 1)"),
+                                              QCoreApplication::translate("main", "number"));
+    parser.addOption(transformThreadsOption);
+
     // Option to overlay the FFTs
     QCommandLineOption showFFTsOption(QStringList() << "show-ffts",
                                       QCoreApplication::translate("main", "Transform: Overlay the input and output FFTs"));
@@ -310,6 +351,7 @@ int main(int argc, char *argv[])
     qint32 startFrame = -1;
     qint32 length = -1;
     qint32 maxThreads = QThread::idealThreadCount();
+    qint32 prefetchMegabytes = 64;
     PalColour::Configuration palConfig;
     Comb::Configuration combConfig;
     OutputWriter::Configuration outputConfig;
@@ -344,6 +386,21 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (parser.isSet(prefetchOption)) {
+        prefetchMegabytes = parser.value(prefetchOption).toInt();
+
+        if (prefetchMegabytes < 0) {
+            // Quit with error
+            qCritical("Specified prefetch size must not be negative");
+            return -1;
+        }
+    }
+
+    QString stageStatsFileName;
+    if (parser.isSet(stageStatsOption)) {
+        stageStatsFileName = parser.value(stageStatsOption);
+    }
+
     if (parser.isSet(chromaGainOption)) {
         const double value = parser.value(chromaGainOption).toDouble();
         palConfig.chromaGain = value;
@@ -397,10 +454,33 @@ int main(int argc, char *argv[])
         combConfig.phaseCompensation = true;
     }
 
+    if (parser.isSet(ntscFloatOption)) {
+        combConfig.singlePrecision = true;
+    }
+
     if (parser.isSet(simplePALOption)) {
         palConfig.simplePAL = true;
     }
 
+    if (parser.isSet(palFloatOption)) {
+        palConfig.palColourSinglePrecision = true;
+    }
+
+    if (parser.isSet(palIsaOption)) {
+        const QString palIsaName = parser.value(palIsaOption);
+        if (palIsaName == "scalar") {
+            PalKernels::setMaxIsa(PalKernels::scalarIsa);
+        } else if (palIsaName == "avx2") {
+            PalKernels::setMaxIsa(PalKernels::avx2Isa);
+        } else if (palIsaName == "avx512") {
+            PalKernels::setMaxIsa(PalKernels::avx512Isa);
+        } else {
+            // Quit with error
+            qCritical() << "Unknown PAL instruction set" << palIsaName;
+            return -1;
+        }
+    }
+
     if (parser.isSet(transformThresholdOption)) {
         palConfig.transformThreshold = parser.value(transformThresholdOption).toDouble();
 
@@ -411,6 +491,25 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (parser.isSet(transformFloatOption)) {
+        if (!TransformPal3D::isSinglePrecisionAvailable()) {
+            // Quit with error
+            qCritical("Single-precision Transform PAL is not available, as ld-chroma-decoder was built without fftw3f");
+            return -1;
+        }
+        palConfig.transformSinglePrecision = true;
+    }
+
+    if (parser.isSet(transformThreadsOption)) {
+        palConfig.transformThreads = parser.value(transformThreadsOption).toInt();
+
+        if (palConfig.transformThreads < 1) {
+            // Quit with error
+            qCritical("Specified number of Transform threads must be greater than zero");
+            return -1;
+        }
+    }
+
     LdDecodeMetaData::LineParameters lineParameters;
     if (parser.isSet(firstFieldLineOption)) {
         lineParameters.firstActiveFieldLine = parser.value(firstFieldLineOption).toInt();
@@ -539,7 +638,8 @@ int main(int argc, char *argv[])
     }
     
     // Perform the processing
-    DecoderPool decoderPool(*decoder, inputFileName, metaData, outputConfig, outputFileName, startFrame, length, maxThreads);
+    DecoderPool decoderPool(*decoder, inputFileName, metaData, outputConfig, outputFileName, startFrame, length, maxThreads, prefetchMegabytes,
+                            stageStatsFileName);
     if (!decoderPool.process()) {
         return -1;
     }
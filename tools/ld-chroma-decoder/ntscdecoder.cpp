@@ -66,6 +66,7 @@ NtscThread::NtscThread(QAtomicInt& _abort, DecoderPool &_decoderPool,
 {
     // Configure NTSC decoder
     comb.updateConfiguration(config.videoParameters, config.combConfig);
+    comb.setScratchArena(&scratchArena);
 }
 
 void NtscThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
@@ -74,3 +75,9 @@ void NtscThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 st
     // Decode fields to frames
     comb.decodeFrames(inputFields, startIndex, endIndex, componentFrames);
 }
+
+void NtscThread::getFrameReuse(qint64 &leadingFrames, qint64 &reusedFrames) const
+{
+    leadingFrames = comb.getLeadingFrames();
+    reusedFrames = comb.getReusedFrames();
+}
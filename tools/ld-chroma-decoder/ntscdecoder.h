@@ -71,6 +71,7 @@ public:
 protected:
     void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                       QVector<ComponentFrame> &componentFrames) override;
+    void getFrameReuse(qint64 &leadingFrames, qint64 &reusedFrames) const override;
 
 private:
     // Settings
@@ -67,7 +67,7 @@
  */
 
 PalColour::PalColour()
-    : configurationSet(false)
+    : configurationSet(false), scratchArena(&ownScratchArena)
 {
 }
 
@@ -118,9 +118,10 @@ void PalColour::updateConfiguration(const LdDecodeMetaData::VideoParameters &_vi
     if (configuration.chromaFilter == transform2DFilter || configuration.chromaFilter == transform3DFilter) {
         // Create the Transform PAL filter
         if (configuration.chromaFilter == transform2DFilter) {
-            transformPal = std::make_unique<TransformPal2D>();
+            transformPal = std::make_unique<TransformPal2D>(configuration.transformThreads);
         } else {
-            transformPal = std::make_unique<TransformPal3D>();
+            transformPal = std::make_unique<TransformPal3D>(configuration.transformSinglePrecision,
+                                                            configuration.transformThreads);
         }
 
         // Configure the filter
@@ -196,6 +197,9 @@ void PalColour::buildLookUpTables()
     // We may wish to broaden vertical bandwidth *slightly* so as to better
     // pass one- or two-line colour bars - underlines/graphics etc.
 
+    auto &cfilt = filterCoefficients.cfilt;
+    auto &yfilt = filterCoefficients.yfilt;
+
     double cdiv = 0, ydiv = 0;
     for (qint32 f = 0; f <= FILTER_SIZE; f++) {
         // 0-2-4-6 sequence here because we're only processing one field.
@@ -250,6 +254,16 @@ void PalColour::buildLookUpTables()
             yfilt[f][i] /= ydiv;
         }
     }
+
+    // Make the single-precision copy
+    for (qint32 f = 0; f <= FILTER_SIZE; f++) {
+        for (qint32 i = 0; i < 4; i++) {
+            filterCoefficientsFloat.cfilt[f][i] = static_cast<float>(cfilt[f][i]);
+        }
+        for (qint32 i = 0; i < 2; i++) {
+            filterCoefficientsFloat.yfilt[f][i] = static_cast<float>(yfilt[f][i]);
+        }
+    }
 }
 
 void PalColour::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
@@ -258,10 +272,14 @@ void PalColour::decodeFrames(const QVector<SourceField> &inputFields, qint32 sta
     assert(configurationSet);
     assert((componentFrames.size() * 2) == (endIndex - startIndex));
 
-    QVector<const double *> chromaData(endIndex - startIndex);
+    // Transform PAL's output is allocated from scratchArena, so it's
+    // released at the end of the batch
+    ScratchArena::Scope scope(*scratchArena);
+
+    chromaData.fill(nullptr, endIndex - startIndex);
     if (configuration.chromaFilter != palColourFilter) {
         // Use Transform PAL filter to extract chroma
-        transformPal->filterFields(inputFields, startIndex, endIndex, chromaData);
+        transformPal->filterFields(inputFields, startIndex, endIndex, chromaData, *scratchArena);
     }
 
     for (qint32 i = startIndex, j = 0, k = 0; i < endIndex; i += 2, j += 2, k++) {
@@ -279,6 +297,11 @@ void PalColour::decodeFrames(const QVector<SourceField> &inputFields, qint32 sta
     }
 }
 
+void PalColour::setScratchArena(ScratchArena *arena)
+{
+    scratchArena = arena;
+}
+
 // Decode one field into componentFrame
 void PalColour::decodeField(const SourceField &inputField, const double *chromaData, ComponentFrame &componentFrame)
 {
@@ -391,35 +414,23 @@ void PalColour::doYNR(double *Yline)
     double nr_y = configuration.yNRLevel * irescale;
 
     // High-pass filter for Y
-    auto yFilter(f_nrpal);
+    const auto nrFilter = makeFIRFilter(c_nrpal_b);
 
-    // Filter delay (since it's a symmetric FIR filter)
-    const qint32 delay = c_nrpal_b.size() / 2;
-
-    // High-pass result
-    std::vector<double> hpY(videoParameters.activeVideoEnd + delay);
-
-    // Feed zeros into the filter outside the active area
-    for (qint32 h = videoParameters.activeVideoStart - delay; h < videoParameters.activeVideoStart; h++) {
-        yFilter.feed(0.0);
-    }
-    for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-        hpY[h] = yFilter.feed(Yline[h]);
-    }
-    for (qint32 h = videoParameters.activeVideoEnd; h < videoParameters.activeVideoEnd + delay; h++) {
-        hpY[h] = yFilter.feed(0.0);
-    }
+    // High-pass result, for the active area of the line
+    const qint32 width = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
+    double *Y = Yline + videoParameters.activeVideoStart;
+    double hpY[MAX_WIDTH];
+    nrFilter.apply(Y, hpY, width);
 
-    for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-        // Offset to cover the filter delay
-        double a = hpY[h + delay];
+    for (qint32 h = 0; h < width; h++) {
+        double a = hpY[h];
 
         // Clip the filter strength
         if (fabs(a) > nr_y) {
             a = (a > 0) ? nr_y : -nr_y;
         }
 
-        Yline[h] -= a;
+        Y[h] -= a;
     }
 }
 
@@ -490,79 +501,14 @@ void PalColour::decodeLine(const SourceField &inputField, const ChromaSample *ch
             pv[i] = pu[i];
             qv[i] = qu[i];
         }
+    } else if (configuration.palColourSinglePrecision) {
+        // Use PALcolour's 2D filter, in single precision
+        const ChromaSample *const in[7] = {in0, in1, in2, in3, in4, in5, in6};
+        filterLine2D(in, filterCoefficientsFloat, py, qy, pu, qu, pv, qv);
     } else {
         // Use PALcolour's 2D filter
-
-        // Multiply the composite input signal by the reference carrier, giving
-        // quadrature samples where the colour subcarrier is now at 0 Hz.
-        // There will be a considerable amount of energy at higher frequencies
-        // resulting from the luma information and aliases of the signal, so
-        // we need to low-pass filter it before extracting the colour
-        // components.
-        //
-        // After filtering -- i.e. removing all the terms with sin(i) and sin^2(i)
-        // from the product -- we'll be left with just the chroma signal, at half
-        // its original amplitude. Phase errors will cancel between lines with
-        // opposite Vsw sense, giving correct phase (hue) but lower amplitude
-        // (saturation).
-        //
-        // As the 2D filters are vertically symmetrical, we can pre-compute the
-        // sums of pairs of lines above and below line.number to save some work
-        // in the inner loop below.
-        //
-        // Vertical taps 1 and 2 are swapped in the array to save one addition
-        // in the filter loop, as U and V use the same sign for taps 0 and 2.
-        double m[4][MAX_WIDTH], n[4][MAX_WIDTH];
-        for (qint32 i = videoParameters.activeVideoStart - FILTER_SIZE; i < videoParameters.activeVideoEnd + FILTER_SIZE + 1; i++) {
-            m[0][i] =  in0[i] * sine[i];
-            m[2][i] =  in1[i] * sine[i] - in2[i] * sine[i];
-            m[1][i] = -in3[i] * sine[i] - in4[i] * sine[i];
-            m[3][i] = -in5[i] * sine[i] + in6[i] * sine[i];
-
-            n[0][i] =  in0[i] * cosine[i];
-            n[2][i] =  in1[i] * cosine[i] - in2[i] * cosine[i];
-            n[1][i] = -in3[i] * cosine[i] - in4[i] * cosine[i];
-            n[3][i] = -in5[i] * cosine[i] + in6[i] * cosine[i];
-        }
-
-        // p & q should be sine/cosine components' amplitudes
-        // NB: Multiline averaging/filtering assumes perfect
-        //     inter-line phase registration...
-
-        for (qint32 i = videoParameters.activeVideoStart; i < videoParameters.activeVideoEnd; i++) {
-            double PU = 0, QU = 0, PV = 0, QV = 0, PY = 0, QY = 0;
-
-            // Carry out 2D filtering. P and Q are the two arbitrary SINE & COS
-            // phases components. U filters for U, V for V, and Y for Y.
-            //
-            // U and V are the same for lines n ([0]), n+/-2 ([1]), but
-            // differ in sign for n+/-1 ([2]), n+/-3 ([3]) owing to the
-            // forward/backward axis slant.
-
-            for (qint32 b = 0; b <= FILTER_SIZE; b++) {
-                const qint32 l = i - b;
-                const qint32 r = i + b;
-
-                PY += (m[0][r] + m[0][l]) * yfilt[b][0] + (m[1][r] + m[1][l]) * yfilt[b][1];
-                QY += (n[0][r] + n[0][l]) * yfilt[b][0] + (n[1][r] + n[1][l]) * yfilt[b][1];
-
-                PU += (m[0][r] + m[0][l]) * cfilt[b][0] + (m[1][r] + m[1][l]) * cfilt[b][1]
-                        + (n[2][r] + n[2][l]) * cfilt[b][2] + (n[3][r] + n[3][l]) * cfilt[b][3];
-                QU += (n[0][r] + n[0][l]) * cfilt[b][0] + (n[1][r] + n[1][l]) * cfilt[b][1]
-                        - (m[2][r] + m[2][l]) * cfilt[b][2] - (m[3][r] + m[3][l]) * cfilt[b][3];
-                PV += (m[0][r] + m[0][l]) * cfilt[b][0] + (m[1][r] + m[1][l]) * cfilt[b][1]
-                        - (n[2][r] + n[2][l]) * cfilt[b][2] - (n[3][r] + n[3][l]) * cfilt[b][3];
-                QV += (n[0][r] + n[0][l]) * cfilt[b][0] + (n[1][r] + n[1][l]) * cfilt[b][1]
-                        + (m[2][r] + m[2][l]) * cfilt[b][2] + (m[3][r] + m[3][l]) * cfilt[b][3];
-            }
-
-            pu[i] = PU;
-            qu[i] = QU;
-            pv[i] = PV;
-            qv[i] = QV;
-            py[i] = PY;
-            qy[i] = QY;
-        }
+        const ChromaSample *const in[7] = {in0, in1, in2, in3, in4, in5, in6};
+        filterLine2D(in, filterCoefficients, py, qy, pu, qu, pv, qv);
     }
 
     // Pointer to composite signal data
@@ -600,3 +546,39 @@ void PalColour::decodeLine(const SourceField &inputField, const ChromaSample *ch
         doYNR(outY);
     }
 }
+
+// Apply PALcolour's 2D filter to a line, computing the P and Q components for
+// Y, U and V. in contains the current line and the surrounding lines, as for
+// PalKernels::prepare.
+template <typename FilterSample, typename ChromaSample>
+void PalColour::filterLine2D(const ChromaSample *const in[7], const PalKernels::Coefficients<FilterSample> &coefficients,
+                             double *py, double *qy, double *pu, double *qu, double *pv, double *qv)
+{
+    // Multiply the composite input signal by the reference carrier, giving
+    // quadrature samples where the colour subcarrier is now at 0 Hz.
+    // There will be a considerable amount of energy at higher frequencies
+    // resulting from the luma information and aliases of the signal, so
+    // we need to low-pass filter it before extracting the colour
+    // components.
+    //
+    // After filtering -- i.e. removing all the terms with sin(i) and sin^2(i)
+    // from the product -- we'll be left with just the chroma signal, at half
+    // its original amplitude. Phase errors will cancel between lines with
+    // opposite Vsw sense, giving correct phase (hue) but lower amplitude
+    // (saturation).
+    //
+    // As the 2D filters are vertically symmetrical, we pre-compute the sums
+    // of pairs of lines above and below the current line to save some work in
+    // the filter (see PalKernels::prepare).
+    alignas(64) FilterSample mData[4][MAX_WIDTH], nData[4][MAX_WIDTH];
+    FilterSample *const m[4] = {mData[0], mData[1], mData[2], mData[3]};
+    FilterSample *const n[4] = {nData[0], nData[1], nData[2], nData[3]};
+    PalKernels::prepare(in, sine, cosine, m, n,
+                        videoParameters.activeVideoStart - FILTER_SIZE, videoParameters.activeVideoEnd + FILTER_SIZE + 1);
+
+    // p & q should be sine/cosine components' amplitudes
+    // NB: Multiline averaging/filtering assumes perfect
+    //     inter-line phase registration...
+    PalKernels::filter(m, n, coefficients, py, qy, pu, qu, pv, qv,
+                       videoParameters.activeVideoStart, videoParameters.activeVideoEnd);
+}
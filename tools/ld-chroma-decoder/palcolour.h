@@ -36,6 +36,8 @@
 
 #include "componentframe.h"
 #include "decoder.h"
+#include "palkernels.h"
+#include "scratcharena.h"
 #include "sourcefield.h"
 #include "transformpal.h"
 
@@ -60,8 +62,11 @@ public:
         double yNRLevel = 0.5;
         bool simplePAL = false;
         ChromaFilterMode chromaFilter = palColourFilter;
+        bool palColourSinglePrecision = false;
         double transformThreshold = 0.4;
         QVector<double> transformThresholds;
+        bool transformSinglePrecision = false;
+        qint32 transformThreads = 1;
         bool showFFTs = false;
         qint32 showPositionX = 200;
         qint32 showPositionY = 200;
@@ -79,6 +84,10 @@ public:
     void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                       QVector<ComponentFrame> &outputFrames);
 
+    // Allocate temporary buffers from arena, rather than the PalColour's own arena.
+    // arena must remain valid for as long as the PalColour is used.
+    void setScratchArena(ScratchArena *arena);
+
     // Maximum frame size, based on PAL
     static constexpr qint32 MAX_WIDTH = 1135;
 
@@ -100,6 +109,9 @@ private:
     template <typename ChromaSample, bool PREFILTERED_CHROMA>
     void decodeLine(const SourceField &inputField, const ChromaSample *chromaData, const LineInfo &line,
                     ComponentFrame &componentFrame);
+    template <typename FilterSample, typename ChromaSample>
+    void filterLine2D(const ChromaSample *const in[7], const PalKernels::Coefficients<FilterSample> &coefficients,
+                      double *py, double *qy, double *pu, double *qu, double *pv, double *qv);
     void doYNR(double *Yline);
 
     // Configuration parameters
@@ -110,6 +122,13 @@ private:
     // Transform PAL filter
     std::unique_ptr<TransformPal> transformPal;
 
+    // Arena for temporary buffers
+    ScratchArena ownScratchArena;
+    ScratchArena *scratchArena;
+
+    // Pointers to Transform PAL's output for each field in a batch
+    QVector<const double *> chromaData;
+
     // The subcarrier reference signal
     double sine[MAX_WIDTH], cosine[MAX_WIDTH];
 
@@ -121,9 +140,12 @@ private:
     // array represents one quarter of a filter. The zeroth horizontal element
     // is included in the sum twice, so the coefficient is halved to
     // compensate. Each filter is (2 * FILTER_SIZE) + 1 elements wide.
-    static constexpr qint32 FILTER_SIZE = 7;
-    double cfilt[FILTER_SIZE + 1][4];
-    double yfilt[FILTER_SIZE + 1][2];
+    //
+    // filterCoefficientsFloat is a single-precision copy, used if
+    // palColourSinglePrecision is set.
+    static constexpr qint32 FILTER_SIZE = PalKernels::FILTER_SIZE;
+    PalKernels::Coefficients<double> filterCoefficients;
+    PalKernels::Coefficients<float> filterCoefficientsFloat;
 };
 
 #endif // PALCOLOUR_H
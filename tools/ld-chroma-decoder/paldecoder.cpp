@@ -64,6 +64,7 @@ PalThread::PalThread(QAtomicInt& _abort, DecoderPool& _decoderPool,
 {
     // Configure PALcolour
     palColour.updateConfiguration(config.videoParameters, config.pal);
+    palColour.setScratchArena(&scratchArena);
 }
 
 void PalThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
@@ -0,0 +1,424 @@
+/************************************************************************
+
+    palkernels.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "palkernels.h"
+
+// AVX2 and AVX-512 are only available through GCC/Clang target attributes on x86
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PALKERNELS_SIMD
+#include <immintrin.h>
+#endif
+
+using PalKernels::Coefficients;
+using PalKernels::FILTER_SIZE;
+
+// Scalar implementations -------------------------------------------------------------------------------------------
+
+// In the vertical direction, the filters are symmetrical, so we compute the
+// sums of pairs of lines above and below the current line here to save some
+// work in filter().
+//
+// Vertical taps 1 and 2 are swapped in the array to save one addition in the
+// filter loop, as U and V use the same sign for taps 0 and 2.
+template <typename Sample, typename T>
+static void prepareScalar(const Sample *const in[7], const double *sine, const double *cosine,
+                          T *const m[4], T *const n[4], qint32 start, qint32 end)
+{
+    for (qint32 i = start; i < end; i++) {
+        const T s = static_cast<T>(sine[i]);
+        const T c = static_cast<T>(cosine[i]);
+        const T in0 = static_cast<T>(in[0][i]), in1 = static_cast<T>(in[1][i]), in2 = static_cast<T>(in[2][i]);
+        const T in3 = static_cast<T>(in[3][i]), in4 = static_cast<T>(in[4][i]);
+        const T in5 = static_cast<T>(in[5][i]), in6 = static_cast<T>(in[6][i]);
+
+        m[0][i] =  in0 * s;
+        m[2][i] =  in1 * s - in2 * s;
+        m[1][i] = -in3 * s - in4 * s;
+        m[3][i] = -in5 * s + in6 * s;
+
+        n[0][i] =  in0 * c;
+        n[2][i] =  in1 * c - in2 * c;
+        n[1][i] = -in3 * c - in4 * c;
+        n[3][i] = -in5 * c + in6 * c;
+    }
+}
+
+template <typename T>
+static void filterScalar(const T *const m[4], const T *const n[4], const Coefficients<T> &coefficients,
+                         double *py, double *qy, double *pu, double *qu, double *pv, double *qv,
+                         qint32 start, qint32 end)
+{
+    const auto &cfilt = coefficients.cfilt;
+    const auto &yfilt = coefficients.yfilt;
+
+    for (qint32 i = start; i < end; i++) {
+        T PU = 0, QU = 0, PV = 0, QV = 0, PY = 0, QY = 0;
+
+        // Carry out 2D filtering. P and Q are the two arbitrary SINE & COS
+        // phases components. U filters for U, V for V, and Y for Y.
+        //
+        // U and V are the same for lines n ([0]), n+/-2 ([1]), but
+        // differ in sign for n+/-1 ([2]), n+/-3 ([3]) owing to the
+        // forward/backward axis slant.
+
+        for (qint32 b = 0; b <= FILTER_SIZE; b++) {
+            const qint32 l = i - b;
+            const qint32 r = i + b;
+
+            PY += (m[0][r] + m[0][l]) * yfilt[b][0] + (m[1][r] + m[1][l]) * yfilt[b][1];
+            QY += (n[0][r] + n[0][l]) * yfilt[b][0] + (n[1][r] + n[1][l]) * yfilt[b][1];
+
+            PU += (m[0][r] + m[0][l]) * cfilt[b][0] + (m[1][r] + m[1][l]) * cfilt[b][1]
+                    + (n[2][r] + n[2][l]) * cfilt[b][2] + (n[3][r] + n[3][l]) * cfilt[b][3];
+            QU += (n[0][r] + n[0][l]) * cfilt[b][0] + (n[1][r] + n[1][l]) * cfilt[b][1]
+                    - (m[2][r] + m[2][l]) * cfilt[b][2] - (m[3][r] + m[3][l]) * cfilt[b][3];
+            PV += (m[0][r] + m[0][l]) * cfilt[b][0] + (m[1][r] + m[1][l]) * cfilt[b][1]
+                    - (n[2][r] + n[2][l]) * cfilt[b][2] - (n[3][r] + n[3][l]) * cfilt[b][3];
+            QV += (n[0][r] + n[0][l]) * cfilt[b][0] + (n[1][r] + n[1][l]) * cfilt[b][1]
+                    + (m[2][r] + m[2][l]) * cfilt[b][2] + (m[3][r] + m[3][l]) * cfilt[b][3];
+        }
+
+        pu[i] = PU;
+        qu[i] = QU;
+        pv[i] = PV;
+        qv[i] = QV;
+        py[i] = PY;
+        qy[i] = QY;
+    }
+}
+
+#ifdef PALKERNELS_SIMD
+
+// Vector operations --------------------------------------------------------------------------------------------------
+//
+// These wrap the intrinsics for each combination of instruction set and
+// precision, so the SIMD kernels below can be written once for each
+// instruction set. None of them use fused multiply-add, so the arithmetic
+// matches the scalar code exactly.
+
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#define AVX512_FUNCTION __attribute__((target("avx512f")))
+
+struct Avx2Double {
+    using Vec = __m256d;
+    static constexpr qint32 WIDTH = 4;
+
+    AVX2_FUNCTION static Vec load(const double *p) { return _mm256_loadu_pd(p); }
+    AVX2_FUNCTION static Vec load(const quint16 *p) {
+        return _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))));
+    }
+    AVX2_FUNCTION static Vec set1(double x) { return _mm256_set1_pd(x); }
+    AVX2_FUNCTION static Vec zero() { return _mm256_setzero_pd(); }
+    AVX2_FUNCTION static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+    AVX2_FUNCTION static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+    AVX2_FUNCTION static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+    AVX2_FUNCTION static Vec neg(Vec a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+    AVX2_FUNCTION static void store(double *p, Vec a) { _mm256_storeu_pd(p, a); }
+    AVX2_FUNCTION static void storeDouble(double *p, Vec a) { _mm256_storeu_pd(p, a); }
+};
+
+struct Avx2Float {
+    using Vec = __m256;
+    static constexpr qint32 WIDTH = 8;
+
+    AVX2_FUNCTION static Vec load(const float *p) { return _mm256_loadu_ps(p); }
+    AVX2_FUNCTION static Vec load(const double *p) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_loadu_pd(p))),
+                                    _mm256_cvtpd_ps(_mm256_loadu_pd(p + 4)), 1);
+    }
+    AVX2_FUNCTION static Vec load(const quint16 *p) {
+        return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))));
+    }
+    AVX2_FUNCTION static Vec set1(float x) { return _mm256_set1_ps(x); }
+    AVX2_FUNCTION static Vec zero() { return _mm256_setzero_ps(); }
+    AVX2_FUNCTION static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+    AVX2_FUNCTION static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+    AVX2_FUNCTION static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+    AVX2_FUNCTION static Vec neg(Vec a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    AVX2_FUNCTION static void store(float *p, Vec a) { _mm256_storeu_ps(p, a); }
+    AVX2_FUNCTION static void storeDouble(double *p, Vec a) {
+        _mm256_storeu_pd(p, _mm256_cvtps_pd(_mm256_castps256_ps128(a)));
+        _mm256_storeu_pd(p + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(a, 1)));
+    }
+};
+
+struct Avx512Double {
+    using Vec = __m512d;
+    static constexpr qint32 WIDTH = 8;
+
+    AVX512_FUNCTION static Vec load(const double *p) { return _mm512_loadu_pd(p); }
+    AVX512_FUNCTION static Vec load(const quint16 *p) {
+        return _mm512_cvtepi32_pd(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))));
+    }
+    AVX512_FUNCTION static Vec set1(double x) { return _mm512_set1_pd(x); }
+    AVX512_FUNCTION static Vec zero() { return _mm512_setzero_pd(); }
+    AVX512_FUNCTION static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+    AVX512_FUNCTION static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+    AVX512_FUNCTION static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+    AVX512_FUNCTION static Vec neg(Vec a) {
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(_mm512_set1_pd(-0.0))));
+    }
+    AVX512_FUNCTION static void store(double *p, Vec a) { _mm512_storeu_pd(p, a); }
+    AVX512_FUNCTION static void storeDouble(double *p, Vec a) { _mm512_storeu_pd(p, a); }
+};
+
+struct Avx512Float {
+    using Vec = __m512;
+    static constexpr qint32 WIDTH = 16;
+
+    AVX512_FUNCTION static Vec load(const float *p) { return _mm512_loadu_ps(p); }
+    AVX512_FUNCTION static Vec load(const double *p) {
+        const __m256 low = _mm512_cvtpd_ps(_mm512_loadu_pd(p));
+        const __m256 high = _mm512_cvtpd_ps(_mm512_loadu_pd(p + 8));
+        return _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castps_pd(_mm512_castps256_ps512(low)), _mm256_castps_pd(high), 1));
+    }
+    AVX512_FUNCTION static Vec load(const quint16 *p) {
+        return _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))));
+    }
+    AVX512_FUNCTION static Vec set1(float x) { return _mm512_set1_ps(x); }
+    AVX512_FUNCTION static Vec zero() { return _mm512_setzero_ps(); }
+    AVX512_FUNCTION static Vec add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+    AVX512_FUNCTION static Vec sub(Vec a, Vec b) { return _mm512_sub_ps(a, b); }
+    AVX512_FUNCTION static Vec mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+    AVX512_FUNCTION static Vec neg(Vec a) {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(_mm512_set1_ps(-0.0f))));
+    }
+    AVX512_FUNCTION static void store(float *p, Vec a) { _mm512_storeu_ps(p, a); }
+    AVX512_FUNCTION static void storeDouble(double *p, Vec a) {
+        _mm512_storeu_pd(p, _mm512_cvtps_pd(_mm512_castps512_ps256(a)));
+        _mm512_storeu_pd(p + 8, _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a), 1))));
+    }
+};
+
+template <typename T> struct Avx2Ops;
+template <> struct Avx2Ops<double> { using Type = Avx2Double; };
+template <> struct Avx2Ops<float> { using Type = Avx2Float; };
+
+template <typename T> struct Avx512Ops;
+template <> struct Avx512Ops<double> { using Type = Avx512Double; };
+template <> struct Avx512Ops<float> { using Type = Avx512Float; };
+
+// SIMD implementations -----------------------------------------------------------------------------------------------
+//
+// These process WIDTH samples at a time, with the same arithmetic as the
+// scalar versions (which handle the remaining samples). The AVX2 and AVX-512
+// versions are identical apart from their target and vector operations.
+
+// Compute one step of prepare() with vector operations V
+#define PALKERNELS_PREPARE_STEP(V)                                              \
+    {                                                                           \
+        const auto s = V::load(sine + i);                                       \
+        const auto c = V::load(cosine + i);                                     \
+        const auto in0 = V::load(in[0] + i), in1 = V::load(in[1] + i);         \
+        const auto in2 = V::load(in[2] + i), in3 = V::load(in[3] + i);         \
+        const auto in4 = V::load(in[4] + i), in5 = V::load(in[5] + i);         \
+        const auto in6 = V::load(in[6] + i);                                    \
+                                                                                \
+        V::store(m[0] + i, V::mul(in0, s));                                     \
+        V::store(m[2] + i, V::sub(V::mul(in1, s), V::mul(in2, s)));             \
+        V::store(m[1] + i, V::sub(V::mul(V::neg(in3), s), V::mul(in4, s)));     \
+        V::store(m[3] + i, V::add(V::mul(V::neg(in5), s), V::mul(in6, s)));     \
+                                                                                \
+        V::store(n[0] + i, V::mul(in0, c));                                     \
+        V::store(n[2] + i, V::sub(V::mul(in1, c), V::mul(in2, c)));             \
+        V::store(n[1] + i, V::sub(V::mul(V::neg(in3), c), V::mul(in4, c)));     \
+        V::store(n[3] + i, V::add(V::mul(V::neg(in5), c), V::mul(in6, c)));     \
+    }
+
+// Compute one step of filter() with vector operations V
+#define PALKERNELS_FILTER_STEP(V)                                                                   \
+    {                                                                                               \
+        auto PU = V::zero(), QU = V::zero(), PV = V::zero(), QV = V::zero();                        \
+        auto PY = V::zero(), QY = V::zero();                                                        \
+                                                                                                    \
+        for (qint32 b = 0; b <= FILTER_SIZE; b++) {                                                 \
+            const qint32 l = i - b;                                                                 \
+            const qint32 r = i + b;                                                                 \
+                                                                                                    \
+            const auto m0 = V::add(V::load(m[0] + r), V::load(m[0] + l));                           \
+            const auto m1 = V::add(V::load(m[1] + r), V::load(m[1] + l));                           \
+            const auto m2 = V::add(V::load(m[2] + r), V::load(m[2] + l));                           \
+            const auto m3 = V::add(V::load(m[3] + r), V::load(m[3] + l));                           \
+            const auto n0 = V::add(V::load(n[0] + r), V::load(n[0] + l));                           \
+            const auto n1 = V::add(V::load(n[1] + r), V::load(n[1] + l));                           \
+            const auto n2 = V::add(V::load(n[2] + r), V::load(n[2] + l));                           \
+            const auto n3 = V::add(V::load(n[3] + r), V::load(n[3] + l));                           \
+                                                                                                    \
+            const auto y0 = V::set1(coefficients.yfilt[b][0]), y1 = V::set1(coefficients.yfilt[b][1]); \
+            const auto c0 = V::set1(coefficients.cfilt[b][0]), c1 = V::set1(coefficients.cfilt[b][1]); \
+            const auto c2 = V::set1(coefficients.cfilt[b][2]), c3 = V::set1(coefficients.cfilt[b][3]); \
+                                                                                                    \
+            PY = V::add(PY, V::add(V::mul(m0, y0), V::mul(m1, y1)));                                \
+            QY = V::add(QY, V::add(V::mul(n0, y0), V::mul(n1, y1)));                                \
+                                                                                                    \
+            const auto mc01 = V::add(V::mul(m0, c0), V::mul(m1, c1));                               \
+            const auto nc01 = V::add(V::mul(n0, c0), V::mul(n1, c1));                               \
+            const auto m2c = V::mul(m2, c2), m3c = V::mul(m3, c3);                                  \
+            const auto n2c = V::mul(n2, c2), n3c = V::mul(n3, c3);                                  \
+                                                                                                    \
+            PU = V::add(PU, V::add(V::add(mc01, n2c), n3c));                                        \
+            QU = V::add(QU, V::sub(V::sub(nc01, m2c), m3c));                                        \
+            PV = V::add(PV, V::sub(V::sub(mc01, n2c), n3c));                                        \
+            QV = V::add(QV, V::add(V::add(nc01, m2c), m3c));                                        \
+        }                                                                                           \
+                                                                                                    \
+        V::storeDouble(pu + i, PU);                                                                 \
+        V::storeDouble(qu + i, QU);                                                                 \
+        V::storeDouble(pv + i, PV);                                                                 \
+        V::storeDouble(qv + i, QV);                                                                 \
+        V::storeDouble(py + i, PY);                                                                 \
+        V::storeDouble(qy + i, QY);                                                                 \
+    }
+
+template <typename Sample, typename T>
+AVX2_FUNCTION static void prepareAVX2(const Sample *const in[7], const double *sine, const double *cosine,
+                                      T *const m[4], T *const n[4], qint32 start, qint32 end)
+{
+    using V = typename Avx2Ops<T>::Type;
+
+    qint32 i = start;
+    for (; i + V::WIDTH <= end; i += V::WIDTH) PALKERNELS_PREPARE_STEP(V)
+
+    // Remaining samples
+    prepareScalar(in, sine, cosine, m, n, i, end);
+}
+
+template <typename T>
+AVX2_FUNCTION static void filterAVX2(const T *const m[4], const T *const n[4], const Coefficients<T> &coefficients,
+                                     double *py, double *qy, double *pu, double *qu, double *pv, double *qv,
+                                     qint32 start, qint32 end)
+{
+    using V = typename Avx2Ops<T>::Type;
+
+    qint32 i = start;
+    for (; i + V::WIDTH <= end; i += V::WIDTH) PALKERNELS_FILTER_STEP(V)
+
+    // Remaining samples
+    filterScalar(m, n, coefficients, py, qy, pu, qu, pv, qv, i, end);
+}
+
+template <typename Sample, typename T>
+AVX512_FUNCTION static void prepareAVX512(const Sample *const in[7], const double *sine, const double *cosine,
+                                          T *const m[4], T *const n[4], qint32 start, qint32 end)
+{
+    using V = typename Avx512Ops<T>::Type;
+
+    qint32 i = start;
+    for (; i + V::WIDTH <= end; i += V::WIDTH) PALKERNELS_PREPARE_STEP(V)
+
+    // Remaining samples
+    prepareScalar(in, sine, cosine, m, n, i, end);
+}
+
+template <typename T>
+AVX512_FUNCTION static void filterAVX512(const T *const m[4], const T *const n[4], const Coefficients<T> &coefficients,
+                                         double *py, double *qy, double *pu, double *qu, double *pv, double *qv,
+                                         qint32 start, qint32 end)
+{
+    using V = typename Avx512Ops<T>::Type;
+
+    qint32 i = start;
+    for (; i + V::WIDTH <= end; i += V::WIDTH) PALKERNELS_FILTER_STEP(V)
+
+    // Remaining samples
+    filterScalar(m, n, coefficients, py, qy, pu, qu, pv, qv, i, end);
+}
+
+#endif
+
+// Dispatching versions ---------------------------------------------------------------------------------------------
+
+// The limit set by setMaxIsa
+static PalKernels::Isa maxIsa = PalKernels::avx512Isa;
+
+PalKernels::Isa PalKernels::getBestIsa()
+{
+#ifdef PALKERNELS_SIMD
+    static const Isa bestIsa = __builtin_cpu_supports("avx512f") ? avx512Isa
+                               : __builtin_cpu_supports("avx2") ? avx2Isa
+                               : scalarIsa;
+    return qMin(bestIsa, maxIsa);
+#else
+    return scalarIsa;
+#endif
+}
+
+void PalKernels::setMaxIsa(Isa isa)
+{
+    maxIsa = isa;
+}
+
+template <typename Sample, typename T>
+void PalKernels::prepare(const Sample *const in[7], const double *sine, const double *cosine,
+                         T *const m[4], T *const n[4], qint32 start, qint32 end, Isa isa)
+{
+#ifdef PALKERNELS_SIMD
+    if (isa == avx512Isa) {
+        prepareAVX512(in, sine, cosine, m, n, start, end);
+        return;
+    }
+    if (isa == avx2Isa) {
+        prepareAVX2(in, sine, cosine, m, n, start, end);
+        return;
+    }
+#else
+    Q_UNUSED(isa);
+#endif
+    prepareScalar(in, sine, cosine, m, n, start, end);
+}
+
+template <typename T>
+void PalKernels::filter(const T *const m[4], const T *const n[4], const Coefficients<T> &coefficients,
+                        double *py, double *qy, double *pu, double *qu, double *pv, double *qv,
+                        qint32 start, qint32 end, Isa isa)
+{
+#ifdef PALKERNELS_SIMD
+    if (isa == avx512Isa) {
+        filterAVX512(m, n, coefficients, py, qy, pu, qu, pv, qv, start, end);
+        return;
+    }
+    if (isa == avx2Isa) {
+        filterAVX2(m, n, coefficients, py, qy, pu, qu, pv, qv, start, end);
+        return;
+    }
+#else
+    Q_UNUSED(isa);
+#endif
+    filterScalar(m, n, coefficients, py, qy, pu, qu, pv, qv, start, end);
+}
+
+// Instantiate the kernels for PALcolour (quint16 input) and Transform PAL
+// (double input), in both precisions
+template void PalKernels::prepare<quint16, double>(const quint16 *const [7], const double *, const double *,
+                                                   double *const [4], double *const [4], qint32, qint32, Isa);
+template void PalKernels::prepare<quint16, float>(const quint16 *const [7], const double *, const double *,
+                                                  float *const [4], float *const [4], qint32, qint32, Isa);
+template void PalKernels::prepare<double, double>(const double *const [7], const double *, const double *,
+                                                  double *const [4], double *const [4], qint32, qint32, Isa);
+template void PalKernels::prepare<double, float>(const double *const [7], const double *, const double *,
+                                                 float *const [4], float *const [4], qint32, qint32, Isa);
+template void PalKernels::filter<double>(const double *const [4], const double *const [4], const Coefficients<double> &,
+                                         double *, double *, double *, double *, double *, double *, qint32, qint32, Isa);
+template void PalKernels::filter<float>(const float *const [4], const float *const [4], const Coefficients<float> &,
+                                        double *, double *, double *, double *, double *, double *, qint32, qint32, Isa);
@@ -0,0 +1,83 @@
+/************************************************************************
+
+    palkernels.h
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef PALKERNELS_H
+#define PALKERNELS_H
+
+#include <QtGlobal>
+
+// Kernels for PALcolour's 2D chroma filter (see PalColour::decodeLine).
+//
+// prepare() multiplies the seven lines of input around the line being decoded
+// by the subcarrier reference, giving the m and n arrays; filter() then
+// applies the 2D filters to them. Each function processes samples
+// [start, end) of a line.
+//
+// The filtering can be done in double precision (T = double) or single
+// precision (T = float). Each function has scalar, AVX2 and AVX-512
+// implementations; the isa parameter selects one, and defaults to the best
+// the CPU supports. The double-precision implementations do the same
+// operations in the same order, so their output is identical; the
+// single-precision ones match each other to within rounding.
+namespace PalKernels {
+    static constexpr qint32 FILTER_SIZE = 7;
+
+    // Coefficients for the chroma and luma filters, as computed by PalColour
+    template <typename T>
+    struct Coefficients {
+        T cfilt[FILTER_SIZE + 1][4];
+        T yfilt[FILTER_SIZE + 1][2];
+    };
+
+    enum Isa {
+        scalarIsa = 0,
+        avx2Isa,
+        avx512Isa
+    };
+
+    // Return the best instruction set the CPU supports, no higher than the
+    // limit set by setMaxIsa
+    Isa getBestIsa();
+
+    // Limit the instruction set that getBestIsa returns, so the
+    // implementations can be compared on the same CPU. This must be called
+    // before any decoding threads start.
+    void setMaxIsa(Isa isa);
+
+    // Compute m and n from the input lines. in[0] is the current line, and
+    // in[1] to in[6] are the lines -1, +1, -2, +2, -3 and +3 lines away.
+    template <typename Sample, typename T>
+    void prepare(const Sample *const in[7], const double *sine, const double *cosine,
+                 T *const m[4], T *const n[4], qint32 start, qint32 end, Isa isa = getBestIsa());
+
+    // Apply the 2D filters to m and n, giving the P and Q components for Y, U
+    // and V. m and n must be valid from start - FILTER_SIZE to
+    // end + FILTER_SIZE.
+    template <typename T>
+    void filter(const T *const m[4], const T *const n[4], const Coefficients<T> &coefficients,
+                double *py, double *qy, double *pu, double *qu, double *pv, double *qv,
+                qint32 start, qint32 end, Isa isa = getBestIsa());
+}
+
+#endif // PALKERNELS_H
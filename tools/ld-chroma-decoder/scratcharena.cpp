@@ -0,0 +1,116 @@
+/************************************************************************
+
+    scratcharena.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "scratcharena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+// Size of the first block the arena allocates
+static constexpr qint64 MINIMUM_BLOCK_SIZE = 64 * 1024;
+
+ScratchArena::ScratchArena()
+    : blockIndex(0), blockUsed(0), scopeDepth(0), heapAllocations(0)
+{
+}
+
+qint64 ScratchArena::getCapacity() const
+{
+    qint64 capacity = 0;
+    for (const Block &block : blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+ScratchArena::Scope::Scope(ScratchArena &_arena)
+    : arena(_arena), blockIndex(_arena.blockIndex), blockUsed(_arena.blockUsed)
+{
+    arena.scopeDepth++;
+}
+
+ScratchArena::Scope::~Scope()
+{
+    arena.endScope(blockIndex, blockUsed);
+}
+
+void *ScratchArena::allocateBytes(qint64 size)
+{
+    assert(scopeDepth > 0);
+    assert(size >= 0);
+
+    // Round the size up, so the next allocation is aligned too
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    const qint32 numBlocks = static_cast<qint32>(blocks.size());
+    if (blockIndex >= numBlocks || (blockUsed + size) > blocks[blockIndex].size) {
+        // Move on to the next block that's big enough, adding one if there isn't one
+        if (blockIndex < numBlocks) blockIndex++;
+        while (blockIndex < numBlocks && size > blocks[blockIndex].size) blockIndex++;
+        blockUsed = 0;
+
+        if (blockIndex == numBlocks) addBlock(size);
+    }
+
+    void *result = blocks[blockIndex].data + blockUsed;
+    blockUsed += size;
+    return result;
+}
+
+// Add a new block to the end of blocks, with at least minimumSize bytes.
+// Blocks at least double the arena's capacity, so it doesn't take many
+// steps to reach the size that's needed.
+void ScratchArena::addBlock(qint64 minimumSize)
+{
+    Block block;
+    block.size = std::max({minimumSize, getCapacity(), MINIMUM_BLOCK_SIZE});
+    block.storage.reset(new char[block.size + ALIGNMENT]);
+
+    // Align the start of the block
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(block.storage.get());
+    block.data = block.storage.get() + ((ALIGNMENT - (address % ALIGNMENT)) % ALIGNMENT);
+
+    blocks.push_back(std::move(block));
+    heapAllocations++;
+}
+
+void ScratchArena::endScope(qint32 _blockIndex, qint64 _blockUsed)
+{
+    assert(scopeDepth > 0);
+    scopeDepth--;
+
+    blockIndex = _blockIndex;
+    blockUsed = _blockUsed;
+
+    if (scopeDepth == 0 && blocks.size() > 1) {
+        // Nothing is allocated now, so replace the blocks with a single one
+        // big enough for all of them
+        const qint64 capacity = getCapacity();
+        blocks.clear();
+        addBlock(capacity);
+
+        blockIndex = 0;
+        blockUsed = 0;
+    }
+}
@@ -0,0 +1,115 @@
+/************************************************************************
+
+    scratcharena.h
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+#include <QtGlobal>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// An arena for a decoder thread's temporary buffers.
+//
+// Stages that need temporary space for a line, field or batch of frames
+// allocate it from an arena rather than the heap. Allocations are made within
+// a Scope; when the Scope ends, everything allocated since it began is
+// released at once. The arena keeps its memory between Scopes, so once it has
+// grown to the largest size needed, it doesn't need the heap again.
+//
+// Each DecoderThread owns a ScratchArena, which it passes to its decoder.
+// An arena must only be used by one thread at a time.
+class ScratchArena
+{
+public:
+    ScratchArena();
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    // Allocations are aligned to this many bytes, which is enough for any SIMD type
+    static constexpr qint64 ALIGNMENT = 64;
+
+    // Mark the current position in the arena. When the Scope is destroyed,
+    // all the space allocated since it was created is released.
+    // Scopes must be destroyed in the reverse order they were created.
+    class Scope
+    {
+    public:
+        explicit Scope(ScratchArena &arena);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        ScratchArena &arena;
+        qint32 blockIndex;
+        qint64 blockUsed;
+    };
+
+    // Allocate uninitialised space for count objects of type T, which must be
+    // trivial. The space remains valid until the innermost Scope ends.
+    template <typename T>
+    T *allocate(qint64 count) {
+        static_assert(std::is_trivial<T>::value, "ScratchArena can only hold trivial types");
+        static_assert(alignof(T) <= ALIGNMENT, "Type is too strictly aligned for ScratchArena");
+        return static_cast<T *>(allocateBytes(count * static_cast<qint64>(sizeof(T))));
+    }
+
+    // Return the number of times the arena has allocated memory from the heap
+    qint64 getHeapAllocations() const {
+        return heapAllocations;
+    }
+
+    // Return the number of bytes of memory the arena holds
+    qint64 getCapacity() const;
+
+private:
+    // Blocks of memory, used in order. Normally there's only one, but more
+    // are added when it fills up; when no Scopes are active, they're
+    // combined into a single block large enough for all of them.
+    struct Block {
+        std::unique_ptr<char[]> storage;
+        char *data;
+        qint64 size;
+    };
+    std::vector<Block> blocks;
+
+    // The block that space is currently allocated from, and how much of it is in use
+    qint32 blockIndex;
+    qint64 blockUsed;
+
+    // Number of active Scopes
+    qint32 scopeDepth;
+
+    qint64 heapAllocations;
+
+    void *allocateBytes(qint64 size);
+    void addBlock(qint64 minimumSize);
+    void endScope(qint32 _blockIndex, qint64 _blockUsed);
+};
+
+#endif // SCRATCHARENA_H
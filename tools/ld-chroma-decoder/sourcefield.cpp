@@ -26,18 +26,94 @@
 
 #include "sourcevideo.h"
 
+// Read or synthesise the data for fields whose metadata has been filled in by
+// loadFieldMetadata, using readField(fieldNumber, data) to read each field
+template <typename ReadField>
+static void loadFieldDataWith(ReadField readField, qint32 fieldLength,
+                              const LdDecodeMetaData::VideoParameters &videoParameters,
+                              const QVector<qint32> &fieldNumbers, QVector<SourceField> &fields)
+{
+    const quint16 black = videoParameters.black16bIre;
+
+    for (qint32 i = 0; i < fields.size(); i++) {
+        if (fieldNumbers[i] == -1) {
+            // Outside the bounds of the input file, so fill with black
+            fields[i].data.fill(black, fieldLength);
+            continue;
+        }
+
+        // Fetch the input field
+        readField(fieldNumbers[i], fields[i].data);
+
+        if ((i % 2) == 1 && (videoParameters.system == PAL || videoParameters.system == PAL_M)
+            && videoParameters.isSubcarrierLocked) {
+            // With subcarrier-locked 4fSC PAL sampling, we have four
+            // "extra" samples over the course of the frame, so the two
+            // fields will be horizontally misaligned by two samples. Shift
+            // the second field to the left to compensate.
+            //
+            // XXX This should be done elsewhere, as it affects other tools
+            // too.
+
+            fields[i].data.remove(0, 2);
+            for (int j = 0; j < 2; j++) {
+                fields[i].data.append(black);
+            }
+        }
+    }
+}
+
 void SourceField::loadFields(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecodeMetaData,
                              qint32 firstFrameNumber, qint32 numFrames,
                              qint32 lookBehindFrames, qint32 lookAheadFrames,
                              QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex)
 {
-    const LdDecodeMetaData::VideoParameters &videoParameters = ldDecodeMetaData.getVideoParameters();
+    QVector<qint32> fieldNumbers;
+    loadFieldMetadata(ldDecodeMetaData, firstFrameNumber, numFrames, lookBehindFrames, lookAheadFrames,
+                      fields, fieldNumbers, startIndex, endIndex);
+
+    // If the input is memory-mapped, copy into the existing field buffers.
+    // Otherwise, use getVideoField, whose cache lets fields that are shared
+    // between batches be read again when the input isn't seekable.
+    const bool memoryMapped = sourceVideo.isMemoryMapped();
+    loadFieldDataWith([&](qint32 fieldNumber, SourceVideo::Data &data) {
+                          if (memoryMapped) {
+                              sourceVideo.readVideoField(fieldNumber, data);
+                          } else {
+                              data = sourceVideo.getVideoField(fieldNumber);
+                          }
+                      },
+                      sourceVideo.getFieldLength(), ldDecodeMetaData.getVideoParameters(), fieldNumbers, fields);
+}
+
+void SourceField::loadFields(FieldPrefetcher &fieldPrefetcher, LdDecodeMetaData &ldDecodeMetaData,
+                             qint32 firstFrameNumber, qint32 numFrames,
+                             qint32 lookBehindFrames, qint32 lookAheadFrames,
+                             QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex)
+{
+    QVector<qint32> fieldNumbers;
+    loadFieldMetadata(ldDecodeMetaData, firstFrameNumber, numFrames, lookBehindFrames, lookAheadFrames,
+                      fields, fieldNumbers, startIndex, endIndex);
+
+    // Copy into the existing field buffers
+    loadFieldDataWith([&](qint32 fieldNumber, SourceVideo::Data &data) {
+                          fieldPrefetcher.readVideoField(fieldNumber, data);
+                      },
+                      fieldPrefetcher.getFieldLength(), ldDecodeMetaData.getVideoParameters(), fieldNumbers, fields);
+}
 
+void SourceField::loadFieldMetadata(LdDecodeMetaData &ldDecodeMetaData,
+                                    qint32 firstFrameNumber, qint32 numFrames,
+                                    qint32 lookBehindFrames, qint32 lookAheadFrames,
+                                    QVector<SourceField> &fields, QVector<qint32> &fieldNumbers,
+                                    qint32 &startIndex, qint32 &endIndex)
+{
     // Work out indexes.
     // fields will contain {lookbehind fields... [startIndex] real fields... [endIndex] lookahead fields...}.
     startIndex = 2 * lookBehindFrames;
     endIndex = startIndex + (2 * numFrames);
     fields.resize(endIndex + (2 * lookAheadFrames));
+    fieldNumbers.resize(fields.size());
 
     // Populate fields
     const qint32 numInputFrames = ldDecodeMetaData.getNumberOfFrames();
@@ -56,33 +132,18 @@ void SourceField::loadFields(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecod
         fields[i].field = ldDecodeMetaData.getField(firstFieldNumber);
         fields[i + 1].field = ldDecodeMetaData.getField(secondFieldNumber);
 
-        const quint16 black = videoParameters.black16bIre;
-
-        if (useBlankFrame) {
-            // Fill both fields with black
-            fields[i].data.fill(black, sourceVideo.getFieldLength());
-            fields[i + 1].data.fill(black, sourceVideo.getFieldLength());
-        } else {
-            // Fetch the input fields
-            fields[i].data = sourceVideo.getVideoField(firstFieldNumber);
-            fields[i + 1].data = sourceVideo.getVideoField(secondFieldNumber);
-
-            if ((videoParameters.system == PAL || videoParameters.system == PAL_M) && videoParameters.isSubcarrierLocked) {
-                // With subcarrier-locked 4fSC PAL sampling, we have four
-                // "extra" samples over the course of the frame, so the two
-                // fields will be horizontally misaligned by two samples. Shift
-                // the second field to the left to compensate.
-                //
-                // XXX This should be done elsewhere, as it affects other tools
-                // too.
-
-                fields[i + 1].data.remove(0, 2);
-                for (int j = 0; j < 2; j++) {
-                    fields[i + 1].data.append(black);
-                }
-            }
-        }
+        fieldNumbers[i] = useBlankFrame ? -1 : firstFieldNumber;
+        fieldNumbers[i + 1] = useBlankFrame ? -1 : secondFieldNumber;
 
         frameNumber++;
     }
 }
+
+void SourceField::loadFieldData(SourceVideo &sourceVideo, const LdDecodeMetaData::VideoParameters &videoParameters,
+                                const QVector<qint32> &fieldNumbers, QVector<SourceField> &fields)
+{
+    loadFieldDataWith([&](qint32 fieldNumber, SourceVideo::Data &data) {
+                          sourceVideo.readVideoField(fieldNumber, data);
+                      },
+                      sourceVideo.getFieldLength(), videoParameters, fieldNumbers, fields);
+}
@@ -25,6 +25,7 @@
 #ifndef SOURCEFIELD_H
 #define SOURCEFIELD_H
 
+#include "fieldprefetcher.h"
 #include "lddecodemetadata.h"
 #include "sourcevideo.h"
 
@@ -42,6 +43,27 @@ struct SourceField {
                            qint32 lookBehindFrames, qint32 lookAheadFrames,
                            QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex);
 
+    // As above, but reading through a FieldPrefetcher
+    static void loadFields(FieldPrefetcher &fieldPrefetcher, LdDecodeMetaData &ldDecodeMetaData,
+                           qint32 firstFrameNumber, qint32 numFrames,
+                           qint32 lookBehindFrames, qint32 lookAheadFrames,
+                           QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex);
+
+    // Fill in the metadata for a sequence of frames as loadFields does, without
+    // reading any data. fieldNumbers is set to the field number to read into
+    // each entry of fields, or -1 where the field should be black.
+    static void loadFieldMetadata(LdDecodeMetaData &ldDecodeMetaData,
+                                  qint32 firstFrameNumber, qint32 numFrames,
+                                  qint32 lookBehindFrames, qint32 lookAheadFrames,
+                                  QVector<SourceField> &fields, QVector<qint32> &fieldNumbers,
+                                  qint32 &startIndex, qint32 &endIndex);
+
+    // Read the data for fields set up by loadFieldMetadata. This reads with
+    // SourceVideo::readVideoField and doesn't use the metadata, so several
+    // threads may load fields from the same source at once.
+    static void loadFieldData(SourceVideo &sourceVideo, const LdDecodeMetaData::VideoParameters &videoParameters,
+                              const QVector<qint32> &fieldNumbers, QVector<SourceField> &fields);
+
     // Return the vertical offset of this field within the interlaced frame
     // (i.e. 0 for the top field, 1 for the bottom field).
     qint32 getOffset() const {
@@ -0,0 +1,353 @@
+/************************************************************************
+
+    testcomb.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "comb.h"
+#include "combkernels.h"
+#include "componentframe.h"
+#include "lddecodemetadata.h"
+#include "sourcefield.h"
+
+// The single-precision path must match the double-precision path to within
+// these limits, measured in 16-bit sample units over the active area:
+// the mean absolute difference must be below MAX_MEAN_ERROR, and no more than
+// MAX_OUTLIER_FRACTION of samples may differ by more than OUTLIER_ERROR.
+// (A few samples can differ by more, where a rounding difference changes one
+// of the adaptive filters' decisions.)
+static constexpr double MAX_MEAN_ERROR = 0.05;
+static constexpr double OUTLIER_ERROR = 1.0;
+static constexpr double MAX_OUTLIER_FRACTION = 0.001;
+
+// Simple deterministic pseudo-random numbers, so the test is repeatable
+static quint32 randomState = 12345;
+static double randomUnit()
+{
+    randomState = (randomState * 1103515245) + 12345;
+    return ((randomState >> 8) & 0xFFFF) / 65536.0;
+}
+
+static LdDecodeMetaData::VideoParameters makeVideoParameters()
+{
+    LdDecodeMetaData::VideoParameters videoParameters;
+    videoParameters.system = NTSC;
+    videoParameters.fSC = 315.0e6 / 88.0;
+    videoParameters.sampleRate = 4 * videoParameters.fSC;
+    videoParameters.fieldWidth = 910;
+    videoParameters.fieldHeight = 263;
+    videoParameters.colourBurstStart = 74;
+    videoParameters.colourBurstEnd = 110;
+    videoParameters.activeVideoStart = 134;
+    videoParameters.activeVideoEnd = 894;
+    videoParameters.white16bIre = 51200;
+    videoParameters.black16bIre = 15360;
+    videoParameters.firstActiveFieldLine = 20;
+    videoParameters.lastActiveFieldLine = 259;
+    videoParameters.firstActiveFrameLine = 40;
+    videoParameters.lastActiveFrameLine = 525;
+    videoParameters.isValid = true;
+    return videoParameters;
+}
+
+// Generate a field of composite video containing blocks of random colours,
+// with some noise
+static SourceField makeField(const LdDecodeMetaData::VideoParameters &videoParameters, qint32 fieldIndex)
+{
+    SourceField sourceField;
+    sourceField.field.seqNo = fieldIndex + 1;
+    sourceField.field.isFirstField = (fieldIndex % 2) == 0;
+    sourceField.field.fieldPhaseID = (fieldIndex % 4) + 1;
+
+    const double ire = (videoParameters.white16bIre - videoParameters.black16bIre) / 100.0;
+    sourceField.data.resize(videoParameters.fieldWidth * videoParameters.fieldHeight);
+
+    // Colours for 8x8 blocks of 16-line by 64-sample areas
+    double blockY[8][16], blockI[8][16], blockQ[8][16];
+    for (qint32 by = 0; by < 8; by++) {
+        for (qint32 bx = 0; bx < 16; bx++) {
+            blockY[by][bx] = (10 + (randomUnit() * 80)) * ire;
+            blockI[by][bx] = (randomUnit() - 0.5) * 40 * ire;
+            blockQ[by][bx] = (randomUnit() - 0.5) * 40 * ire;
+        }
+    }
+
+    for (qint32 line = 0; line < videoParameters.fieldHeight; line++) {
+        // The subcarrier phase inverts on every line, and every field
+        const double phase = (((line + fieldIndex) % 2) == 0) ? 0.0 : M_PI;
+
+        for (qint32 x = 0; x < videoParameters.fieldWidth; x++) {
+            const qint32 by = qMin((line / 16) % 8, 7);
+            const qint32 bx = (x / 64) % 16;
+            const double angle = (x * M_PI / 2) + phase;
+            const double value = videoParameters.black16bIre + blockY[by][bx]
+                                 + (blockI[by][bx] * sin(angle)) + (blockQ[by][bx] * cos(angle))
+                                 + ((randomUnit() - 0.5) * ire);
+            sourceField.data[(line * videoParameters.fieldWidth) + x] = static_cast<quint16>(qBound(0.0, value, 65535.0));
+        }
+    }
+
+    return sourceField;
+}
+
+// Check that the vectorised kernels match the scalar kernels
+static void testKernels()
+{
+    fprintf(stderr, "Testing kernels (AVX2 %s)\n", CombKernels::haveAVX2() ? "available" : "not available");
+
+    const qint32 width = 910;
+    std::vector<quint16> line(width);
+    std::vector<float> previousLine(width), currentLine(width), nextLine(width);
+    for (qint32 i = 0; i < width; i++) {
+        line[i] = static_cast<quint16>(randomUnit() * 65535);
+        previousLine[i] = static_cast<float>((randomUnit() - 0.5) * 4000);
+        currentLine[i] = static_cast<float>((randomUnit() - 0.5) * 4000);
+        nextLine[i] = (i < 300) ? -previousLine[i] : static_cast<float>((randomUnit() - 0.5) * 4000);
+    }
+
+    std::vector<float> outputA(width), outputB(width);
+
+    // Use an odd range, so the scalar tail is exercised
+    CombKernels::split1D(line.data(), outputA.data(), 3, width - 5);
+    CombKernels::split1DScalar(line.data(), outputB.data(), 3, width - 5);
+    for (qint32 i = 3; i < width - 5; i++) {
+        if (outputA[i] != outputB[i]) {
+            fprintf(stderr, "split1D mismatch at %d: %f != %f\n", i, outputA[i], outputB[i]);
+            exit(1);
+        }
+    }
+
+    const float kRange = 45 * 358.4f;
+    CombKernels::split2D(previousLine.data(), currentLine.data(), nextLine.data(), outputA.data(), 3, width - 5, kRange);
+    CombKernels::split2DScalar(previousLine.data(), currentLine.data(), nextLine.data(), outputB.data(), 3, width - 5, kRange);
+    for (qint32 i = 3; i < width - 5; i++) {
+        if (fabs(outputA[i] - outputB[i]) > 1.0e-3 * qMax(1.0f, fabsf(outputB[i]))) {
+            fprintf(stderr, "split2D mismatch at %d: %f != %f\n", i, outputA[i], outputB[i]);
+            exit(1);
+        }
+    }
+
+    // Eight 3D candidates, with a mix of offsets and viability
+    const qint32 irescale = 358;
+    std::vector<std::vector<quint16>> candidateLines(8, std::vector<quint16>(width));
+    std::vector<std::vector<float>> candidate1D(8, std::vector<float>(width)), candidate2D(8, std::vector<float>(width));
+    CombKernels::Candidate3D candidates[8];
+    for (qint32 c = 0; c < 8; c++) {
+        for (qint32 i = 0; i < width; i++) {
+            candidateLines[c][i] = static_cast<quint16>(qBound(0.0, line[i] + ((randomUnit() - 0.5) * 4000 * (c + 1)), 65535.0));
+            candidate1D[c][i] = static_cast<float>((randomUnit() - 0.5) * 4000);
+            candidate2D[c][i] = -currentLine[i] + static_cast<float>((randomUnit() - 0.5) * 500 * (c + 1));
+        }
+        candidates[c].line = candidateLines[c].data();
+        candidates[c].chroma1D = candidate1D[c].data();
+        candidates[c].chroma2D = candidate2D[c].data();
+        candidates[c].offset = (c == 0) ? -2 : (c == 1) ? 2 : 0;
+        candidates[c].adjustPenalty = -2.0f * (c / 2);
+        candidates[c].viable = (c != 3) && (c != 6);
+    }
+    CombKernels::split3D(line.data(), previousLine.data(), currentLine.data(), candidates, 8, 4,
+                         outputA.data(), 3, width - 5, irescale);
+    CombKernels::split3DScalar(line.data(), previousLine.data(), currentLine.data(), candidates, 8, 4,
+                               outputB.data(), 3, width - 5, irescale);
+    for (qint32 i = 3; i < width - 5; i++) {
+        if (outputA[i] != outputB[i]) {
+            fprintf(stderr, "split3D mismatch at %d: %f != %f\n", i, outputA[i], outputB[i]);
+            exit(1);
+        }
+    }
+
+    // Use each possible start phase for splitIQ
+    std::vector<double> yA(width), iA(width), qA(width), yB(width), iB(width), qB(width);
+    for (qint32 start = 4; start < 9; start++) {
+        for (bool invert: {false, true}) {
+            CombKernels::splitIQ(line.data(), currentLine.data(), invert, yA.data(), iA.data(), qA.data(), start, width - 5);
+            CombKernels::splitIQScalar(line.data(), currentLine.data(), invert, yB.data(), iB.data(), qB.data(), start, width - 5);
+            for (qint32 i = start; i < width - 5; i++) {
+                if (yA[i] != yB[i] || iA[i] != iB[i] || qA[i] != qB[i]) {
+                    fprintf(stderr, "splitIQ mismatch at %d (start %d)\n", i, start);
+                    exit(1);
+                }
+            }
+        }
+    }
+}
+
+// Compare one plane of two component frames
+static void comparePlane(const char *name, const LdDecodeMetaData::VideoParameters &videoParameters,
+                         const double *planeA, const double *planeB)
+{
+    double totalError = 0.0;
+    double maxError = 0.0;
+    qint32 outliers = 0;
+    qint32 count = 0;
+
+    for (qint32 y = videoParameters.firstActiveFrameLine; y < videoParameters.lastActiveFrameLine; y++) {
+        for (qint32 x = videoParameters.activeVideoStart; x < videoParameters.activeVideoEnd; x++) {
+            const qint32 i = (y * videoParameters.fieldWidth) + x;
+            const double error = fabs(planeA[i] - planeB[i]);
+            totalError += error;
+            maxError = qMax(maxError, error);
+            if (error > OUTLIER_ERROR) outliers++;
+            count++;
+        }
+    }
+
+    const double meanError = totalError / count;
+    const double outlierFraction = static_cast<double>(outliers) / count;
+    fprintf(stderr, "  %s: mean error %g, max error %g, outliers %d/%d\n", name, meanError, maxError, outliers, count);
+
+    if (meanError > MAX_MEAN_ERROR || outlierFraction > MAX_OUTLIER_FRACTION) {
+        fprintf(stderr, "Single-precision output for %s is outside tolerance\n", name);
+        exit(1);
+    }
+}
+
+// Decode the same input with and without singlePrecision, and compare the results
+static void testDecoder(qint32 dimensions, bool phaseCompensation)
+{
+    fprintf(stderr, "Testing %dD decoder%s\n", dimensions, phaseCompensation ? " with phase compensation" : "");
+
+    const LdDecodeMetaData::VideoParameters videoParameters = makeVideoParameters();
+
+    // Three frames, with one frame of lookbehind and lookahead
+    QVector<SourceField> inputFields;
+    for (qint32 i = 0; i < 10; i++) {
+        inputFields.append(makeField(videoParameters, i));
+    }
+    const qint32 startIndex = 2;
+    const qint32 endIndex = 8;
+
+    QVector<ComponentFrame> framesDouble, framesFloat;
+    for (bool singlePrecision: {false, true}) {
+        Comb::Configuration configuration;
+        configuration.dimensions = dimensions;
+        configuration.phaseCompensation = phaseCompensation;
+        configuration.cNRLevel = 1.0;
+        configuration.singlePrecision = singlePrecision;
+
+        Comb comb;
+        comb.updateConfiguration(videoParameters, configuration);
+
+        QVector<ComponentFrame> &frames = singlePrecision ? framesFloat : framesDouble;
+        frames.resize((endIndex - startIndex) / 2);
+        comb.decodeFrames(inputFields, startIndex, endIndex, frames);
+    }
+
+    for (qint32 i = 0; i < framesDouble.size(); i++) {
+        comparePlane("Y", videoParameters, framesDouble[i].y(0), framesFloat[i].y(0));
+        comparePlane("U", videoParameters, framesDouble[i].u(0), framesFloat[i].u(0));
+        comparePlane("V", videoParameters, framesDouble[i].v(0), framesFloat[i].v(0));
+    }
+}
+
+// Decode the same input in one call, and in two contiguous calls to the same
+// Comb (which can reuse frames from the first call), and check the results are
+// identical and the expected frames were reused
+static void testReuse(qint32 dimensions)
+{
+    fprintf(stderr, "Testing %dD decoder with contiguous batches\n", dimensions);
+
+    const LdDecodeMetaData::VideoParameters videoParameters = makeVideoParameters();
+
+    // Four frames, with one frame of lookbehind and lookahead
+    QVector<SourceField> inputFields;
+    for (qint32 i = 0; i < 12; i++) {
+        inputFields.append(makeField(videoParameters, i));
+    }
+
+    Comb::Configuration configuration;
+    configuration.dimensions = dimensions;
+
+    QVector<ComponentFrame> framesSingle(4);
+    {
+        Comb comb;
+        comb.updateConfiguration(videoParameters, configuration);
+        comb.decodeFrames(inputFields, 2, 10, framesSingle);
+    }
+
+    QVector<ComponentFrame> framesBatched;
+    {
+        Comb comb;
+        comb.updateConfiguration(videoParameters, configuration);
+        for (qint32 batch = 0; batch < 2; batch++) {
+            QVector<ComponentFrame> frames(2);
+            comb.decodeFrames(inputFields.mid(batch * 4, 8), 2, 6, frames);
+            framesBatched.append(frames);
+        }
+
+        // In 3D mode, the second batch's look-behind and first frames are the
+        // first batch's last and look-ahead frames, so both can be reused
+        const qint64 expectedLeading = (dimensions == 3) ? 4 : 2;
+        const qint64 expectedReused = (dimensions == 3) ? 2 : 0;
+        if (comb.getLeadingFrames() != expectedLeading || comb.getReusedFrames() != expectedReused) {
+            fprintf(stderr, "Reused %lld of %lld leading frames, expected %lld of %lld\n",
+                    static_cast<long long>(comb.getReusedFrames()), static_cast<long long>(comb.getLeadingFrames()),
+                    static_cast<long long>(expectedReused), static_cast<long long>(expectedLeading));
+            exit(1);
+        }
+    }
+
+    // If the batches aren't in order (as when other threads have decoded
+    // the batches in between), nothing can be reused
+    {
+        Comb comb;
+        comb.updateConfiguration(videoParameters, configuration);
+        for (qint32 batch = 1; batch >= 0; batch--) {
+            QVector<ComponentFrame> frames(2);
+            comb.decodeFrames(inputFields.mid(batch * 4, 8), 2, 6, frames);
+        }
+        if (comb.getReusedFrames() != 0) {
+            fprintf(stderr, "Reused %lld frames from a non-contiguous batch\n", static_cast<long long>(comb.getReusedFrames()));
+            exit(1);
+        }
+    }
+
+    for (qint32 i = 0; i < framesSingle.size(); i++) {
+        const qint32 size = videoParameters.fieldWidth * framesSingle[i].getHeight();
+        if (!std::equal(framesSingle[i].y(0), framesSingle[i].y(0) + size, framesBatched[i].y(0))
+            || !std::equal(framesSingle[i].u(0), framesSingle[i].u(0) + size, framesBatched[i].u(0))
+            || !std::equal(framesSingle[i].v(0), framesSingle[i].v(0) + size, framesBatched[i].v(0))) {
+            fprintf(stderr, "Frame %d differs when decoded in batches\n", i);
+            exit(1);
+        }
+    }
+}
+
+int main()
+{
+    testKernels();
+
+    testDecoder(1, false);
+    testDecoder(2, false);
+    testDecoder(2, true);
+    testDecoder(3, false);
+
+    testReuse(2);
+    testReuse(3);
+
+    return 0;
+}
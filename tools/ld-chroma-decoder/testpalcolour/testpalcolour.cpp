@@ -0,0 +1,289 @@
+/************************************************************************
+
+    testpalcolour.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "componentframe.h"
+#include "lddecodemetadata.h"
+#include "palcolour.h"
+#include "palkernels.h"
+#include "sourcefield.h"
+
+// The single-precision path must match the double-precision path to within
+// these limits, measured in 16-bit sample units over the active area
+static constexpr double MAX_MEAN_ERROR = 0.05;
+static constexpr double MAX_ERROR = 1.0;
+
+// Simple deterministic pseudo-random numbers, so the test is repeatable
+static quint32 randomState = 12345;
+static double randomUnit()
+{
+    randomState = (randomState * 1103515245) + 12345;
+    return ((randomState >> 8) & 0xFFFF) / 65536.0;
+}
+
+static const char *isaName(PalKernels::Isa isa)
+{
+    switch (isa) {
+    case PalKernels::scalarIsa:
+        return "scalar";
+    case PalKernels::avx2Isa:
+        return "AVX2";
+    case PalKernels::avx512Isa:
+        return "AVX-512";
+    }
+    return "unknown";
+}
+
+// Run prepare and filter for one instruction set, returning the six outputs
+template <typename T>
+static std::vector<std::vector<double>> runKernels(const std::vector<std::vector<quint16>> &lines,
+                                                   const std::vector<double> &sine, const std::vector<double> &cosine,
+                                                   const PalKernels::Coefficients<T> &coefficients,
+                                                   qint32 start, qint32 end, PalKernels::Isa isa)
+{
+    const qint32 width = static_cast<qint32>(sine.size());
+    const quint16 *const in[7] = {
+        lines[0].data(), lines[1].data(), lines[2].data(), lines[3].data(),
+        lines[4].data(), lines[5].data(), lines[6].data()
+    };
+
+    std::vector<std::vector<T>> mData(4, std::vector<T>(width)), nData(4, std::vector<T>(width));
+    T *const m[4] = {mData[0].data(), mData[1].data(), mData[2].data(), mData[3].data()};
+    T *const n[4] = {nData[0].data(), nData[1].data(), nData[2].data(), nData[3].data()};
+    PalKernels::prepare(in, sine.data(), cosine.data(), m, n,
+                        start - PalKernels::FILTER_SIZE, end + PalKernels::FILTER_SIZE + 1, isa);
+
+    std::vector<std::vector<double>> outputs(6, std::vector<double>(width));
+    PalKernels::filter(m, n, coefficients,
+                       outputs[0].data(), outputs[1].data(), outputs[2].data(),
+                       outputs[3].data(), outputs[4].data(), outputs[5].data(),
+                       start, end, isa);
+    return outputs;
+}
+
+// Check that the vectorised kernels match the scalar kernels: exactly in
+// double precision, and to within rounding in single precision
+static void testKernels()
+{
+    const PalKernels::Isa bestIsa = PalKernels::getBestIsa();
+    fprintf(stderr, "Testing kernels (best available: %s)\n", isaName(bestIsa));
+
+    const qint32 width = 1135;
+    std::vector<std::vector<quint16>> lines(7, std::vector<quint16>(width));
+    for (auto &line: lines) {
+        for (qint32 i = 0; i < width; i++) {
+            line[i] = static_cast<quint16>(randomUnit() * 65535);
+        }
+    }
+
+    std::vector<double> sine(width), cosine(width);
+    for (qint32 i = 0; i < width; i++) {
+        sine[i] = sin(i * M_PI / 2.0);
+        cosine[i] = cos(i * M_PI / 2.0);
+    }
+
+    PalKernels::Coefficients<double> coefficients;
+    PalKernels::Coefficients<float> coefficientsFloat;
+    for (qint32 f = 0; f <= PalKernels::FILTER_SIZE; f++) {
+        for (qint32 i = 0; i < 4; i++) {
+            coefficients.cfilt[f][i] = randomUnit() / 32.0;
+            coefficientsFloat.cfilt[f][i] = static_cast<float>(coefficients.cfilt[f][i]);
+        }
+        for (qint32 i = 0; i < 2; i++) {
+            coefficients.yfilt[f][i] = randomUnit() / 32.0;
+            coefficientsFloat.yfilt[f][i] = static_cast<float>(coefficients.yfilt[f][i]);
+        }
+    }
+
+    // Use an odd range, so the scalar tail is exercised
+    const qint32 start = PalKernels::FILTER_SIZE + 3;
+    const qint32 end = width - PalKernels::FILTER_SIZE - 8;
+
+    const auto reference = runKernels(lines, sine, cosine, coefficients, start, end, PalKernels::scalarIsa);
+    const auto referenceFloat = runKernels(lines, sine, cosine, coefficientsFloat, start, end, PalKernels::scalarIsa);
+
+    for (qint32 isa = PalKernels::avx2Isa; isa <= bestIsa; isa++) {
+        const auto outputs = runKernels(lines, sine, cosine, coefficients, start, end,
+                                        static_cast<PalKernels::Isa>(isa));
+        const auto outputsFloat = runKernels(lines, sine, cosine, coefficientsFloat, start, end,
+                                             static_cast<PalKernels::Isa>(isa));
+
+        for (qint32 j = 0; j < 6; j++) {
+            for (qint32 i = start; i < end; i++) {
+                if (outputs[j][i] != reference[j][i]) {
+                    fprintf(stderr, "%s double output %d mismatch at %d: %f != %f\n",
+                            isaName(static_cast<PalKernels::Isa>(isa)), j, i, outputs[j][i], reference[j][i]);
+                    exit(1);
+                }
+                if (fabs(outputsFloat[j][i] - referenceFloat[j][i]) > 1.0e-3 * qMax(1.0, fabs(referenceFloat[j][i]))) {
+                    fprintf(stderr, "%s float output %d mismatch at %d: %f != %f\n",
+                            isaName(static_cast<PalKernels::Isa>(isa)), j, i, outputsFloat[j][i], referenceFloat[j][i]);
+                    exit(1);
+                }
+            }
+        }
+    }
+}
+
+static LdDecodeMetaData::VideoParameters makeVideoParameters()
+{
+    LdDecodeMetaData::VideoParameters videoParameters;
+    videoParameters.system = PAL;
+    videoParameters.fSC = 4433618.75;
+    videoParameters.sampleRate = 4 * videoParameters.fSC;
+    videoParameters.fieldWidth = 1135;
+    videoParameters.fieldHeight = 313;
+    videoParameters.colourBurstStart = 98;
+    videoParameters.colourBurstEnd = 138;
+    videoParameters.activeVideoStart = 185;
+    videoParameters.activeVideoEnd = 1107;
+    videoParameters.white16bIre = 54016;
+    videoParameters.black16bIre = 16384;
+    videoParameters.firstActiveFieldLine = 22;
+    videoParameters.lastActiveFieldLine = 308;
+    videoParameters.firstActiveFrameLine = 44;
+    videoParameters.lastActiveFrameLine = 620;
+    videoParameters.isValid = true;
+    return videoParameters;
+}
+
+// Generate a field of PAL composite video containing blocks of random
+// colours, with a colour burst and some noise
+static SourceField makeField(const LdDecodeMetaData::VideoParameters &videoParameters, qint32 fieldIndex)
+{
+    SourceField sourceField;
+    sourceField.field.seqNo = fieldIndex + 1;
+    sourceField.field.isFirstField = (fieldIndex % 2) == 0;
+    sourceField.field.fieldPhaseID = (fieldIndex % 8) + 1;
+
+    const double ire = (videoParameters.white16bIre - videoParameters.black16bIre) / 100.0;
+    sourceField.data.resize(videoParameters.fieldWidth * videoParameters.fieldHeight);
+
+    // Colours for 8x8 blocks of 16-line by 64-sample areas
+    double blockY[8][16], blockU[8][16], blockV[8][16];
+    for (qint32 by = 0; by < 8; by++) {
+        for (qint32 bx = 0; bx < 16; bx++) {
+            blockY[by][bx] = (10 + (randomUnit() * 80)) * ire;
+            blockU[by][bx] = (randomUnit() - 0.5) * 40 * ire;
+            blockV[by][bx] = (randomUnit() - 0.5) * 40 * ire;
+        }
+    }
+
+    for (qint32 line = 0; line < videoParameters.fieldHeight; line++) {
+        // The subcarrier advances by roughly 3/4 of a cycle per line, and
+        // the V component inverts on every line
+        const double linePhase = (line + (fieldIndex * videoParameters.fieldHeight)) * 3 * M_PI / 2;
+        const double vSwitch = (((line + fieldIndex) % 2) == 0) ? 1.0 : -1.0;
+
+        for (qint32 x = 0; x < videoParameters.fieldWidth; x++) {
+            const double angle = (x * M_PI / 2) + linePhase;
+            double value = videoParameters.black16bIre + ((randomUnit() - 0.5) * ire);
+
+            if (x >= videoParameters.colourBurstStart && x < videoParameters.colourBurstEnd) {
+                // Burst at 180 +/- 45 degrees
+                value += 20 * ire * sin(angle + M_PI + (vSwitch * M_PI / 4));
+            } else if (x >= videoParameters.activeVideoStart && x < videoParameters.activeVideoEnd) {
+                const qint32 by = (line / 16) % 8;
+                const qint32 bx = (x / 64) % 16;
+                value += blockY[by][bx] + (blockU[by][bx] * sin(angle)) + (vSwitch * blockV[by][bx] * cos(angle));
+            }
+
+            sourceField.data[(line * videoParameters.fieldWidth) + x] = static_cast<quint16>(qBound(0.0, value, 65535.0));
+        }
+    }
+
+    return sourceField;
+}
+
+// Compare one plane of two component frames
+static void comparePlane(const char *name, const LdDecodeMetaData::VideoParameters &videoParameters,
+                         const double *planeA, const double *planeB)
+{
+    double totalError = 0.0;
+    double maxError = 0.0;
+    qint32 count = 0;
+
+    for (qint32 y = videoParameters.firstActiveFrameLine; y < videoParameters.lastActiveFrameLine; y++) {
+        for (qint32 x = videoParameters.activeVideoStart; x < videoParameters.activeVideoEnd; x++) {
+            const qint32 i = (y * videoParameters.fieldWidth) + x;
+            const double error = fabs(planeA[i] - planeB[i]);
+            totalError += error;
+            maxError = qMax(maxError, error);
+            count++;
+        }
+    }
+
+    const double meanError = totalError / count;
+    fprintf(stderr, "  %s: mean error %g, max error %g\n", name, meanError, maxError);
+
+    if (meanError > MAX_MEAN_ERROR || maxError > MAX_ERROR) {
+        fprintf(stderr, "Single-precision output for %s is outside tolerance\n", name);
+        exit(1);
+    }
+}
+
+// Decode the same input with and without palColourSinglePrecision, and
+// compare the results
+static void testDecoder()
+{
+    fprintf(stderr, "Testing PALcolour decoder\n");
+
+    const LdDecodeMetaData::VideoParameters videoParameters = makeVideoParameters();
+
+    QVector<SourceField> inputFields;
+    for (qint32 i = 0; i < 4; i++) {
+        inputFields.append(makeField(videoParameters, i));
+    }
+
+    QVector<ComponentFrame> framesDouble, framesFloat;
+    for (bool singlePrecision: {false, true}) {
+        PalColour::Configuration configuration;
+        configuration.palColourSinglePrecision = singlePrecision;
+
+        PalColour palColour;
+        palColour.updateConfiguration(videoParameters, configuration);
+
+        QVector<ComponentFrame> &frames = singlePrecision ? framesFloat : framesDouble;
+        frames.resize(inputFields.size() / 2);
+        palColour.decodeFrames(inputFields, 0, inputFields.size(), frames);
+    }
+
+    for (qint32 i = 0; i < framesDouble.size(); i++) {
+        comparePlane("Y", videoParameters, framesDouble[i].y(0), framesFloat[i].y(0));
+        comparePlane("U", videoParameters, framesDouble[i].u(0), framesFloat[i].u(0));
+        comparePlane("V", videoParameters, framesDouble[i].v(0), framesFloat[i].v(0));
+    }
+}
+
+int main()
+{
+    testKernels();
+    testDecoder();
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+/************************************************************************
+
+    testscratcharena.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "scratcharena.h"
+
+// Check that a pointer is suitably aligned
+static void checkAligned(const void *pointer)
+{
+    if ((reinterpret_cast<std::uintptr_t>(pointer) % ScratchArena::ALIGNMENT) != 0) {
+        fprintf(stderr, "Allocation %p is not aligned\n", pointer);
+        exit(1);
+    }
+}
+
+// Check that space is reused once a Scope ends
+static void testScopes()
+{
+    fprintf(stderr, "Testing scopes\n");
+
+    ScratchArena arena;
+
+    double *first, *second;
+    {
+        ScratchArena::Scope scope(arena);
+        first = arena.allocate<double>(1000);
+        checkAligned(first);
+
+        {
+            ScratchArena::Scope innerScope(arena);
+            second = arena.allocate<double>(3);
+            checkAligned(second);
+            if (second < first + 1000) {
+                fprintf(stderr, "Allocations overlap\n");
+                exit(1);
+            }
+
+            // Unaligned sizes must still give aligned allocations
+            checkAligned(arena.allocate<double>(5));
+        }
+
+        // The inner scope's space should be reused
+        {
+            ScratchArena::Scope innerScope(arena);
+            if (arena.allocate<double>(3) != second) {
+                fprintf(stderr, "Space was not reused after the inner scope ended\n");
+                exit(1);
+            }
+        }
+    }
+
+    {
+        ScratchArena::Scope scope(arena);
+        if (arena.allocate<double>(1000) != first) {
+            fprintf(stderr, "Space was not reused after the scope ended\n");
+            exit(1);
+        }
+    }
+
+    if (arena.getHeapAllocations() != 1) {
+        fprintf(stderr, "Expected 1 heap allocation, got %lld\n", static_cast<long long>(arena.getHeapAllocations()));
+        exit(1);
+    }
+}
+
+// Check that the arena grows when it needs to, then stops allocating
+static void testGrowth()
+{
+    fprintf(stderr, "Testing growth\n");
+
+    ScratchArena arena;
+
+    // Simulate a decoder that needs several large buffers for each frame
+    qint64 allocationsAfterFirstFrame = 0;
+    for (qint32 frame = 0; frame < 10; frame++) {
+        {
+            ScratchArena::Scope scope(arena);
+
+            for (qint32 i = 0; i < 6; i++) {
+                const qint32 size = 400000 + (i * 1000);
+                quint16 *buffer = arena.allocate<quint16>(size);
+                checkAligned(buffer);
+
+                // Write to the whole buffer, so overruns are likely to be caught
+                for (qint32 j = 0; j < size; j++) {
+                    buffer[j] = static_cast<quint16>(j);
+                }
+            }
+        }
+
+        // After the first frame, the blocks should have been combined into
+        // one that's big enough, so no more allocations are needed
+        if (frame == 0) {
+            allocationsAfterFirstFrame = arena.getHeapAllocations();
+        } else if (arena.getHeapAllocations() != allocationsAfterFirstFrame) {
+            fprintf(stderr, "Arena allocated from the heap after the first frame\n");
+            exit(1);
+        }
+    }
+
+    fprintf(stderr, "  %lld heap allocations, capacity %lld bytes\n",
+            static_cast<long long>(arena.getHeapAllocations()), static_cast<long long>(arena.getCapacity()));
+}
+
+int main()
+{
+    testScopes();
+    testGrowth();
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+/************************************************************************
+
+    testtransformpal3d.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "lddecodemetadata.h"
+#include "scratcharena.h"
+#include "sourcefield.h"
+#include "transformpal3d.h"
+
+// The batched double-precision output must match the tile-by-tile output to
+// within MAX_DOUBLE_ERROR. The single-precision output must match it to
+// within these limits, measured in 16-bit sample units over the active area:
+// the mean absolute difference must be below MAX_MEAN_ERROR, and no more than
+// MAX_OUTLIER_FRACTION of samples may differ by more than OUTLIER_ERROR.
+// (A few samples can differ by more, where a rounding difference changes
+// whether the filter keeps a frequency bin.)
+static constexpr double MAX_DOUBLE_ERROR = 1.0e-6;
+static constexpr double MAX_MEAN_ERROR = 0.05;
+static constexpr double OUTLIER_ERROR = 1.0;
+static constexpr double MAX_OUTLIER_FRACTION = 0.001;
+
+// Simple deterministic pseudo-random numbers, so the test is repeatable
+static quint32 randomState = 12345;
+static double randomUnit()
+{
+    randomState = (randomState * 1103515245) + 12345;
+    return ((randomState >> 8) & 0xFFFF) / 65536.0;
+}
+
+// TransformPal3D, with the original tile-by-tile filterFields as a reference
+class ReferenceTransformPal3D : public TransformPal3D {
+public:
+    void filterFieldsPerTile(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
+                             QVector<const double *> &outputFields, ScratchArena &scratchArena)
+    {
+        allocateChromaBuffers(outputFields, scratchArena);
+
+        for (qint32 tileZ = startIndex - HALFZTILE; tileZ < endIndex; tileZ += HALFZTILE) {
+            for (qint32 tileY = videoParameters.firstActiveFrameLine - HALFYTILE; tileY < videoParameters.lastActiveFrameLine; tileY += HALFYTILE) {
+                for (qint32 tileX = videoParameters.activeVideoStart - HALFXTILE; tileX < videoParameters.activeVideoEnd; tileX += HALFXTILE) {
+                    forwardFFTTile(tileX, tileY, tileZ, inputFields);
+                    applyFilter();
+                    inverseFFTTile(tileX, tileY, tileZ, startIndex, endIndex);
+                }
+            }
+        }
+    }
+};
+
+static LdDecodeMetaData::VideoParameters makeVideoParameters()
+{
+    LdDecodeMetaData::VideoParameters videoParameters;
+    videoParameters.system = PAL;
+    videoParameters.fSC = 4433618.75;
+    videoParameters.sampleRate = 4 * videoParameters.fSC;
+    videoParameters.fieldWidth = 1135;
+    videoParameters.fieldHeight = 313;
+    videoParameters.colourBurstStart = 98;
+    videoParameters.colourBurstEnd = 138;
+    videoParameters.activeVideoStart = 185;
+    videoParameters.activeVideoEnd = 1107;
+    videoParameters.white16bIre = 54016;
+    videoParameters.black16bIre = 16384;
+    videoParameters.firstActiveFieldLine = 22;
+    videoParameters.lastActiveFieldLine = 308;
+    videoParameters.firstActiveFrameLine = 44;
+    videoParameters.lastActiveFrameLine = 620;
+    videoParameters.isValid = true;
+    return videoParameters;
+}
+
+// Generate a field of PAL composite video containing blocks of random
+// colours, which move from field to field, with some noise
+static SourceField makeField(const LdDecodeMetaData::VideoParameters &videoParameters, qint32 fieldIndex)
+{
+    SourceField sourceField;
+    sourceField.field.seqNo = fieldIndex + 1;
+    sourceField.field.isFirstField = (fieldIndex % 2) == 0;
+    sourceField.field.fieldPhaseID = (fieldIndex % 8) + 1;
+
+    const double ire = (videoParameters.white16bIre - videoParameters.black16bIre) / 100.0;
+    sourceField.data.resize(videoParameters.fieldWidth * videoParameters.fieldHeight);
+
+    // Colours for 8x8 blocks of 16-line by 64-sample areas
+    double blockY[8][16], blockU[8][16], blockV[8][16];
+    for (qint32 by = 0; by < 8; by++) {
+        for (qint32 bx = 0; bx < 16; bx++) {
+            blockY[by][bx] = (10 + (randomUnit() * 80)) * ire;
+            blockU[by][bx] = (randomUnit() - 0.5) * 40 * ire;
+            blockV[by][bx] = (randomUnit() - 0.5) * 40 * ire;
+        }
+    }
+
+    for (qint32 line = 0; line < videoParameters.fieldHeight; line++) {
+        // The subcarrier advances by roughly 3/4 of a cycle per line, and
+        // the V component inverts on every line
+        const double linePhase = (line + (fieldIndex * videoParameters.fieldHeight)) * 3 * M_PI / 2;
+        const double vSwitch = (((line + fieldIndex) % 2) == 0) ? 1.0 : -1.0;
+
+        for (qint32 x = 0; x < videoParameters.fieldWidth; x++) {
+            const double angle = (x * M_PI / 2) + linePhase;
+            double value = videoParameters.black16bIre + ((randomUnit() - 0.5) * ire);
+
+            if (x >= videoParameters.activeVideoStart && x < videoParameters.activeVideoEnd) {
+                const qint32 by = (line / 16) % 8;
+                const qint32 bx = ((x + (fieldIndex * 4)) / 64) % 16;
+                value += blockY[by][bx] + (blockU[by][bx] * sin(angle)) + (vSwitch * blockV[by][bx] * cos(angle));
+            }
+
+            sourceField.data[(line * videoParameters.fieldWidth) + x] = static_cast<quint16>(qBound(0.0, value, 65535.0));
+        }
+    }
+
+    return sourceField;
+}
+
+// Compare two sets of chroma fields over the active area, and fail if the
+// mean error is above maxMeanError, or more than maxOutlierFraction of the
+// samples differ by more than outlierError
+static void compareFields(const char *name, const LdDecodeMetaData::VideoParameters &videoParameters,
+                          const QVector<const double *> &fieldsA, const QVector<const double *> &fieldsB,
+                          double maxMeanError, double outlierError, double maxOutlierFraction)
+{
+    double totalError = 0.0;
+    double worstError = 0.0;
+    qint64 outliers = 0;
+    qint64 count = 0;
+
+    for (qint32 i = 0; i < fieldsA.size(); i++) {
+        for (qint32 y = videoParameters.firstActiveFieldLine; y < videoParameters.lastActiveFieldLine; y++) {
+            for (qint32 x = videoParameters.activeVideoStart; x < videoParameters.activeVideoEnd; x++) {
+                const qint32 j = (y * videoParameters.fieldWidth) + x;
+                const double error = fabs(fieldsA[i][j] - fieldsB[i][j]);
+                totalError += error;
+                worstError = qMax(worstError, error);
+                if (error > outlierError) outliers++;
+                count++;
+            }
+        }
+    }
+
+    const double meanError = totalError / count;
+    const double outlierFraction = static_cast<double>(outliers) / count;
+    fprintf(stderr, "  %s: mean error %g, max error %g, outliers %lld/%lld\n", name, meanError, worstError,
+            static_cast<long long>(outliers), static_cast<long long>(count));
+
+    if (meanError > maxMeanError || outlierFraction > maxOutlierFraction) {
+        fprintf(stderr, "%s output is outside tolerance\n", name);
+        exit(1);
+    }
+}
+
+// Filter the same fields tile by tile, in batches (with one and several
+// threads), and in single precision, and compare the results
+static void testFilter()
+{
+    fprintf(stderr, "Testing TransformPal3D\n");
+
+    const LdDecodeMetaData::VideoParameters videoParameters = makeVideoParameters();
+
+    // Two frames, with enough fields either side for the Z tiles
+    const qint32 lookBehind = TransformPal3D::getLookBehind() * 2;
+    const qint32 lookAhead = TransformPal3D::getLookAhead() * 2;
+    QVector<SourceField> inputFields;
+    for (qint32 i = 0; i < lookBehind + 4 + lookAhead; i++) {
+        inputFields.append(makeField(videoParameters, i));
+    }
+    const qint32 startIndex = lookBehind;
+    const qint32 endIndex = lookBehind + 4;
+
+    const double threshold = 0.4;
+    const QVector<double> thresholds;
+    ScratchArena scratchArena;
+    ScratchArena::Scope scope(scratchArena);
+
+    ReferenceTransformPal3D reference;
+    reference.updateConfiguration(videoParameters, threshold, thresholds);
+    QVector<const double *> referenceFields(endIndex - startIndex);
+    reference.filterFieldsPerTile(inputFields, startIndex, endIndex, referenceFields, scratchArena);
+
+    TransformPal3D batched(false, 1);
+    batched.updateConfiguration(videoParameters, threshold, thresholds);
+    QVector<const double *> batchedFields(endIndex - startIndex);
+    batched.filterFields(inputFields, startIndex, endIndex, batchedFields, scratchArena);
+    compareFields("Batched", videoParameters, referenceFields, batchedFields, MAX_DOUBLE_ERROR, MAX_DOUBLE_ERROR, 0.0);
+
+    TransformPal3D threaded(false, 3);
+    threaded.updateConfiguration(videoParameters, threshold, thresholds);
+    QVector<const double *> threadedFields(endIndex - startIndex);
+    threaded.filterFields(inputFields, startIndex, endIndex, threadedFields, scratchArena);
+    compareFields("Threaded", videoParameters, referenceFields, threadedFields, MAX_DOUBLE_ERROR, MAX_DOUBLE_ERROR, 0.0);
+
+    if (!TransformPal3D::isSinglePrecisionAvailable()) {
+        fprintf(stderr, "Single-precision FFTW not available, skipping\n");
+        return;
+    }
+
+    TransformPal3D singlePrecision(true, 1);
+    singlePrecision.updateConfiguration(videoParameters, threshold, thresholds);
+    QVector<const double *> singleFields(endIndex - startIndex);
+    singlePrecision.filterFields(inputFields, startIndex, endIndex, singleFields, scratchArena);
+    compareFields("Single-precision", videoParameters, referenceFields, singleFields, MAX_MEAN_ERROR, OUTLIER_ERROR, MAX_OUTLIER_FRACTION);
+}
+
+int main()
+{
+    testFilter();
+
+    return 0;
+}
@@ -27,11 +27,43 @@
 
 #include "transformpal.h"
 
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
-TransformPal::TransformPal(qint32 _xComplex, qint32 _yComplex, qint32 _zComplex)
-    : xComplex(_xComplex), yComplex(_yComplex), zComplex(_zComplex), configurationSet(false)
+// The thread pool used by runParallel, shared by all TransformPal instances
+static QThreadPool &getThreadPool()
+{
+    static QThreadPool threadPool;
+    return threadPool;
+}
+
+// A QRunnable that calls a function
+class FunctionRunnable : public QRunnable
+{
+public:
+    explicit FunctionRunnable(std::function<void()> _function)
+        : function(std::move(_function))
+    {
+    }
+
+    void run() override
+    {
+        function();
+    }
+
+private:
+    std::function<void()> function;
+};
+
+TransformPal::TransformPal(qint32 _xComplex, qint32 _yComplex, qint32 _zComplex, qint32 _threads)
+    : threads(qMax(_threads, 1)), xComplex(_xComplex), yComplex(_yComplex), zComplex(_zComplex),
+      configurationSet(false)
 {
 }
 
@@ -63,6 +95,19 @@ void TransformPal::updateConfiguration(const LdDecodeMetaData::VideoParameters &
     configurationSet = true;
 }
 
+void TransformPal::allocateChromaBuffers(QVector<const double *> &outputFields, ScratchArena &scratchArena)
+{
+    const qint32 fieldSize = videoParameters.fieldWidth * videoParameters.fieldHeight;
+    double *buffers = scratchArena.allocate<double>(static_cast<qint64>(fieldSize) * outputFields.size());
+    std::fill_n(buffers, static_cast<qint64>(fieldSize) * outputFields.size(), 0.0);
+
+    chromaBuf.resize(outputFields.size());
+    for (qint32 i = 0; i < chromaBuf.size(); i++) {
+        chromaBuf[i] = buffers + (static_cast<qint64>(i) * fieldSize);
+        outputFields[i] = chromaBuf[i];
+    }
+}
+
 void TransformPal::overlayFFT(qint32 positionX, qint32 positionY,
                               const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                               QVector<ComponentFrame> &componentFrames)
@@ -117,3 +162,32 @@ void TransformPal::overlayFFTArrays(const fftw_complex *fftIn, const fftw_comple
         }
     }
 }
+
+void TransformPal::runParallel(qint32 numItems, const std::function<void(qint32, qint32)> &task)
+{
+    // Each worker takes the next unprocessed item until there are none left
+    QAtomicInt nextItem(0);
+    auto runWorker = [&](qint32 worker) {
+        while (true) {
+            const qint32 item = nextItem.fetchAndAddRelaxed(1);
+            if (item >= numItems) break;
+            task(worker, item);
+        }
+    };
+
+    // Start workers 1 onwards in the thread pool.
+    // The calling thread is worker 0; since it also processes items, the work
+    // completes even if the pool is busy with other callers' items.
+    const qint32 poolWorkers = qMin(threads, numItems) - 1;
+    QSemaphore finished;
+    for (qint32 worker = 1; worker <= poolWorkers; worker++) {
+        getThreadPool().start(new FunctionRunnable([&runWorker, &finished, worker] {
+            runWorker(worker);
+            finished.release();
+        }));
+    }
+    runWorker(0);
+
+    // Wait for the pool workers to finish
+    finished.acquire(qMax(poolWorkers, 0));
+}
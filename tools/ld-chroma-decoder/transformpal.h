@@ -30,18 +30,21 @@
 
 #include <QVector>
 #include <fftw3.h>
+#include <functional>
 
 #include "lddecodemetadata.h"
 
 #include "componentframe.h"
 #include "framecanvas.h"
 #include "outputwriter.h"
+#include "scratcharena.h"
 #include "sourcefield.h"
 
 // Abstract base class for Transform PAL filters.
 class TransformPal {
 public:
-    TransformPal(qint32 xComplex, qint32 yComplex, qint32 zComplex);
+    // threads is the number of threads to use within filterFields.
+    TransformPal(qint32 xComplex, qint32 yComplex, qint32 zComplex, qint32 threads);
     virtual ~TransformPal();
 
     // Configure TransformPal.
@@ -49,16 +52,18 @@ public:
     // threshold is the similarity threshold for the filter. Values from 0-1
     // are meaningful, with higher values requiring signals to be more similar
     // to be considered chroma.
-    void updateConfiguration(const LdDecodeMetaData::VideoParameters &videoParameters,
-                             double threshold, const QVector<double> &thresholds);
+    virtual void updateConfiguration(const LdDecodeMetaData::VideoParameters &videoParameters,
+                                     double threshold, const QVector<double> &thresholds);
 
     // Filter input fields.
     //
     // For each input frame between startFieldIndex and endFieldIndex, a
     // pointer will be placed in outputFields to an array of the same size
-    // (owned by this object) containing the chroma signal.
+    // containing the chroma signal. The arrays are allocated from
+    // scratchArena, so they remain valid until the caller's
+    // ScratchArena::Scope ends.
     virtual void filterFields(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                              QVector<const double *> &outputFields) = 0;
+                              QVector<const double *> &outputFields, ScratchArena &scratchArena) = 0;
 
     // Draw a visualisation of the FFT over component frames.
     //
@@ -79,6 +84,18 @@ protected:
     void overlayFFTArrays(const fftw_complex *fftIn, const fftw_complex *fftOut,
                           FrameCanvas &canvas);
 
+    // Allocate and clear a field-sized chroma buffer from scratchArena for
+    // each entry in outputFields, and point chromaBuf and outputFields at them
+    void allocateChromaBuffers(QVector<const double *> &outputFields, ScratchArena &scratchArena);
+
+    // Call task(worker, item) for each item from 0 to numItems - 1, using up
+    // to threads workers (numbered from 0) in parallel, and wait for them all
+    // to finish. Each worker processes one item at a time.
+    void runParallel(qint32 numItems, const std::function<void(qint32, qint32)> &task);
+
+    // Number of threads to use within filterFields
+    qint32 threads;
+
     // FFT size
     qint32 xComplex;
     qint32 yComplex;
@@ -88,6 +105,10 @@ protected:
     bool configurationSet;
     LdDecodeMetaData::VideoParameters videoParameters;
     QVector<double> thresholds;
+
+    // The combined result of all the FFT processing for each input field.
+    // Inverse-FFT results are accumulated into these buffers.
+    QVector<double *> chromaBuf;
 };
 
 #endif
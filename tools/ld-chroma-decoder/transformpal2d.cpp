@@ -27,6 +27,7 @@
 
 #include "transformpal2d.h"
 
+#include <QPair>
 #include <QtMath>
 #include <cassert>
 #include <cmath>
@@ -51,8 +52,8 @@ static double computeWindow(qint32 element, qint32 limit)
     return 0.5 - (0.5 * cos((2 * M_PI * (element + 0.5)) / limit));
 }
 
-TransformPal2D::TransformPal2D()
-    : TransformPal(XCOMPLEX, YCOMPLEX, 1)
+TransformPal2D::TransformPal2D(qint32 _threads)
+    : TransformPal(XCOMPLEX, YCOMPLEX, 1, _threads)
 {
     // Compute the window function.
     for (qint32 y = 0; y < YTILE; y++) {
@@ -63,15 +64,21 @@ TransformPal2D::TransformPal2D()
         }
     }
 
-    // Allocate buffers for FFTW. These must be allocated using FFTW's own
-    // functions so they're properly aligned for SIMD operations.
-    fftReal = fftw_alloc_real(YTILE * XTILE);
-    fftComplexIn = fftw_alloc_complex(YCOMPLEX * XCOMPLEX);
-    fftComplexOut = fftw_alloc_complex(YCOMPLEX * XCOMPLEX);
+    // Allocate buffers for FFTW, one set per worker thread. These must be
+    // allocated using FFTW's own functions so they're properly aligned for
+    // SIMD operations.
+    tileBuffers.resize(threads);
+    for (TileBuffers &buffers: tileBuffers) {
+        buffers.fftReal = fftw_alloc_real(YTILE * XTILE);
+        buffers.fftComplexIn = fftw_alloc_complex(YCOMPLEX * XCOMPLEX);
+        buffers.fftComplexOut = fftw_alloc_complex(YCOMPLEX * XCOMPLEX);
+    }
 
-    // Plan FFTW operations
-    forwardPlan = fftw_plan_dft_r2c_2d(YTILE, XTILE, fftReal, fftComplexIn, FFTW_MEASURE);
-    inversePlan = fftw_plan_dft_c2r_2d(YTILE, XTILE, fftComplexOut, fftReal, FFTW_MEASURE);
+    // Plan FFTW operations.
+    // The plans are executed on each worker's buffers using FFTW's new-array
+    // execute functions, which are thread-safe.
+    forwardPlan = fftw_plan_dft_r2c_2d(YTILE, XTILE, tileBuffers[0].fftReal, tileBuffers[0].fftComplexIn, FFTW_MEASURE);
+    inversePlan = fftw_plan_dft_c2r_2d(YTILE, XTILE, tileBuffers[0].fftComplexOut, tileBuffers[0].fftReal, FFTW_MEASURE);
 }
 
 TransformPal2D::~TransformPal2D()
@@ -79,9 +86,11 @@ TransformPal2D::~TransformPal2D()
     // Free FFTW plans and buffers
     fftw_destroy_plan(forwardPlan);
     fftw_destroy_plan(inversePlan);
-    fftw_free(fftReal);
-    fftw_free(fftComplexIn);
-    fftw_free(fftComplexOut);
+    for (TileBuffers &buffers: tileBuffers) {
+        fftw_free(buffers.fftReal);
+        fftw_free(buffers.fftComplexIn);
+        fftw_free(buffers.fftComplexOut);
+    }
 }
 
 qint32 TransformPal2D::getThresholdsSize()
@@ -91,7 +100,7 @@ qint32 TransformPal2D::getThresholdsSize()
 }
 
 void TransformPal2D::filterFields(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                                  QVector<const double *> &outputFields)
+                                  QVector<const double *> &outputFields, ScratchArena &scratchArena)
 {
     assert(configurationSet);
 
@@ -103,48 +112,66 @@ void TransformPal2D::filterFields(const QVector<SourceField> &inputFields, qint3
     assert(outputFields.size() == (endIndex - startIndex));
 
     // Allocate and clear output buffers
-    chromaBuf.resize(endIndex - startIndex);
-    for (qint32 i = 0; i < chromaBuf.size(); i++) {
-        chromaBuf[i].resize(videoParameters.fieldWidth * videoParameters.fieldHeight);
-        chromaBuf[i].fill(0.0);
+    allocateChromaBuffers(outputFields, scratchArena);
 
-        outputFields[i] = chromaBuf[i].data();
-    }
+    // Iterate through the overlapping rows of tiles in each field, covering
+    // the active area. (See TransformPal2D member variable documentation for
+    // how the tiling works.)
+    //
+    // Rows are filtered in parallel. Adjacent rows overlap, so with more than
+    // one thread the even rows are done first, then the odd rows, so that no
+    // two threads write to the same output samples at once. This changes the
+    // order the tiles are summed in, so the output can differ from the
+    // single-threaded output in rounding; with one thread, the rows are done
+    // in order, giving the same result as filtering tile by tile.
+    const qint32 passes = (threads == 1) ? 1 : 2;
+    for (qint32 pass = 0; pass < passes; pass++) {
+        // Make a list of the rows to filter, as (field, row) pairs
+        QVector<QPair<qint32, qint32>> rows;
+        for (qint32 i = startIndex; i < endIndex; i++) {
+            const qint32 firstFieldLine = inputFields[i].getFirstActiveLine(videoParameters);
+            const qint32 lastFieldLine = inputFields[i].getLastActiveLine(videoParameters);
+            for (qint32 row = pass; firstFieldLine - HALFYTILE + (row * HALFYTILE) < lastFieldLine; row += passes) {
+                rows.append(qMakePair(i, row));
+            }
+        }
 
-    for (qint32 i = startIndex, j = 0; i < endIndex; i++, j++) {
-        filterField(inputFields[i], j);
+        runParallel(rows.size(), [&](qint32 worker, qint32 item) {
+            const qint32 fieldIndex = rows.at(item).first;
+            filterRow(tileBuffers[worker], inputFields[fieldIndex], fieldIndex - startIndex, rows.at(item).second);
+        });
     }
 }
 
-// Process one field, writing the reuslt into chromaBuf[outputIndex]
-void TransformPal2D::filterField(const SourceField& inputField, qint32 outputIndex)
+// Process one row of tiles in a field, writing the result into chromaBuf[outputIndex]
+void TransformPal2D::filterRow(TileBuffers &buffers, const SourceField &inputField, qint32 outputIndex, qint32 row)
 {
     const qint32 firstFieldLine = inputField.getFirstActiveLine(videoParameters);
     const qint32 lastFieldLine = inputField.getLastActiveLine(videoParameters);
+    const qint32 tileY = firstFieldLine - HALFYTILE + (row * HALFYTILE);
 
-    // Iterate through the overlapping tile positions, covering the active area.
-    // (See TransformPal2D member variable documentation for how the tiling works.)
-    for (qint32 tileY = firstFieldLine - HALFYTILE; tileY < lastFieldLine; tileY += HALFYTILE) {
-        // Work out which lines of these tiles are within the active region
-        const qint32 startY = qMax(firstFieldLine - tileY, 0);
-        const qint32 endY = qMin(lastFieldLine - tileY, YTILE);
+    // Work out which lines of these tiles are within the active region
+    const qint32 startY = qMax(firstFieldLine - tileY, 0);
+    const qint32 endY = qMin(lastFieldLine - tileY, YTILE);
 
-        for (qint32 tileX = videoParameters.activeVideoStart - HALFXTILE; tileX < videoParameters.activeVideoEnd; tileX += HALFXTILE) {
-            // Compute the forward FFT
-            forwardFFTTile(tileX, tileY, startY, endY, inputField);
+    for (qint32 tileX = videoParameters.activeVideoStart - HALFXTILE; tileX < videoParameters.activeVideoEnd; tileX += HALFXTILE) {
+        // Compute the forward FFT
+        forwardFFTTile(buffers, tileX, tileY, startY, endY, inputField);
 
-            // Apply the frequency-domain filter
-            applyFilter();
+        // Apply the frequency-domain filter
+        applyFilter(buffers);
 
-            // Compute the inverse FFT
-            inverseFFTTile(tileX, tileY, startY, endY, outputIndex);
-        }
+        // Compute the inverse FFT
+        inverseFFTTile(buffers, tileX, tileY, startY, endY, outputIndex);
     }
 }
 
 // Apply the forward FFT to an input tile, populating fftComplexIn
-void TransformPal2D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, const SourceField &inputField)
+void TransformPal2D::forwardFFTTile(TileBuffers &buffers, qint32 tileX, qint32 tileY, qint32 startY, qint32 endY,
+                                    const SourceField &inputField)
 {
+    double *fftReal = buffers.fftReal;
+
     // Copy the input signal into fftReal, applying the window function
     const quint16 *inputPtr = inputField.data.data();
     for (qint32 y = 0; y < YTILE; y++) {
@@ -164,21 +191,24 @@ void TransformPal2D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 startY, q
     }
 
     // Convert time domain in fftReal to frequency domain in fftComplexIn
-    fftw_execute(forwardPlan);
+    fftw_execute_dft_r2c(forwardPlan, fftReal, buffers.fftComplexIn);
 }
 
 // Apply the inverse FFT to fftComplexOut, overlaying the result into chromaBuf[outputIndex]
-void TransformPal2D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, qint32 outputIndex)
+void TransformPal2D::inverseFFTTile(TileBuffers &buffers, qint32 tileX, qint32 tileY, qint32 startY, qint32 endY,
+                                    qint32 outputIndex)
 {
+    const double *fftReal = buffers.fftReal;
+
     // Work out what X range of this tile is inside the active area
     const qint32 startX = qMax(videoParameters.activeVideoStart - tileX, 0);
     const qint32 endX = qMin(videoParameters.activeVideoEnd - tileX, XTILE);
 
     // Convert frequency domain in fftComplexOut back to time domain in fftReal
-    fftw_execute(inversePlan);
+    fftw_execute_dft_c2r(inversePlan, buffers.fftComplexOut, buffers.fftReal);
 
     // Overlay the result, normalising the FFTW output, into chromaBuf
-    double *outputPtr = chromaBuf[outputIndex].data();
+    double *outputPtr = chromaBuf[outputIndex];
     for (qint32 y = startY; y < endY; y++) {
         double *b = outputPtr + ((tileY + y) * videoParameters.fieldWidth);
         for (qint32 x = startX; x < endX; x++) {
@@ -194,8 +224,11 @@ static inline double fftwAbsSq(const fftw_complex &value)
 }
 
 // Apply the frequency-domain filter.
-void TransformPal2D::applyFilter()
+void TransformPal2D::applyFilter(TileBuffers &buffers)
 {
+    const fftw_complex *fftComplexIn = buffers.fftComplexIn;
+    fftw_complex *fftComplexOut = buffers.fftComplexOut;
+
     // Get pointer to squared threshold values
     const double *thresholdsPtr = thresholds.data();
 
@@ -292,10 +325,11 @@ void TransformPal2D::overlayFFTFrame(qint32 positionX, qint32 positionY,
     const qint32 endY = qMin(lastFieldLine - tileY, YTILE);
 
     // Compute the forward FFT
-    forwardFFTTile(positionX, tileY, startY, endY, inputField);
+    TileBuffers &buffers = tileBuffers[0];
+    forwardFFTTile(buffers, positionX, tileY, startY, endY, inputField);
 
     // Apply the frequency-domain filter
-    applyFilter();
+    applyFilter(buffers);
 
     // Create a canvas
     FrameCanvas canvas(componentFrame, videoParameters);
@@ -305,5 +339,5 @@ void TransformPal2D::overlayFFTFrame(qint32 positionX, qint32 positionY,
     canvas.drawRectangle(positionX - 1, positionY + inputField.getOffset() - 1, XTILE + 1, (YTILE * 2) + 1, green);
 
     // Draw the arrays
-    overlayFFTArrays(fftComplexIn, fftComplexOut, canvas);
+    overlayFFTArrays(buffers.fftComplexIn, buffers.fftComplexOut, canvas);
 }
@@ -30,6 +30,7 @@
 
 #include <QVector>
 #include <fftw3.h>
+#include <vector>
 
 #include "componentframe.h"
 #include "outputwriter.h"
@@ -38,20 +39,29 @@
 
 class TransformPal2D : public TransformPal {
 public:
-    TransformPal2D();
+    TransformPal2D(qint32 threads = 1);
     virtual ~TransformPal2D();
 
     // Return the expected size of the thresholds array.
     static qint32 getThresholdsSize();
 
     void filterFields(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                      QVector<const double *> &outputFields) override;
+                      QVector<const double *> &outputFields, ScratchArena &scratchArena) override;
 
 protected:
-    void filterField(const SourceField& inputField, qint32 outputIndex);
-    void forwardFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, const SourceField &inputField);
-    void inverseFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, qint32 outputIndex);
-    void applyFilter();
+    // FFT input/output buffers for one worker thread
+    struct TileBuffers {
+        double *fftReal;
+        fftw_complex *fftComplexIn;
+        fftw_complex *fftComplexOut;
+    };
+
+    void filterRow(TileBuffers &buffers, const SourceField &inputField, qint32 outputIndex, qint32 row);
+    void forwardFFTTile(TileBuffers &buffers, qint32 tileX, qint32 tileY, qint32 startY, qint32 endY,
+                        const SourceField &inputField);
+    void inverseFFTTile(TileBuffers &buffers, qint32 tileX, qint32 tileY, qint32 startY, qint32 endY,
+                        qint32 outputIndex);
+    void applyFilter(TileBuffers &buffers);
     void overlayFFTFrame(qint32 positionX, qint32 positionY,
                          const QVector<SourceField> &inputFields, qint32 fieldIndex,
                          ComponentFrame &componentFrame) override;
@@ -74,17 +84,14 @@ protected:
     // Window function applied before the FFT
     double windowFunction[YTILE][XTILE];
 
-    // FFT input/output buffers
-    double *fftReal;
-    fftw_complex *fftComplexIn;
-    fftw_complex *fftComplexOut;
+    // FFT input/output buffers for each worker thread.
+    // These must be allocated using FFTW's own functions so they're properly
+    // aligned for SIMD operations, which also means the plans below can be
+    // used with any of them.
+    std::vector<TileBuffers> tileBuffers;
 
     // FFT plans
     fftw_plan forwardPlan, inversePlan;
-
-    // The combined result of all the FFT processing for each input field.
-    // Inverse-FFT results are accumulated into these buffers.
-    QVector<QVector<double>> chromaBuf;
 };
 
 #endif
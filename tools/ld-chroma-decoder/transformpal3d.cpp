@@ -54,9 +54,95 @@ static double computeWindow(qint32 element, qint32 limit)
     return 0.5 - (0.5 * cos((2 * M_PI * (element + 0.5)) / limit));
 }
 
-TransformPal3D::TransformPal3D()
-    : TransformPal(XCOMPLEX, YCOMPLEX, ZCOMPLEX)
+// Overloaded wrappers for the double and float versions of the FFTW
+// functions, so the batched code below can be written once for both.
+static void fftAllocate(double *&real, fftw_complex *&complexIn, fftw_complex *&complexOut,
+                        qint32 realSize, qint32 complexSize)
 {
+    real = fftw_alloc_real(realSize);
+    complexIn = fftw_alloc_complex(complexSize);
+    complexOut = fftw_alloc_complex(complexSize);
+}
+
+static void fftFree(double *real, fftw_complex *complexIn, fftw_complex *complexOut)
+{
+    fftw_free(real);
+    fftw_free(complexIn);
+    fftw_free(complexOut);
+}
+
+static void fftPlanMany(const int *n, qint32 howMany, double *real, fftw_complex *complexIn, fftw_complex *complexOut,
+                        qint32 realDist, qint32 complexDist, fftw_plan &forwardPlan, fftw_plan &inversePlan)
+{
+    forwardPlan = fftw_plan_many_dft_r2c(3, n, howMany, real, nullptr, 1, realDist,
+                                         complexIn, nullptr, 1, complexDist, FFTW_MEASURE);
+    inversePlan = fftw_plan_many_dft_c2r(3, n, howMany, complexOut, nullptr, 1, complexDist,
+                                         real, nullptr, 1, realDist, FFTW_MEASURE);
+}
+
+static void fftExecute(fftw_plan plan, double *real, fftw_complex *complex)
+{
+    fftw_execute_dft_r2c(plan, real, complex);
+}
+
+static void fftExecute(fftw_plan plan, fftw_complex *complex, double *real)
+{
+    fftw_execute_dft_c2r(plan, complex, real);
+}
+
+static void fftDestroy(fftw_plan plan)
+{
+    fftw_destroy_plan(plan);
+}
+
+#ifdef HAVE_FFTWF
+
+static void fftAllocate(float *&real, fftwf_complex *&complexIn, fftwf_complex *&complexOut,
+                        qint32 realSize, qint32 complexSize)
+{
+    real = fftwf_alloc_real(realSize);
+    complexIn = fftwf_alloc_complex(complexSize);
+    complexOut = fftwf_alloc_complex(complexSize);
+}
+
+static void fftFree(float *real, fftwf_complex *complexIn, fftwf_complex *complexOut)
+{
+    fftwf_free(real);
+    fftwf_free(complexIn);
+    fftwf_free(complexOut);
+}
+
+static void fftPlanMany(const int *n, qint32 howMany, float *real, fftwf_complex *complexIn, fftwf_complex *complexOut,
+                        qint32 realDist, qint32 complexDist, fftwf_plan &forwardPlan, fftwf_plan &inversePlan)
+{
+    forwardPlan = fftwf_plan_many_dft_r2c(3, n, howMany, real, nullptr, 1, realDist,
+                                          complexIn, nullptr, 1, complexDist, FFTW_MEASURE);
+    inversePlan = fftwf_plan_many_dft_c2r(3, n, howMany, complexOut, nullptr, 1, complexDist,
+                                          real, nullptr, 1, realDist, FFTW_MEASURE);
+}
+
+static void fftExecute(fftwf_plan plan, float *real, fftwf_complex *complex)
+{
+    fftwf_execute_dft_r2c(plan, real, complex);
+}
+
+static void fftExecute(fftwf_plan plan, fftwf_complex *complex, float *real)
+{
+    fftwf_execute_dft_c2r(plan, complex, real);
+}
+
+static void fftDestroy(fftwf_plan plan)
+{
+    fftwf_destroy_plan(plan);
+}
+
+#endif
+
+TransformPal3D::TransformPal3D(bool _singlePrecision, qint32 _threads)
+    : TransformPal(XCOMPLEX, YCOMPLEX, ZCOMPLEX, _threads), singlePrecision(_singlePrecision), rowTiles(0), batchTiles(0)
+{
+    assert(!singlePrecision || isSinglePrecisionAvailable());
+
     // Compute the window function.
     for (qint32 z = 0; z < ZTILE; z++) {
         const double windowZ = computeWindow(z, ZTILE);
@@ -88,6 +174,88 @@ TransformPal3D::~TransformPal3D()
     fftw_free(fftReal);
     fftw_free(fftComplexIn);
     fftw_free(fftComplexOut);
+
+    // Free the batched FFT plans and buffers
+    freeBatch(doubleBatch);
+#ifdef HAVE_FFTWF
+    freeBatch(floatBatch);
+#endif
+}
+
+bool TransformPal3D::isSinglePrecisionAvailable()
+{
+#ifdef HAVE_FFTWF
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TransformPal3D::updateConfiguration(const LdDecodeMetaData::VideoParameters &_videoParameters,
+                                         double threshold, const QVector<double> &_thresholds)
+{
+    TransformPal::updateConfiguration(_videoParameters, threshold, _thresholds);
+
+    // Work out how many tiles there are in each row (see filterFieldsBatched)
+    rowTiles = (videoParameters.activeVideoEnd - videoParameters.activeVideoStart + (2 * HALFXTILE) - 1) / HALFXTILE;
+    batchTiles = qMin(BATCHTILES, rowTiles);
+
+    // Plan FFTW operations for the batch size.
+    // This is done here rather than in filterFields, because the FFTW planner
+    // isn't thread-safe.
+    freeBatch(doubleBatch);
+#ifdef HAVE_FFTWF
+    freeBatch(floatBatch);
+    if (singlePrecision) {
+        planBatch(floatBatch);
+        return;
+    }
+#endif
+    planBatch(doubleBatch);
+}
+
+// Allocate buffers and plan FFTs for batches of tiles
+template <typename BatchType>
+void TransformPal3D::planBatch(BatchType &batch)
+{
+    // Allocate buffers for each worker thread
+    batch.buffers.resize(threads);
+    for (auto &buffers: batch.buffers) {
+        fftAllocate(buffers.real, buffers.complexIn, buffers.complexOut, batchTiles * TILESIZE, batchTiles * COMPLEXSIZE);
+    }
+
+    // Plan using the first worker's buffers.
+    // The FFTW allocation functions give the same alignment for all the
+    // buffers, so the plans can be executed on any of them.
+    auto &buffers = batch.buffers[0];
+    const int n[3] = {ZTILE, YTILE, XTILE};
+    fftPlanMany(n, batchTiles, buffers.real, buffers.complexIn, buffers.complexOut, TILESIZE, COMPLEXSIZE,
+                batch.forwardPlans[0], batch.inversePlans[0]);
+
+    const qint32 leftoverTiles = rowTiles % batchTiles;
+    if (leftoverTiles != 0) {
+        fftPlanMany(n, leftoverTiles, buffers.real, buffers.complexIn, buffers.complexOut, TILESIZE, COMPLEXSIZE,
+                    batch.forwardPlans[1], batch.inversePlans[1]);
+    }
+}
+
+// Free the buffers and plans for batches of tiles, if they have been allocated
+template <typename BatchType>
+void TransformPal3D::freeBatch(BatchType &batch)
+{
+    for (qint32 i = 0; i < 2; i++) {
+        if (batch.forwardPlans[i] != nullptr) {
+            fftDestroy(batch.forwardPlans[i]);
+            fftDestroy(batch.inversePlans[i]);
+            batch.forwardPlans[i] = nullptr;
+            batch.inversePlans[i] = nullptr;
+        }
+    }
+
+    for (auto &buffers: batch.buffers) {
+        fftFree(buffers.real, buffers.complexIn, buffers.complexOut);
+    }
+    batch.buffers.clear();
 }
 
 qint32 TransformPal3D::getThresholdsSize()
@@ -109,7 +277,7 @@ qint32 TransformPal3D::getLookAhead()
 }
 
 void TransformPal3D::filterFields(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                                  QVector<const double *> &outputFields)
+                                  QVector<const double *> &outputFields, ScratchArena &scratchArena)
 {
     assert(configurationSet);
 
@@ -126,41 +294,97 @@ void TransformPal3D::filterFields(const QVector<SourceField> &inputFields, qint3
     assert((inputFields.size() - endIndex) >= HALFZTILE);
 
     // Allocate and clear output buffers
-    chromaBuf.resize(endIndex - startIndex);
-    for (qint32 i = 0; i < chromaBuf.size(); i++) {
-        chromaBuf[i].resize(videoParameters.fieldWidth * videoParameters.fieldHeight);
-        chromaBuf[i].fill(0.0);
+    allocateChromaBuffers(outputFields, scratchArena);
 
-        outputFields[i] = chromaBuf[i].data();
+#ifdef HAVE_FFTWF
+    if (singlePrecision) {
+        filterFieldsBatched(floatBatch, inputFields, startIndex, endIndex);
+        return;
     }
+#endif
+    filterFieldsBatched(doubleBatch, inputFields, startIndex, endIndex);
+}
 
+// Filter the fields, transforming a batch of tiles from each row at a time
+template <typename BatchType>
+void TransformPal3D::filterFieldsBatched(BatchType &batch, const QVector<SourceField> &inputFields,
+                                         qint32 startIndex, qint32 endIndex)
+{
     // Iterate through the overlapping tile positions, covering the active area.
     // (See TransformPal3D member variable documentation for how the tiling works;
     // if you change the Z tiling here, also review getLookBehind/getLookAhead above.)
     for (qint32 tileZ = startIndex - HALFZTILE; tileZ < endIndex; tileZ += HALFZTILE) {
-        for (qint32 tileY = videoParameters.firstActiveFrameLine - HALFYTILE; tileY < videoParameters.lastActiveFrameLine; tileY += HALFYTILE) {
-            for (qint32 tileX = videoParameters.activeVideoStart - HALFXTILE; tileX < videoParameters.activeVideoEnd; tileX += HALFXTILE) {
-                // Compute the forward FFT
-                forwardFFTTile(tileX, tileY, tileZ, inputFields);
+        // Rows are filtered in parallel. Adjacent rows overlap, so with more
+        // than one thread the even rows are done first, then the odd rows, so
+        // that no two threads write to the same output samples at once. This
+        // changes the order the tiles are summed in, so the output can differ
+        // from the single-threaded output in rounding; with one thread, the
+        // rows are done in order.
+        const qint32 firstTileY = videoParameters.firstActiveFrameLine - HALFYTILE;
+        const qint32 numRows = (videoParameters.lastActiveFrameLine - firstTileY + HALFYTILE - 1) / HALFYTILE;
+        const qint32 passes = (threads == 1) ? 1 : 2;
+        for (qint32 pass = 0; pass < passes; pass++) {
+            runParallel((numRows + passes - 1 - pass) / passes, [&](qint32 worker, qint32 item) {
+                const qint32 tileY = firstTileY + (((item * passes) + pass) * HALFYTILE);
+                filterRowBatched(batch, batch.buffers[worker], tileY, tileZ, inputFields, startIndex, endIndex);
+            });
+        }
+    }
+}
+
+// Filter one row of tiles, using the given worker's buffers
+template <typename BatchType>
+void TransformPal3D::filterRowBatched(BatchType &batch, typename BatchType::Buffers &buffers, qint32 tileY, qint32 tileZ,
+                                      const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex)
+{
+    for (qint32 firstTile = 0; firstTile < rowTiles; firstTile += batchTiles) {
+        const qint32 numTiles = qMin(batchTiles, rowTiles - firstTile);
+        const qint32 planIndex = (numTiles == batchTiles) ? 0 : 1;
+        const qint32 firstTileX = videoParameters.activeVideoStart - HALFXTILE + (firstTile * HALFXTILE);
+
+        // Copy the input tiles into the batch
+        for (qint32 i = 0; i < numTiles; i++) {
+            forwardCopyTile(buffers.real + (i * TILESIZE), firstTileX + (i * HALFXTILE), tileY, tileZ, inputFields);
+        }
 
-                // Apply the frequency-domain filter
-                applyFilter();
+        // Compute the forward FFTs
+        fftExecute(batch.forwardPlans[planIndex], buffers.real, buffers.complexIn);
 
-                // Compute the inverse FFT
-                inverseFFTTile(tileX, tileY, tileZ, startIndex, endIndex);
-            }
+        // Apply the frequency-domain filter to each tile
+        for (qint32 i = 0; i < numTiles; i++) {
+            applyFilter(buffers.complexIn + (i * COMPLEXSIZE), buffers.complexOut + (i * COMPLEXSIZE));
+        }
+
+        // Compute the inverse FFTs
+        fftExecute(batch.inversePlans[planIndex], buffers.complexOut, buffers.real);
+
+        // Overlay the output tiles into the chroma buffers
+        for (qint32 i = 0; i < numTiles; i++) {
+            inverseCopyTile(buffers.real + (i * TILESIZE), firstTileX + (i * HALFXTILE), tileY, tileZ, startIndex, endIndex);
         }
     }
 }
 
 // Apply the forward FFT to an input tile, populating fftComplexIn
 void TransformPal3D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, const QVector<SourceField> &inputFields)
+{
+    // Copy the input signal into fftReal
+    forwardCopyTile(fftReal, tileX, tileY, tileZ, inputFields);
+
+    // Convert time domain in fftReal to frequency domain in fftComplexIn
+    fftw_execute(forwardPlan);
+}
+
+// Copy an input tile into tileReal, applying the window function
+template <typename Real>
+void TransformPal3D::forwardCopyTile(Real *tileReal, qint32 tileX, qint32 tileY, qint32 tileZ,
+                                     const QVector<SourceField> &inputFields)
 {
     // Work out which lines of this tile are within the active region
     const qint32 startY = qMax(videoParameters.firstActiveFrameLine - tileY, 0);
     const qint32 endY = qMin(videoParameters.lastActiveFrameLine - tileY, YTILE);
 
-    // Copy the input signal into fftReal, applying the window function
+    // Copy the input signal into tileReal, applying the window function
     for (qint32 z = 0; z < ZTILE; z++) {
         const qint32 fieldIndex = tileZ + z;
         const quint16 *inputPtr = inputFields[fieldIndex].data.data();
@@ -172,7 +396,7 @@ void TransformPal3D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, co
             // field), fill it with black instead.
             if (y < startY || y >= endY || ((tileY + y) % 2) != (fieldIndex % 2)) {
                 for (qint32 x = 0; x < XTILE; x++) {
-                    fftReal[(((z * YTILE) + y) * XTILE) + x] = videoParameters.black16bIre * windowFunction[z][y][x];
+                    tileReal[(((z * YTILE) + y) * XTILE) + x] = videoParameters.black16bIre * windowFunction[z][y][x];
                 }
                 continue;
             }
@@ -180,17 +404,26 @@ void TransformPal3D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, co
             const qint32 fieldLine = (tileY + y) / 2;
             const quint16 *b = inputPtr + (fieldLine * videoParameters.fieldWidth);
             for (qint32 x = 0; x < XTILE; x++) {
-                fftReal[(((z * YTILE) + y) * XTILE) + x] = b[tileX + x] * windowFunction[z][y][x];
+                tileReal[(((z * YTILE) + y) * XTILE) + x] = b[tileX + x] * windowFunction[z][y][x];
             }
         }
     }
-
-    // Convert time domain in fftReal to frequency domain in fftComplexIn
-    fftw_execute(forwardPlan);
 }
 
 // Apply the inverse FFT to fftComplexOut, overlaying the result into chromaBuf
 void TransformPal3D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qint32 startIndex, qint32 endIndex)
+{
+    // Convert frequency domain in fftComplexOut back to time domain in fftReal
+    fftw_execute(inversePlan);
+
+    // Overlay the result into the chroma buffers
+    inverseCopyTile(fftReal, tileX, tileY, tileZ, startIndex, endIndex);
+}
+
+// Overlay an output tile from tileReal, normalising the FFTW output, into chromaBuf
+template <typename Real>
+void TransformPal3D::inverseCopyTile(const Real *tileReal, qint32 tileX, qint32 tileY, qint32 tileZ,
+                                     qint32 startIndex, qint32 endIndex)
 {
     // Work out what portion of this tile is inside the active area
     const qint32 startX = qMax(videoParameters.activeVideoStart - tileX, 0);
@@ -200,13 +433,10 @@ void TransformPal3D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qi
     const qint32 startZ = qMax(startIndex - tileZ, 0);
     const qint32 endZ = qMin(endIndex - tileZ, ZTILE);
 
-    // Convert frequency domain in fftComplexOut back to time domain in fftReal
-    fftw_execute(inversePlan);
-
     // Overlay the result, normalising the FFTW output, into the chroma buffers
     for (qint32 z = startZ; z < endZ; z++) {
         const qint32 outputIndex = tileZ + z - startIndex;
-        double *outputPtr = chromaBuf[outputIndex].data();
+        double *outputPtr = chromaBuf[outputIndex];
 
         for (qint32 y = startY; y < endY; y++) {
             // If this frame line is not part of this field, ignore it.
@@ -217,29 +447,39 @@ void TransformPal3D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qi
             const qint32 outputLine = (tileY + y) / 2;
             double *b = outputPtr + (outputLine * videoParameters.fieldWidth);
             for (qint32 x = startX; x < endX; x++) {
-                b[tileX + x] += fftReal[(((z * YTILE) + y) * XTILE) + x] / (ZTILE * YTILE * XTILE);
+                b[tileX + x] += tileReal[(((z * YTILE) + y) * XTILE) + x] / (ZTILE * YTILE * XTILE);
             }
         }
     }
 }
 
-// Return the absolute value squared of an fftw_complex
-static inline double fftwAbsSq(const fftw_complex &value)
+// Return the absolute value squared of an fftw_complex or fftwf_complex
+template <typename Complex>
+static inline double fftwAbsSq(const Complex &value)
 {
-    return (value[0] * value[0]) + (value[1] * value[1]);
+    const double re = value[0];
+    const double im = value[1];
+    return (re * re) + (im * im);
 }
 
-// Apply the frequency-domain filter.
+// Apply the frequency-domain filter to fftComplexIn, producing fftComplexOut.
 void TransformPal3D::applyFilter()
+{
+    applyFilter(fftComplexIn, fftComplexOut);
+}
+
+// Apply the frequency-domain filter to one tile.
+template <typename Complex>
+void TransformPal3D::applyFilter(const Complex *complexIn, Complex *complexOut)
 {
     // Get pointer to squared threshold values
     const double *thresholdsPtr = thresholds.data();
 
-    // Clear fftComplexOut. We discard values by default; the filter only
+    // Clear complexOut. We discard values by default; the filter only
     // copies values that look like chroma.
-    for (qint32 i = 0; i < ZCOMPLEX * YCOMPLEX * XCOMPLEX; i++) {
-        fftComplexOut[i][0] = 0.0;
-        fftComplexOut[i][1] = 0.0;
+    for (qint32 i = 0; i < COMPLEXSIZE; i++) {
+        complexOut[i][0] = 0.0;
+        complexOut[i][1] = 0.0;
     }
 
     // This is a direct translation of transform_filter from pyctools-pal, with
@@ -268,12 +508,12 @@ void TransformPal3D::applyFilter()
             const qint32 y_ref = ((YTILE / 4) + YTILE - y) % YTILE;
 
             // Input data for this line and its reflection
-            const fftw_complex *bi = fftComplexIn + (((z * YCOMPLEX) + y) * XCOMPLEX);
-            const fftw_complex *bi_ref = fftComplexIn + (((z_ref * YCOMPLEX) + y_ref) * XCOMPLEX);
+            const Complex *bi = complexIn + (((z * YCOMPLEX) + y) * XCOMPLEX);
+            const Complex *bi_ref = complexIn + (((z_ref * YCOMPLEX) + y_ref) * XCOMPLEX);
 
             // Output data for this line and its reflection
-            fftw_complex *bo = fftComplexOut + (((z * YCOMPLEX) + y) * XCOMPLEX);
-            fftw_complex *bo_ref = fftComplexOut + (((z_ref * YCOMPLEX) + y_ref) * XCOMPLEX);
+            Complex *bo = complexOut + (((z * YCOMPLEX) + y) * XCOMPLEX);
+            Complex *bo_ref = complexOut + (((z_ref * YCOMPLEX) + y_ref) * XCOMPLEX);
 
             // We only need to look at horizontal frequencies that might be chroma (0.5fSC to 1.5fSC).
             for (qint32 x = XTILE / 8; x <= XTILE / 4; x++) {
@@ -283,8 +523,8 @@ void TransformPal3D::applyFilter()
                 // Get the threshold for this bin
                 const double threshold_sq = *thresholdsPtr++;
 
-                const fftw_complex &in_val = bi[x];
-                const fftw_complex &ref_val = bi_ref[x_ref];
+                const Complex &in_val = bi[x];
+                const Complex &ref_val = bi_ref[x_ref];
 
                 if (x == x_ref && y == y_ref && z == z_ref) {
                     // This bin is its own reflection (i.e. it's a carrier). Keep it!
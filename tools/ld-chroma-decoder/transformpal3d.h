@@ -30,6 +30,7 @@
 
 #include <QVector>
 #include <fftw3.h>
+#include <vector>
 
 #include "componentframe.h"
 #include "outputwriter.h"
@@ -38,9 +39,18 @@
 
 class TransformPal3D : public TransformPal {
 public:
-    TransformPal3D();
+    // If singlePrecision is true, filterFields uses single-precision FFTs,
+    // which are faster but give very slightly different results. This is only
+    // possible if isSinglePrecisionAvailable() returns true.
+    TransformPal3D(bool singlePrecision = false, qint32 threads = 1);
     ~TransformPal3D();
 
+    // Return true if this was built with single-precision FFTW (fftw3f)
+    static bool isSinglePrecisionAvailable();
+
+    void updateConfiguration(const LdDecodeMetaData::VideoParameters &videoParameters,
+                             double threshold, const QVector<double> &thresholds) override;
+
     // Return the expected size of the thresholds array.
     static qint32 getThresholdsSize();
 
@@ -50,12 +60,14 @@ public:
     static qint32 getLookAhead();
 
     void filterFields(const QVector<SourceField> &inputFields, qint32 startFieldIndex, qint32 endFieldIndex,
-                      QVector<const double *> &outputFields) override;
+                      QVector<const double *> &outputFields, ScratchArena &scratchArena) override;
 
 protected:
     void forwardFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, const QVector<SourceField> &inputFields);
     void inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qint32 startFieldIndex, qint32 endFieldIndex);
     void applyFilter();
+    template <typename Complex>
+    void applyFilter(const Complex *complexIn, Complex *complexOut);
     void overlayFFTFrame(qint32 positionX, qint32 positionY,
                          const QVector<SourceField> &inputFields, qint32 fieldIndex,
                          ComponentFrame &componentFrame) override;
@@ -95,9 +107,54 @@ protected:
     // FFT plans
     fftw_plan forwardPlan, inversePlan;
 
-    // The combined result of all the FFT processing for each input field.
-    // Inverse-FFT results are accumulated into these buffers.
-    QVector<QVector<double>> chromaBuf;
+    // filterFields transforms up to BATCHTILES tiles from a row at once,
+    // using FFTW's advanced interface. The tiles are stored one after another
+    // in the batch buffers.
+    static constexpr qint32 BATCHTILES = 16;
+    static constexpr qint32 TILESIZE = ZTILE * YTILE * XTILE;
+    static constexpr qint32 COMPLEXSIZE = ZCOMPLEX * YCOMPLEX * XCOMPLEX;
+
+    // Buffers and plans for batched FFTs with the given sample types.
+    // There is a set of buffers for each worker thread; the plans are
+    // executed on them using FFTW's new-array execute functions.
+    // plans[0] transforms BATCHTILES tiles; plans[1] transforms the leftover
+    // tiles at the end of a row, if there are any.
+    template <typename Real, typename Complex, typename Plan>
+    struct Batch {
+        struct Buffers {
+            Real *real;
+            Complex *complexIn;
+            Complex *complexOut;
+        };
+        std::vector<Buffers> buffers;
+        Plan forwardPlans[2] = {nullptr, nullptr};
+        Plan inversePlans[2] = {nullptr, nullptr};
+    };
+    Batch<double, fftw_complex, fftw_plan> doubleBatch;
+#ifdef HAVE_FFTWF
+    Batch<float, fftwf_complex, fftwf_plan> floatBatch;
+#endif
+
+    // Precision to use in filterFields
+    bool singlePrecision;
+
+    // Number of tiles in each row, and in a full batch
+    qint32 rowTiles;
+    qint32 batchTiles;
+
+    template <typename BatchType>
+    void planBatch(BatchType &batch);
+    template <typename BatchType>
+    void freeBatch(BatchType &batch);
+    template <typename BatchType>
+    void filterFieldsBatched(BatchType &batch, const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex);
+    template <typename BatchType>
+    void filterRowBatched(BatchType &batch, typename BatchType::Buffers &buffers, qint32 tileY, qint32 tileZ,
+                          const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex);
+    template <typename Real>
+    void forwardCopyTile(Real *tileReal, qint32 tileX, qint32 tileY, qint32 tileZ, const QVector<SourceField> &inputFields);
+    template <typename Real>
+    void inverseCopyTile(const Real *tileReal, qint32 tileX, qint32 tileY, qint32 tileZ, qint32 startIndex, qint32 endIndex);
 };
 
 #endif
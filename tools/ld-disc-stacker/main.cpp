@@ -103,6 +103,13 @@ int main(int argc, char *argv[])
                                          "main", "Specify the number of concurrent threads (default is the number of logical CPUs)"),
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
+
+    // Option to select the amount of input to read ahead
+    QCommandLineOption prefetchOption(QStringList() << "prefetch",
+                                      QCoreApplication::translate(
+                                       "main", "Specify the amount of each input to read ahead in the background, in MB (0 to disable; default 64)"),
+                                      QCoreApplication::translate("main", "megabytes"));
+    parser.addOption(prefetchOption);
     
     // Option to select the stacking mode (-m)
     QCommandLineOption modeOption(QStringList() << "m" << "mode",
@@ -228,6 +235,17 @@ int main(int argc, char *argv[])
         }
     }
 
+    qint32 prefetchMegabytes = 64;
+    if (parser.isSet(prefetchOption)) {
+        prefetchMegabytes = parser.value(prefetchOption).toInt();
+
+        if (prefetchMegabytes < 0) {
+            // Quit with error
+            qCritical("Specified prefetch size must not be negative");
+            return -1;
+        }
+    }
+
     // Require source and target filenames
     QVector<QString> inputFilenames;
     QString outputFilename = "-";
@@ -419,7 +437,7 @@ int main(int argc, char *argv[])
     // Perform the disc stacking processes ----------------------------------------------------------------------------
     qInfo() << "Initial source checks are ok and sources are loaded";
     qint32 result = 0;
-    StackingPool stackingPool(outputFilename, outputJsonFilename, maxThreads,
+    StackingPool stackingPool(outputFilename, outputJsonFilename, maxThreads, prefetchMegabytes,
                                 ldDecodeMetaData, sourceVideos, mode, smartThreshold, reverse, noDiffDod, passThrough, integrityCheck, verbose);
     if (!stackingPool.process()) result = 1;
 
@@ -36,8 +36,10 @@ void Stacker::run()
     qint32 frameNumber;
     QVector<qint32> firstFieldSeqNo;
     QVector<qint32> secondFieldSeqNo;
-    QVector<SourceVideo::Data> firstSourceField;
-    QVector<SourceVideo::Data> secondSourceField;
+    QVector<SourceVideo::View> firstSourceField;
+    QVector<SourceVideo::View> secondSourceField;
+    QVector<SourceVideo::Data> firstSourceBuffers;
+    QVector<SourceVideo::Data> secondSourceBuffers;
     QVector<LdDecodeMetaData::Field> firstFieldMetadata;
     QVector<LdDecodeMetaData::Field> secondFieldMetadata;
     qint32 mode;
@@ -52,6 +54,7 @@ void Stacker::run()
         // Get the next field to process from the input file
         if (!stackingPool.getInputFrame(frameNumber, firstFieldSeqNo, firstSourceField, firstFieldMetadata,
                                        secondFieldSeqNo, secondSourceField, secondFieldMetadata,
+                                       firstSourceBuffers, secondSourceBuffers,
                                        videoParameters, mode, smartThreshold, reverse, noDiffDod, passThrough,
                                        availableSourcesForFrame)) {
             // No more input fields -- exit
@@ -75,7 +78,7 @@ void Stacker::run()
 }
 
 // Method to stack fields
-void Stacker::stackField(const qint32 frameNumber,const QVector<SourceVideo::Data>& inputFields,
+void Stacker::stackField(const qint32 frameNumber,const QVector<SourceVideo::View>& inputFields,
                                       const LdDecodeMetaData::VideoParameters& videoParameters,
                                       const QVector<LdDecodeMetaData::Field>& fieldMetadata,
                                       const QVector<qint32> availableSourcesForFrame,
@@ -88,33 +91,78 @@ void Stacker::stackField(const qint32 frameNumber,const QVector<SourceVideo::Dat
 {
     quint16 prevGoodValue = videoParameters.black16bIre;
     bool forceDropout = false;
-    QVector<QVector<quint16>> tmpField(videoParameters.fieldHeight * videoParameters.fieldWidth);
+    const qint32 fieldWidth = videoParameters.fieldWidth;
+    const qint32 sourceCount = availableSourcesForFrame.size();
     
-    if (availableSourcesForFrame.size() > 0) {
+    if (sourceCount > 0) {
+        // Index each source's dropouts by line, so lookups don't scan the whole list
+        QVector<DropOutIndex> dropOutIndexes;
+        dropOutIndexes.reserve(fieldMetadata.size());
+        for (const LdDecodeMetaData::Field &field : fieldMetadata) {
+            dropOutIndexes.append(DropOutIndex(field.dropOuts));
+        }
+
+        // Samples read for each pixel, for mode >= 3
+        if (mode >= 3) tmpField.reset(videoParameters.fieldHeight * fieldWidth, sourceCount);
+
         // Sources available - process field
+        stackedLine.resize(fieldWidth);
+        SampleSet inputValues;
+        SampleSet valuesN;//North neighbor pixel
+        SampleSet valuesS;//South neighbor pixel
+        SampleSet valuesE;//East neighbor pixel
+        SampleSet valuesW;//West neighbor pixel
         for (qint32 y = 0; y < videoParameters.fieldHeight; y++) {
-            for (qint32 x = 0; x < videoParameters.fieldWidth; x++) {
-                QVector<quint16> valuesN;//North neighbor pixel
-                QVector<quint16> valuesS;//South neighbor pixel
-                QVector<quint16> valuesE;//East neighbor pixel
-                QVector<quint16> valuesW;//West neighbor pixel
-                QVector<bool> isAllDropout = {true,true,true,true,true};//is neighbor pixel all dropout : current = [0] / N = [1] / S = [2] / E = [3] / W = [4]
+            // Line pointers and dropout cursors for the available sources along this line
+            const quint16 *sourceLines[StackKernels::MAX_SOURCES];
+            std::vector<DropOutIndex::Cursor> lineCursors;
+            lineCursors.reserve(sourceCount);
+            for (qint32 i = 0; i < sourceCount; i++) {
+                sourceLines[i] = inputFields[availableSourcesForFrame[i]].data() + (fieldWidth * y);
+                lineCursors.emplace_back(dropOutIndexes[availableSourcesForFrame[i]], y + 1);
+            }
+
+            // For modes 0-2, stack the whole line as if no source had a dropout; pixels where
+            // one does are stacked individually below
+            if (mode == 0) StackKernels::meanLine(sourceLines, sourceCount, 0, fieldWidth, stackedLine.data());
+            else if (mode == 1) StackKernels::medianLine(sourceLines, sourceCount, 0, fieldWidth, stackedLine.data());
+            else if (mode == 2) StackKernels::smartMeanLine(sourceLines, sourceCount, 0, fieldWidth, smartThreshold, stackedLine.data());
+
+            for (qint32 x = 0; x < fieldWidth; x++) {
+                inputValues.clear();
+                valuesN.clear();
+                valuesS.clear();
+                valuesE.clear();
+                valuesW.clear();
+                bool isAllDropout[5] = {true,true,true,true,true};//is neighbor pixel all dropout : current = [0] / N = [1] / S = [2] / E = [3] / W = [4]
                 
-                QVector<quint16> inputValues;
                 // Get input values from the input sources (which are not marked as dropouts)
                 if(mode >= 3)//get surounding pixels
                 {
-                    Stacker::getProcessedSample(x, y, availableSourcesForFrame, inputFields, tmpField, videoParameters, fieldMetadata, inputValues, valuesN, valuesS, valuesE, valuesW, isAllDropout, noDiffDod, verbose);
+                    Stacker::getProcessedSample(x, y, availableSourcesForFrame, inputFields, videoParameters, dropOutIndexes, inputValues, valuesN, valuesS, valuesE, valuesW, isAllDropout, noDiffDod, verbose);
                 }
                 else// get only pixel 1 by 1
                 {
-                    for (qint32 i = 0; i < availableSourcesForFrame.size(); i++){
+                    bool sampleIsDropout[StackKernels::MAX_SOURCES];
+                    bool anyDropout = false;
+                    for (qint32 i = 0; i < sourceCount; i++) {
+                        sampleIsDropout[i] = lineCursors[i].contains(x);
+                        anyDropout |= sampleIsDropout[i];
+                    }
+
+                    // No dropouts - use the value stacked for the whole line
+                    if (!anyDropout) {
+                        outputField[(fieldWidth * y) + x] = stackedLine[x];
+                        prevGoodValue = stackedLine[x];
+                        continue;
+                    }
+
+                    for (qint32 i = 0; i < sourceCount; i++){
                         //read pixel
-                        const quint16 pixelValue = inputFields[availableSourcesForFrame[i]][(videoParameters.fieldWidth * y) + x];
-                        const bool sampleIsDropout = isDropout(fieldMetadata[availableSourcesForFrame[i]].dropOuts, x, y);
+                        const quint16 pixelValue = sourceLines[i][x];
                         
                         // Include the source's pixel data if it's not marked as a dropout
-                        if (!sampleIsDropout) {
+                        if (!sampleIsDropout[i]) {
                             // Pixel is valid
                             inputValues.append(pixelValue);
                         }
@@ -123,7 +171,7 @@ void Stacker::stackField(const qint32 frameNumber,const QVector<SourceVideo::Dat
                             inputValues.append(pixelValue);
                         }
                         
-                        if(!sampleIsDropout)
+                        if(!sampleIsDropout[i])
                         {
                             isAllDropout[0] = false;
                         }
@@ -188,7 +236,12 @@ void Stacker::stackField(const qint32 frameNumber,const QVector<SourceVideo::Dat
                     //2 or more values available - store the result in the output field
                     outputField[(videoParameters.fieldWidth * y) + x] = stackMode(inputValues, valuesN, valuesS, valuesE, valuesW, isAllDropout, mode, smartThreshold);
                     prevGoodValue = outputField[(videoParameters.fieldWidth * y) + x];
-                    tmpField[(videoParameters.fieldWidth * y) + x] = QVector<quint16>{prevGoodValue};
+                    if (mode >= 3) {
+                        // Later pixels use the stacked value as this pixel's sample set
+                        SampleSet stackedValue;
+                        stackedValue.append(prevGoodValue);
+                        tmpField.set((videoParameters.fieldWidth * y) + x, stackedValue);
+                    }
                     if (forceDropout) dropOuts.append(x, x, y + 1);
                 }
             }
@@ -207,12 +260,12 @@ void Stacker::stackField(const qint32 frameNumber,const QVector<SourceVideo::Dat
 }
 
 // Method to stack a vector of quint16 using a selected mode
-quint16 Stacker::stackMode(const QVector<quint16>& elements, const QVector<quint16>& elementsN, const QVector<quint16>& elementsS, const QVector<quint16>& elementsE, const QVector<quint16>& elementsW, const QVector<bool>& isAllDropout, const qint32& mode, const qint32& smartThreshold)
+quint16 Stacker::stackMode(const SampleSet& elements, const SampleSet& elementsN, const SampleSet& elementsS, const SampleSet& elementsE, const SampleSet& elementsW, const bool *isAllDropout, const qint32& mode, const qint32& smartThreshold)
 {
     const qint32 nbOfElements = elements.size();
     qint32 nbSelected = 0;
     quint32 result = 0;
-    QVector<quint16> closestList;
+    SampleSet closestList;
     
     //neighbor pixel
     qint32 resultN = 0;
@@ -226,17 +279,17 @@ quint16 Stacker::stackMode(const QVector<quint16>& elements, const QVector<quint
     switch (mode) {
         case 0://mean mode
         {
-            result = Stacker::mean(elements);
+            result = StackKernels::mean(elements);
             break;
         }
         case 1://median mode
         {
-            result = Stacker::median(elements);
+            result = StackKernels::median(elements);
             break;
         }
         case 2://smart mean mode
         {
-            const qint32 median = Stacker::median(elements);
+            const qint32 median = StackKernels::median(elements);
             //count number of sample withing threshold distance to the median and sum
             for(int i=0; i < nbOfElements;i++)
             {
@@ -259,15 +312,15 @@ quint16 Stacker::stackMode(const QVector<quint16>& elements, const QVector<quint
         }
         case 3://smart neighbor mode
         {
-            const qint32 median = Stacker::median(elements);
+            const qint32 median = StackKernels::median(elements);
             
-            ((elementsN.size() > 1) && isAllDropout[1]) ? resultN = Stacker::median(elementsN) : (elementsN.size() > 0 ? resultN = elementsN[0] : resultN = -1);
-            ((elementsS.size() > 1) && isAllDropout[2]) ? resultS = Stacker::median(elementsS) : (elementsS.size() > 0 ? resultS = elementsS[0] : resultS = -1);
+            ((elementsN.size() > 1) && isAllDropout[1]) ? resultN = StackKernels::median(elementsN) : (elementsN.size() > 0 ? resultN = elementsN[0] : resultN = -1);
+            ((elementsS.size() > 1) && isAllDropout[2]) ? resultS = StackKernels::median(elementsS) : (elementsS.size() > 0 ? resultS = elementsS[0] : resultS = -1);
             
             if(!isAllDropout[0])
             {
-                ((elementsE.size() > 1) && isAllDropout[3]) ? resultE = Stacker::median(elementsE) : (elementsE.size() > 0 ? resultE = elementsE[0] : resultE = -1);
-                ((elementsW.size() > 1) && isAllDropout[4]) ? resultW = Stacker::median(elementsW) : (elementsW.size() > 0 ? resultW = elementsW[0] : resultW = -1);
+                ((elementsE.size() > 1) && isAllDropout[3]) ? resultE = StackKernels::median(elementsE) : (elementsE.size() > 0 ? resultE = elementsE[0] : resultE = -1);
+                ((elementsW.size() > 1) && isAllDropout[4]) ? resultW = StackKernels::median(elementsW) : (elementsW.size() > 0 ? resultW = elementsW[0] : resultW = -1);
             }
             
             //check number of neighbor available and prepare for mean
@@ -279,12 +332,12 @@ quint16 Stacker::stackMode(const QVector<quint16>& elements, const QVector<quint
             if(nbNeighbor > 0)
             {
                 //closest value to a neighbor                    
-                if(resultN > 0){closestList.append(Stacker::closest(elements, resultN));}
-                if(resultS > 0){closestList.append(Stacker::closest(elements, resultS));}
-                if(resultE > 0){closestList.append(Stacker::closest(elements, resultE));}
-                if(resultW > 0){closestList.append(Stacker::closest(elements, resultW));}
+                if(resultN > 0){closestList.append(StackKernels::closest(elements, resultN));}
+                if(resultS > 0){closestList.append(StackKernels::closest(elements, resultS));}
+                if(resultE > 0){closestList.append(StackKernels::closest(elements, resultE));}
+                if(resultW > 0){closestList.append(StackKernels::closest(elements, resultW));}
                 
-                resultNeighbor = Stacker::closest(closestList, median);//get the closest value to the median/mean based on closest value to a neighbor
+                resultNeighbor = StackKernels::closest(closestList, median);//get the closest value to the median/mean based on closest value to a neighbor
             }
             else
             {
@@ -323,15 +376,15 @@ quint16 Stacker::stackMode(const QVector<quint16>& elements, const QVector<quint
         }
         case 4://neighbor mode
         {
-            const qint32 median = Stacker::median(elements);
+            const qint32 median = StackKernels::median(elements);
             
-            ((elementsN.size() > 1) && isAllDropout[1]) ? resultN = Stacker::median(elementsN) : (elementsN.size() > 0 ? resultN = elementsN[0] : resultN = -1);
-            ((elementsS.size() > 1) && isAllDropout[2]) ? resultS = Stacker::median(elementsS) : (elementsS.size() > 0 ? resultS = elementsS[0] : resultS = -1);
+            ((elementsN.size() > 1) && isAllDropout[1]) ? resultN = StackKernels::median(elementsN) : (elementsN.size() > 0 ? resultN = elementsN[0] : resultN = -1);
+            ((elementsS.size() > 1) && isAllDropout[2]) ? resultS = StackKernels::median(elementsS) : (elementsS.size() > 0 ? resultS = elementsS[0] : resultS = -1);
             
             if(!isAllDropout[0] || (isAllDropout[1] && isAllDropout[2]))
             {
-                ((elementsE.size() > 1) && isAllDropout[3]) ? resultE = Stacker::median(elementsE) : (elementsE.size() > 0 ? resultE = elementsE[0] : resultE = -1);
-                ((elementsW.size() > 1) && isAllDropout[4]) ? resultW = Stacker::median(elementsW) : (elementsW.size() > 0 ? resultW = elementsW[0] : resultW = -1);
+                ((elementsE.size() > 1) && isAllDropout[3]) ? resultE = StackKernels::median(elementsE) : (elementsE.size() > 0 ? resultE = elementsE[0] : resultE = -1);
+                ((elementsW.size() > 1) && isAllDropout[4]) ? resultW = StackKernels::median(elementsW) : (elementsW.size() > 0 ? resultW = elementsW[0] : resultW = -1);
             }
 
             
@@ -343,12 +396,12 @@ quint16 Stacker::stackMode(const QVector<quint16>& elements, const QVector<quint
             
             if(nbNeighbor > 0)
             {
-                if(resultN > 0){closestList.append(Stacker::closest(elements, resultN));}
-                if(resultS > 0){closestList.append(Stacker::closest(elements, resultS));}
-                if(resultE > 0){closestList.append(Stacker::closest(elements, resultE));}
-                if(resultW > 0){closestList.append(Stacker::closest(elements, resultW));}
+                if(resultN > 0){closestList.append(StackKernels::closest(elements, resultN));}
+                if(resultS > 0){closestList.append(StackKernels::closest(elements, resultS));}
+                if(resultE > 0){closestList.append(StackKernels::closest(elements, resultE));}
+                if(resultW > 0){closestList.append(StackKernels::closest(elements, resultW));}
                 
-                result = Stacker::closest(closestList, median);//get the closest value to the median/mean based on closest value to a neighbor
+                result = StackKernels::closest(closestList, median);//get the closest value to the median/mean based on closest value to a neighbor
                 
                 if(nbOfElements > 2)
                 {
@@ -366,85 +419,8 @@ quint16 Stacker::stackMode(const QVector<quint16>& elements, const QVector<quint
     return static_cast<quint16>(result);
 }
 
-// Method to find the median of a vector of quint16s
-inline quint16 Stacker::median(QVector<quint16> elements)
-{
-    const qint32 noOfElements = elements.size();
-
-    if (noOfElements % 2 == 0) {
-        // Input set is even length
-
-        // Applying nth_element on n/2th index
-        std::nth_element(elements.begin(), elements.begin() + noOfElements / 2, elements.end());
-
-        // Applying nth_element on (n-1)/2 th index
-        std::nth_element(elements.begin(), elements.begin() + (noOfElements - 1) / 2, elements.end());
-
-        // Find the average of value at index N/2 and (N-1)/2
-        return static_cast<quint16>((elements[(noOfElements - 1) / 2] + elements[noOfElements / 2]) / 2.0);
-    } else {
-        // Input set is odd length
-
-        // Applying nth_element on n/2
-        std::nth_element(elements.begin(), elements.begin() + noOfElements / 2, elements.end());
-
-        // Value at index (N/2)th is the median
-        return static_cast<quint16>(elements[noOfElements / 2]);
-    }
-}
-
-// Method to find the median of a vector of quint16s
-inline qint32 Stacker::mean(const QVector<quint16>& elements)
-{
-    quint32 result = 0;
-    const qint32 nbElements = elements.size();
-    
-    if(nbElements > 1)
-    {
-        //compute mean of all values
-        for(int i=0; i < nbElements;i++)
-        {
-            if(nbElements > 1)
-            {
-                result += elements[i];
-            }
-        }
-        return (result / nbElements);
-    }
-    else if(nbElements == 1)
-    {
-        return elements[0];
-    }
-    else
-    {
-        return -1;
-    }
-    
-}
-
-// Method to find the closest value to a target
-inline quint16 Stacker::closest(const QVector<quint16>& elements, const qint32 target)
-{
-    const qint32 nbOfElements = elements.size();
-    qint32 closest = 0;
-    
-    if(nbOfElements > 0)
-    {
-        closest = elements[0];
-        for(int i=1;i < nbOfElements;i++)
-        {
-            if(abs(target - elements[i]) < abs(target - closest))
-            {
-                closest = elements[i];
-            }
-        }
-    }
-    
-    return closest;
-}
-
 // get value that are unprocessed and reuse processed one for mode >= 3
-void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<qint32>& availableSourcesForFrame, const QVector<SourceVideo::Data>& inputFields, QVector<QVector<quint16>>& tmpField, const LdDecodeMetaData::VideoParameters& videoParameters, const QVector<LdDecodeMetaData::Field>& fieldMetadata, QVector<quint16>& sample, QVector<quint16>& sampleN, QVector<quint16>& sampleS, QVector<quint16>& sampleE, QVector<quint16>& sampleW, QVector<bool>& isAllDropout, const bool& noDiffDod, const bool& verbose)
+void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<qint32>& availableSourcesForFrame, const QVector<SourceVideo::View>& inputFields, const LdDecodeMetaData::VideoParameters& videoParameters, const QVector<DropOutIndex>& dropOutIndexes, SampleSet& sample, SampleSet& sampleN, SampleSet& sampleS, SampleSet& sampleE, SampleSet& sampleW, bool *isAllDropout, const bool& noDiffDod, const bool& verbose)
 {
     quint16 pixelValue = 0;
     qint32 source = 0;
@@ -459,7 +435,7 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
             {
                 //read new value
                 pixelValue = inputFields[source][(fieldWidth * y) + x];
-                sampleIsDropout = isDropout(fieldMetadata[source].dropOuts, x, y);
+                sampleIsDropout = isDropout(dropOutIndexes[source], x, y);
                 if (!sampleIsDropout) {
                     // Pixel is valid
                     sample.append(pixelValue);
@@ -475,7 +451,7 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
                 }
                 
                 pixelValue = inputFields[source][(fieldWidth * y) + x + 1];
-                sampleIsDropout = isDropout(fieldMetadata[source].dropOuts, x+1, y);
+                sampleIsDropout = isDropout(dropOutIndexes[source], x+1, y);
                 if (!sampleIsDropout) {
                     // Pixel is valid
                     sampleE.append(pixelValue);
@@ -491,7 +467,7 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
                 }
                 
                 pixelValue = inputFields[source][(fieldWidth * (y+1)) + x];
-                sampleIsDropout = isDropout(fieldMetadata[source].dropOuts, x, y+1);
+                sampleIsDropout = isDropout(dropOutIndexes[source], x, y+1);
                 if (!sampleIsDropout) {
                     // Pixel is valid
                     sampleS.append(pixelValue);
@@ -510,7 +486,7 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
             {
                 //read new value
                 pixelValue = inputFields[source][(fieldWidth * (y+1)) + x];
-                sampleIsDropout = isDropout(fieldMetadata[source].dropOuts, x, y+1);
+                sampleIsDropout = isDropout(dropOutIndexes[source], x, y+1);
                 if (!sampleIsDropout) {
                     // Pixel is valid
                     sampleS.append(pixelValue);
@@ -529,7 +505,7 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
             {
                 //read new value
                 pixelValue = inputFields[source][(fieldWidth * y) + x + 1];
-                sampleIsDropout = isDropout(fieldMetadata[source].dropOuts, x+1, y);
+                sampleIsDropout = isDropout(dropOutIndexes[source], x+1, y);
                 if (!sampleIsDropout) {
                     // Pixel is valid
                     sampleE.append(pixelValue);
@@ -545,7 +521,7 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
                 }
                 
                 pixelValue = inputFields[source][(fieldWidth * (y+1)) + x];
-                sampleIsDropout = isDropout(fieldMetadata[source].dropOuts, x, y+1);
+                sampleIsDropout = isDropout(dropOutIndexes[source], x, y+1);
                 if (!sampleIsDropout) {
                     // Pixel is valid
                     sampleS.append(pixelValue);
@@ -567,7 +543,7 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
             {
                 //read new value
                 pixelValue = inputFields[source][(fieldWidth * (y+1)) + x];
-                sampleIsDropout = isDropout(fieldMetadata[source].dropOuts, x, y+1);
+                sampleIsDropout = isDropout(dropOutIndexes[source], x, y+1);
                 if (!sampleIsDropout) {
                     // Pixel is valid
                     sampleS.append(pixelValue);
@@ -586,7 +562,7 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
             {
                 //read new value
                 pixelValue = inputFields[source][(fieldWidth * (y+1)) + x];
-                sampleIsDropout = isDropout(fieldMetadata[source].dropOuts, x, y+1);
+                sampleIsDropout = isDropout(dropOutIndexes[source], x, y+1);
                 if (!sampleIsDropout) {
                     // Pixel is valid
                     sampleS.append(pixelValue);
@@ -605,7 +581,7 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
             {
                 //read new value
                 pixelValue = inputFields[source][(fieldWidth * (y+1)) + x];
-                sampleIsDropout = isDropout(fieldMetadata[source].dropOuts, x, y+1);
+                sampleIsDropout = isDropout(dropOutIndexes[source], x, y+1);
                 if (!sampleIsDropout) {
                     // Pixel is valid
                     sampleS.append(pixelValue);
@@ -644,9 +620,9 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
                     }
                 }
             }
-            tmpField[(fieldWidth * y) + x] = sample;
-            tmpField[(fieldWidth * y) + x + 1] = sampleE;
-            tmpField[(fieldWidth * (y+1)) + x] = sampleS;
+            tmpField.set((fieldWidth * y) + x, sample);
+            tmpField.set((fieldWidth * y) + x + 1, sampleE);
+            tmpField.set((fieldWidth * (y+1)) + x, sampleS);
         }
         else if(x == fieldWidth -1)//read south value  
         {
@@ -659,10 +635,10 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
                     }
                 }
             }
-            tmpField[(fieldWidth * (y+1)) + x] = sampleS;
-            sample = tmpField[(fieldWidth * y) + x];
-            sampleW = tmpField[(fieldWidth * y) + x - 1];
-            isAllDropout[4] = haveAllDropout(fieldMetadata,x-1,y);
+            tmpField.set((fieldWidth * (y+1)) + x, sampleS);
+            tmpField.get((fieldWidth * y) + x, sample);
+            tmpField.get((fieldWidth * y) + x - 1, sampleW);
+            isAllDropout[4] = haveAllDropout(dropOutIndexes,x-1,y);
         }
         else//read east + south
         {
@@ -678,11 +654,11 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
                     }
                 }
             }
-            tmpField[(fieldWidth * y) + x + 1] = sampleE;
-            tmpField[(fieldWidth * (y+1)) + x] = sampleS;
-            sample = tmpField[(fieldWidth * y) + x];
-            sampleW = tmpField[(fieldWidth * y) + x - 1];
-            isAllDropout[4] = haveAllDropout(fieldMetadata,x-1,y);
+            tmpField.set((fieldWidth * y) + x + 1, sampleE);
+            tmpField.set((fieldWidth * (y+1)) + x, sampleS);
+            tmpField.get((fieldWidth * y) + x, sample);
+            tmpField.get((fieldWidth * y) + x - 1, sampleW);
+            isAllDropout[4] = haveAllDropout(dropOutIndexes,x-1,y);
         }
     }
     else if(y != fieldHeight -1)//read south value
@@ -696,84 +672,77 @@ void Stacker::getProcessedSample(const qint32 x, const qint32 y, const QVector<q
                 }
             }
         }
-        tmpField[(fieldWidth * (y+1)) + x] = sampleS;
+        tmpField.set((fieldWidth * (y+1)) + x, sampleS);
         if(x == 0)
         {
-            sample = tmpField[(fieldWidth * y) + x];
-            sampleE = tmpField[(fieldWidth * y) + x + 1];
-            sampleN = tmpField[(fieldWidth * (y-1)) + x];
-            isAllDropout[1] = haveAllDropout(fieldMetadata,x,y-1);
-            isAllDropout[3] = haveAllDropout(fieldMetadata,x+1,y);
+            tmpField.get((fieldWidth * y) + x, sample);
+            tmpField.get((fieldWidth * y) + x + 1, sampleE);
+            tmpField.get((fieldWidth * (y-1)) + x, sampleN);
+            isAllDropout[1] = haveAllDropout(dropOutIndexes,x,y-1);
+            isAllDropout[3] = haveAllDropout(dropOutIndexes,x+1,y);
         }
         else if (x == fieldWidth -1)
         {
-            sample = tmpField[(fieldWidth * y) + x];
-            sampleW = tmpField[(fieldWidth * y) + x - 1];
-            sampleN = tmpField[(fieldWidth * (y-1)) + x];
-            isAllDropout[1] = haveAllDropout(fieldMetadata,x,y-1);
-            isAllDropout[4] = haveAllDropout(fieldMetadata,x-1,y);
+            tmpField.get((fieldWidth * y) + x, sample);
+            tmpField.get((fieldWidth * y) + x - 1, sampleW);
+            tmpField.get((fieldWidth * (y-1)) + x, sampleN);
+            isAllDropout[1] = haveAllDropout(dropOutIndexes,x,y-1);
+            isAllDropout[4] = haveAllDropout(dropOutIndexes,x-1,y);
         }
         else
         {
-            sample = tmpField[(fieldWidth * y) + x];
-            sampleW = tmpField[(fieldWidth * y) + x - 1];
-            sampleE = tmpField[(fieldWidth * y) + x + 1];
-            sampleN = tmpField[(fieldWidth * (y-1)) + x];
-            isAllDropout[1] = haveAllDropout(fieldMetadata,x,y-1);
-            isAllDropout[3] = haveAllDropout(fieldMetadata,x+1,y);
-            isAllDropout[4] = haveAllDropout(fieldMetadata,x-1,y);
+            tmpField.get((fieldWidth * y) + x, sample);
+            tmpField.get((fieldWidth * y) + x - 1, sampleW);
+            tmpField.get((fieldWidth * y) + x + 1, sampleE);
+            tmpField.get((fieldWidth * (y-1)) + x, sampleN);
+            isAllDropout[1] = haveAllDropout(dropOutIndexes,x,y-1);
+            isAllDropout[3] = haveAllDropout(dropOutIndexes,x+1,y);
+            isAllDropout[4] = haveAllDropout(dropOutIndexes,x-1,y);
         }
     }
     else//all value already processsed : reuse value
     {
         if(x == 0)
         {
-            sample = tmpField[(fieldWidth * y) + x];
-            sampleE = tmpField[(fieldWidth * y) + x + 1];
-            sampleN = tmpField[(fieldWidth * (y-1)) + x];
-            isAllDropout[1] = haveAllDropout(fieldMetadata,x,y-1);
-            isAllDropout[3] = haveAllDropout(fieldMetadata,x+1,y);
+            tmpField.get((fieldWidth * y) + x, sample);
+            tmpField.get((fieldWidth * y) + x + 1, sampleE);
+            tmpField.get((fieldWidth * (y-1)) + x, sampleN);
+            isAllDropout[1] = haveAllDropout(dropOutIndexes,x,y-1);
+            isAllDropout[3] = haveAllDropout(dropOutIndexes,x+1,y);
         }
         if(x == fieldWidth -1)
         {
-            sample = tmpField[(fieldWidth * y) + x];
-            sampleW = tmpField[(fieldWidth * y) + x - 1];
-            sampleN = tmpField[(fieldWidth * (y-1)) + x];
-            isAllDropout[1] = haveAllDropout(fieldMetadata,x,y-1);
-            isAllDropout[4] = haveAllDropout(fieldMetadata,x-1,y);
+            tmpField.get((fieldWidth * y) + x, sample);
+            tmpField.get((fieldWidth * y) + x - 1, sampleW);
+            tmpField.get((fieldWidth * (y-1)) + x, sampleN);
+            isAllDropout[1] = haveAllDropout(dropOutIndexes,x,y-1);
+            isAllDropout[4] = haveAllDropout(dropOutIndexes,x-1,y);
         }
         else
         {
-            sample = tmpField[(fieldWidth * y) + x];
-            sampleW = tmpField[(fieldWidth * y) + x - 1];
-            sampleE = tmpField[(fieldWidth * y) + x + 1];
-            sampleN = tmpField[(fieldWidth * (y-1)) + x];
-            isAllDropout[1] = haveAllDropout(fieldMetadata,x,y-1);
-            isAllDropout[3] = haveAllDropout(fieldMetadata,x+1,y);
-            isAllDropout[4] = haveAllDropout(fieldMetadata,x-1,y);
+            tmpField.get((fieldWidth * y) + x, sample);
+            tmpField.get((fieldWidth * y) + x - 1, sampleW);
+            tmpField.get((fieldWidth * y) + x + 1, sampleE);
+            tmpField.get((fieldWidth * (y-1)) + x, sampleN);
+            isAllDropout[1] = haveAllDropout(dropOutIndexes,x,y-1);
+            isAllDropout[3] = haveAllDropout(dropOutIndexes,x+1,y);
+            isAllDropout[4] = haveAllDropout(dropOutIndexes,x-1,y);
         }
     }
 }
 
 // Method returns true if specified pixel is a dropout
-inline bool Stacker::isDropout(const DropOuts& dropOuts, const qint32 fieldX, const qint32 fieldY)
+inline bool Stacker::isDropout(const DropOutIndex& dropOutIndex, const qint32 fieldX, const qint32 fieldY)
 {
-    for (qint32 i = 0; i < dropOuts.size(); i++) {
-        if ((dropOuts.fieldLine(i) - 1) == fieldY) {
-            if ((fieldX >= dropOuts.startx(i)) && (fieldX <= dropOuts.endx(i)))
-                return true;
-        }
-    }
-
-    return false;
+    return dropOutIndex.contains(fieldX, fieldY + 1);
 }
 
 // Method returns true if specified pixel is a dropout
-inline bool Stacker::haveAllDropout(const QVector<LdDecodeMetaData::Field>& fieldMetadata, const qint32 x, const qint32 y)
+inline bool Stacker::haveAllDropout(const QVector<DropOutIndex>& dropOutIndexes, const qint32 x, const qint32 y)
 {
-    const qint32 size = fieldMetadata.size();
+    const qint32 size = dropOutIndexes.size();
     for (qint32 i = 0; i < size; i++) {
-        if(!isDropout(fieldMetadata[i].dropOuts,x,y))
+        if(!isDropout(dropOutIndexes[i],x,y))
             return false;
     }
 
@@ -785,9 +754,9 @@ inline bool Stacker::haveAllDropout(const QVector<LdDecodeMetaData::Field>& fiel
 // might cause an increase in errors for really noisy frames (where the DOs are in the same place in
 // multiple sources).  Another possible disadvantage is that diffDOD might pass through master plate errors
 // which, whilst not technically errors, may be undesirable.
-QVector<quint16> Stacker::diffDod(const QVector<quint16>& inputValues, const LdDecodeMetaData::VideoParameters& videoParameters, const bool& verbose)
+SampleSet Stacker::diffDod(const SampleSet& inputValues, const LdDecodeMetaData::VideoParameters& videoParameters, const bool& verbose)
 {
-    QVector<quint16> outputValues;
+    SampleSet outputValues;
 
     // Check that we have at least 3 input values
     if (inputValues.size() < 3) {
@@ -795,7 +764,7 @@ QVector<quint16> Stacker::diffDod(const QVector<quint16>& inputValues, const LdD
     }
 
     // Get the median value of the input values
-    const double medianValue = static_cast<double>(median(inputValues));
+    const double medianValue = static_cast<double>(StackKernels::median(inputValues));
 
     // Set the matching threshold to +-10% of the median value
     const double threshold = 10; // %
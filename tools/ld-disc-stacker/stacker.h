@@ -30,12 +30,17 @@
 #include <QAtomicInt>
 #include <QThread>
 #include <QDebug>
+#include <vector>
 
 #include "sourcevideo.h"
 #include "lddecodemetadata.h"
+#include "dropoutindex.h"
+#include "stackkernels.h"
 
 class StackingPool;
 
+using StackKernels::SampleSet;
+
 class Stacker : public QThread
 {
     Q_OBJECT
@@ -51,17 +56,18 @@ private:
     StackingPool& stackingPool;
     QVector<LdDecodeMetaData::VideoParameters> videoParameters;
 
-    void stackField(const qint32 frameNumber,const QVector<SourceVideo::Data>& inputFields,const LdDecodeMetaData::VideoParameters& videoParameters,
+    // Working buffers, reused from field to field
+    StackKernels::SampleField tmpField;
+    QVector<quint16> stackedLine;
+
+    void stackField(const qint32 frameNumber,const QVector<SourceVideo::View>& inputFields,const LdDecodeMetaData::VideoParameters& videoParameters,
                     const QVector<LdDecodeMetaData::Field>& fieldMetadata,const QVector<qint32> availableSourcesForFrame,const bool& noDiffDod,const bool& passThrough,
                     SourceVideo::Data &outputField, DropOuts &dropOuts,const qint32& mode,const qint32& smartThreshold,const bool& verbose);
-    void getProcessedSample(const qint32 x, const qint32 y, const QVector<qint32>& availableSourcesForFrame, const QVector<SourceVideo::Data>& inputFields, QVector<QVector<quint16>>& tmpField, const LdDecodeMetaData::VideoParameters& videoParameters, const QVector<LdDecodeMetaData::Field>& fieldMetadata, QVector<quint16>& sample, QVector<quint16>& sampleN, QVector<quint16>& sampleS, QVector<quint16>& sampleE, QVector<quint16>& sampleW, QVector<bool>& isAllDropout, const bool& noDiffDod, const bool& verbose);
-    inline quint16 median(QVector<quint16> v);
-    inline qint32 mean(const QVector<quint16>& v);
-    inline quint16 closest(const QVector<quint16>& v,const qint32 target);
-    quint16 stackMode(const QVector<quint16>& elements, const QVector<quint16>& elementsN,const QVector<quint16>& elementsS,const QVector<quint16>& elementsE, const QVector<quint16>& elementsW,const QVector<bool>& isAllDropout, const qint32& mode, const qint32& smartThreshold);
-    inline bool isDropout(const DropOuts& dropOuts, const qint32 fieldX, const qint32 fieldY);
-    inline bool haveAllDropout(const QVector<LdDecodeMetaData::Field>& fieldMetadata, const qint32 x, const qint32 y);
-    QVector<quint16> diffDod(const QVector<quint16>& inputValues,const LdDecodeMetaData::VideoParameters& videoParameters,const bool& verbose);
+    void getProcessedSample(const qint32 x, const qint32 y, const QVector<qint32>& availableSourcesForFrame, const QVector<SourceVideo::View>& inputFields, const LdDecodeMetaData::VideoParameters& videoParameters, const QVector<DropOutIndex>& dropOutIndexes, SampleSet& sample, SampleSet& sampleN, SampleSet& sampleS, SampleSet& sampleE, SampleSet& sampleW, bool *isAllDropout, const bool& noDiffDod, const bool& verbose);
+    quint16 stackMode(const SampleSet& elements, const SampleSet& elementsN,const SampleSet& elementsS,const SampleSet& elementsE, const SampleSet& elementsW,const bool *isAllDropout, const qint32& mode, const qint32& smartThreshold);
+    inline bool isDropout(const DropOutIndex& dropOutIndex, const qint32 fieldX, const qint32 fieldY);
+    inline bool haveAllDropout(const QVector<DropOutIndex>& dropOutIndexes, const qint32 x, const qint32 y);
+    SampleSet diffDod(const SampleSet& inputValues,const LdDecodeMetaData::VideoParameters& videoParameters,const bool& verbose);
 };
 
 #endif // STACKER_H
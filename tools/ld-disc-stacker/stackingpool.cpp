@@ -26,10 +26,10 @@
 #include "vbidecoder.h"
 
 StackingPool::StackingPool(QString _outputFilename, QString _outputJsonFilename,
-                             qint32 _maxThreads, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
+                             qint32 _maxThreads, qint32 _prefetchMegabytes, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
                              qint32 _mode, qint32 _smartThreshold, bool _reverse, bool _noDiffDod, bool _passThrough, bool _integrityCheck, bool _verbose, QObject *parent)
     : QObject(parent), outputFilename(_outputFilename), outputJsonFilename(_outputJsonFilename),
-      maxThreads(_maxThreads), mode(_mode), smartThreshold(_smartThreshold), reverse(_reverse), noDiffDod(_noDiffDod), passThrough(_passThrough), integrityCheck(_integrityCheck), verbose(_verbose),
+      maxThreads(_maxThreads), prefetchMegabytes(_prefetchMegabytes), mode(_mode), smartThreshold(_smartThreshold), reverse(_reverse), noDiffDod(_noDiffDod), passThrough(_passThrough), integrityCheck(_integrityCheck), verbose(_verbose),
       abort(false), ldDecodeMetaData(_ldDecodeMetaData), sourceVideos(_sourceVideos)
 {
 }
@@ -86,6 +86,20 @@ bool StackingPool::process()
     skippedFrame = 0;
     totalTimer.start();
 
+    // Start reading ahead in the input files that aren't memory-mapped or
+    // stdin, if enabled (mapped sources are read directly by the workers)
+    if (prefetchMegabytes > 0) {
+        for (qint32 sourceNo = 0; sourceNo < sourceVideos.size(); sourceNo++) {
+            if (!FieldPrefetcher::isUseful(*sourceVideos[sourceNo])) {
+                fieldPrefetchers.append(nullptr);
+                continue;
+            }
+            fieldPrefetchers.append(new FieldPrefetcher(*sourceVideos[sourceNo], prefetchMegabytes,
+                                                        ldDecodeMetaData[sourceNo]->getNumberOfFields()));
+            fieldPrefetchers.last()->start();
+        }
+    }
+
     // Start a vector of decoding threads to process the video
     qInfo() << "Beginning multi-threaded disc stacking process...";
     QVector<QThread *> threads;
@@ -101,6 +115,15 @@ bool StackingPool::process()
         delete threads[i];
     }
 
+    // Stop reading ahead
+    for (qint32 sourceNo = 0; sourceNo < fieldPrefetchers.size(); sourceNo++) {
+        if (fieldPrefetchers[sourceNo] == nullptr) continue;
+        qDebug() << "StackingPool::process(): Source" << sourceNo << "prefetcher hits:" << fieldPrefetchers[sourceNo]->getHitCount()
+                 << "misses:" << fieldPrefetchers[sourceNo]->getMissCount();
+        delete fieldPrefetchers[sourceNo];
+    }
+    fieldPrefetchers.clear();
+
     // Did any of the threads abort?
     if (abort) {
         targetVideo.close();
@@ -129,8 +152,9 @@ bool StackingPool::process()
 // Returns true if a frame was returned, false if the end of the input has been
 // reached.
 bool StackingPool::getInputFrame(qint32& frameNumber,
-                                  QVector<qint32>& firstFieldNumber, QVector<SourceVideo::Data>& firstFieldVideoData, QVector<LdDecodeMetaData::Field>& firstFieldMetadata,
-                                  QVector<qint32>& secondFieldNumber, QVector<SourceVideo::Data>& secondFieldVideoData, QVector<LdDecodeMetaData::Field>& secondFieldMetadata,
+                                  QVector<qint32>& firstFieldNumber, QVector<SourceVideo::View>& firstFieldVideoData, QVector<LdDecodeMetaData::Field>& firstFieldMetadata,
+                                  QVector<qint32>& secondFieldNumber, QVector<SourceVideo::View>& secondFieldVideoData, QVector<LdDecodeMetaData::Field>& secondFieldMetadata,
+                                  QVector<SourceVideo::Data>& firstFieldBuffers, QVector<SourceVideo::Data>& secondFieldBuffers,
                                   QVector<LdDecodeMetaData::VideoParameters>& videoParameters,
                                   qint32& _mode, qint32& _smartThreshold, bool& _reverse, bool& _noDiffDod, bool& _passThrough,
                                   QVector<qint32>& availableSourcesForFrame)
@@ -155,8 +179,10 @@ bool StackingPool::getInputFrame(qint32& frameNumber,
     firstFieldNumber.resize(numberOfSources);
     firstFieldVideoData.resize(numberOfSources);
     firstFieldMetadata.resize(numberOfSources);
+    firstFieldBuffers.resize(numberOfSources);
     secondFieldNumber.resize(numberOfSources);
     secondFieldVideoData.resize(numberOfSources);
+    secondFieldBuffers.resize(numberOfSources);
     secondFieldMetadata.resize(numberOfSources);
     videoParameters.resize(numberOfSources);
 
@@ -201,11 +227,11 @@ bool StackingPool::getInputFrame(qint32& frameNumber,
         if (firstFieldNumber[sourceNo] != -1 && secondFieldNumber[sourceNo] != -1) {
             // Fetch the input data (get the fields in TBC sequence order to save seeking)
             if (firstFieldNumber[sourceNo] < secondFieldNumber[sourceNo]) {
-                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(firstFieldNumber[sourceNo]);
-                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(secondFieldNumber[sourceNo]);
+                firstFieldVideoData[sourceNo] = getVideoField(sourceNo, firstFieldNumber[sourceNo], firstFieldBuffers[sourceNo]);
+                secondFieldVideoData[sourceNo] = getVideoField(sourceNo, secondFieldNumber[sourceNo], secondFieldBuffers[sourceNo]);
             } else {
-                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(secondFieldNumber[sourceNo]);
-                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(firstFieldNumber[sourceNo]);
+                secondFieldVideoData[sourceNo] = getVideoField(sourceNo, secondFieldNumber[sourceNo], secondFieldBuffers[sourceNo]);
+                firstFieldVideoData[sourceNo] = getVideoField(sourceNo, firstFieldNumber[sourceNo], firstFieldBuffers[sourceNo]);
             }
 
             firstFieldMetadata[sourceNo] = ldDecodeMetaData[sourceNo]->getField(firstFieldNumber[sourceNo]);
@@ -254,6 +280,24 @@ bool StackingPool::getInputFrame(qint32& frameNumber,
     return true;
 }
 
+// Get a view of a whole field from a source. If the source is memory-mapped,
+// this points straight into the mapping, so no data is copied and the pages
+// are faulted in by the worker that stacks the field, outside inputMutex.
+// Otherwise, the field is read into buffer (through the source's prefetcher if
+// there is one), and the view points into that.
+// You must hold inputMutex to call this.
+SourceVideo::View StackingPool::getVideoField(qint32 sourceNo, qint32 fieldNumber, SourceVideo::Data &buffer)
+{
+    if (sourceVideos[sourceNo]->isMemoryMapped()) return sourceVideos[sourceNo]->getVideoFieldView(fieldNumber);
+
+    if (fieldPrefetchers.isEmpty() || fieldPrefetchers[sourceNo] == nullptr) {
+        buffer = sourceVideos[sourceNo]->getVideoField(fieldNumber);
+    } else {
+        buffer = fieldPrefetchers[sourceNo]->getVideoField(fieldNumber);
+    }
+    return SourceVideo::View(buffer.constData(), buffer.size());
+}
+
 // Put a corrected frame into the output stream.
 //
 // The worker threads will complete frames in an arbitrary order, so we can't
@@ -429,7 +473,7 @@ qint32 StackingPool::convertVbiFrameNumberToSequential(qint32 vbiFrameNumber, qi
     return vbiFrameNumber - sourceMinimumVbiFrame[sourceNumber] + 1;
 }
 
-bool StackingPool::isIntegrityOk(const SourceVideo::Data& inputFields,const LdDecodeMetaData::VideoParameters& videoParameters)
+bool StackingPool::isIntegrityOk(const SourceVideo::View& inputFields,const LdDecodeMetaData::VideoParameters& videoParameters)
 {
     qint32 count = 0;
     for (qint32 y = 0; y < videoParameters.fieldHeight; y++) 
@@ -31,6 +31,7 @@
 #include <QMutex>
 #include <QThread>
 
+#include "fieldprefetcher.h"
 #include "sourcevideo.h"
 #include "lddecodemetadata.h"
 #include "stacker.h"
@@ -40,15 +41,16 @@ class StackingPool : public QObject
     Q_OBJECT
 public:
     explicit StackingPool(QString _outputFilename, QString _outputJsonFilename,
-                           qint32 _maxThreads, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
+                           qint32 _maxThreads, qint32 _prefetchMegabytes, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
                            qint32 _mode, qint32 _smartThreshold, bool _reverse, bool _noDiffDod, bool _passThrough, bool _integrityCheck, bool _verbose, QObject *parent = nullptr);
 
     bool process();
 
     // Member functions used by worker threads
     bool getInputFrame(qint32& frameNumber,
-                       QVector<qint32> &firstFieldNumber, QVector<SourceVideo::Data> &firstFieldVideoData, QVector<LdDecodeMetaData::Field> &firstFieldMetadata,
-                       QVector<qint32> &secondFieldNumber, QVector<SourceVideo::Data> &secondFieldVideoData, QVector<LdDecodeMetaData::Field> &secondFieldMetadata,
+                       QVector<qint32> &firstFieldNumber, QVector<SourceVideo::View> &firstFieldVideoData, QVector<LdDecodeMetaData::Field> &firstFieldMetadata,
+                       QVector<qint32> &secondFieldNumber, QVector<SourceVideo::View> &secondFieldVideoData, QVector<LdDecodeMetaData::Field> &secondFieldMetadata,
+                       QVector<SourceVideo::Data> &firstFieldBuffers, QVector<SourceVideo::Data> &secondFieldBuffers,
                        QVector<LdDecodeMetaData::VideoParameters> &videoParameters,
                        qint32& _mode, qint32& _smartThreshold, bool& _reverse, bool &_noDiffDod, bool &_passThrough, QVector<qint32> &availableSourcesForFrame);
 
@@ -62,6 +64,7 @@ private:
     QString outputFilename;
     QString outputJsonFilename;
     qint32 maxThreads;
+    qint32 prefetchMegabytes;
     qint32 mode;
     qint32 smartThreshold;
     bool reverse;
@@ -81,6 +84,7 @@ private:
     qint32 lastFrameNumber;
     QVector<LdDecodeMetaData *> &ldDecodeMetaData;
     QVector<SourceVideo *> &sourceVideos;
+    QVector<FieldPrefetcher *> fieldPrefetchers;
 
     // Output stream information (all guarded by outputMutex while threads are running)
     QMutex outputMutex;
@@ -103,13 +107,14 @@ private:
     QVector<qint32> sourceMinimumVbiFrame;
     QVector<qint32> sourceMaximumVbiFrame;
 
+    SourceVideo::View getVideoField(qint32 sourceNo, qint32 fieldNumber, SourceVideo::Data &buffer);
     bool setMinAndMaxVbiFrames();
     qint32 convertSequentialFrameNumberToVbi(qint32 sequentialFrameNumber, qint32 sourceNumber);
     qint32 convertVbiFrameNumberToSequential(qint32 vbiFrameNumber, qint32 sourceNumber);
     QVector<qint32> getAvailableSourcesForFrame(qint32 vbiFrameNumber);
     bool writeOutputField(const SourceVideo::Data &fieldData);
     void correctPhaseIDs();
-    bool isIntegrityOk(const SourceVideo::Data& inputFields,const LdDecodeMetaData::VideoParameters& videoParameters);
+    bool isIntegrityOk(const SourceVideo::View& inputFields,const LdDecodeMetaData::VideoParameters& videoParameters);
     template<int field>
     void replaceFieldMetaData(qint32 frameNumber);
     LdDecodeMetaData &correctMetaData();
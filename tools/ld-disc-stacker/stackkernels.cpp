@@ -0,0 +1,291 @@
+/************************************************************************
+
+    stackkernels.cpp
+
+    ld-disc-stacker - Disc stacking for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-disc-stacker is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "stackkernels.h"
+
+#include <algorithm>
+
+// Number of samples the line functions process at once
+static constexpr qint32 BLOCK_SIZE = 32;
+
+// Sorting networks for 3 to 8 values [Knuth TAOCP vol. 3, 5.3.4]
+struct Comparator {
+    qint32 a;
+    qint32 b;
+};
+
+static constexpr Comparator NETWORK3[] = {
+    {0, 2}, {0, 1}, {1, 2}
+};
+static constexpr Comparator NETWORK4[] = {
+    {0, 2}, {1, 3}, {0, 1}, {2, 3}, {1, 2}
+};
+static constexpr Comparator NETWORK5[] = {
+    {0, 3}, {1, 4}, {0, 2}, {1, 3}, {0, 1}, {2, 4}, {1, 2}, {3, 4}, {2, 3}
+};
+static constexpr Comparator NETWORK6[] = {
+    {0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3}, {2, 5}, {0, 1}, {2, 3}, {4, 5}, {1, 2}, {3, 4}
+};
+static constexpr Comparator NETWORK7[] = {
+    {0, 6}, {2, 3}, {4, 5}, {0, 2}, {1, 4}, {3, 6}, {0, 1}, {2, 5}, {3, 4}, {1, 2}, {4, 6}, {2, 3},
+    {4, 5}, {1, 2}, {3, 4}, {5, 6}
+};
+static constexpr Comparator NETWORK8[] = {
+    {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}, {0, 1}, {2, 3}, {4, 5}, {6, 7},
+    {2, 4}, {3, 5}, {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}
+};
+
+// Sort values in place using a sorting network
+template <qint32 C>
+static inline void sortValues(quint16 *values, const Comparator (&network)[C])
+{
+    for (const Comparator &comparator : network) {
+        const quint16 low = std::min(values[comparator.a], values[comparator.b]);
+        const quint16 high = std::max(values[comparator.a], values[comparator.b]);
+        values[comparator.a] = low;
+        values[comparator.b] = high;
+    }
+}
+
+// Sort each column of a block of samples using a sorting network. The inner
+// loops are independent min/max operations, which vectorise; the results go
+// through temporaries so the compiler doesn't need to check the rows for aliasing.
+template <qint32 C>
+static inline void sortBlock(quint16 (*block)[BLOCK_SIZE], const Comparator (&network)[C])
+{
+    quint16 low[BLOCK_SIZE], high[BLOCK_SIZE];
+
+    for (const Comparator &comparator : network) {
+        quint16 *a = block[comparator.a];
+        quint16 *b = block[comparator.b];
+        for (qint32 i = 0; i < BLOCK_SIZE; i++) {
+            low[i] = std::min(a[i], b[i]);
+            high[i] = std::max(a[i], b[i]);
+        }
+        std::copy(low, low + BLOCK_SIZE, a);
+        std::copy(high, high + BLOCK_SIZE, b);
+    }
+}
+
+// Return the median of a sorted set of values
+static inline quint16 sortedMedian(const quint16 *values, qint32 count)
+{
+    if (count % 2 == 0) return static_cast<quint16>((values[(count / 2) - 1] + values[count / 2]) / 2);
+    return values[count / 2];
+}
+
+// SampleField --------------------------------------------------------------------------------------------------------
+
+void StackKernels::SampleField::reset(qint32 pixels, qint32 _stride)
+{
+    stride = _stride;
+    values.resize(pixels * stride);
+    counts.fill(0, pixels);
+}
+
+void StackKernels::SampleField::get(qint32 pixel, SampleSet &set) const
+{
+    set.clear();
+    const quint16 *pixelValues = values.constData() + (pixel * stride);
+    for (qint32 i = 0; i < counts[pixel]; i++) {
+        set.append(pixelValues[i]);
+    }
+}
+
+void StackKernels::SampleField::set(qint32 pixel, const SampleSet &set)
+{
+    Q_ASSERT(set.size() <= stride);
+    std::copy(set.begin(), set.end(), values.data() + (pixel * stride));
+    counts[pixel] = set.size();
+}
+
+// Per-pixel functions ------------------------------------------------------------------------------------------------
+
+// Return the median of a set of values (for an even-sized set, the mean of the middle two)
+quint16 StackKernels::median(const SampleSet &elements)
+{
+    const qint32 count = elements.size();
+    if (count == 0) return 0;
+
+    quint16 values[MAX_SOURCES];
+    std::copy(elements.begin(), elements.end(), values);
+
+    switch (count) {
+    case 1:
+        return values[0];
+    case 2:
+        return sortedMedian(values, 2);
+    case 3:
+        sortValues(values, NETWORK3);
+        break;
+    case 4:
+        sortValues(values, NETWORK4);
+        break;
+    case 5:
+        sortValues(values, NETWORK5);
+        break;
+    case 6:
+        sortValues(values, NETWORK6);
+        break;
+    case 7:
+        sortValues(values, NETWORK7);
+        break;
+    case 8:
+        sortValues(values, NETWORK8);
+        break;
+    default:
+        // Only the middle values need to be in place
+        std::nth_element(values, values + (count / 2), values + count);
+        if (count % 2 == 0) {
+            std::nth_element(values, values + ((count - 1) / 2), values + (count / 2));
+        }
+        break;
+    }
+
+    return sortedMedian(values, count);
+}
+
+// Return the mean of a set of values, or -1 if the set is empty
+qint32 StackKernels::mean(const SampleSet &elements)
+{
+    if (elements.isEmpty()) return -1;
+
+    quint32 result = 0;
+    for (quint16 value : elements) result += value;
+    return result / elements.size();
+}
+
+// Return the value closest to target (or 0 if the set is empty)
+quint16 StackKernels::closest(const SampleSet &elements, qint32 target)
+{
+    if (elements.isEmpty()) return 0;
+
+    qint32 result = elements[0];
+    for (qint32 i = 1; i < elements.size(); i++) {
+        if (qAbs(target - elements[i]) < qAbs(target - result)) result = elements[i];
+    }
+    return static_cast<quint16>(result);
+}
+
+// Line functions -----------------------------------------------------------------------------------------------------
+
+// Median of N sources, using a sorting network on blocks of samples
+template <qint32 N, qint32 C>
+static void medianLineNetwork(const quint16 *const *lines, qint32 start, qint32 end, quint16 *output,
+                              const Comparator (&network)[C])
+{
+    // Lanes past the end of the last block are sorted too, so they must be initialised
+    quint16 block[N][BLOCK_SIZE] = {};
+
+    for (qint32 x = start; x < end; x += BLOCK_SIZE) {
+        const qint32 width = std::min(BLOCK_SIZE, end - x);
+        for (qint32 n = 0; n < N; n++) {
+            std::copy(lines[n] + x, lines[n] + x + width, block[n]);
+        }
+
+        sortBlock(block, network);
+
+        for (qint32 i = 0; i < width; i++) {
+            if (N % 2 == 0) output[x + i] = static_cast<quint16>((block[(N / 2) - 1][i] + block[N / 2][i]) / 2);
+            else output[x + i] = block[N / 2][i];
+        }
+    }
+}
+
+void StackKernels::medianLine(const quint16 *const *lines, qint32 count, qint32 start, qint32 end, quint16 *output)
+{
+    switch (count) {
+    case 3:
+        medianLineNetwork<3>(lines, start, end, output, NETWORK3);
+        return;
+    case 4:
+        medianLineNetwork<4>(lines, start, end, output, NETWORK4);
+        return;
+    case 5:
+        medianLineNetwork<5>(lines, start, end, output, NETWORK5);
+        return;
+    case 6:
+        medianLineNetwork<6>(lines, start, end, output, NETWORK6);
+        return;
+    case 7:
+        medianLineNetwork<7>(lines, start, end, output, NETWORK7);
+        return;
+    case 8:
+        medianLineNetwork<8>(lines, start, end, output, NETWORK8);
+        return;
+    default:
+        break;
+    }
+
+    // Other source counts are done one sample at a time
+    SampleSet elements;
+    for (qint32 x = start; x < end; x++) {
+        elements.clear();
+        for (qint32 n = 0; n < count; n++) elements.append(lines[n][x]);
+        output[x] = median(elements);
+    }
+}
+
+void StackKernels::meanLine(const quint16 *const *lines, qint32 count, qint32 start, qint32 end, quint16 *output)
+{
+    for (qint32 x = start; x < end; x++) {
+        quint32 result = 0;
+        for (qint32 n = 0; n < count; n++) result += lines[n][x];
+        output[x] = static_cast<quint16>(result / count);
+    }
+}
+
+// Mean of the values within smartThreshold of the median (or the median, if there are none)
+void StackKernels::smartMeanLine(const quint16 *const *lines, qint32 count, qint32 start, qint32 end,
+                                 qint32 smartThreshold, quint16 *output)
+{
+    medianLine(lines, count, start, end, output);
+
+    for (qint32 x = start; x < end; x++) {
+        const qint32 median = output[x];
+        quint32 result = 0;
+        qint32 nbSelected = 0;
+        for (qint32 n = 0; n < count; n++) {
+            const qint32 value = lines[n][x];
+            if (value < (median + smartThreshold) && value > (median - smartThreshold)) {
+                result += value;
+                nbSelected++;
+            }
+        }
+        if (nbSelected != 0) output[x] = static_cast<quint16>(result / nbSelected);
+    }
+}
+
+QDebug operator<<(QDebug dbg, const StackKernels::SampleSet &set)
+{
+    QDebugStateSaver saver(dbg);
+    dbg.nospace() << "SampleSet(";
+    for (qint32 i = 0; i < set.size(); i++) {
+        if (i != 0) dbg << ", ";
+        dbg << set[i];
+    }
+    dbg << ')';
+
+    return dbg;
+}
@@ -0,0 +1,178 @@
+/************************************************************************
+
+    teststackkernels.cpp
+
+    ld-disc-stacker - Disc stacking for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-disc-stacker is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "stackkernels.h"
+
+using StackKernels::SampleSet;
+
+// The original median, using std::nth_element on a copy of the values
+static quint16 referenceMedian(std::vector<quint16> elements)
+{
+    const qint32 noOfElements = static_cast<qint32>(elements.size());
+
+    if (noOfElements % 2 == 0) {
+        std::nth_element(elements.begin(), elements.begin() + noOfElements / 2, elements.end());
+        std::nth_element(elements.begin(), elements.begin() + (noOfElements - 1) / 2, elements.end());
+        return static_cast<quint16>((elements[(noOfElements - 1) / 2] + elements[noOfElements / 2]) / 2.0);
+    } else {
+        std::nth_element(elements.begin(), elements.begin() + noOfElements / 2, elements.end());
+        return elements[noOfElements / 2];
+    }
+}
+
+// The original smart mean (stacking mode 2)
+static quint16 referenceSmartMean(const std::vector<quint16> &elements, qint32 smartThreshold)
+{
+    const qint32 median = referenceMedian(elements);
+    quint32 result = 0;
+    qint32 nbSelected = 0;
+    for (quint16 value : elements) {
+        if (value < (median + smartThreshold) && value > (median - smartThreshold)) {
+            nbSelected++;
+            result += value;
+        }
+    }
+    return static_cast<quint16>(nbSelected == 0 ? median : result / nbSelected);
+}
+
+// Compare the per-pixel and line functions against the original versions,
+// for every supported number of sources
+static void testSourceCount(std::mt19937 &random, qint32 count)
+{
+    const qint32 width = 1135;
+    const qint32 smartThreshold = 15 * 256;
+
+    // Mostly similar values, with some outliers and repeats, so that the
+    // smart mean selects some but not all of them
+    std::uniform_int_distribution<qint32> base(0, 65535 - 8192);
+    std::uniform_int_distribution<qint32> noise(0, 8191);
+    std::uniform_int_distribution<qint32> choice(0, 15);
+    std::vector<std::vector<quint16>> lines(count, std::vector<quint16>(width));
+    for (qint32 x = 0; x < width; x++) {
+        const qint32 level = base(random);
+        for (qint32 n = 0; n < count; n++) {
+            const qint32 c = choice(random);
+            if (c == 0) lines[n][x] = static_cast<quint16>(random() & 0xFFFF);
+            else if (c == 1 && n > 0) lines[n][x] = lines[n - 1][x];
+            else lines[n][x] = static_cast<quint16>(level + noise(random));
+        }
+    }
+
+    std::vector<const quint16 *> linePointers(count);
+    for (qint32 n = 0; n < count; n++) linePointers[n] = lines[n].data();
+
+    // Use an odd range, so the partial last block is exercised
+    const qint32 start = 3;
+    const qint32 end = width - 5;
+    std::vector<quint16> medianOutput(width), meanOutput(width), smartOutput(width);
+    StackKernels::medianLine(linePointers.data(), count, start, end, medianOutput.data());
+    StackKernels::meanLine(linePointers.data(), count, start, end, meanOutput.data());
+    StackKernels::smartMeanLine(linePointers.data(), count, start, end, smartThreshold, smartOutput.data());
+
+    for (qint32 x = start; x < end; x++) {
+        std::vector<quint16> elements;
+        SampleSet set;
+        quint32 sum = 0;
+        for (qint32 n = 0; n < count; n++) {
+            elements.push_back(lines[n][x]);
+            set.append(lines[n][x]);
+            sum += lines[n][x];
+        }
+
+        const quint16 expectedMedian = referenceMedian(elements);
+        if (StackKernels::median(set) != expectedMedian || medianOutput[x] != expectedMedian) {
+            fprintf(stderr, "median mismatch for %d sources at %d: %d/%d != %d\n", count, x,
+                    StackKernels::median(set), medianOutput[x], expectedMedian);
+            exit(1);
+        }
+
+        const quint16 expectedMean = static_cast<quint16>(sum / count);
+        if (StackKernels::mean(set) != expectedMean || meanOutput[x] != expectedMean) {
+            fprintf(stderr, "mean mismatch for %d sources at %d\n", count, x);
+            exit(1);
+        }
+
+        if (smartOutput[x] != referenceSmartMean(elements, smartThreshold)) {
+            fprintf(stderr, "smart mean mismatch for %d sources at %d\n", count, x);
+            exit(1);
+        }
+    }
+}
+
+static void testClosest()
+{
+    SampleSet set;
+    assert(StackKernels::closest(set, 100) == 0);
+
+    set.append(10);
+    set.append(200);
+    set.append(95);
+    set.append(105);
+    assert(StackKernels::closest(set, 100) == 95);
+    assert(StackKernels::closest(set, 150) == 105);
+    assert(StackKernels::closest(set, 60000) == 200);
+}
+
+static void testSampleField()
+{
+    StackKernels::SampleField field;
+    field.reset(4, 3);
+
+    SampleSet set;
+    field.get(2, set);
+    assert(set.isEmpty());
+
+    set.append(1);
+    set.append(2);
+    field.set(2, set);
+
+    SampleSet result;
+    result.append(99);
+    field.get(2, result);
+    assert(result.size() == 2 && result[0] == 1 && result[1] == 2);
+
+    // Resetting clears the sets
+    field.reset(4, 3);
+    field.get(2, result);
+    assert(result.isEmpty());
+}
+
+int main()
+{
+    std::mt19937 random(42);
+    for (qint32 count = 1; count <= StackKernels::MAX_SOURCES; count++) {
+        testSourceCount(random, count);
+    }
+    testClosest();
+    testSampleField();
+
+    fprintf(stderr, "Tests passed\n");
+    return 0;
+}
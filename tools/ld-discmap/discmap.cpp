@@ -592,13 +592,64 @@ void DiscMap::sort()
     // pull-downs are sorted following the preceeding numbered frame (which should keep
     // them in the right place).
     //
-    // Note that the stuct has an overloaded < operator that controls the sort comparison
-    // (see the .h file)
-    std::sort(m_frames.begin(), m_frames.end());
+    // This is the same order as the overloaded < operator on Frame (see the .h file), but
+    // built from the VBI index in linear time; frames that compare equal stay in their
+    // current order
+    const VbiIndex index = buildVbiIndex();
+
+    std::vector<Frame> sortedFrames;
+    sortedFrames.reserve(m_frames.size());
+    for (qint32 group = 0; group < index.numberOfGroups(); group++) {
+        for (qint32 i = index.groupStart[group]; i < index.groupStart[group + 1]; i++) {
+            if (!m_frames[index.frames[i]].isPullDown()) sortedFrames.push_back(m_frames[index.frames[i]]);
+        }
+        for (qint32 i = index.groupStart[group]; i < index.groupStart[group + 1]; i++) {
+            if (m_frames[index.frames[i]].isPullDown()) sortedFrames.push_back(m_frames[index.frames[i]]);
+        }
+    }
+    m_frames.swap(sortedFrames);
 
     m_numberOfFrames = m_frames.size();
 }
 
+// Build an index of the frames in the disc map by VBI frame number.  This takes
+// a single pass over the disc map (plus sorting the distinct frame numbers), so
+// callers can find all the frames with a given number without rescanning the map
+DiscMap::VbiIndex DiscMap::buildVbiIndex() const
+{
+    VbiIndex index;
+
+    // Count the frames with each VBI frame number
+    QHash<qint32, qint32> groupPosition;
+    groupPosition.reserve(static_cast<qint32>(m_frames.size()));
+    for (const Frame &frame : m_frames) groupPosition[frame.vbiFrameNumber()]++;
+
+    // Put the groups in VBI frame number order
+    index.vbiFrameNumbers.reserve(groupPosition.size());
+    for (auto it = groupPosition.constBegin(); it != groupPosition.constEnd(); ++it) {
+        index.vbiFrameNumbers.append(it.key());
+    }
+    std::sort(index.vbiFrameNumbers.begin(), index.vbiFrameNumbers.end());
+
+    // Work out where each group starts, then fill in the frames in disc map order
+    index.groupStart.reserve(index.vbiFrameNumbers.size() + 1);
+    qint32 position = 0;
+    for (qint32 vbiFrameNumber : index.vbiFrameNumbers) {
+        index.groupStart.append(position);
+        const qint32 groupSize = groupPosition[vbiFrameNumber];
+        groupPosition[vbiFrameNumber] = position;
+        position += groupSize;
+    }
+    index.groupStart.append(position);
+
+    index.frames.resize(position);
+    for (qint32 frameNumber = 0; frameNumber < static_cast<qint32>(m_frames.size()); frameNumber++) {
+        index.frames[groupPosition[m_frames[frameNumber].vbiFrameNumber()]++] = frameNumber;
+    }
+
+    return index;
+}
+
 // Method to output frame debug for a frame number in the disc map
 void DiscMap::debugFrameDetails(qint32 frameNumber)
 {
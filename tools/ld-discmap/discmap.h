@@ -28,7 +28,9 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QFileInfo>
+#include <QHash>
 #include <QtMath>
+#include <QVector>
 
 // TBC library includes
 #include "lddecodemetadata.h"
@@ -46,6 +48,20 @@ public:
 
     DiscMap(const QFileInfo &metadataFileInfo, const bool reverseFieldOrder, const bool noStrict);
 
+    // The frames in the disc map grouped by VBI frame number (see buildVbiIndex)
+    struct VbiIndex {
+        // The distinct VBI frame numbers, in ascending order
+        QVector<qint32> vbiFrameNumbers;
+
+        // The frames with VBI frame number vbiFrameNumbers[i] are
+        // frames[groupStart[i]] to frames[groupStart[i + 1] - 1], in disc map order
+        QVector<qint32> groupStart;
+        QVector<qint32> frames;
+
+        qint32 numberOfGroups() const { return vbiFrameNumbers.size(); }
+        qint32 groupSize(qint32 group) const { return groupStart[group + 1] - groupStart[group]; }
+    };
+
     QString filename() const;
     bool valid() const;
     qint32 numberOfFrames() const;
@@ -70,6 +86,7 @@ public:
     void setMarkedForDeletion(qint32 frameNumber);
     qint32 flush();
     void sort();
+    VbiIndex buildVbiIndex() const;
     void debugFrameDetails(qint32 frameNumber);
     void addPadding(qint32 startFrame, qint32 numberOfFrames);
     qint32 getVideoFieldLength();
@@ -326,65 +326,47 @@ void DiscMapper::correctVbiFrameNumbersUsingSequenceAnalysis(DiscMap &discMap)
 void DiscMapper::removeDuplicateNumberedFrames(DiscMap &discMap)
 {
     qInfo() << "Searching for duplicate frames";
-    qDebug() << "Building list of VBIs that have more than one entry in the discmap...";
-    QVector<qint32> duplicatedFrameList;
-    duplicatedFrameList.reserve(discMap.numberOfFrames()); // just to speed things up a little
-    for (qint32 frameNumber = 0; frameNumber < discMap.numberOfFrames(); frameNumber++) {
-        if (!discMap.isPulldown(frameNumber)) {
-            for (qint32 i = frameNumber + 1; i < discMap.numberOfFrames(); i++) {
-                // Does the current frameNumber have a duplicate?
-                if (discMap.vbiFrameNumber(frameNumber) == discMap.vbiFrameNumber(i) && !discMap.isPulldown(i)) {
-                    duplicatedFrameList.append(discMap.vbiFrameNumber(frameNumber));
-                }
-            }
+    qDebug() << "Indexing the discmap by VBI frame number...";
+    const DiscMap::VbiIndex vbiIndex = discMap.buildVbiIndex();
+
+    // Find the VBI frame numbers that have more than one (non-pulldown) entry in the discmap
+    QVector<qint32> duplicatedGroups;
+    for (qint32 group = 0; group < vbiIndex.numberOfGroups(); group++) {
+        qint32 numberedFrames = 0;
+        for (qint32 i = vbiIndex.groupStart[group]; i < vbiIndex.groupStart[group + 1]; i++) {
+            if (!discMap.isPulldown(vbiIndex.frames[i])) numberedFrames++;
         }
+        if (numberedFrames > 1) duplicatedGroups.append(group);
     }
 
-    qDebug() << "Sorting the duplicated frame list into numerical order...";
-    std::sort(duplicatedFrameList.begin(), duplicatedFrameList.end());
-    qDebug() << "Removing any repeated frame numbers from the duplicated frame list...";
-    auto last = std::unique(duplicatedFrameList.begin(), duplicatedFrameList.end());
-    duplicatedFrameList.erase(last, duplicatedFrameList.end());
-
-    qDebug() << "Found" << duplicatedFrameList.size() << "VBI frame numbers with more than 1 entry in the discmap";
-
-    // The duplicated frame list is a list of VBI frame numbers that have duplicates
+    qDebug() << "Found" << duplicatedGroups.size() << "VBI frame numbers with more than 1 entry in the discmap";
 
     // Process the list of duplications one by one
-    for (qint32 i = 0; i < duplicatedFrameList.size(); i++) {
-        if (duplicatedFrameList[i] != -1) {
-            qDebug() << "VBI Frame number" << duplicatedFrameList[i] << "has duplicates; searching for them...";
-            QVector<qint32> discMapDuplicateAddress;
-            for (qint32 frameNumber = 0; frameNumber < discMap.numberOfFrames(); frameNumber++) {
-                // Does the current frameNumber's VBI match the VBI in the duplicated frame list?
-                if (discMap.vbiFrameNumber(frameNumber) == duplicatedFrameList[i]) {
-                    // Add the frame number ot the duplicate disc map address list
-                    discMapDuplicateAddress.append(frameNumber);
-//                    qDebug() << "  Seq frame" << discMap.seqFrameNumber(frameNumber) << "is a duplicate of" <<
-//                                duplicatedFrameList[i] <<
-//                                "with a quality of" << discMap.frameQuality(frameNumber);
-                }
-            }
+    for (qint32 group : duplicatedGroups) {
+        const qint32 vbiFrameNumber = vbiIndex.vbiFrameNumbers[group];
+        if (vbiFrameNumber != -1) {
+            // The index lists every frame in the discmap with this VBI frame number
+            const qint32 *discMapDuplicateAddress = vbiIndex.frames.constData() + vbiIndex.groupStart[group];
+            const qint32 numberOfDuplicates = vbiIndex.groupSize(group);
 
             // Show the number of duplicates in the discMap that were found
-            qDebug() << "  Found" << discMapDuplicateAddress.size() << "duplicates of VBI frame" << duplicatedFrameList[i];
+            qDebug() << "  Found" << numberOfDuplicates << "duplicates of VBI frame" << vbiFrameNumber;
 
             // Pick the sequential frame duplicate with the best quality
-            qint32 bestDiscMapFrame = discMapDuplicateAddress.first();
-            for (qint32 i = 0; i < discMapDuplicateAddress.size(); i++) {
+            qint32 bestDiscMapFrame = discMapDuplicateAddress[0];
+            for (qint32 i = 0; i < numberOfDuplicates; i++) {
                 if (discMap.frameQuality(bestDiscMapFrame) < discMap.frameQuality(discMapDuplicateAddress[i])) {
                     bestDiscMapFrame = discMapDuplicateAddress[i];
                 }
             }
 
-            qDebug() << "  Highest quality duplicate of VBI" << duplicatedFrameList[i] << "is sequential frame" <<
+            qDebug() << "  Highest quality duplicate of VBI" << vbiFrameNumber << "is sequential frame" <<
                         discMap.seqFrameNumber(bestDiscMapFrame) << "with a quality of" << discMap.frameQuality(bestDiscMapFrame);
 
             // Delete all duplicates except the best sequential frame
-            for (qint32 i = 0; i < discMapDuplicateAddress.size(); i++) {
+            for (qint32 i = 0; i < numberOfDuplicates; i++) {
                 if (discMapDuplicateAddress[i] != bestDiscMapFrame) {
                     discMap.setMarkedForDeletion(discMapDuplicateAddress[i]);
-                    //qDebug() << " Seq. frame" << discMap.seqFrameNumber(discMapDuplicateAddress[i]) << "marked for deletion";
                 }
             }
         } else {
@@ -637,15 +619,25 @@ void DiscMapper::deleteUnmappableFrames(DiscMap &discMap)
 }
 
 // Method to save the current disc map
+//
+// The output is planned first, as a list of ranges of the input files, and then
+// copied with SpanCopier (which reads the input in file order rather than seeking
+// for every field)
 bool DiscMapper::saveDiscMap(DiscMap &discMap)
 {
     // Open the input video file
-    SourceVideo sourceVideo;
-    sourceVideo.open(inputFileInfo.filePath(), discMap.getVideoFieldLength());
+    QFile sourceVideo(inputFileInfo.filePath());
+    if (!sourceVideo.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        // Could not open source video file
+        qInfo() << "Cannot open source video file:" << inputFileInfo.filePath();
+        return false;
+    }
+    const qint64 fieldByteLength = static_cast<qint64>(discMap.getVideoFieldLength()) * 2;
+    const qint64 availableFields = sourceVideo.size() / fieldByteLength;
 
     // Open the output video file
     QFile targetVideo(outputFileInfo.filePath());
-    if (!targetVideo.open(QIODevice::WriteOnly)) {
+    if (!targetVideo.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
         // Could not open target video file
         qInfo() << "Cannot open target video file:" << outputFileInfo.filePath();
         sourceVideo.close();
@@ -653,16 +645,16 @@ bool DiscMapper::saveDiscMap(DiscMap &discMap)
     }
 
     // Initialise the input audio file
-    SourceAudio sourceAudio;
+    QFile sourceAudio;
     QFile targetAudio;
 
     if (!noAudio) {
         // Open the input audio file
-        if (!sourceAudio.open(inputFileInfo)) {
+        sourceAudio.setFileName(inputFileInfo.absolutePath() + "/" + inputFileInfo.completeBaseName() + ".pcm");
+        if (!sourceAudio.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
             // Could not open input audio file
-            qInfo() << "Cannot open source audio file:" << inputFileInfo.absolutePath() + "/" + inputFileInfo.completeBaseName() + ".pcm";
+            qInfo() << "Cannot open source audio file:" << sourceAudio.fileName();
             sourceVideo.close();
-            sourceAudio.close();
             return false;
         }
 
@@ -674,7 +666,7 @@ bool DiscMapper::saveDiscMap(DiscMap &discMap)
             sourceAudio.close();
             return false;
         }
-        if (!targetAudio.open(QIODevice::WriteOnly)) {
+        if (!targetAudio.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
             // Could not open target audio file
             qInfo() << "Cannot open target audio file:" << targetAudio.fileName();
             sourceVideo.close();
@@ -683,48 +675,40 @@ bool DiscMapper::saveDiscMap(DiscMap &discMap)
         }
     }
 
-    // Make a dummy video field to use when outputting padded frames
-    SourceVideo::Data missingFieldData;
-    missingFieldData.fill(0, discMap.getVideoFieldLength());
-
-    // Make a dummy audio field to use when outputting padded frames
-    SourceAudio::Data missingFieldAudioData;
-    missingFieldAudioData.fill(0, discMap.getApproximateAudioFieldLength());
-
-    // Create the output video file
-    SourceVideo::Data sourceFirstField;
-    SourceVideo::Data sourceSecondField;
-    SourceAudio::Data sourceAudioFirstField;
-    SourceAudio::Data sourceAudioSecondField;
+    // Padded frames are written as zeros; audio is approximately one field's worth
+    // of 16-bit samples per field
+    const qint64 missingFieldAudioByteLength = static_cast<qint64>(discMap.getApproximateAudioFieldLength()) * 2;
 
-    qInfo() << "Saving target video frames...";
-    qint32 notifyInterval = discMap.numberOfFrames() / 50;
-    if (notifyInterval < 1) notifyInterval = 1;
+    // Plan the output
+    qInfo() << "Planning target video frames...";
+    SpanCopier videoCopier(sourceVideo, targetVideo);
+    SpanCopier audioCopier(sourceAudio, targetAudio);
 
     for (qint32 frameNumber = 0; frameNumber < discMap.numberOfFrames(); frameNumber++) {
-        bool writeFail = false;
-
         // Is the current frameNumber a real frame or a padded frame?
         if (!discMap.isPadded(frameNumber)) {
             // Real frame
             qint32 firstFieldNumber = discMap.getFirstFieldNumber(frameNumber);
             qint32 secondFieldNumber = discMap.getSecondFieldNumber(frameNumber);
-            sourceFirstField = sourceVideo.getVideoField(firstFieldNumber);
-            sourceSecondField = sourceVideo.getVideoField(secondFieldNumber);
+
+            if (firstFieldNumber < 1 || firstFieldNumber > availableFields
+                || secondFieldNumber < 1 || secondFieldNumber > availableFields) {
+                qWarning() << "Frame number" << frameNumber << "refers to fields" << firstFieldNumber << "and" <<
+                              secondFieldNumber << "which are not in the source TBC file";
+                targetVideo.close();
+                sourceVideo.close();
+                return false;
+            }
 
             // Write the fields into the output TBC file in the same order as the source file
+            const qint64 firstFieldStart = (firstFieldNumber - 1) * fieldByteLength;
+            const qint64 secondFieldStart = (secondFieldNumber - 1) * fieldByteLength;
             if (firstFieldNumber < secondFieldNumber) {
-                // Save the first field and then second field to the output file
-                if (!targetVideo.write(reinterpret_cast<const char *>(sourceFirstField.data()),
-                                       sourceFirstField.size() * 2)) writeFail = true;
-                if (!targetVideo.write(reinterpret_cast<const char *>(sourceSecondField.data()),
-                                       sourceSecondField.size() * 2)) writeFail = true;
+                videoCopier.addCopy(firstFieldStart, fieldByteLength);
+                videoCopier.addCopy(secondFieldStart, fieldByteLength);
             } else {
-                // Save the second field and then first field to the output file
-                if (!targetVideo.write(reinterpret_cast<const char *>(sourceSecondField.data()),
-                                       sourceSecondField.size() * 2)) writeFail = true;
-                if (!targetVideo.write(reinterpret_cast<const char *>(sourceFirstField.data()),
-                                       sourceFirstField.size() * 2)) writeFail = true;
+                videoCopier.addCopy(secondFieldStart, fieldByteLength);
+                videoCopier.addCopy(firstFieldStart, fieldByteLength);
             }
 
             // Save the audio (not field order dependent)
@@ -732,17 +716,11 @@ bool DiscMapper::saveDiscMap(DiscMap &discMap)
                 // Ensure there is audio to read from the first and second fields
                 if ((discMap.getFirstFieldAudioDataLength(frameNumber) > 0) &&
                         (discMap.getSecondFieldAudioDataLength(frameNumber) > 0)) {
-                    // Read the audio
-                    sourceAudioFirstField = sourceAudio.getAudioData(discMap.getFirstFieldAudioDataStart(frameNumber),
-                                                                     discMap.getFirstFieldAudioDataLength(frameNumber));
-                    sourceAudioSecondField = sourceAudio.getAudioData(discMap.getSecondFieldAudioDataStart(frameNumber),
-                                                                      discMap.getSecondFieldAudioDataLength(frameNumber));
-
-                    // Write the audio
-                    if (!targetAudio.write(reinterpret_cast<const char *>(sourceAudioFirstField.data()),
-                                           sourceAudioFirstField.size() * 2)) writeFail = true;
-                    if (!targetAudio.write(reinterpret_cast<const char *>(sourceAudioSecondField.data()),
-                                           sourceAudioSecondField.size() * 2)) writeFail = true;
+                    // Audio is stereo 16-bit sample pairs (4 bytes per sample)
+                    audioCopier.addCopy(static_cast<qint64>(discMap.getFirstFieldAudioDataStart(frameNumber)) * 4,
+                                        static_cast<qint64>(discMap.getFirstFieldAudioDataLength(frameNumber)) * 4);
+                    audioCopier.addCopy(static_cast<qint64>(discMap.getSecondFieldAudioDataStart(frameNumber)) * 4,
+                                        static_cast<qint64>(discMap.getSecondFieldAudioDataLength(frameNumber)) * 4);
                 } else {
                     if (discMap.getFirstFieldAudioDataLength(frameNumber) < 1) {
                         qInfo() << "Warning: Input file seems to have zero audio data in the first field of frame number #" << frameNumber;
@@ -756,33 +734,19 @@ bool DiscMapper::saveDiscMap(DiscMap &discMap)
             }
         } else {
             // Padded frame - write two dummy fields
-            if (!targetVideo.write(reinterpret_cast<const char *>(missingFieldData.data()),
-                                   missingFieldData.size() * 2)) writeFail = true;
-            if (!targetVideo.write(reinterpret_cast<const char *>(missingFieldData.data()),
-                                   missingFieldData.size() * 2)) writeFail = true;
-
-            if (!noAudio) {
-                // Write the padded audio
-                if (!targetAudio.write(reinterpret_cast<const char *>(missingFieldAudioData.data()),
-                                       missingFieldAudioData.size() * 2)) writeFail = true;
-                if (!targetAudio.write(reinterpret_cast<const char *>(missingFieldAudioData.data()),
-                                       missingFieldAudioData.size() * 2)) writeFail = true;
-            }
-        }
-
-        // Notify user
-        if (frameNumber % notifyInterval == 0) {
-            qInfo() << "Written frame" << frameNumber << "of" << discMap.numberOfFrames();
+            videoCopier.addZeros(2 * fieldByteLength);
+            if (!noAudio) audioCopier.addZeros(2 * missingFieldAudioByteLength);
         }
+    }
 
-        // Was the write successful?
-        if (writeFail) {
-            // Could not write to target TBC file
-            qWarning() << "Writing fields to the target TBC file failed on frame number" << frameNumber;
-            targetVideo.close();
-            sourceVideo.close();
-            return false;
-        }
+    // Copy the video
+    qInfo() << "Saving target video frames...";
+    if (!videoCopier.run("target video")) {
+        // Could not write to target TBC file
+        qWarning() << "Writing fields to the target TBC file failed";
+        targetVideo.close();
+        sourceVideo.close();
+        return false;
     }
     qInfo() << discMap.numberOfFrames() << "video frames saved";
 
@@ -790,8 +754,15 @@ bool DiscMapper::saveDiscMap(DiscMap &discMap)
     targetVideo.close();
     sourceVideo.close();
 
-    // Close the source and target audio files
+    // Copy the audio
     if (!noAudio) {
+        if (!audioCopier.run("target audio")) {
+            qWarning() << "Writing the target audio file failed";
+            targetAudio.close();
+            sourceAudio.close();
+            return false;
+        }
+
         qInfo() << "Target audio frames saved";
         targetAudio.close();
         sourceAudio.close();
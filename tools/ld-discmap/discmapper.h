@@ -31,11 +31,10 @@
 #include <QFile>
 
 // TBC library includes
-#include "sourcevideo.h"
-#include "sourceaudio.h"
 #include "lddecodemetadata.h"
 
 #include "discmap.h"
+#include "spancopier.h"
 
 class DiscMapper
 {
@@ -0,0 +1,209 @@
+/************************************************************************
+
+    spancopier.cpp
+
+    ld-discmap - TBC and VBI alignment and correction
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-discmap is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "spancopier.h"
+
+#include <algorithm>
+#include <cstring>
+
+SpanCopier::SpanCopier(QFile &_sourceFile, QFile &_targetFile)
+    : sourceFile(_sourceFile), targetFile(_targetFile), totalLength(0)
+{
+}
+
+void SpanCopier::addCopy(qint64 sourceOffset, qint64 length)
+{
+    if (length <= 0) return;
+    totalLength += length;
+
+    // Extend the previous span if this follows on from it in the source
+    if (!spans.isEmpty() && spans.last().sourceOffset != -1
+        && spans.last().sourceOffset + spans.last().length == sourceOffset) {
+        spans.last().length += length;
+        return;
+    }
+
+    spans.append(Span { sourceOffset, length });
+}
+
+void SpanCopier::addZeros(qint64 length)
+{
+    if (length <= 0) return;
+    totalLength += length;
+
+    if (!spans.isEmpty() && spans.last().sourceOffset == -1) {
+        spans.last().length += length;
+        return;
+    }
+
+    spans.append(Span { -1, length });
+}
+
+qint64 SpanCopier::getTotalLength() const
+{
+    return totalLength;
+}
+
+bool SpanCopier::run(const QString &description)
+{
+    qDebug().nospace() << "SpanCopier::run(): Copying " << totalLength << " bytes in " << spans.size() << " spans for " << description;
+
+    const qint64 windowSize = std::min(WINDOW_BYTES, std::max(totalLength, static_cast<qint64>(1)));
+    for (qint32 i = 0; i < 2; i++) {
+        windows[i].resize(windowSize);
+        windowLength[i] = 0;
+    }
+    readFinished = false;
+    writeFailed = false;
+
+    WriterThread writerThread(*this);
+    writerThread.start();
+
+    bool readFailed = false;
+    QVector<Piece> pieces;
+    qint32 spanIndex = 0;
+    qint64 spanPosition = 0;
+    qint64 copiedLength = 0;
+    qint32 lastPercent = -1;
+    qint32 bufferIndex = 0;
+
+    while (spanIndex < spans.size()) {
+        // Wait for the buffer to be free
+        {
+            QMutexLocker locker(&windowMutex);
+            while (windowLength[bufferIndex] != 0 && !writeFailed) {
+                windowCondition.wait(&windowMutex);
+            }
+            if (writeFailed) break;
+        }
+
+        // Collect the pieces of the spans that fall in this window
+        pieces.clear();
+        qint64 windowPosition = 0;
+        while (spanIndex < spans.size() && windowPosition < windowSize) {
+            const Span &span = spans[spanIndex];
+            const qint64 length = std::min(span.length - spanPosition, windowSize - windowPosition);
+
+            pieces.append(Piece { span.sourceOffset == -1 ? -1 : span.sourceOffset + spanPosition, windowPosition, length });
+            windowPosition += length;
+            spanPosition += length;
+            if (spanPosition == span.length) {
+                spanIndex++;
+                spanPosition = 0;
+            }
+        }
+
+        if (!fillWindow(pieces, windows[bufferIndex].data())) {
+            readFailed = true;
+            break;
+        }
+
+        // Pass the window to the writer
+        {
+            QMutexLocker locker(&windowMutex);
+            windowLength[bufferIndex] = windowPosition;
+            windowCondition.wakeAll();
+        }
+        bufferIndex ^= 1;
+
+        // Notify user
+        copiedLength += windowPosition;
+        const qint32 percent = static_cast<qint32>((copiedLength * 100) / totalLength);
+        if (percent / 5 != lastPercent / 5) {
+            qInfo().nospace() << "Written " << percent << "% of " << description;
+            lastPercent = percent;
+        }
+    }
+
+    // Wait for the writer to finish
+    {
+        QMutexLocker locker(&windowMutex);
+        readFinished = true;
+        windowCondition.wakeAll();
+    }
+    writerThread.wait();
+
+    // Release the windows
+    windows[0].clear();
+    windows[1].clear();
+
+    if (readFailed) qWarning() << "Reading from" << sourceFile.fileName() << "failed";
+    if (writeFailed) qWarning() << "Writing to" << targetFile.fileName() << "failed";
+    return !readFailed && !writeFailed;
+}
+
+// Read the pieces of one window, in source file order
+bool SpanCopier::fillWindow(QVector<Piece> &pieces, char *window)
+{
+    std::sort(pieces.begin(), pieces.end(), [](const Piece &a, const Piece &b) {
+        return a.sourceOffset < b.sourceOffset;
+    });
+
+    for (const Piece &piece : pieces) {
+        if (piece.sourceOffset == -1) {
+            memset(window + piece.windowOffset, 0, piece.length);
+            continue;
+        }
+
+        if (sourceFile.pos() != piece.sourceOffset && !sourceFile.seek(piece.sourceOffset)) {
+            qDebug() << "SpanCopier::fillWindow(): Seek to" << piece.sourceOffset << "failed";
+            return false;
+        }
+        if (sourceFile.read(window + piece.windowOffset, piece.length) != piece.length) {
+            qDebug() << "SpanCopier::fillWindow(): Short read of" << piece.length << "bytes at" << piece.sourceOffset;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Writer thread: write the windows to the target file in order
+void SpanCopier::writeWindows()
+{
+    qint32 bufferIndex = 0;
+
+    while (true) {
+        qint64 length;
+        {
+            QMutexLocker locker(&windowMutex);
+            while (windowLength[bufferIndex] == 0 && !readFinished) {
+                windowCondition.wait(&windowMutex);
+            }
+            length = windowLength[bufferIndex];
+            if (length == 0) break;
+        }
+
+        const bool ok = targetFile.write(windows[bufferIndex].constData(), length) == length;
+
+        {
+            QMutexLocker locker(&windowMutex);
+            windowLength[bufferIndex] = 0;
+            if (!ok) writeFailed = true;
+            windowCondition.wakeAll();
+            if (!ok) break;
+        }
+        bufferIndex ^= 1;
+    }
+}
@@ -0,0 +1,113 @@
+/************************************************************************
+
+    spancopier.h
+
+    ld-discmap - TBC and VBI alignment and correction
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-discmap is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef SPANCOPIER_H
+#define SPANCOPIER_H
+
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+// Copy a planned sequence of byte ranges from a source file to the end of a
+// target file.
+//
+// The target is written in order, but the ranges can come from anywhere in the
+// source. Rather than seeking to each range as it is written, SpanCopier fills
+// a large window of the target at a time: ranges that are contiguous in the
+// source are merged, the ranges in a window are read in source file order, and
+// the window is written in one go. Writing one window overlaps with reading the
+// next, on a separate thread.
+class SpanCopier
+{
+public:
+    SpanCopier(QFile &sourceFile, QFile &targetFile);
+
+    // Add a range of the source file to the end of the plan
+    void addCopy(qint64 sourceOffset, qint64 length);
+
+    // Add a range of zero bytes to the end of the plan
+    void addZeros(qint64 length);
+
+    qint64 getTotalLength() const;
+
+    // Carry out the plan, reporting progress with the given description.
+    // Returns false if a read or write failed.
+    bool run(const QString &description);
+
+private:
+    // Size of each window of the target file
+    static constexpr qint64 WINDOW_BYTES = 32 * 1024 * 1024;
+
+    // A range of the target; sourceOffset is -1 for zeros
+    struct Span {
+        qint64 sourceOffset;
+        qint64 length;
+    };
+
+    // Part of a span that falls within one window
+    struct Piece {
+        qint64 sourceOffset;
+        qint64 windowOffset;
+        qint64 length;
+    };
+
+    class WriterThread : public QThread
+    {
+    public:
+        WriterThread(SpanCopier &_spanCopier) : spanCopier(_spanCopier) {}
+
+    protected:
+        void run() override {
+            spanCopier.writeWindows();
+        }
+
+    private:
+        SpanCopier &spanCopier;
+    };
+
+    QFile &sourceFile;
+    QFile &targetFile;
+    QVector<Span> spans;
+    qint64 totalLength;
+
+    // Double-buffered windows, shared with the writer thread. windowLength[i]
+    // is the number of bytes of windows[i] waiting to be written, or 0 if it
+    // is free.
+    QMutex windowMutex;
+    QWaitCondition windowCondition;
+    QByteArray windows[2];
+    qint64 windowLength[2];
+    bool readFinished;
+    bool writeFailed;
+
+    bool fillWindow(QVector<Piece> &pieces, char *window);
+    void writeWindows();
+};
+
+#endif // SPANCOPIER_H
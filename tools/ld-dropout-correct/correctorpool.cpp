@@ -26,12 +26,12 @@
 #include "correctorpool.h"
 #include "vbidecoder.h"
 
-CorrectorPool::CorrectorPool(QString _outputFilename, QString _outputJsonFilename,
-                             qint32 _maxThreads, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
+CorrectorPool::CorrectorPool(QString _outputFilename, QString _outputJsonFilename, QString _patchBaseFilename,
+                             qint32 _maxThreads, qint32 _prefetchMegabytes, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
                              bool _reverse, bool _intraField, bool _overCorrect, QObject *parent)
-    : QObject(parent), outputFilename(_outputFilename), outputJsonFilename(_outputJsonFilename),
-      maxThreads(_maxThreads), reverse(_reverse), intraField(_intraField), overCorrect(_overCorrect),
-      abort(false), ldDecodeMetaData(_ldDecodeMetaData), sourceVideos(_sourceVideos)
+    : QObject(parent), outputFilename(_outputFilename), outputJsonFilename(_outputJsonFilename), patchBaseFilename(_patchBaseFilename),
+      maxThreads(_maxThreads), prefetchMegabytes(_prefetchMegabytes), reverse(_reverse), intraField(_intraField), overCorrect(_overCorrect),
+      abort(false), ldDecodeMetaData(_ldDecodeMetaData), sourceVideos(_sourceVideos), fieldPrefetcher(nullptr)
 {
 }
 
@@ -54,13 +54,25 @@ bool CorrectorPool::process()
         }
     }
 
+    // Start the patch file, if we're writing one
+    if (!patchBaseFilename.isEmpty()) {
+        const LdDecodeMetaData::VideoParameters &videoParameters = ldDecodeMetaData[0]->getVideoParameters();
+        if (!patchWriter.open(&targetVideo, outputFilename, patchBaseFilename,
+                              videoParameters.fieldWidth * videoParameters.fieldHeight, videoParameters.fieldWidth)) {
+            qInfo() << "Writing the header to the output patch file failed";
+            targetVideo.close();
+            return false;
+        }
+    }
+
     // If there is a leading field in the TBC which is out of field order, we need to copy it
-    // to ensure the JSON metadata files match up
+    // to ensure the JSON metadata files match up (a patch doesn't need it, as
+    // it's unchanged in the base file)
     qInfo() << "Verifying leading fields match...";
     qint32 firstFieldNumber = ldDecodeMetaData[0]->getFirstFieldNumber(1);
     qint32 secondFieldNumber = ldDecodeMetaData[0]->getSecondFieldNumber(1);
 
-    if (firstFieldNumber != 1 && secondFieldNumber != 1) {
+    if (firstFieldNumber != 1 && secondFieldNumber != 1 && patchBaseFilename.isEmpty()) {
         SourceVideo::Data sourceField = sourceVideos[0]->getVideoField(1);
         if (!writeOutputField(sourceField)) {
             // Could not write to target TBC file
@@ -87,6 +99,8 @@ bool CorrectorPool::process()
     sameSourceConcealmentTotal = 0;
     multiSourceConcealmentTotal = 0;
     multiSourceCorrectionTotal = 0;
+    secondaryFieldsAvailable = 0;
+    secondaryFieldsRead = 0;
 
     // Initialise processing state
     inputFrameNumber = 1;
@@ -94,6 +108,25 @@ bool CorrectorPool::process()
     lastFrameNumber = ldDecodeMetaData[0]->getNumberOfFrames();
     totalTimer.start();
 
+    // Start writing the output metadata; the metadata for each field is
+    // written once the field itself has been written
+    if (!metadataWriter.open(outputJsonFilename, *ldDecodeMetaData[0])) {
+        qInfo() << "Unable to open output JSON file";
+        targetVideo.close();
+        return false;
+    }
+    outputMetadataFieldNumber = 1;
+
+    // Start reading ahead in the first input file, if enabled and the input
+    // isn't memory-mapped or stdin. The other sources are only read for frames
+    // that need correcting, so reading ahead in them would mostly fetch fields
+    // that are never used.
+    if (prefetchMegabytes > 0 && FieldPrefetcher::isUseful(*sourceVideos[0])) {
+        fieldPrefetcher = new FieldPrefetcher(*sourceVideos[0], prefetchMegabytes,
+                                              ldDecodeMetaData[0]->getNumberOfFields());
+        fieldPrefetcher->start();
+    }
+
     // Start a vector of decoding threads to process the video
     qInfo() << "Beginning multi-threaded dropout correction process...";
     QVector<QThread *> threads;
@@ -109,6 +142,19 @@ bool CorrectorPool::process()
         delete threads[i];
     }
 
+    // Stop reading ahead
+    if (fieldPrefetcher != nullptr) {
+        qDebug() << "CorrectorPool::process(): Prefetcher hits:" << fieldPrefetcher->getHitCount()
+                 << "misses:" << fieldPrefetcher->getMissCount();
+        delete fieldPrefetcher;
+        fieldPrefetcher = nullptr;
+    }
+
+    if (sourceVideos.size() > 1) {
+        qInfo() << "Read" << secondaryFieldsRead.loadAcquire() << "of" << secondaryFieldsAvailable
+                << "fields available from the additional sources";
+    }
+
     // Did any of the threads abort?
     if (abort) {
         targetVideo.close();
@@ -120,8 +166,16 @@ bool CorrectorPool::process()
     qInfo() << "Dropout correction complete -" << lastFrameNumber << "frames in" << totalSecs << "seconds (" <<
                lastFrameNumber / totalSecs << "FPS )";
 
+    if (!patchBaseFilename.isEmpty()) {
+        qInfo() << "Patch contains" << patchWriter.getNumberOfRuns() << "runs of replacement samples, totalling"
+                << patchWriter.getNumberOfSamples() << "samples";
+    }
+
     qInfo() << "Creating JSON metadata file for drop-out corrected TBC...";
-    ldDecodeMetaData[0]->write(outputJsonFilename);
+    if (!writeOutputMetadata(ldDecodeMetaData[0]->getNumberOfFields()) || !metadataWriter.close()) {
+        targetVideo.close();
+        return false;
+    }
 
     // Close the target video
     targetVideo.close();
@@ -181,8 +235,8 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
             secondFieldNumber[sourceNo] = ldDecodeMetaData[sourceNo]->getSecondFieldNumber(frameNumber);
 
             // Determine the frame quality (currently this is based on frame average black SNR)
-            double firstFrameSnr = ldDecodeMetaData[sourceNo]->getField(firstFieldNumber[sourceNo]).vitsMetrics.bPSNR;
-            double secondFrameSnr = ldDecodeMetaData[sourceNo]->getField(secondFieldNumber[sourceNo]).vitsMetrics.bPSNR;
+            double firstFrameSnr = ldDecodeMetaData[sourceNo]->copyField(firstFieldNumber[sourceNo]).vitsMetrics.bPSNR;
+            double secondFrameSnr = ldDecodeMetaData[sourceNo]->copyField(secondFieldNumber[sourceNo]).vitsMetrics.bPSNR;
             sourceFrameQuality[sourceNo] = (firstFrameSnr + secondFrameSnr) / 2.0;
 
             qDebug().nospace() << "CorrectorPool::getInputFrame(): Source #0 fields are " <<
@@ -196,8 +250,8 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
             secondFieldNumber[sourceNo] = ldDecodeMetaData[sourceNo]->getSecondFieldNumber(currentSourceFrameNumber);
 
             // Determine the frame quality (currently this is based on frame average black SNR)
-            double firstFrameSnr = ldDecodeMetaData[sourceNo]->getField(firstFieldNumber[sourceNo]).vitsMetrics.bPSNR;
-            double secondFrameSnr = ldDecodeMetaData[sourceNo]->getField(secondFieldNumber[sourceNo]).vitsMetrics.bPSNR;
+            double firstFrameSnr = ldDecodeMetaData[sourceNo]->copyField(firstFieldNumber[sourceNo]).vitsMetrics.bPSNR;
+            double secondFrameSnr = ldDecodeMetaData[sourceNo]->copyField(secondFieldNumber[sourceNo]).vitsMetrics.bPSNR;
             sourceFrameQuality[sourceNo] = (firstFrameSnr + secondFrameSnr) / 2.0;
 
             qDebug().nospace() << "CorrectorPool::getInputFrame(): Source #" << sourceNo << " has VBI frame number " << currentVbiFrame <<
@@ -207,19 +261,28 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
             qDebug().nospace() << "CorrectorPool::getInputFrame(): Source #" << sourceNo << " does not contain a usable frame";
         }
 
+        // Only the first source is read here; the others are read by
+        // getSecondaryFieldData if the frame turns out to need correcting
+        if (sourceNo != 0) {
+            firstFieldVideoData[sourceNo].clear();
+            secondFieldVideoData[sourceNo].clear();
+        }
+
         // If the field numbers are valid - get the rest of the required data
         if (firstFieldNumber[sourceNo] != -1 && secondFieldNumber[sourceNo] != -1) {
             // Fetch the input data (get the fields in TBC sequence order to save seeking)
-            if (firstFieldNumber[sourceNo] < secondFieldNumber[sourceNo]) {
-                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(firstFieldNumber[sourceNo]);
-                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(secondFieldNumber[sourceNo]);
-            } else {
-                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(secondFieldNumber[sourceNo]);
-                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(firstFieldNumber[sourceNo]);
+            if (sourceNo == 0) {
+                if (firstFieldNumber[sourceNo] < secondFieldNumber[sourceNo]) {
+                    firstFieldVideoData[sourceNo] = getPrimaryVideoField(firstFieldNumber[sourceNo]);
+                    secondFieldVideoData[sourceNo] = getPrimaryVideoField(secondFieldNumber[sourceNo]);
+                } else {
+                    secondFieldVideoData[sourceNo] = getPrimaryVideoField(secondFieldNumber[sourceNo]);
+                    firstFieldVideoData[sourceNo] = getPrimaryVideoField(firstFieldNumber[sourceNo]);
+                }
             }
 
-            firstFieldMetadata[sourceNo] = ldDecodeMetaData[sourceNo]->getField(firstFieldNumber[sourceNo]);
-            secondFieldMetadata[sourceNo] = ldDecodeMetaData[sourceNo]->getField(secondFieldNumber[sourceNo]);
+            firstFieldMetadata[sourceNo] = ldDecodeMetaData[sourceNo]->copyField(firstFieldNumber[sourceNo]);
+            secondFieldMetadata[sourceNo] = ldDecodeMetaData[sourceNo]->copyField(secondFieldNumber[sourceNo]);
             videoParameters[sourceNo] = ldDecodeMetaData[sourceNo]->getVideoParameters();
         }
     }
@@ -228,6 +291,9 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
     availableSourcesForFrame.clear();
     if (numberOfSources > 1) {
         availableSourcesForFrame = getAvailableSourcesForFrame(currentVbiFrame);
+        for (qint32 sourceNo : availableSourcesForFrame) {
+            if (sourceNo != 0) secondaryFieldsAvailable += 2;
+        }
     } else {
         availableSourcesForFrame.append(0);
     }
@@ -240,6 +306,33 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
     return true;
 }
 
+// Read the fields of the additional sources for a frame from getInputFrame.
+//
+// Workers only call this for frames where the first source has dropouts, so
+// frames that don't need correcting never touch the other sources. Only the
+// first source can be piped, so the others can be read in any order without
+// holding inputMutex.
+void CorrectorPool::getSecondaryFieldData(const QVector<qint32> &availableSourcesForFrame,
+                                          const QVector<qint32> &firstFieldNumber, QVector<SourceVideo::Data> &firstFieldVideoData,
+                                          const QVector<qint32> &secondFieldNumber, QVector<SourceVideo::Data> &secondFieldVideoData)
+{
+    for (qint32 sourceNo : availableSourcesForFrame) {
+        if (sourceNo == 0 || firstFieldNumber[sourceNo] == -1 || secondFieldNumber[sourceNo] == -1) continue;
+
+        sourceVideos[sourceNo]->readVideoField(firstFieldNumber[sourceNo], firstFieldVideoData[sourceNo]);
+        sourceVideos[sourceNo]->readVideoField(secondFieldNumber[sourceNo], secondFieldVideoData[sourceNo]);
+        secondaryFieldsRead.fetchAndAddRelaxed(2);
+    }
+}
+
+// Read a whole field from the first source, through the prefetcher if there
+// is one. You must hold inputMutex to call this.
+SourceVideo::Data CorrectorPool::getPrimaryVideoField(qint32 fieldNumber)
+{
+    if (fieldPrefetcher == nullptr) return sourceVideos[0]->getVideoField(fieldNumber);
+    return fieldPrefetcher->getVideoField(fieldNumber);
+}
+
 // Put a corrected frame into the output stream.
 //
 // The worker threads will complete frames in an arbitrary order, so we can't
@@ -249,6 +342,7 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
 //
 // Returns true on success, false on failure.
 bool CorrectorPool::setOutputFrame(qint32 frameNumber,
+                                   SourceVideo::Data firstSourceFieldData, SourceVideo::Data secondSourceFieldData,
                                    SourceVideo::Data firstTargetFieldData, SourceVideo::Data secondTargetFieldData,
                                    qint32 firstFieldSeqNo, qint32 secondFieldSeqNo,
                                    qint32 sameSourceConcealment, qint32 multiSourceConcealment,
@@ -258,6 +352,8 @@ bool CorrectorPool::setOutputFrame(qint32 frameNumber,
 
     // Put the output frame into the map
     OutputFrame pendingFrame;
+    pendingFrame.firstSourceFieldData = firstSourceFieldData;
+    pendingFrame.secondSourceFieldData = secondSourceFieldData;
     pendingFrame.firstTargetFieldData = firstTargetFieldData;
     pendingFrame.secondTargetFieldData = secondTargetFieldData;
     pendingFrame.firstFieldSeqNo = firstFieldSeqNo;
@@ -279,12 +375,12 @@ bool CorrectorPool::setOutputFrame(qint32 frameNumber,
         bool writeFail = false;
         if (outputFrame.firstFieldSeqNo < outputFrame.secondFieldSeqNo) {
             // Save the first field and then second field to the output file
-            if (!writeOutputField(outputFrame.firstTargetFieldData)) writeFail = true;
-            if (!writeOutputField(outputFrame.secondTargetFieldData)) writeFail = true;
+            if (!writeCorrectedField(outputFrame.firstFieldSeqNo, outputFrame.firstSourceFieldData, outputFrame.firstTargetFieldData)) writeFail = true;
+            if (!writeCorrectedField(outputFrame.secondFieldSeqNo, outputFrame.secondSourceFieldData, outputFrame.secondTargetFieldData)) writeFail = true;
         } else {
             // Save the second field and then first field to the output file
-            if (!writeOutputField(outputFrame.secondTargetFieldData)) writeFail = true;
-            if (!writeOutputField(outputFrame.firstTargetFieldData)) writeFail = true;
+            if (!writeCorrectedField(outputFrame.secondFieldSeqNo, outputFrame.secondSourceFieldData, outputFrame.secondTargetFieldData)) writeFail = true;
+            if (!writeCorrectedField(outputFrame.firstFieldSeqNo, outputFrame.firstSourceFieldData, outputFrame.firstTargetFieldData)) writeFail = true;
         }
 
         // Was the write successful?
@@ -295,6 +391,12 @@ bool CorrectorPool::setOutputFrame(qint32 frameNumber,
             return false;
         }
 
+        // Write the metadata for the fields up to this point
+        if (!writeOutputMetadata(qMax(outputFrame.firstFieldSeqNo, outputFrame.secondFieldSeqNo))) {
+            targetVideo.close();
+            return false;
+        }
+
         // Show debug
         double avgReplacementDistance = 0;
         if (outputFrame.sameSourceConcealment + outputFrame.multiSourceConcealment +  outputFrame.multiSourceCorrection > 0) {
@@ -442,8 +544,8 @@ QVector<qint32> CorrectorPool::getAvailableSourcesForFrame(qint32 vbiFrameNumber
             qint32 secondFieldNumber = ldDecodeMetaData[sourceNo]->getSecondFieldNumber(convertVbiFrameNumberToSequential(vbiFrameNumber, sourceNo));
 
             // Ensure the frame is not a padded field (i.e. missing)
-            if (!(ldDecodeMetaData[sourceNo]->getField(firstFieldNumber).pad &&
-                  ldDecodeMetaData[sourceNo]->getField(secondFieldNumber).pad)) {
+            if (!(ldDecodeMetaData[sourceNo]->copyField(firstFieldNumber).pad &&
+                  ldDecodeMetaData[sourceNo]->copyField(secondFieldNumber).pad)) {
                 availableSourcesForFrame.append(sourceNo);
             }
         }
@@ -459,6 +561,28 @@ bool CorrectorPool::writeOutputField(const SourceVideo::Data &fieldData)
     return targetVideo.write(reinterpret_cast<const char *>(fieldData.data()), 2 * fieldData.size());
 }
 
+// Write a corrected field to the output - either the whole field, or (when
+// writing a patch) just the samples that differ from the source field.
+// Returns true on success, false on failure.
+bool CorrectorPool::writeCorrectedField(qint32 fieldNumber, const SourceVideo::Data &sourceFieldData,
+                                        const SourceVideo::Data &targetFieldData)
+{
+    if (patchBaseFilename.isEmpty()) return writeOutputField(targetFieldData);
+    return patchWriter.writeField(fieldNumber, sourceFieldData, targetFieldData);
+}
+
+// Write the output metadata for fields up to and including lastFieldNumber
+// (taken from the first source, as the output is in the same field order)
+bool CorrectorPool::writeOutputMetadata(qint32 lastFieldNumber)
+{
+    while (outputMetadataFieldNumber <= lastFieldNumber) {
+        if (!metadataWriter.writeField(ldDecodeMetaData[0]->copyField(outputMetadataFieldNumber))) return false;
+        outputMetadataFieldNumber++;
+    }
+
+    return true;
+}
+
 // Getters for reporting
 qint32 CorrectorPool::getSameSourceConcealmentTotal()
 {
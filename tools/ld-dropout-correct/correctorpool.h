@@ -32,16 +32,19 @@
 #include <QMutex>
 #include <QThread>
 
+#include "fieldprefetcher.h"
 #include "sourcevideo.h"
 #include "lddecodemetadata.h"
+#include "metadatawriter.h"
+#include "tbcpatchwriter.h"
 #include "dropoutcorrect.h"
 
 class CorrectorPool : public QObject
 {
     Q_OBJECT
 public:
-    explicit CorrectorPool(QString _outputFilename, QString _outputJsonFilename,
-                           qint32 _maxThreads, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
+    explicit CorrectorPool(QString _outputFilename, QString _outputJsonFilename, QString _patchBaseFilename,
+                           qint32 _maxThreads, qint32 _prefetchMegabytes, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
                            bool _reverse, bool _intraField, bool _overCorrect, QObject *parent = nullptr);
 
     bool process();
@@ -52,8 +55,12 @@ public:
                        QVector<qint32> &secondFieldNumber, QVector<SourceVideo::Data> &secondFieldVideoData, QVector<LdDecodeMetaData::Field> &secondFieldMetadata,
                        QVector<LdDecodeMetaData::VideoParameters> &videoParameters,
                        bool& _reverse, bool& _intraField, bool& _overCorrect, QVector<qint32> &availableSourcesForFrame, QVector<double> &sourceFrameQuality);
+    void getSecondaryFieldData(const QVector<qint32> &availableSourcesForFrame,
+                               const QVector<qint32> &firstFieldNumber, QVector<SourceVideo::Data> &firstFieldVideoData,
+                               const QVector<qint32> &secondFieldNumber, QVector<SourceVideo::Data> &secondFieldVideoData);
 
     bool setOutputFrame(qint32 frameNumber,
+                        SourceVideo::Data firstSourceFieldData, SourceVideo::Data secondSourceFieldData,
                         SourceVideo::Data firstTargetFieldData, SourceVideo::Data secondTargetFieldData,
                         qint32 firstFieldSeqNo, qint32 secondFieldSeqNo,
                         qint32 sameSourceReplacement, qint32 multiSourceReplacement, qint32 multiSourceCorrection, qint32 totalReplacementDistance);
@@ -66,7 +73,9 @@ public:
 private:
     QString outputFilename;
     QString outputJsonFilename;
+    QString patchBaseFilename;
     qint32 maxThreads;
+    qint32 prefetchMegabytes;
     bool reverse;
     bool intraField;
     bool overCorrect;
@@ -82,11 +91,14 @@ private:
     qint32 lastFrameNumber;
     QVector<LdDecodeMetaData *> &ldDecodeMetaData;
     QVector<SourceVideo *> &sourceVideos;
+    FieldPrefetcher *fieldPrefetcher;
 
     // Output stream information (all guarded by outputMutex while threads are running)
     QMutex outputMutex;
 
     struct OutputFrame {
+        SourceVideo::Data firstSourceFieldData;
+        SourceVideo::Data secondSourceFieldData;
         SourceVideo::Data firstTargetFieldData;
         SourceVideo::Data secondTargetFieldData;
         qint32 firstFieldSeqNo;
@@ -102,6 +114,12 @@ private:
     qint32 outputFrameNumber;
     QMap<qint32, OutputFrame> pendingOutputFrames;
     QFile targetVideo;
+    MetadataWriter metadataWriter;
+    qint32 outputMetadataFieldNumber;
+
+    // If patchBaseFilename isn't empty, the output is a patch for that file
+    // rather than a complete TBC file
+    TbcPatchWriter patchWriter;
 
     // Local source information
     QVector<bool> sourceDiscTypeCav;
@@ -113,11 +131,19 @@ private:
     qint32 multiSourceConcealmentTotal;
     qint32 multiSourceCorrectionTotal;
 
+    // Secondary source fields that could have been used for correction
+    // (guarded by inputMutex), and the number that were actually read
+    qint32 secondaryFieldsAvailable;
+    QAtomicInt secondaryFieldsRead;
+
+    SourceVideo::Data getPrimaryVideoField(qint32 fieldNumber);
     bool setMinAndMaxVbiFrames();
     qint32 convertSequentialFrameNumberToVbi(qint32 sequentialFrameNumber, qint32 sourceNumber);
     qint32 convertVbiFrameNumberToSequential(qint32 vbiFrameNumber, qint32 sourceNumber);
     QVector<qint32> getAvailableSourcesForFrame(qint32 vbiFrameNumber);
     bool writeOutputField(const SourceVideo::Data &fieldData);
+    bool writeCorrectedField(qint32 fieldNumber, const SourceVideo::Data &sourceFieldData, const SourceVideo::Data &targetFieldData);
+    bool writeOutputMetadata(qint32 lastFieldNumber);
 };
 
 #endif // CORRECTORPOOL_H
@@ -69,14 +69,22 @@ void DropOutCorrect::run()
         qDebug().nospace() << "DropOutCorrect::process(): Frame #" << frameNumber << " - There are " << totalAvailableSources << " sources available of which " <<
                               availableSourcesForFrame.size() << " contain the required frame";
 
+        // Check if the frame contains drop-outs
+        const bool hasDropOuts = !(firstFieldMetadata[0].dropOuts.empty() && secondFieldMetadata[0].dropOuts.empty());
+
+        // The other sources' data is only needed if there's something to correct
+        if (hasDropOuts && availableSourcesForFrame.size() > 1) {
+            correctorPool.getSecondaryFieldData(availableSourcesForFrame, firstFieldSeqNo, firstSourceField,
+                                                secondFieldSeqNo, secondSourceField);
+        }
+
         // Copy the input frames' data to the target frames.
         // We'll use these both as source and target during correction, which
         // is OK because we're careful not to copy data from another dropout.
         QVector<SourceVideo::Data> firstFieldData = firstSourceField;
         QVector<SourceVideo::Data> secondFieldData = secondSourceField;
 
-        // Check if the frame contains drop-outs
-        if (firstFieldMetadata[0].dropOuts.empty() && secondFieldMetadata[0].dropOuts.empty()) {
+        if (!hasDropOuts) {
             // No correction required...
             qDebug() << "DropOutCorrect::process(): Skipping fields [" <<
                         firstFieldSeqNo[0] << "/" << secondFieldSeqNo[0] << "]";
@@ -103,24 +111,30 @@ void DropOutCorrect::run()
                     secondFieldDropouts[currentSource] = setDropOutLocations(populateDropoutsVector(secondFieldMetadata[currentSource], overCorrect));
             }
 
+            // Index the drop outs by line for the replacement line search
+            const QVector<DropOutIndex> firstFieldIndexes = buildDropOutIndexes(firstFieldDropouts);
+            const QVector<DropOutIndex> secondFieldIndexes = buildDropOutIndexes(secondFieldDropouts);
+
             // Correct the first field
-            correctField(firstFieldDropouts, secondFieldDropouts, firstFieldData, secondFieldData, true, intraField, availableSourcesForFrame, sourceFrameQuality,
-                         statistics);
+            correctField(firstFieldDropouts, firstFieldIndexes, secondFieldIndexes, firstFieldData, secondFieldData, true, intraField,
+                         availableSourcesForFrame, sourceFrameQuality, statistics);
 
             // Correct the second field
-            correctField(secondFieldDropouts, firstFieldDropouts, secondFieldData, firstFieldData, false, intraField, availableSourcesForFrame, sourceFrameQuality,
-                         statistics);
+            correctField(secondFieldDropouts, secondFieldIndexes, firstFieldIndexes, secondFieldData, firstFieldData, false, intraField,
+                         availableSourcesForFrame, sourceFrameQuality, statistics);
         }
 
         // Return the processed fields
-        correctorPool.setOutputFrame(frameNumber, firstFieldData[0], secondFieldData[0], firstFieldSeqNo[0], secondFieldSeqNo[0],
+        correctorPool.setOutputFrame(frameNumber, firstSourceField[0], secondSourceField[0],
+                firstFieldData[0], secondFieldData[0], firstFieldSeqNo[0], secondFieldSeqNo[0],
                 statistics.sameSourceConcealment, statistics.multiSourceConcealment, statistics.multiSourceCorrection ,statistics.totalReplacementDistance);
     }
 }
 
 // Correct dropouts within one field
 void DropOutCorrect::correctField(const QVector<QVector<DropOutLocation>> &thisFieldDropouts,
-                                  const QVector<QVector<DropOutLocation>> &otherFieldDropouts,
+                                  const QVector<DropOutIndex> &thisFieldIndexes,
+                                  const QVector<DropOutIndex> &otherFieldIndexes,
                                   QVector<SourceVideo::Data> &thisFieldData, const QVector<SourceVideo::Data> &otherFieldData,
                                   bool thisFieldIsFirst, bool intraField, const QVector<qint32> &availableSourcesForFrame,
                                   const QVector<double> &sourceFrameQuality, Statistics &statistics)
@@ -130,7 +144,7 @@ void DropOutCorrect::correctField(const QVector<QVector<DropOutLocation>> &thisF
 
         // Is the current dropout in the colour burst?
         if (thisFieldDropouts[0][dropoutIndex].location == Location::colourBurst) {
-            replacement = findReplacementLine(thisFieldDropouts, otherFieldDropouts,
+            replacement = findReplacementLine(thisFieldDropouts, thisFieldIndexes, otherFieldIndexes,
                                               dropoutIndex, thisFieldIsFirst, true,
                                               true, intraField, availableSourcesForFrame,
                                               sourceFrameQuality);
@@ -139,11 +153,11 @@ void DropOutCorrect::correctField(const QVector<QVector<DropOutLocation>> &thisF
         // Is the current dropout in the visible video line?
         if (thisFieldDropouts[0][dropoutIndex].location == Location::visibleLine) {
             // Find separate replacements for luma and chroma
-            replacement = findReplacementLine(thisFieldDropouts, otherFieldDropouts,
+            replacement = findReplacementLine(thisFieldDropouts, thisFieldIndexes, otherFieldIndexes,
                                               dropoutIndex, thisFieldIsFirst, false,
                                               false, intraField, availableSourcesForFrame,
                                               sourceFrameQuality);
-            chromaReplacement = findReplacementLine(thisFieldDropouts, otherFieldDropouts,
+            chromaReplacement = findReplacementLine(thisFieldDropouts, thisFieldIndexes, otherFieldIndexes,
                                                     dropoutIndex, thisFieldIsFirst, true,
                                                     false, intraField, availableSourcesForFrame,
                                                     sourceFrameQuality);
@@ -249,11 +263,30 @@ QVector<DropOutCorrect::DropOutLocation> DropOutCorrect::setDropOutLocations(QVe
     return dropOuts;
 }
 
+// Index each source's drop outs by line, so the replacement line search can check
+// for overlaps without scanning every drop out in the field
+QVector<DropOutIndex> DropOutCorrect::buildDropOutIndexes(const QVector<QVector<DropOutLocation>> &fieldDropouts)
+{
+    QVector<DropOutIndex> indexes(fieldDropouts.size());
+    for (qint32 sourceNo = 0; sourceNo < fieldDropouts.size(); sourceNo++) {
+        if (fieldDropouts[sourceNo].isEmpty()) continue;
+
+        DropOuts dropOuts;
+        for (const DropOutLocation &dropOut : fieldDropouts[sourceNo]) {
+            dropOuts.append(dropOut.startx, dropOut.endx, dropOut.fieldLine);
+        }
+        indexes[sourceNo] = DropOutIndex(dropOuts);
+    }
+
+    return indexes;
+}
+
 // Find a replacement line to take replacement data from.  This method looks both up and down the field
 // for the nearest replacement line that doesn't contain a drop-out itself (to prevent copying bad data
 // over bad data).
 DropOutCorrect::Replacement DropOutCorrect::findReplacementLine(const QVector<QVector<DropOutLocation>> &thisFieldDropouts,
-                                                                const QVector<QVector<DropOutLocation>> &otherFieldDropouts,
+                                                                const QVector<DropOutIndex> &thisFieldIndexes,
+                                                                const QVector<DropOutIndex> &otherFieldIndexes,
                                                                 qint32 dropOutIndex, bool thisFieldIsFirst, bool matchChromaPhase,
                                                                 bool isColourBurst, bool intraField,
                                                                 const QVector<qint32> &availableSourcesForFrame,
@@ -320,13 +353,13 @@ DropOutCorrect::Replacement DropOutCorrect::findReplacementLine(const QVector<QV
 
         // Look up the field for a replacement
         findPotentialReplacementLine(thisFieldDropouts, dropOutIndex,
-                                     thisFieldDropouts, true, 0, -stepAmount,
+                                     thisFieldIndexes, true, 0, -stepAmount,
                                      currentSource, sourceFrameQuality,
                                      candidates);
 
         // Look down the field for a replacement
         findPotentialReplacementLine(thisFieldDropouts, dropOutIndex,
-                                     thisFieldDropouts, true, stepAmount, stepAmount,
+                                     thisFieldIndexes, true, stepAmount, stepAmount,
                                      currentSource, sourceFrameQuality,
                                      candidates);
 
@@ -336,13 +369,13 @@ DropOutCorrect::Replacement DropOutCorrect::findReplacementLine(const QVector<QV
 
             // Look up the field for a replacement
             findPotentialReplacementLine(thisFieldDropouts, dropOutIndex,
-                                         otherFieldDropouts, false, otherFieldOffset, -stepAmount,
+                                         otherFieldIndexes, false, otherFieldOffset, -stepAmount,
                                          currentSource, sourceFrameQuality,
                                          candidates);
 
             // Look down the field for a replacement
             findPotentialReplacementLine(thisFieldDropouts, dropOutIndex,
-                                         otherFieldDropouts, false, otherFieldOffset + stepAmount, stepAmount,
+                                         otherFieldIndexes, false, otherFieldOffset + stepAmount, stepAmount,
                                          currentSource, sourceFrameQuality,
                                          candidates);
         }
@@ -404,13 +437,15 @@ DropOutCorrect::Replacement DropOutCorrect::findReplacementLine(const QVector<QV
 // Given a dropout, scan through a source field for the nearest replacement line that doesn't have overlapping dropouts.
 // Adds a Replacement to candidates if one was found.
 void DropOutCorrect::findPotentialReplacementLine(const QVector<QVector<DropOutLocation>> &targetDropouts, qint32 targetIndex,
-                                                  const QVector<QVector<DropOutLocation>> &sourceDropouts, bool isSameField,
+                                                  const QVector<DropOutIndex> &sourceIndexes, bool isSameField,
                                                   qint32 sourceOffset, qint32 stepAmount,
                                                   qint32 sourceNo, const QVector<double> &sourceFrameQuality,
                                                   QVector<Replacement> &candidates)
 {    
+    const DropOutLocation &target = targetDropouts[0][targetIndex];
+
     // Calculate the start source line, applying sourceOffset to find a line with the right chroma phase
-    qint32 sourceLine = targetDropouts[0][targetIndex].fieldLine + sourceOffset;
+    qint32 sourceLine = target.fieldLine + sourceOffset;
 
     // Is the line within the active range?
     if ((sourceLine - 1) < videoParameters[sourceNo].firstActiveFieldLine
@@ -423,18 +458,10 @@ void DropOutCorrect::findPotentialReplacementLine(const QVector<QVector<DropOutL
     while ((sourceLine - 1) >= videoParameters[sourceNo].firstActiveFieldLine
            && (sourceLine - 1) < videoParameters[sourceNo].lastActiveFieldLine) {
         // Is there a dropout that overlaps the one we're trying to replace?
-        bool hasOverlap = false;
-        for (qint32 sourceIndex = 0; sourceIndex < sourceDropouts[sourceNo].size(); sourceIndex++) {
-            if (sourceDropouts[sourceNo][sourceIndex].fieldLine == sourceLine &&
-                (targetDropouts[0][targetIndex].endx - sourceDropouts[sourceNo][sourceIndex].startx) >= 0 &&
-                (sourceDropouts[sourceNo][sourceIndex].endx - targetDropouts[0][targetIndex].startx) >= 0) {
-                // Overlap -- can't use this line
-                sourceLine += stepAmount;
-                hasOverlap = true;
-                break;
-            }
-        }
-        if (!hasOverlap) {
+        if (sourceIndexes[sourceNo].overlaps(target.startx, target.endx, sourceLine)) {
+            // Overlap -- can't use this line
+            sourceLine += stepAmount;
+        } else {
             // No overlaps -- we can use this line
             Replacement replacement;
             replacement.isSameField = isSameField;
@@ -34,6 +34,7 @@
 
 #include "sourcevideo.h"
 #include "lddecodemetadata.h"
+#include "dropoutindex.h"
 
 class CorrectorPool;
 
@@ -88,19 +89,22 @@ private:
     QVector<LdDecodeMetaData::VideoParameters> videoParameters;
 
     void correctField(const QVector<QVector<DropOutLocation> > &thisFieldDropouts,
-                      const QVector<QVector<DropOutLocation> > &otherFieldDropouts,
+                      const QVector<DropOutIndex> &thisFieldIndexes,
+                      const QVector<DropOutIndex> &otherFieldIndexes,
                       QVector<SourceVideo::Data> &thisFieldData, const QVector<SourceVideo::Data> &otherFieldData,
                       bool thisFieldIsFirst, bool intraField, const QVector<qint32> &availableSourcesForFrame,
                       const QVector<double> &sourceFrameQuality, Statistics &statistics);
     QVector<DropOutLocation> populateDropoutsVector(LdDecodeMetaData::Field field, bool overCorrect);
     QVector<DropOutLocation> setDropOutLocations(QVector<DropOutLocation> dropOuts);
+    QVector<DropOutIndex> buildDropOutIndexes(const QVector<QVector<DropOutLocation>> &fieldDropouts);
     Replacement findReplacementLine(const QVector<QVector<DropOutLocation>> &thisFieldDropouts,
-                                    const QVector<QVector<DropOutLocation>> &otherFieldDropouts,
+                                    const QVector<DropOutIndex> &thisFieldIndexes,
+                                    const QVector<DropOutIndex> &otherFieldIndexes,
                                     qint32 dropOutIndex, bool thisFieldIsFirst, bool matchChromaPhase,
                                     bool isColourBurst, bool intraField, const QVector<qint32> &availableSourcesForFrame,
                                     const QVector<double> &sourceFrameQuality);
     void findPotentialReplacementLine(const QVector<QVector<DropOutLocation>> &targetDropouts, qint32 targetIndex,
-                                      const QVector<QVector<DropOutLocation>> &sourceDropouts, bool isSameField,
+                                      const QVector<DropOutIndex> &sourceIndexes, bool isSameField,
                                       qint32 sourceOffset, qint32 stepAmount,
                                       qint32 sourceNo, const QVector<double> &sourceFrameQuality,
                                       QVector<Replacement> &candidates);
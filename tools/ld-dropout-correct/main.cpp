@@ -32,6 +32,7 @@
 
 #include "logging.h"
 #include "correctorpool.h"
+#include "tbcpatch.h"
 
 int main(int argc, char *argv[])
 {
@@ -96,6 +97,19 @@ int main(int argc, char *argv[])
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to write a patch rather than a complete TBC file
+    QCommandLineOption patchOption(QStringList() << "patch",
+                                   QCoreApplication::translate(
+                                    "main", "Write a patch file containing only the corrected samples, which other tools read together with the first input TBC file"));
+    parser.addOption(patchOption);
+
+    // Option to select the amount of input to read ahead
+    QCommandLineOption prefetchOption(QStringList() << "prefetch",
+                                      QCoreApplication::translate(
+                                       "main", "Specify the amount of the first input to read ahead in the background, in MB (0 to disable; default 64)"),
+                                      QCoreApplication::translate("main", "megabytes"));
+    parser.addOption(prefetchOption);
+
     // Positional argument to specify input video file
     parser.addPositionalArgument("inputs", QCoreApplication::translate(
                                      "main", "Specify input TBC files (- as first source for piped input)"));
@@ -114,6 +128,7 @@ int main(int argc, char *argv[])
     bool reverse = parser.isSet(setReverseOption);
     bool intraField = parser.isSet(setIntrafieldOption);
     bool overCorrect = parser.isSet(setOverCorrectOption);
+    bool writePatch = parser.isSet(patchOption);
 
     // Get the arguments from the parser
     qint32 maxThreads = QThread::idealThreadCount();
@@ -127,6 +142,17 @@ int main(int argc, char *argv[])
         }
     }
 
+    qint32 prefetchMegabytes = 64;
+    if (parser.isSet(prefetchOption)) {
+        prefetchMegabytes = parser.value(prefetchOption).toInt();
+
+        if (prefetchMegabytes < 0) {
+            // Quit with error
+            qCritical("Specified prefetch size must not be negative");
+            return -1;
+        }
+    }
+
     // Require source and target filenames
     QVector<QString> inputFilenames;
     QString outputFilename = "-";
@@ -163,6 +189,20 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // A patch refers to the first input file, so that must be a complete TBC file
+    QString patchBaseFilename;
+    if (writePatch) {
+        if (inputFilenames[0] == "-") {
+            qCritical("A patch file can't be written when the first input is piped");
+            return -1;
+        }
+        if (TbcPatch::isPatchFile(inputFilenames[0])) {
+            qCritical("A patch file can't be written when the first input is itself a patch file");
+            return -1;
+        }
+        patchBaseFilename = inputFilenames[0];
+    }
+
     // If the output filename is "-" (piped output) - verify a JSON file has been specified
     if (outputFilename == "-" && !parser.isSet(outputJsonOption)) {
         // Quit with error
@@ -307,7 +347,7 @@ int main(int argc, char *argv[])
     // Perform the DOC process ----------------------------------------------------------------------------------------
     qInfo() << "Initial source checks are ok and sources are loaded";
     qint32 result = 0;
-    CorrectorPool correctorPool(outputFilename, outputJsonFilename, maxThreads,
+    CorrectorPool correctorPool(outputFilename, outputJsonFilename, patchBaseFilename, maxThreads, prefetchMegabytes,
                                 ldDecodeMetaData, sourceVideos,
                                 reverse, intraField, overCorrect);
     if (!correctorPool.process()) result = 1;
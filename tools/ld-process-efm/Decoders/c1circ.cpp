@@ -24,6 +24,8 @@
 
 #include "c1circ.h"
 
+#include "circsyndrome.h"
+
 C1Circ::C1Circ()
 {
     reset();
@@ -158,37 +160,52 @@ void C1Circ::errorCorrect()
 {
     // The C1 error correction can correct, at most, 2 symbols
 
-    // Convert the data and errors into the form expected by the ezpwd library
-    std::vector<uint8_t> data;
-    std::vector<int> erasures;
-    data.resize(32);
-
+    // Count the erasures
+    qint32 erasureCount = 0;
     for (qint32 byteC = 0; byteC < 32; byteC++) {
-        data[static_cast<size_t>(byteC)] = static_cast<uchar>(interleavedC1Data[byteC]);
-        if (interleavedC1Errors[byteC] == static_cast<char>(1)) erasures.push_back(byteC);
+        if (interleavedC1Errors[byteC] == static_cast<char>(1)) erasureCount++;
     }
 
     // Perform error check and correction
     int fixed = -1;
 
-    if (erasures.size() <= 2) {
-        // Perform error check and correction
+    if (erasureCount <= 2) {
+        // The codeword as passed to the decoder
+        uchar codeword[32];
+        for (qint32 byteC = 0; byteC < 32; byteC++) codeword[byteC] = interleavedC1Data[byteC];
+
+        if (CircSyndrome::isCodeword(codeword)) {
+            // All the syndromes are zero, so there are no errors to correct; the
+            // full decode would return 0 and leave the data unchanged
+            fixed = 0;
+        } else {
+            // Convert the data and errors into the form expected by the ezpwd library
+            std::vector<uint8_t> data(codeword, codeword + 32);
+            std::vector<int> erasures;
+            for (qint32 byteC = 0; byteC < 32; byteC++) {
+                if (interleavedC1Errors[byteC] == static_cast<char>(1)) erasures.push_back(byteC);
+            }
+
+            // Initialise the error corrector
+            C1RS<255,255-4> rs; // Up to 251 symbols data load with 4 symbols parity RS(32,28)
 
-        // Initialise the error corrector
-        C1RS<255,255-4> rs; // Up to 251 symbols data load with 4 symbols parity RS(32,28)
+            // Perform decode
+            std::vector<int> position;
+            fixed = rs.decode(data, erasures, &position);
 
-        // Perform decode
-        std::vector<int> position;
-        fixed = rs.decode(data, erasures, &position);
+            // If there were more than 2 symbols in error, mark the C1 as an erasure
+            if (fixed > 2) fixed = -1;
 
-        // If there were more than 2 symbols in error, mark the C1 as an erasure
-        if (fixed > 2) fixed = -1;
+            if (fixed >= 0) {
+                for (qint32 byteC = 0; byteC < 28; byteC++) codeword[byteC] = static_cast<uchar>(data[static_cast<size_t>(byteC)]);
+            }
+        }
 
         if (fixed >= 0) {
             // Copy the result back to the output byte array (removing the parity symbols)
             for (qint32 byteC = 0; byteC < 28; byteC++) {
-                outputC1Data[byteC] = static_cast<uchar>(data[static_cast<size_t>(byteC)]);
-                if (fixed < 0) outputC1Errors[byteC] = 1; else outputC1Errors[byteC] = 0;
+                outputC1Data[byteC] = codeword[byteC];
+                outputC1Errors[byteC] = 0;
             }
         } else {
             // Erasure
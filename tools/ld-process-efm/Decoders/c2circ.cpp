@@ -24,6 +24,8 @@
 
 #include "c2circ.h"
 
+#include "circsyndrome.h"
+
 C2Circ::C2Circ()
 {
     reset();
@@ -134,37 +136,53 @@ void C2Circ::errorCorrect()
 {
     // The C2 error correction can correct, at most, 4 symbols
 
-    // Convert the data and errors into the form expected by the ezpwd library
-    std::vector<uint8_t> data;
-    std::vector<int> erasures;
-    data.resize(32);
-
+    // Count the erasures
+    qint32 erasureCount = 0;
     for (qint32 byteC = 0; byteC < 28; byteC++) {
-        data[static_cast<size_t>(byteC)] = static_cast<uchar>(interleavedC2Data[byteC]);
-        if (interleavedC2Errors[byteC] != static_cast<char>(0)) erasures.push_back(byteC);
+        if (interleavedC2Errors[byteC] != static_cast<char>(0)) erasureCount++;
     }
 
     // Perform error check and correction
     int fixed = -1;
 
-    if (erasures.size() <= 4 ) {
-        // Perform error check and correction
+    if (erasureCount <= 4) {
+        // The codeword as passed to the decoder (the 28 C2 symbols, padded with zeros)
+        uchar codeword[32];
+        for (qint32 byteC = 0; byteC < 28; byteC++) codeword[byteC] = interleavedC2Data[byteC];
+        for (qint32 byteC = 28; byteC < 32; byteC++) codeword[byteC] = 0;
 
-        // Initialise the error corrector
-        C2RS<255,255-4> rs; // Up to 251 symbols data load with 4 symbols parity RS(32,28)
+        if (CircSyndrome::isCodeword(codeword)) {
+            // All the syndromes are zero, so there are no errors to correct; the
+            // full decode would return 0 and leave the data unchanged
+            fixed = 0;
+        } else {
+            // Convert the data and errors into the form expected by the ezpwd library
+            std::vector<uint8_t> data(codeword, codeword + 32);
+            std::vector<int> erasures;
+            for (qint32 byteC = 0; byteC < 28; byteC++) {
+                if (interleavedC2Errors[byteC] != static_cast<char>(0)) erasures.push_back(byteC);
+            }
 
-        // Perform decode
-        std::vector<int> position;
-        fixed = rs.decode(data, erasures, &position);
+            // Initialise the error corrector
+            C2RS<255,255-4> rs; // Up to 251 symbols data load with 4 symbols parity RS(32,28)
 
-        // If there were more than 3 symbols in error, mark the C2 as an erasure
-        if (fixed > 3) fixed = -1;
+            // Perform decode
+            std::vector<int> position;
+            fixed = rs.decode(data, erasures, &position);
+
+            // If there were more than 3 symbols in error, mark the C2 as an erasure
+            if (fixed > 3) fixed = -1;
+
+            if (fixed >= 0) {
+                for (qint32 byteC = 0; byteC < 28; byteC++) codeword[byteC] = static_cast<uchar>(data[static_cast<size_t>(byteC)]);
+            }
+        }
 
         if (fixed >= 0) {
             // Copy the result back to the output byte array (removing the parity symbols)
             for (qint32 byteC = 0; byteC < 28; byteC++) {
-                outputC2Data[byteC] = static_cast<uchar>(data[static_cast<size_t>(byteC)]);
-                if (fixed < 0) outputC2Errors[byteC] = 1; else outputC2Errors[byteC] = 0;
+                outputC2Data[byteC] = codeword[byteC];
+                outputC2Errors[byteC] = 0;
             }
         } else {
             // Erasure
@@ -0,0 +1,92 @@
+/************************************************************************
+
+    circsyndrome.cpp
+
+    ld-process-efm - EFM data decoder
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-process-efm is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+
+#include "circsyndrome.h"
+
+namespace {
+    // Number of syndromes (parity symbols) in each codeword
+    constexpr qint32 NROOTS = 4;
+
+    // Log value used for the zero symbol, which has no logarithm.  Any sum of
+    // this and a position exponent indexes a zero entry in the antilog table.
+    constexpr qint32 LOG_ZERO = 510;
+
+    struct Tables {
+        Tables() {
+            // Build the log and antilog tables for GF(2^8) with polynomial 0x11d
+            qint32 value = 1;
+            for (qint32 i = 0; i < 255; i++) {
+                antilog[i] = static_cast<uchar>(value);
+                antilog[i + 255] = static_cast<uchar>(value);
+                log[value] = static_cast<quint16>(i);
+                value <<= 1;
+                if (value & 0x100) value ^= 0x11d;
+            }
+            for (qint32 i = 510; i < LOG_ZERO + 255; i++) antilog[i] = 0;
+            log[0] = LOG_ZERO;
+
+            // Syndrome i evaluates the codeword polynomial at alpha^i, so symbol j is
+            // multiplied by alpha^(i * (31 - j))
+            for (qint32 i = 0; i < NROOTS; i++) {
+                for (qint32 j = 0; j < CircSyndrome::CODEWORD_SYMBOLS; j++) {
+                    positionExponent[i][j] = static_cast<quint16>((i * (CircSyndrome::CODEWORD_SYMBOLS - 1 - j)) % 255);
+                }
+            }
+        }
+
+        quint16 log[256];
+        uchar antilog[LOG_ZERO + 255];
+        quint16 positionExponent[NROOTS][CircSyndrome::CODEWORD_SYMBOLS];
+    };
+
+    const Tables &getTables()
+    {
+        static const Tables tables;
+        return tables;
+    }
+}
+
+bool CircSyndrome::isCodeword(const uchar *symbols)
+{
+    // Syndrome 0 is the XOR of all the symbols, and is the cheapest to check
+    uchar syndrome = 0;
+    for (qint32 j = 0; j < CODEWORD_SYMBOLS; j++) syndrome ^= symbols[j];
+    if (syndrome != 0) return false;
+
+    const Tables &tables = getTables();
+
+    quint16 symbolLog[CODEWORD_SYMBOLS];
+    for (qint32 j = 0; j < CODEWORD_SYMBOLS; j++) symbolLog[j] = tables.log[symbols[j]];
+
+    for (qint32 i = 1; i < NROOTS; i++) {
+        const quint16 *exponent = tables.positionExponent[i];
+        for (qint32 j = 0; j < CODEWORD_SYMBOLS; j++) {
+            syndrome ^= tables.antilog[symbolLog[j] + exponent[j]];
+        }
+        if (syndrome != 0) return false;
+    }
+
+    return true;
+}
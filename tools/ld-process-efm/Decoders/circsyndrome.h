@@ -0,0 +1,46 @@
+/************************************************************************
+
+    circsyndrome.h
+
+    ld-process-efm - EFM data decoder
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-process-efm is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+
+#ifndef CIRCSYNDROME_H
+#define CIRCSYNDROME_H
+
+#include <QtGlobal>
+
+// Syndrome check for the RS(32,28) codewords used by C1 and C2 CIRC error
+// correction: GF(2^8) with field polynomial 0x11d and generator roots
+// alpha^0 to alpha^3, as configured by C1RS and C2RS.
+//
+// This computes the same syndromes as the ezpwd decoder, using log/antilog
+// tables, so that a codeword with no errors can be recognised without
+// running the full decode.
+namespace CircSyndrome {
+    // Number of symbols in a codeword, including the 4 parity symbols
+    static constexpr qint32 CODEWORD_SYMBOLS = 32;
+
+    // Return true if all the syndromes of the codeword are zero
+    bool isCodeword(const uchar *symbols);
+}
+
+#endif // CIRCSYNDROME_H
@@ -33,7 +33,11 @@ EfmToF3Frames::EfmToF3Frames()
 // Public methods -----------------------------------------------------------------------------------------------------
 
 // Main processing method
-std::vector<F3Frame> EfmToF3Frames::process(QByteArray efmDataIn, bool debugState, bool _audioIsDts)
+//
+// The EFM T-values are read in place from efmDataIn; only the (small) number of
+// T-values left unconsumed at the end of each call are copied, so they can be
+// joined to the start of the next call's data.
+const std::vector<F3Frame> &EfmToF3Frames::process(const char *efmDataIn, qint32 efmDataLength, bool debugState, bool _audioIsDts)
 {
     debugOn = debugState;
     audioIsDts = _audioIsDts;
@@ -41,35 +45,42 @@ std::vector<F3Frame> EfmToF3Frames::process(QByteArray efmDataIn, bool debugStat
     // Clear the output buffer
     f3FramesOut.clear();
 
-    // Append input data to the processing buffer
-    efmDataBuffer.append(efmDataIn);
+    // If T-values were left over from the previous call, join the start of the
+    // new data on to them and process that until the state-machine has consumed
+    // all of the carried T-values.  The joined region grows geometrically, so
+    // this only copies more than a few KiB if the state-machine stalls.
+    qint32 inputPosition = 0;
+    while (!carryBuffer.isEmpty() && inputPosition < efmDataLength) {
+        qint32 joinLength = qMin(efmDataLength - inputPosition, qMax(carryBuffer.size(), 4096));
+        carryBuffer.append(efmDataIn + inputPosition, joinLength);
+        inputPosition += joinLength;
+
+        efmData = carryBuffer.constData();
+        efmDataSize = carryBuffer.size();
+        runStateMachine();
+
+        if (efmDataSize <= inputPosition) {
+            // The remaining T-values all come from the new data, so continue from there
+            inputPosition -= efmDataSize;
+            carryBuffer.clear();
+        } else {
+            carryBuffer = carryBuffer.right(efmDataSize);
+        }
+    }
 
-    waitingForData = false;
-    while (!waitingForData) {
-        currentState = nextState;
+    // Process the rest of the new data in place
+    if (carryBuffer.isEmpty() && inputPosition < efmDataLength) {
+        efmData = efmDataIn + inputPosition;
+        efmDataSize = efmDataLength - inputPosition;
+        runStateMachine();
 
-        switch (currentState) {
-        case state_initial:
-            nextState = sm_state_initial();
-            break;
-        case state_findInitialSyncStage1:
-            nextState = sm_state_findInitialSyncStage1();
-            break;
-        case state_findInitialSyncStage2:
-            nextState = sm_state_findInitialSyncStage2();
-            break;
-        case state_findSecondSync:
-            nextState = sm_state_findSecondSync();
-            break;
-        case state_syncLost:
-            nextState = sm_state_syncLost();
-            break;
-        case state_processFrame:
-            nextState = sm_state_processFrame();
-            break;
-        }
+        // Keep the unconsumed T-values for the next call
+        carryBuffer.append(efmData, efmDataSize);
     }
 
+    efmData = nullptr;
+    efmDataSize = 0;
+
     return f3FramesOut;
 }
 
@@ -114,7 +125,9 @@ void EfmToF3Frames::reset()
     clearStatistics();
 
     // Initialise the state-machine
-    efmDataBuffer.clear();
+    carryBuffer.clear();
+    efmData = nullptr;
+    efmDataSize = 0;
     currentState = state_initial;
     nextState = currentState;
     waitingForData = false;
@@ -125,6 +138,45 @@ void EfmToF3Frames::reset()
 
 // Private methods ----------------------------------------------------------------------------------------------------
 
+// Run the state-machine until it needs more EFM data than the input window holds
+void EfmToF3Frames::runStateMachine()
+{
+    waitingForData = false;
+    while (!waitingForData) {
+        currentState = nextState;
+
+        switch (currentState) {
+        case state_initial:
+            nextState = sm_state_initial();
+            break;
+        case state_findInitialSyncStage1:
+            nextState = sm_state_findInitialSyncStage1();
+            break;
+        case state_findInitialSyncStage2:
+            nextState = sm_state_findInitialSyncStage2();
+            break;
+        case state_findSecondSync:
+            nextState = sm_state_findSecondSync();
+            break;
+        case state_syncLost:
+            nextState = sm_state_syncLost();
+            break;
+        case state_processFrame:
+            nextState = sm_state_processFrame();
+            break;
+        }
+    }
+}
+
+// Discard T-values from the start of the input window
+void EfmToF3Frames::consumeEfmData(qint32 count)
+{
+    if (count <= 0) return;
+
+    efmData += count;
+    efmDataSize -= count;
+}
+
 // Method to clear the statistics counters
 void EfmToF3Frames::clearStatistics()
 {
@@ -161,18 +213,18 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_findInitialSyncStage1()
     // Find the first T11+T11 sync pattern in the EFM buffer
     qint32 startSyncTransition = -1;
 
-    for (qint32 i = 0; i < efmDataBuffer.size() - 1; i++) {
-        if (efmDataBuffer[i] == static_cast<char>(11) && efmDataBuffer[i + 1] == static_cast<char>(11)) {
+    for (qint32 i = 0; i < efmDataSize - 1; i++) {
+        if (efmData[i] == static_cast<char>(11) && efmData[i + 1] == static_cast<char>(11)) {
             startSyncTransition = i;
             break;
         }
     }
 
     if (startSyncTransition == -1) {
-        if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findInitialSyncStage1(): No initial F3 sync found in EFM buffer - discarding" << efmDataBuffer.size() - 1 << "EFM values";
+        if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findInitialSyncStage1(): No initial F3 sync found in EFM buffer - discarding" << efmDataSize - 1 << "EFM values";
 
         // Discard the EFM already tested and try again
-        efmDataBuffer.remove(0, efmDataBuffer.size() - 1);
+        consumeEfmData(efmDataSize - 1);
 
         waitingForData = true;
         return state_findInitialSyncStage1;
@@ -181,7 +233,7 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_findInitialSyncStage1()
     if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findInitialSyncStage1(): Initial F3 sync found at buffer position" << startSyncTransition << "- discarding" << startSyncTransition << "EFM values";
 
     // Discard all EFM data up to the sync start
-    efmDataBuffer.remove(0, startSyncTransition);
+    consumeEfmData(startSyncTransition);
 
     // Move to find initial sync stage 2
     return state_findInitialSyncStage2;
@@ -198,12 +250,12 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_findInitialSyncStage2()
 
     qint32 searchLength = 588 * 4;
 
-    for (qint32 i = 1; i < efmDataBuffer.size() - 1; i++) {
-        if (efmDataBuffer[i] == static_cast<char>(11) && efmDataBuffer[i + 1] == static_cast<char>(11)) {
+    for (qint32 i = 1; i < efmDataSize - 1; i++) {
+        if (efmData[i] == static_cast<char>(11) && efmData[i + 1] == static_cast<char>(11)) {
             endSyncTransition = i;
             break;
         }
-        tTotal += efmDataBuffer[i];
+        tTotal += efmData[i];
 
         // If we are more than a few F3 frame lengths out, give up
         if (tTotal > searchLength) {
@@ -215,7 +267,7 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_findInitialSyncStage2()
     if (tTotal > searchLength) {
         if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findInitialSyncStage2(): No second F3 sync found within a reasonable length, going back to look for new initial sync.  T =" << tTotal;
         if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findInitialSyncStage2(): Discarding" << endSyncTransition << "EFM values";
-        efmDataBuffer.remove(0, endSyncTransition);
+        consumeEfmData(endSyncTransition);
         return state_findInitialSyncStage1;
     }
 
@@ -228,7 +280,7 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_findInitialSyncStage2()
     if (tTotal < 587 || tTotal > 589) {
         // Discard the transitions already tested and try again
         if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findInitialSyncStage2(): Discarding" << endSyncTransition << "EFM values";
-        efmDataBuffer.remove(0, endSyncTransition);
+        consumeEfmData(endSyncTransition);
         return state_findInitialSyncStage2;
     }
 
@@ -246,8 +298,8 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_findSecondSync()
     // Get at least 588 bits of data
     qint32 i = 0;
     qint32 tTotal = 0;
-    while (i < efmDataBuffer.size() && tTotal < 588) {
-        tTotal += efmDataBuffer[i];
+    while (i < efmDataSize && tTotal < 588) {
+        tTotal += efmData[i];
         i++;
     }
 
@@ -259,7 +311,7 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_findSecondSync()
     }
 
     // Do we have enough data to verify the sync position?
-    if ((efmDataBuffer.size() - i) < 2) {
+    if ((efmDataSize - i) < 2) {
         // Indicate that more deltas are required and stay in this state
         waitingForData = true;
         return state_findSecondSync;
@@ -274,15 +326,15 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_findSecondSync()
         sequentialGoodSyncCounter++;
     } else {
         // Handle various possible sync issues in a (hopefully) smart way
-        if (efmDataBuffer[i] == static_cast<char>(11) && efmDataBuffer[i + 1] == static_cast<char>(11)) {
+        if (efmData[i] == static_cast<char>(11) && efmData[i + 1] == static_cast<char>(11)) {
             if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findSecondSync(): F3 Sync is in the right position and is valid - frame contains invalid T value";
             endSyncTransition = i;
             statistics.validSyncs++;
-        } else if (efmDataBuffer[i - 1] == static_cast<char>(11) && efmDataBuffer[i] == static_cast<char>(11)) {
+        } else if (efmData[i - 1] == static_cast<char>(11) && efmData[i] == static_cast<char>(11)) {
             if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findSecondSync(): F3 Sync valid, but off by one transition backwards";
             endSyncTransition = i - 1;
             statistics.undershootSyncs++;
-        } else if (efmDataBuffer[i - 1] >= static_cast<char>(10) && efmDataBuffer[i] >= static_cast<char>(10)) {
+        } else if (efmData[i - 1] >= static_cast<char>(10) && efmData[i] >= static_cast<char>(10)) {
             if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findSecondSync(): F3 Sync value low and off by one transition backwards";
             endSyncTransition = i - 1;
             statistics.undershootSyncs++;
@@ -299,11 +351,11 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_findSecondSync()
                     if (tTotal > 588) endSyncTransition = i - 1; else endSyncTransition = i;
                     sequentialBadSyncCounter++;
                     if (tTotal > 588) statistics.overshootSyncs++; else statistics.undershootSyncs++;
-            } else if (efmDataBuffer[i] == static_cast<char>(11) && efmDataBuffer[i + 1] == static_cast<char>(11)) {
+            } else if (efmData[i] == static_cast<char>(11) && efmData[i + 1] == static_cast<char>(11)) {
                 if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findSecondSync(): F3 Sync valid, but off by one transition forward";
                 endSyncTransition = i;
                 statistics.overshootSyncs++;
-            } else if (efmDataBuffer[i] >= static_cast<char>(10) && efmDataBuffer[i + 1] >= static_cast<char>(10)) {
+            } else if (efmData[i] >= static_cast<char>(10) && efmData[i + 1] >= static_cast<char>(10)) {
                 if (debugOn) qDebug() << "EfmToF3Frames::sm_state_findSecondSync(): F3 Sync value low and off by one transition forward";
                 endSyncTransition = i;
                 statistics.overshootSyncs++;
@@ -365,7 +417,7 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_processFrame()
         qDebug() << "EfmToF3Frames::sm_state_processFrame(): Number of T-values in frame exceeded 189!";
     }
     for (qint32 delta = 0; delta < tLength; delta++) {
-        uchar value = static_cast<uchar>(efmDataBuffer[delta]);
+        uchar value = static_cast<uchar>(efmData[delta]);
 
         if (value < 3 || value > 11) statistics.outOfRangeTValues++;
         else statistics.inRangeTValues++;
@@ -390,7 +442,7 @@ EfmToF3Frames::StateMachine EfmToF3Frames::sm_state_processFrame()
     statistics.correctedEfmSymbols += f3FramesOut.back().getNumberOfCorrectedEfmSymbols();
 
     // Discard all transitions up to the sync end
-    efmDataBuffer.remove(0, endSyncTransition);
+    consumeEfmData(endSyncTransition);
 
     // Find the next sync position
     return state_findSecondSync;
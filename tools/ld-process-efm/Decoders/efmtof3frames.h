@@ -55,7 +55,7 @@ public:
         qint64 correctedEfmSymbols;
     };
 
-    std::vector<F3Frame> process(QByteArray efmDataIn, bool debugState, bool _audioIsDts);
+    const std::vector<F3Frame> &process(const char *efmDataIn, qint32 efmDataLength, bool debugState, bool _audioIsDts);
     const Statistics &getStatistics() const;
     void reportStatistics() const;
     void reset();
@@ -64,7 +64,14 @@ private:
     bool debugOn;
     bool audioIsDts;
     Statistics statistics;
-    QByteArray efmDataBuffer;
+
+    // Input window - the EFM T-values not yet consumed by the state-machine.
+    // This points either into the caller's data or into carryBuffer, which holds
+    // the T-values left over from the previous call to process().
+    const char *efmData;
+    qint32 efmDataSize;
+    QByteArray carryBuffer;
+
     std::vector<F3Frame> f3FramesOut;
 
     // State machine state definitions
@@ -86,6 +93,8 @@ private:
     qint32 endSyncTransition;
 
     void clearStatistics();
+    void runStateMachine();
+    void consumeEfmData(qint32 count);
 
     StateMachine sm_state_initial();
     StateMachine sm_state_findInitialSyncStage1();
@@ -33,21 +33,29 @@ F3ToF2Frames::F3ToF2Frames()
 // Public methods -----------------------------------------------------------------------------------------------------
 
 const std::vector<F2Frame> &F3ToF2Frames::process(const std::vector<F3Frame> &f3FramesIn, bool debugState, bool noTimeStamp)
+{
+    return processC2(processC1(f3FramesIn, debugState, noTimeStamp));
+}
+
+// Process sections of F3 frames through C1 CIRC. This and processC2 can be
+// called from different threads, as they don't share any state other than
+// separate statistics counters.
+const std::vector<F3ToF2Frames::C1Section> &F3ToF2Frames::processC1(const std::vector<F3Frame> &f3FramesIn, bool debugState, bool noTimeStamp)
 {
     debugOn = debugState;
 
     // Clear the output buffer
-    f2FramesOut.clear();
+    c1SectionsOut.clear();
 
     // Make sure there is something to process
-    if (f3FramesIn.empty()) return f2FramesOut;
+    if (f3FramesIn.empty()) return c1SectionsOut;
 
     // Ensure that the upstream is providing only complete sections of
     // 98 frames... otherwise we have an upstream bug.
     if (f3FramesIn.size() % 98 != 0) {
         qFatal("F3ToF2Frames::process(): Upstream has provided incomplete sections of 98 F3 frames - This is a bug!");
         // Exection stops...
-        // return f2FramesOut;
+        // return c1SectionsOut;
     }
 
     // Process the incoming F3 Frames.
@@ -173,12 +181,6 @@ const std::vector<F2Frame> &F3ToF2Frames::process(const std::vector<F3Frame> &f3
                 statistics.sequenceInterruptions++;
                 statistics.missingF3Frames += (sectionFrameGap - 1) * 98;
                 c1Circ.flush();
-                c2Circ.flush();
-                c2Deinterleave.flush();
-
-                // Also flush the section metadata as it's now out of sync
-                sectionBuffer.clear();
-                sectionDiscTimes.clear();
 
                 // Mark section loss
                 lostSections = true;
@@ -188,88 +190,120 @@ const std::vector<F2Frame> &F3ToF2Frames::process(const std::vector<F3Frame> &f3
             lastDiscTime = currentDiscTime;
             statistics.currentDiscTime = currentDiscTime;
 
-            // Add the new section to our section buffer
-            sectionBuffer.push_back(section);
-            sectionDiscTimes.push_back(currentDiscTime);
+            // Pass the section on to the C2 stage, telling it to flush its
+            // buffers too if the section isn't contiguous
+            c1SectionsOut.emplace_back();
+            C1Section &c1Section = c1SectionsOut.back();
+            c1Section.flush = sectionFrameGap > 1;
+            c1Section.section = section;
+            c1Section.discTime = currentDiscTime;
+            c1Section.numC1Frames = 0;
 
-            // Process the F3 frames into F2 frames (payload data)
+            // Process the F3 frames through C1 CIRC
             for (qint32 i = 0; i < 98; i++) {
-                // Process C1 CIRC
                 c1Circ.pushF3Frame(f3FramesIn[inputIndex + i]);
 
-                // If we have C1 results, process C2
+                // Collect the C1 results, if there are any
                 if (c1Circ.getDataSymbols() != nullptr) {
-                    // Get C1 results
-                    uchar c1DataSymbols[28];
-                    uchar c1ErrorSymbols[28];
-                    for (qint32 i = 0; i < 28; i++) {
-                        c1DataSymbols[i] = c1Circ.getDataSymbols()[i];
-                        c1ErrorSymbols[i] = c1Circ.getErrorSymbols()[i];
+                    uchar *c1DataSymbols = c1Section.c1DataSymbols + (c1Section.numC1Frames * 28);
+                    uchar *c1ErrorSymbols = c1Section.c1ErrorSymbols + (c1Section.numC1Frames * 28);
+                    for (qint32 j = 0; j < 28; j++) {
+                        c1DataSymbols[j] = c1Circ.getDataSymbols()[j];
+                        c1ErrorSymbols[j] = c1Circ.getErrorSymbols()[j];
                     }
+                    c1Section.numC1Frames++;
+                }
+            }
+        }
+    }
 
-                    // Process C2 CIRC
-                    c2Circ.pushC1(c1DataSymbols, c1ErrorSymbols);
-
-                    // Only process the F2 frames if we received data
-                    if (c2Circ.getDataSymbols() != nullptr) {
-                        // Get C2 results
-                        uchar c2DataSymbols[28];
-                        uchar c2ErrorSymbols[28];
-                        for (qint32 i = 0; i < 28; i++) {
-                            c2DataSymbols[i] = c2Circ.getDataSymbols()[i];
-                            c2ErrorSymbols[i] = c2Circ.getErrorSymbols()[i];
-                        }
-
-                        // Deinterleave the C2
-                        c2Deinterleave.pushC2(c2DataSymbols, c2ErrorSymbols);
-
-                        // If we have deinterleaved C2s, create an F2 frame
-                        if (c2Deinterleave.getDataSymbols() != nullptr) {
-                            // Get C2 deinterleave results
-                            uchar c2DeinterleavedData[24];
-                            uchar c2DeinterleavedErrors[24];
-                            for (qint32 i = 0; i < 24; i++) {
-                                c2DeinterleavedData[i] = c2Deinterleave.getDataSymbols()[i];
-                                c2DeinterleavedErrors[i] = c2Deinterleave.getErrorSymbols()[i];
-                            }
-
-                            F2Frame newF2Frame;
-                            newF2Frame.setData(c2DeinterleavedData, c2DeinterleavedErrors);
-
-                            // Add the section metadata to the F2 Frame (each section is applied to
-                            // 98 F2 frames)
-
-                            // Always output the disc time from the corrected local version
-                            newF2Frame.setDiscTime(sectionDiscTimes[0]);
-
-                            // Only use the real metadata if it is valid and available
-                            if (sectionBuffer[0].getQMode() == 1 || sectionBuffer[0].getQMode() == 4) {
-                                newF2Frame.setTrackTime(sectionBuffer[0].getQMetadata().qMode1And4.trackTime);
-                                newF2Frame.setTrackNumber(sectionBuffer[0].getQMetadata().qMode1And4.trackNumber);
-                                newF2Frame.setIsEncoderRunning(sectionBuffer[0].getQMetadata().qMode1And4.isEncoderRunning);
-                            } else {
-                                newF2Frame.setTrackTime(TrackTime(0, 0, 0));
-                                newF2Frame.setTrackNumber(1);
-                                newF2Frame.setIsEncoderRunning(true);
-                            }
-
-                            // Add the F2 frame to our output buffer
-                            f2FrameBuffer.push_back(newF2Frame);
-
-                        }
-                    }
+    return c1SectionsOut;
+}
+
+// Process the C1 results from processC1 through C2 CIRC and deinterleaving
+// into F2 frames
+const std::vector<F2Frame> &F3ToF2Frames::processC2(const std::vector<C1Section> &c1SectionsIn)
+{
+    // Clear the output buffer
+    f2FramesOut.clear();
+
+    for (const C1Section &c1Section : c1SectionsIn) {
+        if (c1Section.flush) {
+            // The C2 and deinterleave buffers are full of the wrong data
+            c2Circ.flush();
+            c2Deinterleave.flush();
+
+            // Also flush the section metadata as it's now out of sync
+            sectionBuffer.clear();
+            sectionDiscTimes.clear();
+        }
+
+        // Add the new section to our section buffer
+        sectionBuffer.push_back(c1Section.section);
+        sectionDiscTimes.push_back(c1Section.discTime);
+
+        // Process the C1 results into F2 frames (payload data)
+        for (qint32 i = 0; i < c1Section.numC1Frames; i++) {
+            // Process C2 CIRC
+            c2Circ.pushC1(c1Section.c1DataSymbols + (i * 28), c1Section.c1ErrorSymbols + (i * 28));
+
+            // Only process the F2 frames if we received data
+            if (c2Circ.getDataSymbols() != nullptr) {
+                // Get C2 results
+                uchar c2DataSymbols[28];
+                uchar c2ErrorSymbols[28];
+                for (qint32 j = 0; j < 28; j++) {
+                    c2DataSymbols[j] = c2Circ.getDataSymbols()[j];
+                    c2ErrorSymbols[j] = c2Circ.getErrorSymbols()[j];
                 }
 
-                // If we have 98 F2 frames, move them to the output buffer
-                if (f2FrameBuffer.size() == 98) {
-                    f2FramesOut.insert(f2FramesOut.end(), f2FrameBuffer.begin(), f2FrameBuffer.end());
-                    statistics.totalF2Frames += 98;
-                    f2FrameBuffer.clear();
+                // Deinterleave the C2
+                c2Deinterleave.pushC2(c2DataSymbols, c2ErrorSymbols);
+
+                // If we have deinterleaved C2s, create an F2 frame
+                if (c2Deinterleave.getDataSymbols() != nullptr) {
+                    // Get C2 deinterleave results
+                    uchar c2DeinterleavedData[24];
+                    uchar c2DeinterleavedErrors[24];
+                    for (qint32 j = 0; j < 24; j++) {
+                        c2DeinterleavedData[j] = c2Deinterleave.getDataSymbols()[j];
+                        c2DeinterleavedErrors[j] = c2Deinterleave.getErrorSymbols()[j];
+                    }
+
+                    F2Frame newF2Frame;
+                    newF2Frame.setData(c2DeinterleavedData, c2DeinterleavedErrors);
 
-                    sectionBuffer.erase(sectionBuffer.begin());
-                    sectionDiscTimes.erase(sectionDiscTimes.begin());
+                    // Add the section metadata to the F2 Frame (each section is applied to
+                    // 98 F2 frames)
+
+                    // Always output the disc time from the corrected local version
+                    newF2Frame.setDiscTime(sectionDiscTimes[0]);
+
+                    // Only use the real metadata if it is valid and available
+                    if (sectionBuffer[0].getQMode() == 1 || sectionBuffer[0].getQMode() == 4) {
+                        newF2Frame.setTrackTime(sectionBuffer[0].getQMetadata().qMode1And4.trackTime);
+                        newF2Frame.setTrackNumber(sectionBuffer[0].getQMetadata().qMode1And4.trackNumber);
+                        newF2Frame.setIsEncoderRunning(sectionBuffer[0].getQMetadata().qMode1And4.isEncoderRunning);
+                    } else {
+                        newF2Frame.setTrackTime(TrackTime(0, 0, 0));
+                        newF2Frame.setTrackNumber(1);
+                        newF2Frame.setIsEncoderRunning(true);
+                    }
+
+                    // Add the F2 frame to our output buffer
+                    f2FrameBuffer.push_back(newF2Frame);
                 }
             }
+
+            // If we have 98 F2 frames, move them to the output buffer
+            if (f2FrameBuffer.size() == 98) {
+                f2FramesOut.insert(f2FramesOut.end(), f2FrameBuffer.begin(), f2FrameBuffer.end());
+                statistics.totalF2Frames += 98;
+                f2FrameBuffer.clear();
+
+                sectionBuffer.erase(sectionBuffer.begin());
+                sectionDiscTimes.erase(sectionDiscTimes.begin());
+            }
         }
     }
 
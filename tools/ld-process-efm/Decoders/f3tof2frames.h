@@ -60,7 +60,24 @@ public:
         qint32 preempFrames;
     };
 
+    // The C1 results for one section of 98 F3 frames, passed from the C1
+    // stage to the C2 stage
+    struct C1Section {
+        // Flush C2 and the section metadata before this section
+        bool flush;
+
+        Section section;
+        TrackTime discTime;
+
+        // C1 output for each F3 frame that produced any, 28 symbols each
+        qint32 numC1Frames;
+        uchar c1DataSymbols[98 * 28];
+        uchar c1ErrorSymbols[98 * 28];
+    };
+
     const std::vector<F2Frame> &process(const std::vector<F3Frame> &f3FramesIn, bool debugState, bool noTimeStamp);
+    const std::vector<C1Section> &processC1(const std::vector<F3Frame> &f3FramesIn, bool debugState, bool noTimeStamp);
+    const std::vector<F2Frame> &processC2(const std::vector<C1Section> &c1SectionsIn);
     const Statistics &getStatistics();
     void reportStatistics() const;
     void reset();
@@ -71,7 +88,15 @@ private:
 
     void clearStatistics();
 
+    // C1 stage (processC1)
     C1Circ c1Circ;
+    std::vector<C1Section> c1SectionsOut;
+
+    bool initialDiscTimeSet;
+    TrackTime lastDiscTime;
+    bool lostSections;
+
+    // C2 stage (processC2)
     C2Circ c2Circ;
     C2Deinterleave c2Deinterleave;
 
@@ -79,10 +104,6 @@ private:
     std::vector<F2Frame> f2FramesOut;
     std::vector<Section> sectionBuffer;
     std::vector<TrackTime> sectionDiscTimes;
-
-    bool initialDiscTimeSet;
-    TrackTime lastDiscTime;
-    bool lostSections;
 };
 
 #endif // F3TOF2FRAMES_H
@@ -24,8 +24,30 @@
 
 #include "efmprocess.h"
 
+#include <QElapsedTimer>
 #include <vector>
 
+namespace {
+    // Run one stage of the decoding pipeline: take blocks from the input queue,
+    // process them, and pass any non-empty results on to the output queue.
+    // Closes the output queue once the input queue is exhausted.
+    template <typename In, typename Out, typename Process>
+    void runPipelineStage(StageQueue<In> &input, StageQueue<Out> &output,
+                          EfmProcess::PipelineStageStatistics &stageStatistics, Process process)
+    {
+        In block;
+        while (input.pop(block)) {
+            QElapsedTimer busyTimer;
+            busyTimer.start();
+            const Out &result = process(block);
+            if (!result.empty()) output.push(result);
+            stageStatistics.busyNsecs += busyTimer.nsecsElapsed();
+            stageStatistics.itemsIn += static_cast<qint64>(block.size());
+        }
+        output.close();
+    }
+}
+
 EfmProcess::EfmProcess()
 {
     debug_efmToF3Frames = false;
@@ -100,6 +122,7 @@ void EfmProcess::reportStatistics() const
     f2ToF1Frames.reportStatistics();
     if (decodeAsAudio) f1ToAudio.reportStatistics();
     if (decodeAsData) f1ToData.reportStatistics();
+    reportPipelineStatistics();
 }
 
 // Process the EFM file
@@ -145,38 +168,138 @@ bool EfmProcess::process(QString inputFilename, QString outputFilename)
     qint64 initialInputFileSize = inputFileHandle.bytesAvailable();
     qint32 lastPercent = 0;
 
-    // Set input EFM data buffer size in 256K blocks
-    qint32 bufferSize = 1024 * 256;
-
-    while(inputFileHandle.bytesAvailable() > 0) {
-        // Get a buffer of EFM data
-        QByteArray inputEfmBuffer;
-        inputEfmBuffer.resize(bufferSize);
+    // Process the input EFM data in 256K blocks
+    const qint32 bufferSize = 1024 * 256;
 
-        qint64 bytesRead = inputFileHandle.read(inputEfmBuffer.data(), inputEfmBuffer.size());
-        if (bytesRead != bufferSize) inputEfmBuffer.resize(static_cast<qint32>(bytesRead));
-
-        // Perform EFM processing
-        const std::vector<F3Frame> &initialF3Frames = efmToF3Frames.process(inputEfmBuffer, debug_efmToF3Frames, audioIsDts);
-        const std::vector<F3Frame> &syncedF3Frames = syncF3Frames.process(initialF3Frames, debug_syncF3Frames);
-        const std::vector<F2Frame> &f2Frames = f3ToF2Frames.process(syncedF3Frames, debug_f3ToF2Frames, noTimeStamp);
-        const std::vector<F1Frame> &f1Frames = f2ToF1Frames.process(f2Frames, debug_f2ToF1Frame, noTimeStamp);
-
-        // Process as either audio or data
-        if (decodeAsAudio) {
-            outputFileHandle.write(f1ToAudio.process(f1Frames, padInitialDiscTime, errorTreatment, concealType, debug_f1ToAudio));
+    // If the input file is seekable, map it into memory so the EFM data can be
+    // decoded in place.  Otherwise, read it through a single reused buffer.
+    const char *mappedData = nullptr;
+    if (!inputFileHandle.isSequential() && inputFileHandle.size() > 0) {
+        mappedData = reinterpret_cast<const char *>(inputFileHandle.map(0, inputFileHandle.size()));
+        if (mappedData == nullptr) {
+            qDebug() << "EfmProcess::process(): Could not memory-map EFM input file, falling back to buffered reads";
         } else {
-            outputFileHandle.write(f1ToData.process(f1Frames, debug_f1ToData));
+            qDebug() << "EfmProcess::process(): EFM input file is memory-mapped";
         }
+    }
+    QByteArray inputEfmBuffer;
+    if (mappedData == nullptr) inputEfmBuffer.resize(bufferSize);
+
+    // Set up the decoding pipeline.  This thread reads the input and converts
+    // it into F3 frames; each of the following stages runs on its own thread,
+    // connected by bounded queues of blocks of frames.
+    StageQueue<std::vector<F3Frame>> initialF3Queue(PIPELINE_QUEUE_DEPTH);
+    StageQueue<std::vector<F3Frame>> syncedF3Queue(PIPELINE_QUEUE_DEPTH);
+    StageQueue<std::vector<F3ToF2Frames::C1Section>> c1Queue(PIPELINE_QUEUE_DEPTH);
+    StageQueue<std::vector<F2Frame>> f2Queue(PIPELINE_QUEUE_DEPTH);
+    StageQueue<std::vector<F1Frame>> f1Queue(PIPELINE_QUEUE_DEPTH);
+
+    pipelineStatistics.clear();
+    pipelineStatistics.append({ "EFM to F3 frames", "T-values", 0, 0, false, {} });
+    pipelineStatistics.append({ "Sync F3 frames", "F3 frames", 0, 0, true, {} });
+    pipelineStatistics.append({ "F3 frames to C1", "F3 frames", 0, 0, true, {} });
+    pipelineStatistics.append({ "C1 to F2 frames", "sections", 0, 0, true, {} });
+    pipelineStatistics.append({ "F2 to F1 frames", "F2 frames", 0, 0, true, {} });
+    pipelineStatistics.append({ decodeAsAudio ? "F1 to audio" : "F1 to data", "F1 frames", 0, 0, true, {} });
+
+    StageThread syncThread([&]() {
+        runPipelineStage(initialF3Queue, syncedF3Queue, pipelineStatistics[1], [&](const std::vector<F3Frame> &f3Frames) -> const std::vector<F3Frame> & {
+            return syncF3Frames.process(f3Frames, debug_syncF3Frames);
+        });
+    });
+    StageThread c1Thread([&]() {
+        runPipelineStage(syncedF3Queue, c1Queue, pipelineStatistics[2], [&](const std::vector<F3Frame> &f3Frames) -> const std::vector<F3ToF2Frames::C1Section> & {
+            return f3ToF2Frames.processC1(f3Frames, debug_f3ToF2Frames, noTimeStamp);
+        });
+    });
+    StageThread c2Thread([&]() {
+        runPipelineStage(c1Queue, f2Queue, pipelineStatistics[3], [&](const std::vector<F3ToF2Frames::C1Section> &c1Sections) -> const std::vector<F2Frame> & {
+            return f3ToF2Frames.processC2(c1Sections);
+        });
+    });
+    StageThread f2ToF1Thread([&]() {
+        runPipelineStage(f2Queue, f1Queue, pipelineStatistics[4], [&](const std::vector<F2Frame> &f2Frames) -> const std::vector<F1Frame> & {
+            return f2ToF1Frames.process(f2Frames, debug_f2ToF1Frame, noTimeStamp);
+        });
+    });
+    StageThread outputThread([&]() {
+        PipelineStageStatistics &stageStatistics = pipelineStatistics[5];
+        std::vector<F1Frame> f1Frames;
+        while (f1Queue.pop(f1Frames)) {
+            QElapsedTimer busyTimer;
+            busyTimer.start();
+
+            // Process as either audio or data
+            if (decodeAsAudio) {
+                outputFileHandle.write(f1ToAudio.process(f1Frames, padInitialDiscTime, errorTreatment, concealType, debug_f1ToAudio));
+            } else {
+                outputFileHandle.write(f1ToData.process(f1Frames, debug_f1ToData));
+            }
+
+            stageStatistics.busyNsecs += busyTimer.nsecsElapsed();
+            stageStatistics.itemsIn += static_cast<qint64>(f1Frames.size());
+        }
+    });
+
+    syncThread.start();
+    c1Thread.start();
+    c2Thread.start();
+    f2ToF1Thread.start();
+    outputThread.start();
+
+    qint64 inputPosition = 0;
+    qint64 bytesRemaining = initialInputFileSize;
+    while ((mappedData != nullptr) ? (bytesRemaining > 0) : (inputFileHandle.bytesAvailable() > 0)) {
+        // Get a block of EFM data
+        const char *efmData;
+        qint32 efmDataLength;
+        if (mappedData != nullptr) {
+            efmData = mappedData + inputPosition;
+            efmDataLength = static_cast<qint32>(qMin(bytesRemaining, static_cast<qint64>(bufferSize)));
+            inputPosition += efmDataLength;
+            bytesRemaining -= efmDataLength;
+        } else {
+            qint64 bytesRead = inputFileHandle.read(inputEfmBuffer.data(), inputEfmBuffer.size());
+            if (bytesRead <= 0) break;
+            efmData = inputEfmBuffer.constData();
+            efmDataLength = static_cast<qint32>(bytesRead);
+            bytesRemaining = inputFileHandle.bytesAvailable();
+        }
+
+        // Convert the EFM data into F3 frames, and pass them down the pipeline
+        QElapsedTimer busyTimer;
+        busyTimer.start();
+        const std::vector<F3Frame> &initialF3Frames = efmToF3Frames.process(efmData, efmDataLength, debug_efmToF3Frames, audioIsDts);
+        if (!initialF3Frames.empty()) initialF3Queue.push(initialF3Frames);
+        pipelineStatistics[0].busyNsecs += busyTimer.nsecsElapsed();
+        pipelineStatistics[0].itemsIn += efmDataLength;
 
         // Report progress to user
-        double percent = 100 - (100.0 / static_cast<double>(initialInputFileSize)) * static_cast<double>(inputFileHandle.bytesAvailable());
+        double percent = 100 - (100.0 / static_cast<double>(initialInputFileSize)) * static_cast<double>(bytesRemaining);
         if (static_cast<qint32>(percent) > lastPercent) {
             qInfo().nospace() << "Processed " << static_cast<qint32>(percent) << "%";
         }
         lastPercent = static_cast<qint32>(percent);
     }
 
+    // Wait for the pipeline to drain
+    initialF3Queue.close();
+    syncThread.wait();
+    c1Thread.wait();
+    c2Thread.wait();
+    f2ToF1Thread.wait();
+    outputThread.wait();
+
+    pipelineStatistics[1].inputQueue = initialF3Queue.getStatistics();
+    pipelineStatistics[2].inputQueue = syncedF3Queue.getStatistics();
+    pipelineStatistics[3].inputQueue = c1Queue.getStatistics();
+    pipelineStatistics[4].inputQueue = f2Queue.getStatistics();
+    pipelineStatistics[5].inputQueue = f1Queue.getStatistics();
+
+    if (mappedData != nullptr) {
+        inputFileHandle.unmap(reinterpret_cast<uchar *>(const_cast<char *>(mappedData)));
+    }
+
     // Check if audio is available
     if (f1ToAudio.getStatistics().totalSamples > 0) qDebug() << "EfmProcess::process(): Audio is available";
     if (f1ToData.getStatistics().totalSectors > 0) qDebug() << "EfmProcess::process(): Data is available";
@@ -193,6 +316,31 @@ bool EfmProcess::process(QString inputFilename, QString outputFilename)
     return true;
 }
 
+// Output the per-stage pipeline statistics to qInfo
+void EfmProcess::reportPipelineStatistics() const
+{
+    if (pipelineStatistics.isEmpty()) return;
+
+    qInfo() << "";
+    qInfo() << "Decoding pipeline:";
+    for (const PipelineStageStatistics &stage : pipelineStatistics) {
+        const double busySeconds = static_cast<double>(stage.busyNsecs) / 1e9;
+        qInfo().nospace().noquote() << "  " << stage.name << ": " << stage.itemsIn << " " << stage.unit << " in "
+                                    << busySeconds << " seconds busy ("
+                                    << (busySeconds > 0 ? static_cast<double>(stage.itemsIn) / busySeconds : 0.0)
+                                    << " " << stage.unit << "/second)";
+
+        if (stage.hasInputQueue) {
+            const StageQueueStatistics &queue = stage.inputQueue;
+            const double meanDepth = queue.blocks > 0 ? static_cast<double>(queue.totalDepth) / static_cast<double>(queue.blocks) : 0.0;
+            qInfo().nospace() << "    Input queue: " << queue.blocks << " blocks, depth mean " << meanDepth
+                              << " max " << queue.maxDepth << " of " << queue.capacity
+                              << ", waited " << static_cast<double>(queue.pushWaitNsecs) / 1e9 << " seconds full, "
+                              << static_cast<double>(queue.popWaitNsecs) / 1e9 << " seconds empty";
+        }
+    }
+}
+
 // Return statistics about the decoding process
 EfmProcess::Statistics EfmProcess::getStatistics()
 {
@@ -27,7 +27,10 @@
 
 #include <QString>
 #include <QFile>
+#include <QThread>
+#include <QVector>
 #include <QDebug>
+#include <functional>
 
 #include "Decoders/efmtof3frames.h"
 #include "Decoders/syncf3frames.h"
@@ -36,6 +39,8 @@
 #include "Decoders/f1toaudio.h"
 #include "Decoders/f1todata.h"
 
+#include "stagequeue.h"
+
 class EfmProcess
 {
 public:
@@ -52,6 +57,16 @@ public:
         F1ToData::Statistics f1ToData;
     };
 
+    // Statistics for one stage of the decoding pipeline
+    struct PipelineStageStatistics {
+        QString name;
+        QString unit;
+        qint64 itemsIn;
+        qint64 busyNsecs;
+        bool hasInputQueue;
+        StageQueueStatistics inputQueue;
+    };
+
     void setDebug(bool _debug_efmToF3Frames, bool _debug_syncF3Frames,
                   bool _debug_f3ToF2Frames, bool _debug_f2ToF1Frames,
                   bool _debug_f1ToAudio, bool _debug_f1ToData);
@@ -63,6 +78,24 @@ public:
     void reset();
 
 private:
+    // Thread running one stage of the decoding pipeline
+    class StageThread : public QThread
+    {
+    public:
+        StageThread(std::function<void()> _body) : body(std::move(_body)) {}
+
+    protected:
+        void run() override {
+            body();
+        }
+
+    private:
+        std::function<void()> body;
+    };
+
+    // Maximum number of blocks waiting between each pair of pipeline stages
+    static constexpr qint32 PIPELINE_QUEUE_DEPTH = 4;
+
     // Debug
     bool debug_efmToF3Frames;
     bool debug_f3ToF2Frames;
@@ -89,6 +122,9 @@ private:
     bool noTimeStamp;
 
     Statistics statistics;
+    QVector<PipelineStageStatistics> pipelineStatistics;
+
+    void reportPipelineStatistics() const;
 };
 
 #endif // EFMPROCESS_H
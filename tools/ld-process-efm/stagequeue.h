@@ -0,0 +1,123 @@
+/************************************************************************
+
+    stagequeue.h
+
+    ld-process-efm - EFM data decoder
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-process-efm is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef STAGEQUEUE_H
+#define STAGEQUEUE_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <deque>
+#include <utility>
+
+// Statistics for a StageQueue
+struct StageQueueStatistics {
+    qint64 blocks = 0;
+    qint32 capacity = 0;
+    qint32 maxDepth = 0;
+    qint64 totalDepth = 0;
+    qint64 pushWaitNsecs = 0;
+    qint64 popWaitNsecs = 0;
+};
+
+// A bounded FIFO of blocks, passed from one thread of the EFM decoding
+// pipeline to the next. push() waits while the queue is full, so a slow
+// stage holds back the stages before it rather than letting data pile up.
+template <typename T>
+class StageQueue
+{
+public:
+    explicit StageQueue(qint32 capacity)
+    {
+        statistics.capacity = capacity;
+    }
+
+    // Add a block to the end of the queue, waiting while the queue is full
+    void push(T block)
+    {
+        QMutexLocker locker(&mutex);
+
+        if (static_cast<qint32>(blocks.size()) >= statistics.capacity) {
+            QElapsedTimer waitTimer;
+            waitTimer.start();
+            while (static_cast<qint32>(blocks.size()) >= statistics.capacity) notFull.wait(&mutex);
+            statistics.pushWaitNsecs += waitTimer.nsecsElapsed();
+        }
+
+        blocks.push_back(std::move(block));
+
+        const qint32 depth = static_cast<qint32>(blocks.size());
+        statistics.blocks++;
+        statistics.totalDepth += depth;
+        if (depth > statistics.maxDepth) statistics.maxDepth = depth;
+
+        notEmpty.wakeOne();
+    }
+
+    // Take the block from the front of the queue, waiting while the queue is
+    // empty. Returns false if the queue is empty and has been closed.
+    bool pop(T &block)
+    {
+        QMutexLocker locker(&mutex);
+
+        if (blocks.empty() && !closed) {
+            QElapsedTimer waitTimer;
+            waitTimer.start();
+            while (blocks.empty() && !closed) notEmpty.wait(&mutex);
+            statistics.popWaitNsecs += waitTimer.nsecsElapsed();
+        }
+        if (blocks.empty()) return false;
+
+        block = std::move(blocks.front());
+        blocks.pop_front();
+
+        notFull.wakeOne();
+        return true;
+    }
+
+    // Indicate that no more blocks will be pushed
+    void close()
+    {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        notEmpty.wakeAll();
+    }
+
+    StageQueueStatistics getStatistics() const
+    {
+        QMutexLocker locker(&mutex);
+        return statistics;
+    }
+
+private:
+    mutable QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    std::deque<T> blocks;
+    bool closed = false;
+    StageQueueStatistics statistics;
+};
+
+#endif // STAGEQUEUE_H
@@ -0,0 +1,90 @@
+/************************************************************************
+
+    testcircsyndrome.cpp
+
+    ld-process-efm - EFM data decoder
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-process-efm is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "c1circ.h"
+#include "circsyndrome.h"
+
+// Return true if the ezpwd decoder finds no errors in the codeword
+static bool referenceIsCodeword(const std::vector<uint8_t> &symbols)
+{
+    C1RS<255,255-4> rs;
+    std::vector<uint8_t> data = symbols;
+    std::vector<int> erasures;
+    std::vector<int> position;
+    return rs.decode(data, erasures, &position) == 0 && data == symbols;
+}
+
+static void testCodeword(const std::vector<uint8_t> &symbols)
+{
+    const bool expected = referenceIsCodeword(symbols);
+    const bool actual = CircSyndrome::isCodeword(symbols.data());
+    if (actual != expected) {
+        fprintf(stderr, "isCodeword returned %d, expected %d\n", actual, expected);
+        assert(false);
+    }
+}
+
+int main()
+{
+    std::mt19937 randomEngine(42);
+    std::uniform_int_distribution<int> symbolDistribution(0, 255);
+    std::uniform_int_distribution<int> positionDistribution(0, 31);
+    C1RS<255,255-4> rs;
+
+    // All-zero and random codewords
+    testCodeword(std::vector<uint8_t>(32, 0));
+    for (qint32 i = 0; i < 10000; i++) {
+        std::vector<uint8_t> symbols(32);
+        for (uint8_t &symbol : symbols) symbol = static_cast<uint8_t>(symbolDistribution(randomEngine));
+        testCodeword(symbols);
+    }
+
+    // Valid codewords, and the same codewords with errors in 1-3 symbols
+    qint32 validCodewords = 0;
+    for (qint32 i = 0; i < 10000; i++) {
+        std::vector<uint8_t> symbols(28);
+        for (uint8_t &symbol : symbols) symbol = static_cast<uint8_t>(symbolDistribution(randomEngine));
+        rs.encode(symbols);
+        assert(symbols.size() == 32);
+
+        testCodeword(symbols);
+        if (CircSyndrome::isCodeword(symbols.data())) validCodewords++;
+
+        const qint32 errors = 1 + (i % 3);
+        for (qint32 j = 0; j < errors; j++) {
+            symbols[static_cast<size_t>(positionDistribution(randomEngine))] ^= static_cast<uint8_t>(1 + symbolDistribution(randomEngine) % 255);
+        }
+        testCodeword(symbols);
+    }
+    assert(validCodewords == 10000);
+
+    printf("Tests passed\n");
+    return 0;
+}
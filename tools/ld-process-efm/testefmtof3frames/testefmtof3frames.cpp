@@ -0,0 +1,180 @@
+/************************************************************************
+
+    testefmtof3frames.cpp
+
+    ld-process-efm - EFM data decoder
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-process-efm is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "efmtof3frames.h"
+
+// Append a frame of T-values: a T11+T11 sync, followed by random T-values
+// (which don't contain another sync) making the frame length totalT
+static void appendFrame(std::vector<char> &efmData, qint32 totalT, std::mt19937 &randomEngine)
+{
+    std::uniform_int_distribution<int> tDistribution(3, 10);
+
+    efmData.push_back(11);
+    efmData.push_back(11);
+    qint32 remaining = totalT - 22;
+    while (remaining > 20) {
+        const qint32 t = tDistribution(randomEngine);
+        efmData.push_back(static_cast<char>(t));
+        remaining -= t;
+    }
+
+    // Finish with two T-values in range
+    const qint32 t = qMax(3, remaining - 10);
+    efmData.push_back(static_cast<char>(t));
+    efmData.push_back(static_cast<char>(remaining - t));
+}
+
+// Append random T-values, which may include syncs in the wrong places
+static void appendNoise(std::vector<char> &efmData, qint32 count, std::mt19937 &randomEngine)
+{
+    std::uniform_int_distribution<int> tDistribution(2, 12);
+
+    for (qint32 i = 0; i < count; i++) {
+        efmData.push_back(static_cast<char>(tDistribution(randomEngine)));
+    }
+}
+
+// Decode efmData, split into blocks of the sizes returned by blockSize
+template <typename BlockSize>
+static std::vector<F3Frame> decode(const std::vector<char> &efmData, BlockSize blockSize,
+                                   EfmToF3Frames::Statistics &statistics)
+{
+    EfmToF3Frames efmToF3Frames;
+    std::vector<F3Frame> f3Frames;
+
+    qint32 position = 0;
+    const qint32 length = static_cast<qint32>(efmData.size());
+    while (position < length) {
+        const qint32 size = qMin(blockSize(), length - position);
+        const std::vector<F3Frame> &blockFrames = efmToF3Frames.process(efmData.data() + position, size, false, false);
+        f3Frames.insert(f3Frames.end(), blockFrames.begin(), blockFrames.end());
+        position += size;
+    }
+
+    statistics = efmToF3Frames.getStatistics();
+    return f3Frames;
+}
+
+static bool isSameFrame(const F3Frame &a, const F3Frame &b)
+{
+    return std::memcmp(a.getDataSymbols(), b.getDataSymbols(), 32) == 0
+           && std::memcmp(a.getErrorSymbols(), b.getErrorSymbols(), 32) == 0
+           && a.getSubcodeSymbol() == b.getSubcodeSymbol()
+           && a.isSubcodeSync0() == b.isSubcodeSync0()
+           && a.isSubcodeSync1() == b.isSubcodeSync1()
+           && a.getNumberOfValidEfmSymbols() == b.getNumberOfValidEfmSymbols()
+           && a.getNumberOfInvalidEfmSymbols() == b.getNumberOfInvalidEfmSymbols()
+           && a.getNumberOfCorrectedEfmSymbols() == b.getNumberOfCorrectedEfmSymbols();
+}
+
+static bool isSameStatistics(const EfmToF3Frames::Statistics &a, const EfmToF3Frames::Statistics &b)
+{
+    return a.undershootSyncs == b.undershootSyncs
+           && a.validSyncs == b.validSyncs
+           && a.overshootSyncs == b.overshootSyncs
+           && a.undershootFrames == b.undershootFrames
+           && a.validFrames == b.validFrames
+           && a.overshootFrames == b.overshootFrames
+           && a.inRangeTValues == b.inRangeTValues
+           && a.outOfRangeTValues == b.outOfRangeTValues
+           && a.validEfmSymbols == b.validEfmSymbols
+           && a.invalidEfmSymbols == b.invalidEfmSymbols
+           && a.correctedEfmSymbols == b.correctedEfmSymbols;
+}
+
+// Check that decoding in blocks gives the same frames as decoding all at once
+template <typename BlockSize>
+static void testSplit(const char *name, const std::vector<char> &efmData, BlockSize blockSize,
+                      const std::vector<F3Frame> &expectedFrames, const EfmToF3Frames::Statistics &expectedStatistics)
+{
+    EfmToF3Frames::Statistics statistics;
+    const std::vector<F3Frame> f3Frames = decode(efmData, blockSize, statistics);
+
+    if (f3Frames.size() != expectedFrames.size()) {
+        fprintf(stderr, "%s: got %d frames, expected %d\n", name,
+                static_cast<int>(f3Frames.size()), static_cast<int>(expectedFrames.size()));
+        assert(false);
+    }
+    for (size_t i = 0; i < f3Frames.size(); i++) {
+        if (!isSameFrame(f3Frames[i], expectedFrames[i])) {
+            fprintf(stderr, "%s: frame %d differs\n", name, static_cast<int>(i));
+            assert(false);
+        }
+    }
+    if (!isSameStatistics(statistics, expectedStatistics)) {
+        fprintf(stderr, "%s: statistics differ\n", name);
+        assert(false);
+    }
+}
+
+int main()
+{
+    std::mt19937 randomEngine(42);
+
+    // Make an EFM stream with noise at the start, frames with the right and
+    // wrong lengths, and noise between groups of frames, so that the decoder
+    // loses sync and finds it again
+    std::vector<char> efmData;
+    appendNoise(efmData, 100, randomEngine);
+    for (qint32 group = 0; group < 8; group++) {
+        for (qint32 i = 0; i < 40; i++) {
+            qint32 totalT = 588;
+            if (i == 10) totalT = 587;
+            if (i == 20) totalT = 591;
+            if (i == 30) totalT = 580;
+            appendFrame(efmData, totalT, randomEngine);
+        }
+        appendNoise(efmData, 20 + (group * 150), randomEngine);
+    }
+
+    // Decode it all at once
+    EfmToF3Frames::Statistics expectedStatistics;
+    const qint32 length = static_cast<qint32>(efmData.size());
+    const std::vector<F3Frame> expectedFrames = decode(efmData, [&] { return length; }, expectedStatistics);
+    assert(expectedFrames.size() > 250);
+
+    // Decode it in fixed-size blocks, including sizes around a frame's length
+    // in T-values and the size of the decoder's join region
+    for (qint32 size : { 1, 2, 3, 7, 64, 100, 150, 189, 190, 1000, 4095, 4096, 4097, 10000 }) {
+        char name[32];
+        snprintf(name, sizeof(name), "Blocks of %d", size);
+        testSplit(name, efmData, [&] { return size; }, expectedFrames, expectedStatistics);
+    }
+
+    // Decode it in blocks of random sizes
+    for (qint32 i = 0; i < 20; i++) {
+        std::uniform_int_distribution<int> sizeDistribution(1, 1 << (i % 14));
+        testSplit("Random blocks", efmData, [&] { return sizeDistribution(randomEngine); }, expectedFrames, expectedStatistics);
+    }
+
+    printf("Tests passed\n");
+    return 0;
+}
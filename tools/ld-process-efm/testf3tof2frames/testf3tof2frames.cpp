@@ -0,0 +1,335 @@
+/************************************************************************
+
+    testf3tof2frames.cpp
+
+    ld-process-efm - EFM data decoder
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-process-efm is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "f3tof2frames.h"
+#include "stagequeue.h"
+
+// EFM codes for the subcode sync patterns
+static constexpr qint16 EFM_SYNC0 = 0x801;
+static constexpr qint16 EFM_SYNC1 = 0x012;
+
+static uchar toBcd(qint32 value)
+{
+    return static_cast<uchar>(((value / 10) << 4) | (value % 10));
+}
+
+// Make an F3 frame from its 33 EFM codes (the subcode symbol, then 32 data
+// symbols), by working out the T-values that F3Frame would decode them from
+static F3Frame makeF3Frame(const qint16 *efmCodes)
+{
+    // Find the positions of the 1 bits in the 588-bit frame. The frame starts
+    // with a 1 bit (the start of the sync pattern, which isn't decoded), and
+    // each 14-bit code is followed by 3 merging bits.
+    std::vector<qint32> onePositions;
+    onePositions.push_back(0);
+    for (qint32 code = 0; code < 33; code++) {
+        for (qint32 bit = 0; bit < 14; bit++) {
+            if (efmCodes[code] & (1 << (13 - bit))) onePositions.push_back(27 + (code * 17) + bit);
+        }
+    }
+    onePositions.push_back(588);
+
+    uchar tValues[600];
+    qint32 tLength = 0;
+    for (size_t i = 1; i < onePositions.size(); i++) {
+        tValues[tLength++] = static_cast<uchar>(onePositions[i] - onePositions[i - 1]);
+    }
+
+    return F3Frame(tValues, tLength, false);
+}
+
+// Append a section of 98 F3 frames to f3Frames, with Q channel mode 1 data
+// giving the disc time. If qValid is false, the Q channel CRC is wrong.
+static void appendSection(std::vector<F3Frame> &f3Frames, const TrackTime &discTime, bool qValid,
+                          std::mt19937 &randomEngine)
+{
+    // Make the Q channel data: audio, mode 1, track 1, index 1
+    const TrackTime::Time time = discTime.getTime();
+    uchar qSubcode[12];
+    qSubcode[0] = 0x01;
+    qSubcode[1] = toBcd(1);
+    qSubcode[2] = toBcd(1);
+    qSubcode[3] = toBcd(time.minutes);
+    qSubcode[4] = toBcd(time.seconds);
+    qSubcode[5] = toBcd(time.frames);
+    qSubcode[6] = 0;
+    qSubcode[7] = toBcd(time.minutes);
+    qSubcode[8] = toBcd(time.seconds);
+    qSubcode[9] = toBcd(time.frames);
+
+    // CRC16 (XMODEM), inverted on disc
+    quint32 crc = 0;
+    for (qint32 i = 0; i < 10; i++) {
+        crc ^= static_cast<quint32>(qSubcode[i]) << 8;
+        for (qint32 bit = 0; bit < 8; bit++) {
+            crc <<= 1;
+            if (crc & 0x10000) crc = (crc ^ 0x1021) & 0xFFFF;
+        }
+    }
+    const quint16 qCrc = static_cast<quint16>(~crc);
+    qSubcode[10] = static_cast<uchar>(qCrc >> 8);
+    qSubcode[11] = static_cast<uchar>(qCrc & 0xFF);
+
+    // Corrupt two bits, which is more than Section will try to correct
+    if (!qValid) qSubcode[3] ^= 0x11;
+
+    std::uniform_int_distribution<int> byteDistribution(0, 255);
+    for (qint32 frame = 0; frame < 98; frame++) {
+        qint16 efmCodes[33];
+
+        // The subcode symbol carries one bit of the Q channel (as 0x40)
+        if (frame == 0) {
+            efmCodes[0] = EFM_SYNC0;
+        } else if (frame == 1) {
+            efmCodes[0] = EFM_SYNC1;
+        } else {
+            const qint32 qBit = frame - 2;
+            const bool q = (qSubcode[qBit / 8] >> (7 - (qBit % 8))) & 1;
+            efmCodes[0] = efm2numberLUT[q ? 0x40 : 0x00];
+        }
+
+        // Random data symbols
+        for (qint32 i = 1; i < 33; i++) {
+            efmCodes[i] = efm2numberLUT[byteDistribution(randomEngine)];
+        }
+
+        f3Frames.push_back(makeF3Frame(efmCodes));
+    }
+}
+
+static bool isSameTime(const TrackTime &a, const TrackTime &b)
+{
+    return a.getFrames() == b.getFrames();
+}
+
+// Check two sequences of F2 frames are identical
+static void compareF2Frames(const std::vector<F2Frame> &expected, const std::vector<F2Frame> &actual, const char *name)
+{
+    if (actual.size() != expected.size()) {
+        fprintf(stderr, "%s: %d F2 frames, expected %d\n", name, static_cast<qint32>(actual.size()),
+                static_cast<qint32>(expected.size()));
+        assert(false);
+    }
+
+    for (size_t i = 0; i < expected.size(); i++) {
+        const F2Frame &a = expected[i];
+        const F2Frame &b = actual[i];
+        if (memcmp(a.getDataSymbols(), b.getDataSymbols(), 24) != 0
+            || a.isFrameCorrupt() != b.isFrameCorrupt()
+            || !isSameTime(a.getDiscTime(), b.getDiscTime())
+            || !isSameTime(a.getTrackTime(), b.getTrackTime())
+            || a.getTrackNumber() != b.getTrackNumber()
+            || a.getIsEncoderRunning() != b.getIsEncoderRunning()) {
+            fprintf(stderr, "%s: F2 frame %d differs\n", name, static_cast<qint32>(i));
+            assert(false);
+        }
+    }
+}
+
+// Check two sets of F3ToF2Frames statistics are identical
+static void compareStatistics(const F3ToF2Frames::Statistics &a, const F3ToF2Frames::Statistics &b, const char *name)
+{
+    if (a.totalF3Frames != b.totalF3Frames
+        || a.totalF2Frames != b.totalF2Frames
+        || a.sequenceInterruptions != b.sequenceInterruptions
+        || a.missingF3Frames != b.missingF3Frames
+        || a.preempFrames != b.preempFrames
+        || !isSameTime(a.initialDiscTime, b.initialDiscTime)
+        || !isSameTime(a.currentDiscTime, b.currentDiscTime)
+        || a.c1Circ_statistics.c1Passed != b.c1Circ_statistics.c1Passed
+        || a.c1Circ_statistics.c1Corrected != b.c1Circ_statistics.c1Corrected
+        || a.c1Circ_statistics.c1Failed != b.c1Circ_statistics.c1Failed
+        || a.c1Circ_statistics.c1flushed != b.c1Circ_statistics.c1flushed
+        || a.c2Circ_statistics.c2Passed != b.c2Circ_statistics.c2Passed
+        || a.c2Circ_statistics.c2Corrected != b.c2Circ_statistics.c2Corrected
+        || a.c2Circ_statistics.c2Failed != b.c2Circ_statistics.c2Failed
+        || a.c2Circ_statistics.c2flushed != b.c2Circ_statistics.c2flushed
+        || a.c2Deinterleave_statistics.validDeinterleavedC2s != b.c2Deinterleave_statistics.validDeinterleavedC2s
+        || a.c2Deinterleave_statistics.invalidDeinterleavedC2s != b.c2Deinterleave_statistics.invalidDeinterleavedC2s
+        || a.c2Deinterleave_statistics.c2flushed != b.c2Deinterleave_statistics.c2flushed) {
+        fprintf(stderr, "%s: statistics differ\n", name);
+        assert(false);
+    }
+}
+
+// Split f3Frames into blocks of whole sections, with the given numbers of
+// sections in each block (repeating the sizes as needed)
+static std::vector<std::vector<F3Frame>> splitSections(const std::vector<F3Frame> &f3Frames,
+                                                       const std::vector<qint32> &blockSections)
+{
+    std::vector<std::vector<F3Frame>> blocks;
+    size_t position = 0;
+    for (size_t i = 0; position < f3Frames.size(); i++) {
+        const size_t length = qMin(static_cast<size_t>(blockSections[i % blockSections.size()] * 98),
+                                   f3Frames.size() - position);
+        blocks.emplace_back(f3Frames.begin() + position, f3Frames.begin() + position + length);
+        position += length;
+    }
+    return blocks;
+}
+
+// Decode the blocks with process(), in a single stage
+static std::vector<F2Frame> decodeSingleStage(const std::vector<std::vector<F3Frame>> &blocks,
+                                              F3ToF2Frames::Statistics &statistics)
+{
+    F3ToF2Frames f3ToF2Frames;
+    std::vector<F2Frame> f2Frames;
+    for (const std::vector<F3Frame> &block : blocks) {
+        const std::vector<F2Frame> &output = f3ToF2Frames.process(block, false, false);
+        f2Frames.insert(f2Frames.end(), output.begin(), output.end());
+    }
+    statistics = f3ToF2Frames.getStatistics();
+    return f2Frames;
+}
+
+// Decode the blocks with processC1 and processC2 on separate threads,
+// connected by a StageQueue as in EfmProcess. Returns the number of sections
+// that the C1 stage flagged for flushing in flushes.
+static std::vector<F2Frame> decodeTwoStage(const std::vector<std::vector<F3Frame>> &blocks,
+                                           F3ToF2Frames::Statistics &statistics, qint32 &flushes)
+{
+    F3ToF2Frames f3ToF2Frames;
+    StageQueue<std::vector<F3ToF2Frames::C1Section>> c1Queue(4);
+
+    flushes = 0;
+    std::thread c1Thread([&]() {
+        for (const std::vector<F3Frame> &block : blocks) {
+            const std::vector<F3ToF2Frames::C1Section> &c1Sections = f3ToF2Frames.processC1(block, false, false);
+            for (const F3ToF2Frames::C1Section &c1Section : c1Sections) {
+                if (c1Section.flush) flushes++;
+            }
+            if (!c1Sections.empty()) c1Queue.push(c1Sections);
+        }
+        c1Queue.close();
+    });
+
+    std::vector<F2Frame> f2Frames;
+    std::vector<F3ToF2Frames::C1Section> c1Sections;
+    while (c1Queue.pop(c1Sections)) {
+        const std::vector<F2Frame> &output = f3ToF2Frames.processC2(c1Sections);
+        f2Frames.insert(f2Frames.end(), output.begin(), output.end());
+    }
+    c1Thread.join();
+
+    statistics = f3ToF2Frames.getStatistics();
+    return f2Frames;
+}
+
+int main()
+{
+    std::mt19937 randomEngine(42);
+
+    // Make a stream of sections with discontinuities in the disc time: a
+    // forward jump, a jump backwards, and a section with corrupt Q data
+    // (whose time is estimated) just before another jump
+    std::vector<F3Frame> f3Frames;
+    TrackTime discTime(0, 2, 0);
+    for (qint32 i = 0; i < 20; i++) {
+        appendSection(f3Frames, discTime, true, randomEngine);
+        discTime.addFrames(1);
+    }
+    const qint32 timeBeforeJump = discTime.getFrames() - 1;
+    discTime.addFrames(7);
+    for (qint32 i = 0; i < 20; i++) {
+        appendSection(f3Frames, discTime, true, randomEngine);
+        discTime.addFrames(1);
+    }
+    discTime.subtractFrames(30);
+    for (qint32 i = 0; i < 20; i++) {
+        appendSection(f3Frames, discTime, i != 10, randomEngine);
+        discTime.addFrames(1);
+    }
+    discTime.addFrames(3);
+    appendSection(f3Frames, discTime, false, randomEngine);
+    discTime.addFrames(1);
+    for (qint32 i = 0; i < 20; i++) {
+        appendSection(f3Frames, discTime, true, randomEngine);
+        discTime.addFrames(1);
+    }
+    const qint32 lastTime = discTime.getFrames() - 1;
+
+    // Decode the whole stream in one block with process()
+    F3ToF2Frames::Statistics expectedStatistics;
+    const std::vector<F2Frame> expectedF2Frames = decodeSingleStage({ f3Frames }, expectedStatistics);
+    fprintf(stderr, "%d F2 frames, %d sequence interruptions\n", static_cast<qint32>(expectedF2Frames.size()),
+            expectedStatistics.sequenceInterruptions);
+
+    // The forward jump, and the jump after the corrupt section (whose time is
+    // estimated), must have been detected. The jump backwards isn't a gap, so
+    // it doesn't cause a flush.
+    assert(expectedStatistics.sequenceInterruptions == 2);
+
+    // process() is built from processC1 and processC2 too, so also check
+    // the flushes happened. C2 and the deinterleaver must each have been
+    // flushed once for each interruption.
+    assert(expectedStatistics.c2Circ_statistics.c2flushed == expectedStatistics.sequenceInterruptions);
+    assert(expectedStatistics.c2Deinterleave_statistics.c2flushed == expectedStatistics.sequenceInterruptions);
+
+    // The CIRC delay is more than one section but less than two. So the
+    // section before the forward jump was still in the C2 buffers when they
+    // were flushed, and none of its frames can come out before the jump, or
+    // be labelled with its time if the section metadata wasn't flushed. At
+    // the end, the last section hasn't come out but the one before it has.
+    for (const F2Frame &f2Frame : expectedF2Frames) {
+        const qint32 frameTime = f2Frame.getDiscTime().getFrames();
+        if (frameTime > timeBeforeJump) break;
+        assert(frameTime != timeBeforeJump);
+    }
+    assert(!expectedF2Frames.empty() && expectedF2Frames.back().getDiscTime().getFrames() == lastTime - 1);
+
+    // Decode it in different block sizes, in one stage and in two
+    const std::vector<std::vector<qint32>> blockSizes = { { 1 }, { 3 }, { 7, 1, 2 }, { 1000 } };
+    for (const std::vector<qint32> &blockSections : blockSizes) {
+        fprintf(stderr, "Testing blocks of %d sections\n", blockSections[0]);
+        const std::vector<std::vector<F3Frame>> blocks = splitSections(f3Frames, blockSections);
+
+        F3ToF2Frames::Statistics statistics;
+        const std::vector<F2Frame> singleStageF2Frames = decodeSingleStage(blocks, statistics);
+        compareF2Frames(expectedF2Frames, singleStageF2Frames, "Single stage");
+        compareStatistics(expectedStatistics, statistics, "Single stage");
+
+        qint32 flushes;
+        const std::vector<F2Frame> twoStageF2Frames = decodeTwoStage(blocks, statistics, flushes);
+        compareF2Frames(expectedF2Frames, twoStageF2Frames, "Two stages");
+        compareStatistics(expectedStatistics, statistics, "Two stages");
+
+        // Each interruption must have been passed on to the C2 stage
+        if (flushes != expectedStatistics.sequenceInterruptions) {
+            fprintf(stderr, "%d sections flagged for flushing, expected %d\n", flushes,
+                    expectedStatistics.sequenceInterruptions);
+            assert(false);
+        }
+    }
+
+    printf("Tests passed\n");
+    return 0;
+}
@@ -25,9 +25,11 @@
 #include "decoderpool.h"
 
 DecoderPool::DecoderPool(QString _inputFilename, QString _outputJsonFilename,
-                         qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData)
+                         qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
+                         bool _measureVits, bool _reportDropouts)
     : inputFilename(_inputFilename), outputJsonFilename(_outputJsonFilename),
-      maxThreads(_maxThreads), ldDecodeMetaData(_ldDecodeMetaData)
+      maxThreads(_maxThreads), measureVits(_measureVits), reportDropouts(_reportDropouts),
+      ldDecodeMetaData(_ldDecodeMetaData)
 {
 }
 
@@ -55,11 +57,30 @@ bool DecoderPool::process()
     // Show some information for the user
     qInfo() << "Using" << maxThreads << "threads to process" << ldDecodeMetaData.getNumberOfFields() << "fields";
 
+    // Work out which field lines to read.  If the VITS metrics are being
+    // measured in the same pass, this includes the lines they need too.
+    startFieldLine = VbiLineDecoder::startFieldLine;
+    endFieldLine = VbiLineDecoder::endFieldLine;
+    if (measureVits) {
+        VitsMetrics vitsMetrics(videoParameters);
+        startFieldLine = qMin(startFieldLine, vitsMetrics.getStartFieldLine());
+        endFieldLine = qMax(endFieldLine, vitsMetrics.getEndFieldLine());
+    }
+
     // Initialise processing state
     inputFieldNumber = 1;
     lastFieldNumber = ldDecodeMetaData.getNumberOfFields();
+    outputFieldNumber = 1;
+    dropoutStatistics = DropoutStatistics { 0, 0, 0, 0, 0 };
     totalTimer.start();
 
+    // Start writing the output metadata; fields are written as they're completed
+    if (!metadataWriter.open(outputJsonFilename, ldDecodeMetaData)) {
+        qCritical() << "Could not open output JSON file";
+        sourceVideo.close();
+        return false;
+    }
+
     // Start a vector of decoding threads to process the video
     QVector<QThread *> threads;
     threads.resize(maxThreads);
@@ -85,17 +106,39 @@ bool DecoderPool::process()
     qInfo() << "VBI Processing complete -" << lastFieldNumber << "fields in" << totalSecs << "seconds (" <<
                lastFieldNumber / totalSecs << "FPS )";
 
-    // Write the JSON metadata file
+    // Finish the JSON metadata file
     qInfo() << "Writing JSON metadata file...";
-    ldDecodeMetaData.write(outputJsonFilename);
+    if (!metadataWriter.close()) {
+        sourceVideo.close();
+        return false;
+    }
     qInfo() << "VBI processing complete";
 
+    if (reportDropouts) reportDropoutStatistics();
+
     // Close the source video
     sourceVideo.close();
 
     return true;
 }
 
+// Return true if workers should measure the VITS metrics as well as decoding the VBI
+bool DecoderPool::getMeasureVits() const
+{
+    return measureVits;
+}
+
+// Return the range of field lines returned by getInputField (1-based, inclusive)
+qint32 DecoderPool::getStartFieldLine() const
+{
+    return startFieldLine;
+}
+
+qint32 DecoderPool::getEndFieldLine() const
+{
+    return endFieldLine;
+}
+
 // Get the next field that needs processing from the input.
 //
 // Returns true if a field was returned, false if the end of the input has been
@@ -103,23 +146,27 @@ bool DecoderPool::process()
 bool DecoderPool::getInputField(qint32 &fieldNumber, SourceVideo::Data &fieldVideoData,
                                 LdDecodeMetaData::Field &fieldMetadata, LdDecodeMetaData::VideoParameters &videoParameters)
 {
-    QMutexLocker locker(&inputMutex);
+    {
+        QMutexLocker locker(&inputMutex);
 
-    if (inputFieldNumber > lastFieldNumber) {
-        // No more input fields
-        return false;
-    }
+        if (inputFieldNumber > lastFieldNumber) {
+            // No more input fields
+            return false;
+        }
 
-    fieldNumber = inputFieldNumber;
-    inputFieldNumber++;
+        fieldNumber = inputFieldNumber;
+        inputFieldNumber++;
 
-    // Show what we are about to process
-    qDebug() << "DecoderPool::process(): Processing field number" << fieldNumber;
+        // Show what we are about to process
+        qDebug() << "DecoderPool::process(): Processing field number" << fieldNumber;
+
+        fieldMetadata = ldDecodeMetaData.copyField(fieldNumber);
+        videoParameters = ldDecodeMetaData.getVideoParameters();
+    }
 
-    // Fetch the input data
-    fieldVideoData = sourceVideo.getVideoField(fieldNumber, VbiLineDecoder::startFieldLine, VbiLineDecoder::endFieldLine);
-    fieldMetadata = ldDecodeMetaData.getField(fieldNumber);
-    videoParameters = ldDecodeMetaData.getVideoParameters();
+    // Fetch the input data.  This is done without holding inputMutex, so
+    // workers can read their fields concurrently.
+    sourceVideo.readVideoField(fieldNumber, fieldVideoData, startFieldLine, endFieldLine);
 
     return true;
 }
@@ -131,13 +178,52 @@ bool DecoderPool::setOutputField(qint32 fieldNumber, const LdDecodeMetaData::Fie
 {
     QMutexLocker locker(&outputMutex);
 
-    // Save the field data to the metadata (only some metadata is affected)
-    ldDecodeMetaData.updateFieldVbi(fieldMetadata.vbi, fieldNumber);
-    ldDecodeMetaData.updateFieldNtsc(fieldMetadata.ntsc, fieldNumber);
-    ldDecodeMetaData.updateFieldVitc(fieldMetadata.vitc, fieldNumber);
-    ldDecodeMetaData.updateFieldClosedCaption(fieldMetadata.closedCaption, fieldNumber);
+    if (reportDropouts) updateDropoutStatistics(fieldNumber, fieldMetadata.dropOuts);
+
+    // The worker started from a copy of the input field's metadata, and only
+    // changed the VBI, NTSC, VITC, closed caption and (if measured) VITS
+    // metrics, so it can be written out directly. It isn't stored back into
+    // ldDecodeMetaData, which would keep every field in memory.
+    //
+    // Write out as many fields as possible, in order; fields that finish out
+    // of order wait in pendingOutputFields.
+    pendingOutputFields[fieldNumber] = fieldMetadata;
+    while (pendingOutputFields.contains(outputFieldNumber)) {
+        if (!metadataWriter.writeField(pendingOutputFields.value(outputFieldNumber))) return false;
+
+        pendingOutputFields.remove(outputFieldNumber);
+        outputFieldNumber++;
+    }
 
     return true;
 }
 
+// Add a field's dropouts to the dropout statistics
+void DecoderPool::updateDropoutStatistics(qint32 fieldNumber, const DropOuts &dropOuts)
+{
+    if (dropOuts.empty()) return;
+
+    const LdDecodeMetaData::VideoParameters &videoParameters = ldDecodeMetaData.getVideoParameters();
+    const qint64 totalLength = dropOuts.totalLength();
+
+    dropoutStatistics.fieldsWithDropouts++;
+    dropoutStatistics.totalLength += totalLength;
+    dropoutStatistics.visibleLength += dropOuts.visibleLength(videoParameters.firstActiveFieldLine, videoParameters.lastActiveFieldLine,
+                                                              videoParameters.activeVideoStart, videoParameters.activeVideoEnd);
+    if (totalLength > dropoutStatistics.worstFieldLength) {
+        dropoutStatistics.worstField = fieldNumber;
+        dropoutStatistics.worstFieldLength = totalLength;
+    }
+}
 
+// Show the dropout statistics to the user
+void DecoderPool::reportDropoutStatistics() const
+{
+    qInfo() << "Dropout statistics:";
+    qInfo() << "  Fields with dropouts:" << dropoutStatistics.fieldsWithDropouts << "of" << lastFieldNumber;
+    qInfo() << "  Total dropout length:" << dropoutStatistics.totalLength << "samples";
+    qInfo() << "  Visible dropout length:" << dropoutStatistics.visibleLength << "samples";
+    if (dropoutStatistics.fieldsWithDropouts > 0) {
+        qInfo() << "  Worst field:" << dropoutStatistics.worstField << "with" << dropoutStatistics.worstFieldLength << "samples";
+    }
+}
@@ -27,22 +27,29 @@
 
 #include <QAtomicInt>
 #include <QElapsedTimer>
+#include <QMap>
 #include <QMutex>
 #include <QThread>
 
 #include "sourcevideo.h"
 #include "lddecodemetadata.h"
+#include "metadatawriter.h"
 #include "vbilinedecoder.h"
+#include "vitsmetrics.h"
 
 class DecoderPool
 {
 public:
     // Public methods
     explicit DecoderPool(QString _inputFilename, QString _outputJsonFilename,
-                        qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData);
+                        qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
+                        bool _measureVits = false, bool _reportDropouts = false);
     bool process();
 
     // Member functions used by worker threads
+    bool getMeasureVits() const;
+    qint32 getStartFieldLine() const;
+    qint32 getEndFieldLine() const;
     bool getInputField(qint32 &fieldNumber, SourceVideo::Data &fieldVideoData, LdDecodeMetaData::Field &fieldMetadata, LdDecodeMetaData::VideoParameters &videoParameters);
     bool setOutputField(qint32 fieldNumber, const LdDecodeMetaData::Field& fieldMetadata);
 
@@ -50,14 +57,19 @@ private:
     QString inputFilename;
     QString outputJsonFilename;
     qint32 maxThreads;
+    bool measureVits;
+    bool reportDropouts;
     QElapsedTimer totalTimer;
 
     // Atomic abort flag shared by worker threads; workers watch this, and shut
     // down as soon as possible if it becomes true
     QAtomicInt abort;
 
-    // Input stream information (all guarded by inputMutex while threads are running)
+    // Input stream information (all guarded by inputMutex while threads are running,
+    // except sourceVideo, which workers read from with the thread-safe readVideoField)
     QMutex inputMutex;
+    qint32 startFieldLine;
+    qint32 endFieldLine;
     qint32 inputFieldNumber;
     qint32 lastFieldNumber;
     LdDecodeMetaData &ldDecodeMetaData;
@@ -65,7 +77,21 @@ private:
 
     // Output stream information (all guarded by outputMutex while threads are running)
     QMutex outputMutex;
-    QFile targetJson;
+    qint32 outputFieldNumber;
+    QMap<qint32, LdDecodeMetaData::Field> pendingOutputFields;
+    MetadataWriter metadataWriter;
+
+    // Dropout statistics (all guarded by outputMutex while threads are running)
+    struct DropoutStatistics {
+        qint32 fieldsWithDropouts;
+        qint64 totalLength;
+        qint64 visibleLength;
+        qint32 worstField;
+        qint64 worstFieldLength;
+    } dropoutStatistics;
+
+    void updateDropoutStatistics(qint32 fieldNumber, const DropOuts &dropOuts);
+    void reportDropoutStatistics() const;
 };
 
 #endif // DECODERPOOL_H
@@ -82,6 +82,16 @@ int main(int argc, char *argv[])
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to also measure the VITS metrics in the same pass
+    QCommandLineOption vitsOption(QStringList() << "vits",
+                                  QCoreApplication::translate("main", "Also measure the VITS metrics (as ld-process-vits), reading the TBC only once"));
+    parser.addOption(vitsOption);
+
+    // Option to also report dropout statistics
+    QCommandLineOption dropoutStatsOption(QStringList() << "dropout-stats",
+                                          QCoreApplication::translate("main", "Also report dropout statistics for the TBC"));
+    parser.addOption(dropoutStatsOption);
+
     // Positional argument to specify input TBC file
     parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file"));
 
@@ -93,6 +103,8 @@ int main(int argc, char *argv[])
 
     // Get the options from the parser
     bool noBackup = parser.isSet(showNoBackupOption);
+    bool measureVits = parser.isSet(vitsOption);
+    bool reportDropouts = parser.isSet(dropoutStatsOption);
 
     qint32 maxThreads = QThread::idealThreadCount();
     if (parser.isSet(threadsOption)) {
@@ -145,7 +157,7 @@ int main(int argc, char *argv[])
 
     // Perform the processing
     qInfo() << "Beginning VBI processing...";
-    DecoderPool decoderPool(inputFilename, outputJsonFilename, maxThreads, metaData);
+    DecoderPool decoderPool(inputFilename, outputJsonFilename, maxThreads, metaData, measureVits, reportDropouts);
     if (!decoderPool.process()) return 1;
 
     // Quit with success
@@ -100,6 +100,12 @@ void VbiLineDecoder::run()
         closedCaption.decodeLine(getFieldLine(sourceFieldData, (videoParameters.system == PAL) ? 22 : 21, videoParameters),
                                  videoParameters, fieldMetadata);
 
+        // Measure the VITS metrics from the same field data, if required
+        if (decoderPool.getMeasureVits()) {
+            VitsMetrics vitsMetrics(videoParameters);
+            vitsMetrics.measureField(sourceFieldData, decoderPool.getStartFieldLine(), fieldNumber, fieldMetadata);
+        }
+
         // Write the result to the output metadata
         if (!decoderPool.setOutputField(fieldNumber, fieldMetadata)) {
             abort = true;
@@ -113,11 +119,11 @@ SourceVideo::Data VbiLineDecoder::getFieldLine(const SourceVideo::Data &sourceFi
                                                const LdDecodeMetaData::VideoParameters& videoParameters)
 {
     // Range-check the field line
-    if (fieldLine < startFieldLine || fieldLine > endFieldLine) {
+    if (fieldLine < decoderPool.getStartFieldLine() || fieldLine > decoderPool.getEndFieldLine()) {
         qWarning() << "Cannot generate field-line data, line number is out of bounds! Scan line =" << fieldLine;
         return SourceVideo::Data();
     }
 
-    qint32 startPointer = (fieldLine - startFieldLine) * videoParameters.fieldWidth;
+    qint32 startPointer = (fieldLine - decoderPool.getStartFieldLine()) * videoParameters.fieldWidth;
     return sourceField.mid(startPointer, videoParameters.fieldWidth);
 }
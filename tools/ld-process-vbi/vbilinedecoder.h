@@ -41,7 +41,7 @@ class VbiLineDecoder : public QThread {
 public:
     explicit VbiLineDecoder(QAtomicInt& _abort, DecoderPool& _decoderPool, QObject *parent = nullptr);
 
-    // The range of field lines needed from the input file (1-based, inclusive)
+    // The range of field lines needed for VBI decoding (1-based, inclusive)
     static constexpr qint32 startFieldLine = 6;
     static constexpr qint32 endFieldLine = 22;
 
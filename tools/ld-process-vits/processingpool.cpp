@@ -58,8 +58,16 @@ bool ProcessingPool::process()
     // Initialise processing state
     inputFieldNumber = 1;
     lastFieldNumber = ldDecodeMetaData.getNumberOfFields();
+    outputFieldNumber = 1;
     totalTimer.start();
 
+    // Start writing the output metadata; fields are written as they're completed
+    if (!metadataWriter.open(outputJsonFilename, ldDecodeMetaData)) {
+        qCritical() << "Could not open output JSON file";
+        sourceVideo.close();
+        return false;
+    }
+
     // Start a vector of decoding threads to process the video
     QVector<QThread *> threads;
     threads.resize(maxThreads);
@@ -85,9 +93,12 @@ bool ProcessingPool::process()
     qInfo() << "VITS Processing complete -" << lastFieldNumber << "fields in" << totalSecs << "seconds (" <<
                lastFieldNumber / totalSecs << "FPS )";
 
-    // Write the JSON metadata file
+    // Finish the JSON metadata file
     qInfo() << "Writing JSON metadata file...";
-    ldDecodeMetaData.write(outputJsonFilename);
+    if (!metadataWriter.close()) {
+        sourceVideo.close();
+        return false;
+    }
     qInfo() << "VITS processing complete";
 
     // Close the source video
@@ -102,23 +113,27 @@ bool ProcessingPool::process()
 bool ProcessingPool::getInputField(qint32 &fieldNumber, SourceVideo::Data &fieldVideoData,
                                 LdDecodeMetaData::Field &fieldMetadata, LdDecodeMetaData::VideoParameters &videoParameters)
 {
-    QMutexLocker locker(&inputMutex);
+    {
+        QMutexLocker locker(&inputMutex);
 
-    if (inputFieldNumber > lastFieldNumber) {
-        // No more input fields
-        return false;
-    }
+        if (inputFieldNumber > lastFieldNumber) {
+            // No more input fields
+            return false;
+        }
 
-    fieldNumber = inputFieldNumber;
-    inputFieldNumber++;
+        fieldNumber = inputFieldNumber;
+        inputFieldNumber++;
 
-    // Show what we are about to process
-    //qDebug() << "Processing field number" << fieldNumber;
+        // Show what we are about to process
+        //qDebug() << "Processing field number" << fieldNumber;
 
-    // Fetch the input data
-    fieldVideoData = sourceVideo.getVideoField(fieldNumber);
-    fieldMetadata = ldDecodeMetaData.getField(fieldNumber);
-    videoParameters = ldDecodeMetaData.getVideoParameters();
+        fieldMetadata = ldDecodeMetaData.copyField(fieldNumber);
+        videoParameters = ldDecodeMetaData.getVideoParameters();
+    }
+
+    // Fetch the input data.  This is done without holding inputMutex, so
+    // workers can read their fields concurrently.
+    sourceVideo.readVideoField(fieldNumber, fieldVideoData);
 
     return true;
 }
@@ -130,8 +145,20 @@ bool ProcessingPool::setOutputField(qint32 fieldNumber, LdDecodeMetaData::Field
 {
     QMutexLocker locker(&outputMutex);
 
-    // Save the field data to the metadata (only VITS metrics metadata is affected)
-    ldDecodeMetaData.updateFieldVitsMetrics(fieldMetadata.vitsMetrics, fieldNumber);
+    // The worker started from a copy of the input field's metadata, and only
+    // changed the VITS metrics, so it can be written out directly. It isn't
+    // stored back into ldDecodeMetaData, which would keep every field in
+    // memory.
+    //
+    // Write out as many fields as possible, in order; fields that finish out
+    // of order wait in pendingOutputFields.
+    pendingOutputFields[fieldNumber] = fieldMetadata;
+    while (pendingOutputFields.contains(outputFieldNumber)) {
+        if (!metadataWriter.writeField(pendingOutputFields.value(outputFieldNumber))) return false;
+
+        pendingOutputFields.remove(outputFieldNumber);
+        outputFieldNumber++;
+    }
 
     return true;
 }
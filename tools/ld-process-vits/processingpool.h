@@ -27,11 +27,13 @@
 
 #include <QAtomicInt>
 #include <QElapsedTimer>
+#include <QMap>
 #include <QMutex>
 #include <QThread>
 
 #include "sourcevideo.h"
 #include "lddecodemetadata.h"
+#include "metadatawriter.h"
 #include "vitsanalyser.h"
 
 class ProcessingPool
@@ -55,7 +57,8 @@ private:
     // down as soon as possible if it becomes true
     QAtomicInt abort;
 
-    // Input stream information (all guarded by inputMutex while threads are running)
+    // Input stream information (all guarded by inputMutex while threads are running,
+    // except sourceVideo, which workers read from with the thread-safe readVideoField)
     QMutex inputMutex;
     qint32 inputFieldNumber;
     qint32 lastFieldNumber;
@@ -64,7 +67,9 @@ private:
 
     // Output stream information (all guarded by outputMutex while threads are running)
     QMutex outputMutex;
-    QFile targetJson;
+    qint32 outputFieldNumber;
+    QMap<qint32, LdDecodeMetaData::Field> pendingOutputFields;
+    MetadataWriter metadataWriter;
 };
 
 #endif // PROCESSINGPOOL_H
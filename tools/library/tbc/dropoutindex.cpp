@@ -0,0 +1,95 @@
+/************************************************************************
+
+    dropoutindex.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "dropoutindex.h"
+
+#include <algorithm>
+
+DropOutIndex::DropOutIndex(const DropOuts &dropOuts)
+{
+    if (dropOuts.empty()) return;
+
+    // Sort the dropouts by line and startx
+    struct Entry {
+        qint32 fieldLine;
+        Interval interval;
+    };
+    QVector<Entry> entries;
+    entries.reserve(dropOuts.size());
+    qint32 maxLine = 0;
+    for (qint32 i = 0; i < dropOuts.size(); i++) {
+        if (dropOuts.fieldLine(i) < 0 || dropOuts.endx(i) < dropOuts.startx(i)) continue;
+
+        entries.append(Entry { dropOuts.fieldLine(i), { dropOuts.startx(i), dropOuts.endx(i) } });
+        maxLine = qMax(maxLine, dropOuts.fieldLine(i));
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        if (a.fieldLine != b.fieldLine) return a.fieldLine < b.fieldLine;
+        return a.interval.startx < b.interval.startx;
+    });
+
+    // Build the intervals, merging any that overlap, and the line starts
+    lineStarts.fill(0, maxLine + 2);
+    intervals.reserve(entries.size());
+    qint32 line = -1;
+    for (const Entry &entry : entries) {
+        if (entry.fieldLine != line) {
+            while (line < entry.fieldLine) lineStarts[++line] = intervals.size();
+        } else if (entry.interval.startx <= intervals.last().endx) {
+            intervals.last().endx = qMax(intervals.last().endx, entry.interval.endx);
+            continue;
+        }
+        intervals.append(entry.interval);
+    }
+    while (line <= maxLine) lineStarts[++line] = intervals.size();
+}
+
+DropOutIndex::Line DropOutIndex::getLine(qint32 fieldLine) const
+{
+    if (fieldLine < 0 || fieldLine + 1 >= lineStarts.size()) return Line { nullptr, nullptr };
+
+    const Interval *base = intervals.constData();
+    return Line { base + lineStarts[fieldLine], base + lineStarts[fieldLine + 1] };
+}
+
+bool DropOutIndex::contains(qint32 x, qint32 fieldLine) const
+{
+    return overlaps(x, x, fieldLine);
+}
+
+bool DropOutIndex::overlaps(qint32 startx, qint32 endx, qint32 fieldLine) const
+{
+    const Line line = getLine(fieldLine);
+
+    // Find the first interval that ends at or after startx
+    const Interval *it = std::lower_bound(line.begin(), line.end(), startx, [](const Interval &interval, qint32 x) {
+        return interval.endx < x;
+    });
+    return it != line.end() && it->startx <= endx;
+}
+
+DropOutIndex::Cursor::Cursor(const DropOutIndex &index, qint32 fieldLine)
+    : line(index.getLine(fieldLine)), current(line.first)
+{
+}
@@ -0,0 +1,100 @@
+/************************************************************************
+
+    dropoutindex.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef DROPOUTINDEX_H
+#define DROPOUTINDEX_H
+
+#include <QVector>
+#include <QtGlobal>
+
+#include "dropouts.h"
+
+// Index of the dropouts in a field, by line.
+//
+// DropOuts is a flat list, so finding whether a sample is in a dropout means
+// scanning every entry. DropOutIndex sorts the dropouts by line and position
+// (merging any that overlap), so the dropouts on a line can be found
+// directly. Lines are numbered from 1, as in DropOuts, and the x ranges are
+// inclusive.
+class DropOutIndex
+{
+public:
+    struct Interval {
+        qint32 startx;
+        qint32 endx;
+    };
+
+    // Return the dropouts on one line
+    struct Line {
+        const Interval *first;
+        const Interval *last;
+
+        const Interval *begin() const { return first; }
+        const Interval *end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    // Find dropouts along a line, for increasing values of x.
+    // Each call is O(1) amortised over the line.
+    class Cursor
+    {
+    public:
+        Cursor(const DropOutIndex &index, qint32 fieldLine);
+
+        // Return true if x is in a dropout. x must not be less than the
+        // previous call's x.
+        bool contains(qint32 x) {
+            while (current != line.last && current->endx < x) ++current;
+            return current != line.last && current->startx <= x;
+        }
+
+    private:
+        Line line;
+        const Interval *current;
+    };
+
+    DropOutIndex() = default;
+    explicit DropOutIndex(const DropOuts &dropOuts);
+
+    // Return true if there are no dropouts
+    bool empty() const {
+        return intervals.empty();
+    }
+
+    Line getLine(qint32 fieldLine) const;
+
+    // Return true if (x, fieldLine) is in a dropout
+    bool contains(qint32 x, qint32 fieldLine) const;
+
+    // Return true if any dropout on fieldLine overlaps [startx, endx]
+    bool overlaps(qint32 startx, qint32 endx, qint32 fieldLine) const;
+
+private:
+    // Dropouts sorted by line, then startx; the ones on line L are
+    // intervals[lineStarts[L]] to intervals[lineStarts[L + 1] - 1]
+    QVector<Interval> intervals;
+    QVector<qint32> lineStarts;
+};
+
+#endif // DROPOUTINDEX_H
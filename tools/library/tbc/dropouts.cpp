@@ -123,6 +123,31 @@ void DropOuts::concatenate(const bool verbose)
     if(verbose){qDebug() << "Concatenated dropouts: was" << sizeAtStart << "now" << m_startx.size() << "dropouts";}
 }
 
+qint64 DropOuts::totalLength() const
+{
+    qint64 length = 0;
+    for (qint32 i = 0; i < m_startx.size(); i++) {
+        length += m_endx[i] - m_startx[i];
+    }
+
+    return length;
+}
+
+qint64 DropOuts::visibleLength(qint32 firstActiveFieldLine, qint32 lastActiveFieldLine,
+                               qint32 activeVideoStart, qint32 activeVideoEnd) const
+{
+    qint64 length = 0;
+    for (qint32 i = 0; i < m_startx.size(); i++) {
+        // Does the drop out start in the visible area?
+        if (m_fieldLine[i] >= firstActiveFieldLine && m_fieldLine[i] <= lastActiveFieldLine
+            && m_startx[i] >= activeVideoStart) {
+            length += qMin(m_endx[i], activeVideoEnd) - m_startx[i];
+        }
+    }
+
+    return length;
+}
+
 // Custom debug streaming operator
 QDebug operator<<(QDebug dbg, DropOuts &dropOuts)
 {
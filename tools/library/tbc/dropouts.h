@@ -70,6 +70,14 @@ public:
         return m_fieldLine[index];
     }
 
+    // Return the total length of the dropouts, in samples
+    qint64 totalLength() const;
+
+    // Return the total length of the dropouts starting within the active area,
+    // with each clipped to the end of the active area, in samples
+    qint64 visibleLength(qint32 firstActiveFieldLine, qint32 lastActiveFieldLine,
+                         qint32 activeVideoStart, qint32 activeVideoEnd) const;
+
     void read(JsonReader &reader);
     void write(JsonWriter &writer) const;
 
@@ -0,0 +1,236 @@
+/************************************************************************
+
+    fieldprefetcher.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "fieldprefetcher.h"
+
+#include <algorithm>
+
+bool FieldPrefetcher::isUseful(SourceVideo &sourceVideo)
+{
+    return sourceVideo.getNumberOfAvailableFields() != -1 && !sourceVideo.isMemoryMapped();
+}
+
+FieldPrefetcher::FieldPrefetcher(SourceVideo &_sourceVideo, qint32 bufferMegabytes, qint32 _lastFieldNumber, QObject *parent)
+    : QThread(parent), sourceVideo(_sourceVideo), lastFieldNumber(_lastFieldNumber), stopping(false),
+      direction(1), lastRequest(0), reversedRequests(0), windowAnchor(1), nextPrefetch(1), inFlight(-1),
+      hitCount(0), missCount(0)
+{
+    // Don't read beyond the end of the file
+    const qint32 availableFields = sourceVideo.getNumberOfAvailableFields();
+    if (availableFields != -1) lastFieldNumber = qMin(lastFieldNumber, availableFields);
+
+    // Work out how many fields fit in the buffer
+    const qint64 fieldBytes = static_cast<qint64>(sourceVideo.getFieldLength()) * 2;
+    const qint64 ringSize = (static_cast<qint64>(bufferMegabytes) * 1024 * 1024) / fieldBytes;
+    ring.resize(static_cast<qint32>(qMax(static_cast<qint64>(4), ringSize)));
+    for (Slot &slot: ring) slot.fieldNumber = -1;
+    keepBehind = ring.size() / 4;
+
+    qDebug() << "FieldPrefetcher::FieldPrefetcher(): Prefetching up to" << ring.size() << "fields";
+}
+
+FieldPrefetcher::~FieldPrefetcher()
+{
+    stop();
+}
+
+void FieldPrefetcher::stop()
+{
+    {
+        QMutexLocker locker(&ringMutex);
+        stopping = true;
+        ringCondition.wakeAll();
+    }
+    wait();
+}
+
+SourceVideo::Data FieldPrefetcher::getVideoField(qint32 fieldNumber)
+{
+    QMutexLocker locker(&ringMutex);
+
+    const Slot *slot = findField(fieldNumber);
+    if (slot != nullptr) return slot->data;
+
+    // Read it directly, without holding the ring lock (readVideoField can be
+    // called while the thread is reading another field). The window has
+    // already moved past this field, so the thread won't read it too.
+    locker.unlock();
+    SourceVideo::Data data;
+    sourceVideo.readVideoField(fieldNumber, data);
+    locker.relock();
+
+    storeField(fieldNumber, data);
+    return data;
+}
+
+void FieldPrefetcher::readVideoField(qint32 fieldNumber, SourceVideo::Data &fieldData)
+{
+    QMutexLocker locker(&ringMutex);
+
+    // Copy the field rather than sharing the slot's data, so that neither the
+    // caller's buffer nor the slot needs a new allocation when it's reused
+    const Slot *slot = findField(fieldNumber);
+    if (slot != nullptr) {
+        fieldData.resize(slot->data.size());
+        std::copy(slot->data.constBegin(), slot->data.constEnd(), fieldData.begin());
+        return;
+    }
+
+    // Read it directly, as in getVideoField
+    locker.unlock();
+    sourceVideo.readVideoField(fieldNumber, fieldData);
+    locker.relock();
+
+    storeField(fieldNumber, fieldData);
+}
+
+qint32 FieldPrefetcher::getFieldLength()
+{
+    return sourceVideo.getFieldLength();
+}
+
+qint32 FieldPrefetcher::getHitCount()
+{
+    QMutexLocker locker(&ringMutex);
+    return hitCount;
+}
+
+qint32 FieldPrefetcher::getMissCount()
+{
+    QMutexLocker locker(&ringMutex);
+    return missCount;
+}
+
+// Move the window for a request for fieldNumber, wait if the thread is reading
+// it, and return its slot if it's in the ring, or nullptr if it isn't.
+// You must hold ringMutex to call this.
+const FieldPrefetcher::Slot *FieldPrefetcher::findField(qint32 fieldNumber)
+{
+    updateWindow(fieldNumber);
+    ringCondition.wakeAll();
+
+    // If the thread is reading this field now, wait for it. Other reads don't
+    // hold us up.
+    while (inFlight == fieldNumber) ringCondition.wait(&ringMutex);
+
+    const Slot &slot = ring[fieldNumber % ring.size()];
+    if (slot.fieldNumber == fieldNumber) {
+        // The field is in the ring
+        hitCount++;
+        return &slot;
+    }
+
+    missCount++;
+    return nullptr;
+}
+
+// Copy a field that missed the ring into its slot, if it's still within the
+// window. You must hold ringMutex to call this.
+void FieldPrefetcher::storeField(qint32 fieldNumber, const SourceVideo::Data &fieldData)
+{
+    if (!isInWindow(fieldNumber)) return;
+
+    Slot &slot = ring[fieldNumber % ring.size()];
+    slot.fieldNumber = fieldNumber;
+    slot.data.resize(fieldData.size());
+    std::copy(fieldData.constBegin(), fieldData.constEnd(), slot.data.begin());
+}
+
+// Return true if fieldNumber is within the window of fields the ring may hold.
+// You must hold ringMutex to call this.
+bool FieldPrefetcher::isInWindow(qint32 fieldNumber) const
+{
+    const qint32 offset = (fieldNumber - windowAnchor) * direction;
+    return offset >= -keepBehind && offset < ring.size() - keepBehind;
+}
+
+// Move the window to account for a request for fieldNumber.
+// You must hold ringMutex to call this.
+void FieldPrefetcher::updateWindow(qint32 fieldNumber)
+{
+    // Work out which direction the fields are being requested in. Requests
+    // from several workers can arrive slightly out of order, so only change
+    // direction after two requests in a row have gone the other way.
+    if (lastRequest != 0 && fieldNumber != lastRequest) {
+        if ((fieldNumber - lastRequest) * direction > 0) {
+            reversedRequests = 0;
+        } else if (++reversedRequests == 2) {
+            direction = -direction;
+            reversedRequests = 0;
+            windowAnchor = fieldNumber;
+            nextPrefetch = fieldNumber + direction;
+        }
+    }
+    lastRequest = fieldNumber;
+
+    if (!isInWindow(fieldNumber)) {
+        // We've jumped somewhere else entirely, so restart prefetching from here
+        windowAnchor = fieldNumber;
+        nextPrefetch = fieldNumber + direction;
+    } else if ((fieldNumber - windowAnchor) * direction > 0) {
+        // Move the window forwards (in the current direction)
+        windowAnchor = fieldNumber;
+    }
+
+    // Don't prefetch fields at or behind this one
+    if ((nextPrefetch - fieldNumber) * direction <= 0) nextPrefetch = fieldNumber + direction;
+}
+
+void FieldPrefetcher::run()
+{
+    QMutexLocker locker(&ringMutex);
+
+    // The buffer to read into. Once a field has been read, this is swapped
+    // with the slot's buffer, so the slot's old allocation is reused for the
+    // next read.
+    SourceVideo::Data data;
+
+    while (true) {
+        // Wait until there's a field to read
+        while (!stopping && (!isInWindow(nextPrefetch) || nextPrefetch < 1 || nextPrefetch > lastFieldNumber)) {
+            ringCondition.wait(&ringMutex);
+        }
+        if (stopping) break;
+
+        // Skip fields that are already in the ring
+        const qint32 fieldNumber = nextPrefetch;
+        nextPrefetch += direction;
+        if (ring[fieldNumber % ring.size()].fieldNumber == fieldNumber) continue;
+
+        // Read the field without holding the ring lock
+        inFlight = fieldNumber;
+        locker.unlock();
+        sourceVideo.readVideoField(fieldNumber, data);
+        locker.relock();
+
+        // Store it, if it's still within the window
+        if (isInWindow(fieldNumber)) {
+            Slot &slot = ring[fieldNumber % ring.size()];
+            slot.fieldNumber = fieldNumber;
+            slot.data.swap(data);
+        }
+        inFlight = -1;
+        ringCondition.wakeAll();
+    }
+}
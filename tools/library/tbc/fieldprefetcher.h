@@ -0,0 +1,131 @@
+/************************************************************************
+
+    fieldprefetcher.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef FIELDPREFETCHER_H
+#define FIELDPREFETCHER_H
+
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "sourcevideo.h"
+
+// Background read-ahead for whole fields from a SourceVideo.
+//
+// The worker pools read input fields in (approximately) increasing order
+// while holding their input lock, so every worker stalls while one of them
+// waits for the disk. A FieldPrefetcher runs a thread that reads the fields
+// following the most recently requested one into a ring of buffers, so that
+// I/O overlaps with decoding and getVideoField usually returns immediately.
+// If the fields are requested in decreasing order, it reads backwards
+// instead.
+//
+// Fields are read with SourceVideo::readVideoField. Once a FieldPrefetcher
+// has been started, the SourceVideo must not be accessed with getVideoField
+// or getVideoFieldView until it has been stopped.
+//
+// The thread reads fields in a different order from the workers, so this
+// only works with seekable input; use isUseful to check before creating one.
+class FieldPrefetcher : public QThread
+{
+public:
+    // Return true if prefetching from sourceVideo is possible and worthwhile.
+    // It isn't possible for non-seekable input such as stdin, and it isn't
+    // worthwhile for memory-mapped input, where it would only add a copy.
+    static bool isUseful(SourceVideo &sourceVideo);
+
+    // Prefetch up to bufferMegabytes of fields ahead, not going beyond
+    // lastFieldNumber.
+    FieldPrefetcher(SourceVideo &sourceVideo, qint32 bufferMegabytes, qint32 lastFieldNumber, QObject *parent = nullptr);
+    ~FieldPrefetcher() override;
+
+    // Prevent copying or assignment
+    FieldPrefetcher(const FieldPrefetcher &) = delete;
+    FieldPrefetcher& operator=(const FieldPrefetcher &) = delete;
+
+    // Stop the prefetch thread. This is called automatically on destruction.
+    void stop();
+
+    // Get a whole field, using prefetched data if available. This is safe to
+    // call from multiple threads.
+    SourceVideo::Data getVideoField(qint32 fieldNumber);
+
+    // As above, but copy the field into fieldData, reusing its allocation
+    // where possible. This is also safe to call from multiple threads.
+    void readVideoField(qint32 fieldNumber, SourceVideo::Data &fieldData);
+
+    qint32 getFieldLength();
+
+    // Statistics
+    qint32 getHitCount();
+    qint32 getMissCount();
+
+protected:
+    void run() override;
+
+private:
+    SourceVideo &sourceVideo;
+    qint32 lastFieldNumber;
+
+    // Ring state (all guarded by ringMutex)
+    QMutex ringMutex;
+    QWaitCondition ringCondition;
+    bool stopping;
+
+    struct Slot {
+        qint32 fieldNumber;
+        SourceVideo::Data data;
+    };
+    QVector<Slot> ring;
+
+    // Number of fields to keep behind the most recent request, for decoders
+    // that look behind or sources that are read slightly out of order
+    qint32 keepBehind;
+
+    // The direction fields are being requested in (1 or -1), the most recent
+    // request, and the number of consecutive requests that have gone the
+    // other way
+    qint32 direction;
+    qint32 lastRequest;
+    qint32 reversedRequests;
+
+    // The furthest field requested in the current direction; the ring holds
+    // fields from keepBehind behind this to the end of the ring ahead of it
+    qint32 windowAnchor;
+    // The next field the thread will read
+    qint32 nextPrefetch;
+    // The field the thread is reading now, or -1
+    qint32 inFlight;
+
+    qint32 hitCount;
+    qint32 missCount;
+
+    const Slot *findField(qint32 fieldNumber);
+    void storeField(qint32 fieldNumber, const SourceVideo::Data &fieldData);
+    bool isInWindow(qint32 fieldNumber) const;
+    void updateWindow(qint32 fieldNumber);
+};
+
+#endif // FIELDPREFETCHER_H
@@ -27,6 +27,7 @@
 #include "lddecodemetadata.h"
 
 #include "jsonio.h"
+#include "metadatacache.h"
 
 #include <cassert>
 #include <fstream>
@@ -530,6 +531,11 @@ LdDecodeMetaData::LdDecodeMetaData()
     clear();
 }
 
+// Defined here, where MetadataCache is a complete type
+LdDecodeMetaData::~LdDecodeMetaData()
+{
+}
+
 // Reset the metadata to the defaults
 void LdDecodeMetaData::clear()
 {
@@ -541,10 +547,63 @@ void LdDecodeMetaData::clear()
     pcmAudioParameters = PcmAudioParameters();
 
     fields.clear();
+    metadataCache.reset();
+    cachedFields.clear();
+}
+
+bool LdDecodeMetaData::writeCache = false;
+
+void LdDecodeMetaData::setWriteCache(bool state)
+{
+    writeCache = state;
 }
 
-// Read all metadata from a JSON file
+// Read all metadata from a JSON file.
+// If there's an up-to-date binary cache of the JSON file, this reads that
+// instead; otherwise, it parses the JSON file, and tries to write a cache if
+// that's been enabled with setWriteCache.
 bool LdDecodeMetaData::read(QString fileName)
+{
+    clear();
+
+    std::unique_ptr<MetadataCache> cache = MetadataCache::open(fileName);
+    if (cache) {
+        videoParameters = cache->getVideoParameters();
+        pcmAudioParameters = cache->getPcmAudioParameters();
+        metadataCache = std::move(cache);
+    } else if (!readJson(fileName)) {
+        return false;
+    }
+
+    // Check we saw VideoParameters - if not, we can't do anything useful!
+    if (!videoParameters.isValid) {
+        qCritical("JSON file invalid: videoParameters object is not defined");
+        return false;
+    }
+
+    // Check numberOfSequentialFields is consistent
+    if (videoParameters.numberOfSequentialFields != getNumberOfFields()) {
+        qCritical("JSON file invalid: numberOfSequentialFields does not match fields array");
+        return false;
+    }
+
+    // If we parsed the JSON file, write a cache to speed up reading it next time
+    if (writeCache && !metadataCache) {
+        MetadataCache::write(fileName, videoParameters, pcmAudioParameters, fields.size(),
+                             [&](qint32 fieldNumber) { return fields[fieldNumber]; });
+    }
+
+    // Now we know the video system, initialise the rest of VideoParameters
+    initialiseVideoSystemParameters();
+
+    // Generate the PCM audio map based on the field metadata
+    generatePcmAudioMap();
+
+    return true;
+}
+
+// Parse a JSON file
+bool LdDecodeMetaData::readJson(QString fileName)
 {
     std::ifstream jsonFile(fileName.toStdString());
     if (jsonFile.fail()) {
@@ -552,8 +611,6 @@ bool LdDecodeMetaData::read(QString fileName)
         return false;
     }
 
-    clear();
-
     JsonReader reader(jsonFile);
 
     try {
@@ -575,24 +632,6 @@ bool LdDecodeMetaData::read(QString fileName)
 
     jsonFile.close();
 
-    // Check we saw VideoParameters - if not, we can't do anything useful!
-    if (!videoParameters.isValid) {
-        qCritical("JSON file invalid: videoParameters object is not defined");
-        return false;
-    }
-
-    // Check numberOfSequentialFields is consistent
-    if (videoParameters.numberOfSequentialFields != fields.size()) {
-        qCritical("JSON file invalid: numberOfSequentialFields does not match fields array");
-        return false;
-    }
-
-    // Now we know the video system, initialise the rest of VideoParameters
-    initialiseVideoSystemParameters();
-
-    // Generate the PCM audio map based on the field metadata
-    generatePcmAudioMap();
-
     return true;
 }
 
@@ -612,17 +651,19 @@ bool LdDecodeMetaData::write(QString fileName) const
     // Keep members in alphabetical order
     writer.writeMember("fields");
     writeFields(writer);
-    if (pcmAudioParameters.isValid) {
-        writer.writeMember("pcmAudioParameters");
-        pcmAudioParameters.write(writer);
-    }
-    writer.writeMember("videoParameters");
-    videoParameters.write(writer);
+    writeParameters(writer);
 
     writer.endObject();
 
     jsonFile.close();
 
+    // Regenerate the binary cache to match the new JSON file
+    if (writeCache) {
+        const qint32 numberOfFields = metadataCache ? metadataCache->getNumberOfFields() : fields.size();
+        MetadataCache::write(fileName, videoParameters, pcmAudioParameters, numberOfFields,
+                             [&](qint32 fieldNumber) { return fieldAt(fieldNumber); });
+    }
+
     return true;
 }
 
@@ -640,14 +681,34 @@ void LdDecodeMetaData::readFields(JsonReader &reader)
     reader.endArray();
 }
 
+// Write the pcmAudioParameters and videoParameters members to JSON
+void LdDecodeMetaData::writeParameters(JsonWriter &writer) const
+{
+    writeParameters(writer, videoParameters.numberOfSequentialFields);
+}
+
+// As above, but with numberOfSequentialFields replaced by numberOfFields
+void LdDecodeMetaData::writeParameters(JsonWriter &writer, qint32 numberOfFields) const
+{
+    if (pcmAudioParameters.isValid) {
+        writer.writeMember("pcmAudioParameters");
+        pcmAudioParameters.write(writer);
+    }
+    VideoParameters outputVideoParameters = videoParameters;
+    outputVideoParameters.numberOfSequentialFields = numberOfFields;
+    writer.writeMember("videoParameters");
+    outputVideoParameters.write(writer);
+}
+
 // Write array of Fields to JSON
 void LdDecodeMetaData::writeFields(JsonWriter &writer) const
 {
     writer.beginArray();
 
-    for (const Field &field : fields) {
+    const qint32 numberOfFields = metadataCache ? metadataCache->getNumberOfFields() : fields.size();
+    for (qint32 fieldNumber = 0; fieldNumber < numberOfFields; fieldNumber++) {
         writer.writeElement();
-        field.write(writer);
+        fieldAt(fieldNumber).write(writer);
     }
 
     writer.endArray();
@@ -781,7 +842,26 @@ const LdDecodeMetaData::Field &LdDecodeMetaData::getField(qint32 sequentialField
         qCritical() << "LdDecodeMetaData::getField(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber];
+    return fieldAt(fieldNumber);
+}
+
+// This method gets a copy of the metadata for the specified sequential field number
+LdDecodeMetaData::Field LdDecodeMetaData::copyField(qint32 sequentialFieldNumber)
+{
+    qint32 fieldNumber = sequentialFieldNumber - 1;
+    if (fieldNumber < 0 || fieldNumber >= getNumberOfFields()) {
+        qCritical() << "LdDecodeMetaData::copyField(): Requested field number" << sequentialFieldNumber << "out of bounds!";
+        return Field();
+    }
+
+    if (!metadataCache) return fields[fieldNumber];
+
+    // Use the field if it's already been decoded (and maybe updated);
+    // otherwise decode it without keeping it
+    QMutexLocker locker(&cacheMutex);
+    auto it = cachedFields.find(fieldNumber);
+    if (it != cachedFields.end()) return it->second;
+    return metadataCache->getField(fieldNumber);
 }
 
 // This method gets the VITS metrics metadata for the specified sequential field number
@@ -792,7 +872,7 @@ const LdDecodeMetaData::VitsMetrics &LdDecodeMetaData::getFieldVitsMetrics(qint3
         qCritical() << "LdDecodeMetaData::getFieldVitsMetrics(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].vitsMetrics;
+    return fieldAt(fieldNumber).vitsMetrics;
 }
 
 // This method gets the VBI metadata for the specified sequential field number
@@ -803,7 +883,7 @@ const LdDecodeMetaData::Vbi &LdDecodeMetaData::getFieldVbi(qint32 sequentialFiel
         qCritical() << "LdDecodeMetaData::getFieldVbi(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].vbi;
+    return fieldAt(fieldNumber).vbi;
 }
 
 // This method gets the NTSC metadata for the specified sequential field number
@@ -814,7 +894,7 @@ const LdDecodeMetaData::Ntsc &LdDecodeMetaData::getFieldNtsc(qint32 sequentialFi
         qCritical() << "LdDecodeMetaData::getFieldNtsc(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].ntsc;
+    return fieldAt(fieldNumber).ntsc;
 }
 
 // This method gets the VITC metadata for the specified sequential field number
@@ -825,7 +905,7 @@ const LdDecodeMetaData::Vitc &LdDecodeMetaData::getFieldVitc(qint32 sequentialFi
         qCritical() << "LdDecodeMetaData::getFieldVitc(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].vitc;
+    return fieldAt(fieldNumber).vitc;
 }
 
 // This method gets the Closed Caption metadata for the specified sequential field number
@@ -836,7 +916,7 @@ const LdDecodeMetaData::ClosedCaption &LdDecodeMetaData::getFieldClosedCaption(q
         qCritical() << "LdDecodeMetaData::getFieldClosedCaption(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].closedCaption;
+    return fieldAt(fieldNumber).closedCaption;
 }
 
 // This method gets the drop-out metadata for the specified sequential field number
@@ -847,7 +927,7 @@ const DropOuts &LdDecodeMetaData::getFieldDropOuts(qint32 sequentialFieldNumber)
         qCritical() << "LdDecodeMetaData::getFieldDropOuts(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].dropOuts;
+    return fieldAt(fieldNumber).dropOuts;
 }
 
 // This method sets the field metadata for a field
@@ -858,7 +938,7 @@ void LdDecodeMetaData::updateField(const LdDecodeMetaData::Field &field, qint32
         qCritical() << "LdDecodeMetaData::updateFieldVitsMetrics(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber] = field;
+    fieldAt(fieldNumber) = field;
 }
 
 // This method sets the field VBI metadata for a field
@@ -869,7 +949,7 @@ void LdDecodeMetaData::updateFieldVitsMetrics(const LdDecodeMetaData::VitsMetric
         qCritical() << "LdDecodeMetaData::updateFieldVitsMetrics(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].vitsMetrics = vitsMetrics;
+    fieldAt(fieldNumber).vitsMetrics = vitsMetrics;
 }
 
 // This method sets the field VBI metadata for a field
@@ -880,7 +960,7 @@ void LdDecodeMetaData::updateFieldVbi(const LdDecodeMetaData::Vbi &vbi, qint32 s
         qCritical() << "LdDecodeMetaData::updateFieldVbi(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].vbi = vbi;
+    fieldAt(fieldNumber).vbi = vbi;
 }
 
 // This method sets the field NTSC metadata for a field
@@ -891,7 +971,7 @@ void LdDecodeMetaData::updateFieldNtsc(const LdDecodeMetaData::Ntsc &ntsc, qint3
         qCritical() << "LdDecodeMetaData::updateFieldNtsc(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].ntsc = ntsc;
+    fieldAt(fieldNumber).ntsc = ntsc;
 }
 
 // This method sets the VITC metadata for a field
@@ -902,7 +982,7 @@ void LdDecodeMetaData::updateFieldVitc(const LdDecodeMetaData::Vitc &vitc, qint3
         qCritical() << "LdDecodeMetaData::updateFieldVitc(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].vitc = vitc;
+    fieldAt(fieldNumber).vitc = vitc;
 }
 
 // This method sets the Closed Caption metadata for a field
@@ -913,7 +993,7 @@ void LdDecodeMetaData::updateFieldClosedCaption(const LdDecodeMetaData::ClosedCa
         qCritical() << "LdDecodeMetaData::updateFieldClosedCaption(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].closedCaption = closedCaption;
+    fieldAt(fieldNumber).closedCaption = closedCaption;
 }
 
 // This method sets the field dropout metadata for a field
@@ -924,7 +1004,7 @@ void LdDecodeMetaData::updateFieldDropOuts(const DropOuts &dropOuts, qint32 sequ
         qCritical() << "LdDecodeMetaData::updateFieldDropOuts(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].dropOuts = dropOuts;
+    fieldAt(fieldNumber).dropOuts = dropOuts;
 }
 
 // This method clears the field dropout metadata for a field
@@ -935,20 +1015,95 @@ void LdDecodeMetaData::clearFieldDropOuts(qint32 sequentialFieldNumber)
         qCritical() << "LdDecodeMetaData::clearFieldDropOuts(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].dropOuts.clear();
+    fieldAt(fieldNumber).dropOuts.clear();
 }
 
 // This method appends a new field to the existing metadata
 void LdDecodeMetaData::appendField(const LdDecodeMetaData::Field &field)
 {
-    fields.append(field);
+    // field may refer to a cached field, so copy it before loadAllFields
+    const Field newField = field;
+    loadAllFields();
+    fields.append(newField);
 
     videoParameters.numberOfSequentialFields = fields.size();
 }
 
+// Private method to get the metadata for a field (indexed from 0).
+// When reading from a binary cache, this decodes the field on first use.
+const LdDecodeMetaData::Field &LdDecodeMetaData::fieldAt(qint32 fieldNumber) const
+{
+    if (!metadataCache) return fields[fieldNumber];
+
+    QMutexLocker locker(&cacheMutex);
+
+    auto it = cachedFields.find(fieldNumber);
+    if (it == cachedFields.end()) {
+        Field field;
+        if (fieldNumber >= 0 && fieldNumber < metadataCache->getNumberOfFields()) {
+            field = metadataCache->getField(fieldNumber);
+        }
+        it = cachedFields.emplace(fieldNumber, std::move(field)).first;
+    }
+
+    // Elements of an unordered_map don't move, so this stays valid
+    return it->second;
+}
+
+LdDecodeMetaData::Field &LdDecodeMetaData::fieldAt(qint32 fieldNumber)
+{
+    return const_cast<Field &>(static_cast<const LdDecodeMetaData *>(this)->fieldAt(fieldNumber));
+}
+
+// Private method to get isFirstField for a field (indexed from 0), without
+// decoding the rest of the field from the cache
+bool LdDecodeMetaData::fieldIsFirstField(qint32 fieldNumber) const
+{
+    const qint32 numberOfFields = metadataCache ? metadataCache->getNumberOfFields() : fields.size();
+    if (fieldNumber < 0 || fieldNumber >= numberOfFields) return false;
+
+    if (!metadataCache) return fields[fieldNumber].isFirstField;
+
+    QMutexLocker locker(&cacheMutex);
+    auto it = cachedFields.find(fieldNumber);
+    if (it != cachedFields.end()) return it->second.isFirstField;
+    return metadataCache->getIsFirstField(fieldNumber);
+}
+
+// Private method to get audioSamples for a field (indexed from 0), without
+// decoding the rest of the field from the cache
+qint32 LdDecodeMetaData::fieldAudioSamples(qint32 fieldNumber) const
+{
+    if (!metadataCache) return fields[fieldNumber].audioSamples;
+
+    QMutexLocker locker(&cacheMutex);
+    auto it = cachedFields.find(fieldNumber);
+    if (it != cachedFields.end()) return it->second.audioSamples;
+    return metadataCache->getAudioSamples(fieldNumber);
+}
+
+// Private method to decode all the fields from the cache into fields, so
+// they can be modified in ways the cache can't represent
+void LdDecodeMetaData::loadAllFields()
+{
+    if (!metadataCache) return;
+
+    const qint32 numberOfFields = metadataCache->getNumberOfFields();
+    fields.resize(numberOfFields);
+    for (qint32 fieldNumber = 0; fieldNumber < numberOfFields; fieldNumber++) {
+        auto it = cachedFields.find(fieldNumber);
+        if (it != cachedFields.end()) fields[fieldNumber] = it->second;
+        else fields[fieldNumber] = metadataCache->getField(fieldNumber);
+    }
+
+    metadataCache.reset();
+    cachedFields.clear();
+}
+
 // Method to get the available number of fields (according to the metadata)
 qint32 LdDecodeMetaData::getNumberOfFields()
 {
+    if (metadataCache) return metadataCache->getNumberOfFields();
     return fields.size();
 }
 
@@ -1028,10 +1183,10 @@ qint32 LdDecodeMetaData::getNumberOfFrames()
     // skip it when counting the number of still-frames
     if (isFirstFieldFirst) {
         // Expecting first field first
-        if (!getField(1).isFirstField) frameOffset = 1;
+        if (!fieldIsFirstField(0)) frameOffset = 1;
     } else {
         // Expecting second field first
-        if (getField(1).isFirstField) frameOffset = 1;
+        if (fieldIsFirstField(0)) frameOffset = 1;
     }
 
     return (getNumberOfFields() / 2) - frameOffset;
@@ -1064,7 +1219,7 @@ qint32 LdDecodeMetaData::getFieldNumber(qint32 frameNumber, qint32 field)
     // If the field number pointed to by firstFieldNumber doesn't have
     // isFirstField set, move forward field by field until the current
     // field does
-    while (!getField(firstFieldNumber).isFirstField) {
+    while (!fieldIsFirstField(firstFieldNumber - 1)) {
         firstFieldNumber++;
         secondFieldNumber++;
 
@@ -1092,7 +1247,7 @@ qint32 LdDecodeMetaData::getFieldNumber(qint32 frameNumber, qint32 field)
     }
 
     // Test for a buggy TBC file...
-    if (getField(secondFieldNumber).isFirstField) {
+    if (fieldIsFirstField(secondFieldNumber - 1)) {
         qCritical() << "LdDecodeMetaData::getFieldNumber(): Both of the determined fields have isFirstField set - the TBC source video is probably broken...";
     }
 
@@ -1218,7 +1373,7 @@ void LdDecodeMetaData::generatePcmAudioMap()
 
     for (qint32 fieldNo = 0; fieldNo < numberOfFields; fieldNo++) {
         // Each audio sample is 16 bit - and there are 2 samples per stereo pair
-        pcmAudioFieldLengthMap[fieldNo] = static_cast<qint32>(getField(fieldNo+1).audioSamples);
+        pcmAudioFieldLengthMap[fieldNo] = fieldAudioSamples(fieldNo);
 
         if (fieldNo == 0) {
             // First field starts at 0 units
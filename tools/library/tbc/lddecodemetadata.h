@@ -31,12 +31,16 @@
 #include <QVector>
 #include <QTemporaryFile>
 #include <QDebug>
+#include <QMutex>
 #include <array>
+#include <memory>
+#include <unordered_map>
 
 #include "dropouts.h"
 
 class JsonReader;
 class JsonWriter;
+class MetadataCache;
 
 // The video system (combination of a line standard and a colour standard)
 // Note: If you update this, be sure to update VIDEO_SYSTEM_DEFAULTS also
@@ -219,6 +223,7 @@ public:
     };
 
     LdDecodeMetaData();
+    ~LdDecodeMetaData();
 
     // Prevent copying or assignment
     LdDecodeMetaData(const LdDecodeMetaData &) = delete;
@@ -227,8 +232,15 @@ public:
     void clear();
     bool read(QString fileName);
     bool write(QString fileName) const;
+
+    // Control whether read and write also write a binary cache of the
+    // metadata alongside the JSON file (see MetadataCache). This is off by
+    // default; an existing, up-to-date cache is always used by read.
+    static void setWriteCache(bool state);
     void readFields(JsonReader &reader);
     void writeFields(JsonWriter &writer) const;
+    void writeParameters(JsonWriter &writer) const;
+    void writeParameters(JsonWriter &writer, qint32 numberOfFields) const;
 
     const VideoParameters &getVideoParameters();
     void setVideoParameters(const VideoParameters &videoParameters);
@@ -248,6 +260,11 @@ public:
     const ClosedCaption &getFieldClosedCaption(qint32 sequentialFieldNumber);
     const DropOuts &getFieldDropOuts(qint32 sequentialFieldNumber);
 
+    // Get a copy of a field's metadata. Unlike getField, this doesn't keep
+    // the decoded field in memory when reading from a binary cache, so tools
+    // that pass through each field once should use this.
+    Field copyField(qint32 sequentialFieldNumber);
+
     // Set field metadata
     void updateField(const Field &field, qint32 sequentialFieldNumber);
     void updateFieldVitsMetrics(const LdDecodeMetaData::VitsMetrics &vitsMetrics, qint32 sequentialFieldNumber);
@@ -287,6 +304,20 @@ private:
     QVector<qint32> pcmAudioFieldStartSampleMap;
     QVector<qint32> pcmAudioFieldLengthMap;
 
+    // If the metadata was read from a binary cache, fields is empty, and
+    // fields are decoded from the cache into cachedFields as they're used
+    static bool writeCache;
+    std::unique_ptr<MetadataCache> metadataCache;
+    mutable std::unordered_map<qint32, Field> cachedFields;
+    mutable QMutex cacheMutex;
+
+    const Field &fieldAt(qint32 fieldNumber) const;
+    Field &fieldAt(qint32 fieldNumber);
+    bool fieldIsFirstField(qint32 fieldNumber) const;
+    qint32 fieldAudioSamples(qint32 fieldNumber) const;
+    void loadAllFields();
+
+    bool readJson(QString fileName);
     void initialiseVideoSystemParameters();
     qint32 getFieldNumber(qint32 frameNumber, qint32 field);
     void generatePcmAudioMap();
@@ -25,6 +25,8 @@
 
 #include "logging.h"
 
+#include "lddecodemetadata.h"
+
 // Global for debug output
 static bool showDebug = false;
 static bool saveDebug = false;
@@ -37,6 +39,8 @@ static QCommandLineOption showDebugOption(QStringList() << "d" << "debug",
                                           QCoreApplication::translate("main", "Show debug"));
 static QCommandLineOption setQuietOption({"q", "quiet"},
                                          QCoreApplication::translate("main", "Suppress info and warning messages"));
+static QCommandLineOption writeMetadataCacheOption("write-metadata-cache",
+                                                   QCoreApplication::translate("main", "Write a binary cache alongside JSON metadata files, to speed up reading them"));
 
 // Qt debug message handler
 void debugOutputHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
@@ -138,6 +142,9 @@ void addStandardDebugOptions(QCommandLineParser &parser)
 
     // Option to set quiet mode (-q)
     parser.addOption(setQuietOption);
+
+    // Option to write metadata caches (--write-metadata-cache)
+    parser.addOption(writeMetadataCacheOption);
 }
 
 // Method to process the standard debug options
@@ -146,6 +153,7 @@ void processStandardDebugOptions(QCommandLineParser &parser)
     // Process any options added by the addStandardDebugOptions method
     if (parser.isSet(showDebugOption)) setDebug(true); else setDebug(false);
     if (parser.isSet(setQuietOption)) setQuiet(true); else setQuiet(false);
+    LdDecodeMetaData::setWriteCache(parser.isSet(writeMetadataCacheOption));
 }
 
 // Method to get the current debug logging state
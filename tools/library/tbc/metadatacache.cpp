@@ -0,0 +1,442 @@
+/************************************************************************
+
+    metadatacache.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "metadatacache.h"
+
+#include "jsonio.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+// Magic number and version at the start of the cache file.
+// Increase the version if you change the format.
+static constexpr char CACHE_MAGIC[8] = { 'L', 'D', 'M', 'C', 'A', 'C', 'H', 'E' };
+static constexpr quint32 CACHE_VERSION = 2;
+
+// Written in native byte order, so the cache is ignored on a machine with different endianness
+static constexpr quint32 CACHE_BYTE_ORDER = 0x01020304;
+
+// Columns start at multiples of this
+static constexpr qint64 CACHE_ALIGNMENT = 8;
+
+// Number of bytes at each end of the JSON file that are included in its hash
+static constexpr qint64 JSON_HASH_BYTES = 64 * 1024;
+
+struct CacheHeader {
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 numColumns;
+    quint32 parametersSize;
+    qint64 jsonSize;
+    qint64 jsonModified;
+    qint64 numberOfFields;
+    quint64 jsonHash;
+};
+
+struct CacheColumnEntry {
+    quint32 id;
+    quint32 elementSize;
+    qint64 offset;
+    qint64 count;
+};
+
+// Data for a column being written
+struct ColumnBuilder {
+    quint32 elementSize = 0;
+    QByteArray data;
+
+    template <typename T>
+    void append(T value) {
+        elementSize = sizeof(T);
+        data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+};
+
+// Get the size and modification time of a JSON file, and a hash of the data
+// at its start and end. The hash catches the file being replaced by a
+// different one with the same size and time (e.g. by cp -p or rsync), without
+// reading the whole of a large file.
+static bool getJsonStamp(const QString &jsonFileName, qint64 &size, qint64 &modified, quint64 &hash)
+{
+    QFileInfo info(jsonFileName);
+    if (!info.exists()) return false;
+
+    size = info.size();
+    modified = info.lastModified().toMSecsSinceEpoch();
+
+    QFile file(jsonFileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QByteArray data = file.read(JSON_HASH_BYTES);
+    if (size > 2 * JSON_HASH_BYTES && !file.seek(size - JSON_HASH_BYTES)) return false;
+    data.append(file.read(JSON_HASH_BYTES));
+
+    // 64-bit FNV-1a
+    hash = 0xCBF29CE484222325ULL;
+    for (const char c : data) {
+        hash = (hash ^ static_cast<uchar>(c)) * 0x100000001B3ULL;
+    }
+    return true;
+}
+
+static qint64 alignOffset(qint64 offset)
+{
+    return (offset + CACHE_ALIGNMENT - 1) & ~(CACHE_ALIGNMENT - 1);
+}
+
+MetadataCache::~MetadataCache()
+{
+    if (mappedData != nullptr) file.unmap(const_cast<uchar *>(mappedData));
+}
+
+QString MetadataCache::getCacheFileName(const QString &jsonFileName)
+{
+    return jsonFileName + ".cache";
+}
+
+std::unique_ptr<MetadataCache> MetadataCache::open(const QString &jsonFileName)
+{
+    qint64 jsonSize, jsonModified;
+    quint64 jsonHash;
+    if (!getJsonStamp(jsonFileName, jsonSize, jsonModified, jsonHash)) return nullptr;
+
+    std::unique_ptr<MetadataCache> cache(new MetadataCache);
+    cache->file.setFileName(getCacheFileName(jsonFileName));
+    if (!cache->file.exists() || !cache->file.open(QIODevice::ReadOnly)) return nullptr;
+
+    const qint64 fileSize = cache->file.size();
+    if (fileSize < static_cast<qint64>(sizeof(CacheHeader))) return nullptr;
+
+    cache->mappedData = cache->file.map(0, fileSize);
+    if (cache->mappedData == nullptr) {
+        qDebug() << "MetadataCache::open(): Could not map" << cache->file.fileName();
+        return nullptr;
+    }
+
+    // Check the header matches this version, and the JSON file hasn't changed
+    CacheHeader header;
+    std::memcpy(&header, cache->mappedData, sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0
+        || header.version != CACHE_VERSION
+        || header.byteOrder != CACHE_BYTE_ORDER
+        || header.numColumns != NUM_COLUMNS) {
+        qDebug() << "MetadataCache::open(): Ignoring" << cache->file.fileName() << "as it is not a compatible cache file";
+        return nullptr;
+    }
+    if (header.jsonSize != jsonSize || header.jsonModified != jsonModified || header.jsonHash != jsonHash) {
+        qDebug() << "MetadataCache::open(): Ignoring" << cache->file.fileName() << "as the JSON file has changed";
+        return nullptr;
+    }
+    if (header.numberOfFields < 0 || header.numberOfFields > std::numeric_limits<qint32>::max() - 1) {
+        qDebug() << "MetadataCache::open(): Ignoring" << cache->file.fileName() << "as its number of fields is invalid";
+        return nullptr;
+    }
+    cache->numberOfFields = static_cast<qint32>(header.numberOfFields);
+
+    // Read the column table, checking each column is within the file, and has
+    // the element size and number of entries that getField expects. There is
+    // one entry per field in each column, except that the dropout index has an
+    // extra entry at the end, and the other dropout columns have one entry per
+    // dropout.
+    qint64 offset = sizeof(CacheHeader);
+    if (offset + static_cast<qint64>(NUM_COLUMNS * sizeof(CacheColumnEntry)) > fileSize) return nullptr;
+    qint64 numDropOuts = -1;
+    for (quint32 i = 0; i < NUM_COLUMNS; i++) {
+        CacheColumnEntry entry;
+        std::memcpy(&entry, cache->mappedData + offset, sizeof(entry));
+        offset += sizeof(entry);
+
+        qint64 expectedCount = header.numberOfFields;
+        if (i == DROPOUT_INDEX) expectedCount = header.numberOfFields + 1;
+        else if (i > DROPOUT_INDEX) expectedCount = (numDropOuts == -1) ? entry.count : numDropOuts;
+
+        const qint64 elementSize = getElementSize(static_cast<Column>(i));
+        if (entry.id != i || entry.elementSize != elementSize
+            || entry.count < 0 || entry.count != expectedCount
+            || entry.offset < 0 || entry.offset % CACHE_ALIGNMENT != 0 || entry.offset > fileSize
+            || entry.count > (fileSize - entry.offset) / elementSize) {
+            qDebug() << "MetadataCache::open(): Column" << i << "in" << cache->file.fileName() << "is invalid";
+            return nullptr;
+        }
+        cache->columns[i] = cache->mappedData + entry.offset;
+        if (i > DROPOUT_INDEX) numDropOuts = entry.count;
+    }
+
+    // Check the dropout index gives a valid range of dropouts for each field
+    quint64 previousIndex = 0;
+    for (qint64 fieldNumber = 0; fieldNumber <= header.numberOfFields; fieldNumber++) {
+        const quint64 index = *cache->column<quint64>(DROPOUT_INDEX, fieldNumber);
+        if (index < previousIndex || index > static_cast<quint64>(numDropOuts)
+            || (fieldNumber == 0 && index != 0)
+            || (fieldNumber == header.numberOfFields && index != static_cast<quint64>(numDropOuts))) {
+            qDebug() << "MetadataCache::open(): Dropout index in" << cache->file.fileName() << "is invalid";
+            return nullptr;
+        }
+        previousIndex = index;
+    }
+
+    // Read the parameters
+    if (offset + header.parametersSize > fileSize) return nullptr;
+    std::istringstream parametersStream(std::string(reinterpret_cast<const char *>(cache->mappedData + offset),
+                                                    header.parametersSize));
+    JsonReader reader(parametersStream);
+    try {
+        reader.beginObject();
+
+        std::string member;
+        while (reader.readMember(member)) {
+            if (member == "pcmAudioParameters") cache->pcmAudioParameters.read(reader);
+            else if (member == "videoParameters") cache->videoParameters.read(reader);
+            else reader.discard();
+        }
+
+        reader.endObject();
+    } catch (JsonReader::Error &error) {
+        qDebug() << "MetadataCache::open(): Parsing parameters failed:" << error.what();
+        return nullptr;
+    }
+
+    qDebug() << "MetadataCache::open(): Using cached metadata for" << cache->numberOfFields << "fields from" << cache->file.fileName();
+    return cache;
+}
+
+bool MetadataCache::write(const QString &jsonFileName,
+                          const LdDecodeMetaData::VideoParameters &videoParameters,
+                          const LdDecodeMetaData::PcmAudioParameters &pcmAudioParameters,
+                          qint32 numberOfFields,
+                          const std::function<LdDecodeMetaData::Field(qint32)> &getField)
+{
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.byteOrder = CACHE_BYTE_ORDER;
+    header.numColumns = NUM_COLUMNS;
+    header.numberOfFields = numberOfFields;
+    if (!getJsonStamp(jsonFileName, header.jsonSize, header.jsonModified, header.jsonHash)) return false;
+
+    // Serialise the parameters
+    std::ostringstream parametersStream;
+    JsonWriter writer(parametersStream);
+    writer.beginObject();
+    if (pcmAudioParameters.isValid) {
+        writer.writeMember("pcmAudioParameters");
+        pcmAudioParameters.write(writer);
+    }
+    writer.writeMember("videoParameters");
+    videoParameters.write(writer);
+    writer.endObject();
+    const std::string parameters = parametersStream.str();
+    header.parametersSize = static_cast<quint32>(parameters.size());
+
+    // Build the columns
+    ColumnBuilder columns[NUM_COLUMNS];
+    quint64 numDropOuts = 0;
+    for (qint32 fieldNumber = 0; fieldNumber < numberOfFields; fieldNumber++) {
+        const LdDecodeMetaData::Field field = getField(fieldNumber);
+
+        columns[SEQ_NO].append<qint32>(field.seqNo);
+        columns[IS_FIRST_FIELD].append<quint8>(field.isFirstField);
+        columns[SYNC_CONF].append<qint32>(field.syncConf);
+        columns[MEDIAN_BURST_IRE].append<double>(field.medianBurstIRE);
+        columns[FIELD_PHASE_ID].append<qint32>(field.fieldPhaseID);
+        columns[AUDIO_SAMPLES].append<qint32>(field.audioSamples);
+        columns[PAD].append<quint8>(field.pad);
+        columns[DISK_LOC].append<double>(field.diskLoc);
+        columns[FILE_LOC].append<qint64>(field.fileLoc);
+        columns[DECODE_FAULTS].append<qint32>(field.decodeFaults);
+        columns[EFM_T_VALUES].append<qint32>(field.efmTValues);
+
+        columns[VITS_IN_USE].append<quint8>(field.vitsMetrics.inUse);
+        columns[VITS_WSNR].append<double>(field.vitsMetrics.wSNR);
+        columns[VITS_BPSNR].append<double>(field.vitsMetrics.bPSNR);
+
+        columns[VBI_IN_USE].append<quint8>(field.vbi.inUse);
+        columns[VBI_DATA].append(field.vbi.vbiData);
+
+        columns[NTSC_IN_USE].append<quint8>(field.ntsc.inUse);
+        columns[NTSC_IS_FM_CODE_DATA_VALID].append<quint8>(field.ntsc.isFmCodeDataValid);
+        columns[NTSC_FM_CODE_DATA].append<qint32>(field.ntsc.fmCodeData);
+        columns[NTSC_FIELD_FLAG].append<quint8>(field.ntsc.fieldFlag);
+        columns[NTSC_IS_VIDEO_ID_DATA_VALID].append<quint8>(field.ntsc.isVideoIdDataValid);
+        columns[NTSC_VIDEO_ID_DATA].append<qint32>(field.ntsc.videoIdData);
+        columns[NTSC_WHITE_FLAG].append<quint8>(field.ntsc.whiteFlag);
+
+        columns[VITC_IN_USE].append<quint8>(field.vitc.inUse);
+        columns[VITC_DATA].append(field.vitc.vitcData);
+
+        columns[CC_IN_USE].append<quint8>(field.closedCaption.inUse);
+        columns[CC_DATA0].append<qint32>(field.closedCaption.data0);
+        columns[CC_DATA1].append<qint32>(field.closedCaption.data1);
+
+        // The dropout index gives the position of each field's first dropout
+        columns[DROPOUT_INDEX].append<quint64>(numDropOuts);
+        for (qint32 i = 0; i < field.dropOuts.size(); i++) {
+            columns[DROPOUT_STARTX].append<qint32>(field.dropOuts.startx(i));
+            columns[DROPOUT_ENDX].append<qint32>(field.dropOuts.endx(i));
+            columns[DROPOUT_FIELDLINE].append<qint32>(field.dropOuts.fieldLine(i));
+        }
+        numDropOuts += field.dropOuts.size();
+    }
+    columns[DROPOUT_INDEX].append<quint64>(numDropOuts);
+
+    // Set the element sizes explicitly, since columns that are empty (because
+    // there are no fields or dropouts) haven't had any entries appended
+    for (quint32 i = 0; i < NUM_COLUMNS; i++) {
+        columns[i].elementSize = getElementSize(static_cast<Column>(i));
+    }
+
+    // Lay out the file: header, column table, parameters, then the columns
+    CacheColumnEntry entries[NUM_COLUMNS];
+    qint64 offset = alignOffset(sizeof(CacheHeader) + sizeof(entries) + parameters.size());
+    for (quint32 i = 0; i < NUM_COLUMNS; i++) {
+        entries[i].id = i;
+        entries[i].elementSize = columns[i].elementSize;
+        entries[i].offset = offset;
+        entries[i].count = columns[i].data.size() / columns[i].elementSize;
+        offset = alignOffset(offset + columns[i].data.size());
+    }
+
+    // Write it out, replacing the existing cache atomically
+    QSaveFile cacheFile(getCacheFileName(jsonFileName));
+    if (!cacheFile.open(QIODevice::WriteOnly)) {
+        qDebug() << "MetadataCache::write(): Could not open" << cacheFile.fileName() << "for writing";
+        return false;
+    }
+
+    cacheFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    cacheFile.write(reinterpret_cast<const char *>(entries), sizeof(entries));
+    cacheFile.write(parameters.data(), parameters.size());
+
+    static const char padding[CACHE_ALIGNMENT] = {};
+    for (quint32 i = 0; i < NUM_COLUMNS; i++) {
+        cacheFile.write(padding, entries[i].offset - cacheFile.pos());
+        cacheFile.write(columns[i].data);
+    }
+
+    if (!cacheFile.commit()) {
+        qDebug() << "MetadataCache::write(): Writing" << cacheFile.fileName() << "failed:" << cacheFile.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+LdDecodeMetaData::Field MetadataCache::getField(qint32 fieldNumber) const
+{
+    LdDecodeMetaData::Field field;
+
+    field.seqNo = *column<qint32>(SEQ_NO, fieldNumber);
+    field.isFirstField = *column<quint8>(IS_FIRST_FIELD, fieldNumber) != 0;
+    field.syncConf = *column<qint32>(SYNC_CONF, fieldNumber);
+    field.medianBurstIRE = *column<double>(MEDIAN_BURST_IRE, fieldNumber);
+    field.fieldPhaseID = *column<qint32>(FIELD_PHASE_ID, fieldNumber);
+    field.audioSamples = *column<qint32>(AUDIO_SAMPLES, fieldNumber);
+    field.pad = *column<quint8>(PAD, fieldNumber) != 0;
+    field.diskLoc = *column<double>(DISK_LOC, fieldNumber);
+    field.fileLoc = *column<qint64>(FILE_LOC, fieldNumber);
+    field.decodeFaults = *column<qint32>(DECODE_FAULTS, fieldNumber);
+    field.efmTValues = *column<qint32>(EFM_T_VALUES, fieldNumber);
+
+    field.vitsMetrics.inUse = *column<quint8>(VITS_IN_USE, fieldNumber) != 0;
+    field.vitsMetrics.wSNR = *column<double>(VITS_WSNR, fieldNumber);
+    field.vitsMetrics.bPSNR = *column<double>(VITS_BPSNR, fieldNumber);
+
+    field.vbi.inUse = *column<quint8>(VBI_IN_USE, fieldNumber) != 0;
+    field.vbi.vbiData = *column<std::array<qint32, 3>>(VBI_DATA, fieldNumber);
+
+    field.ntsc.inUse = *column<quint8>(NTSC_IN_USE, fieldNumber) != 0;
+    field.ntsc.isFmCodeDataValid = *column<quint8>(NTSC_IS_FM_CODE_DATA_VALID, fieldNumber) != 0;
+    field.ntsc.fmCodeData = *column<qint32>(NTSC_FM_CODE_DATA, fieldNumber);
+    field.ntsc.fieldFlag = *column<quint8>(NTSC_FIELD_FLAG, fieldNumber) != 0;
+    field.ntsc.isVideoIdDataValid = *column<quint8>(NTSC_IS_VIDEO_ID_DATA_VALID, fieldNumber) != 0;
+    field.ntsc.videoIdData = *column<qint32>(NTSC_VIDEO_ID_DATA, fieldNumber);
+    field.ntsc.whiteFlag = *column<quint8>(NTSC_WHITE_FLAG, fieldNumber) != 0;
+
+    field.vitc.inUse = *column<quint8>(VITC_IN_USE, fieldNumber) != 0;
+    field.vitc.vitcData = *column<std::array<qint32, 8>>(VITC_DATA, fieldNumber);
+
+    field.closedCaption.inUse = *column<quint8>(CC_IN_USE, fieldNumber) != 0;
+    field.closedCaption.data0 = *column<qint32>(CC_DATA0, fieldNumber);
+    field.closedCaption.data1 = *column<qint32>(CC_DATA1, fieldNumber);
+
+    const quint64 firstDropOut = *column<quint64>(DROPOUT_INDEX, fieldNumber);
+    const quint64 lastDropOut = *column<quint64>(DROPOUT_INDEX, fieldNumber + 1);
+    field.dropOuts.reserve(static_cast<int>(lastDropOut - firstDropOut));
+    for (quint64 i = firstDropOut; i < lastDropOut; i++) {
+        field.dropOuts.append(*column<qint32>(DROPOUT_STARTX, i),
+                              *column<qint32>(DROPOUT_ENDX, i),
+                              *column<qint32>(DROPOUT_FIELDLINE, i));
+    }
+
+    return field;
+}
+
+quint32 MetadataCache::getElementSize(Column id)
+{
+    switch (id) {
+    case IS_FIRST_FIELD:
+    case PAD:
+    case VITS_IN_USE:
+    case VBI_IN_USE:
+    case NTSC_IN_USE:
+    case NTSC_IS_FM_CODE_DATA_VALID:
+    case NTSC_FIELD_FLAG:
+    case NTSC_IS_VIDEO_ID_DATA_VALID:
+    case NTSC_WHITE_FLAG:
+    case VITC_IN_USE:
+    case CC_IN_USE:
+        return sizeof(quint8);
+    case MEDIAN_BURST_IRE:
+    case DISK_LOC:
+    case VITS_WSNR:
+    case VITS_BPSNR:
+        return sizeof(double);
+    case FILE_LOC:
+        return sizeof(qint64);
+    case VBI_DATA:
+        return sizeof(std::array<qint32, 3>);
+    case VITC_DATA:
+        return sizeof(std::array<qint32, 8>);
+    case DROPOUT_INDEX:
+        return sizeof(quint64);
+    default:
+        return sizeof(qint32);
+    }
+}
+
+bool MetadataCache::getIsFirstField(qint32 fieldNumber) const
+{
+    return *column<quint8>(IS_FIRST_FIELD, fieldNumber) != 0;
+}
+
+qint32 MetadataCache::getAudioSamples(qint32 fieldNumber) const
+{
+    return *column<qint32>(AUDIO_SAMPLES, fieldNumber);
+}
@@ -0,0 +1,150 @@
+/************************************************************************
+
+    metadatacache.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef METADATACACHE_H
+#define METADATACACHE_H
+
+#include <QFile>
+#include <QString>
+#include <functional>
+#include <memory>
+
+#include "lddecodemetadata.h"
+
+// Binary cache of the metadata in a .tbc.json file.
+//
+// Parsing the JSON metadata for a long capture takes several seconds, so
+// LdDecodeMetaData can write a copy of it in this format alongside the JSON
+// file (with ".cache" appended to the name), if the tool has enabled this with
+// LdDecodeMetaData::setWriteCache. It reads the cache instead of the JSON file
+// whenever it's up to date. The file is memory-mapped, and each field's
+// metadata is decoded from it only when it's needed.
+//
+// The file contains a header, the video/PCM audio parameters (as JSON), and
+// a table of columns. Each column is an array with one fixed-size entry per
+// field (or, for the dropout columns, one per dropout). The header records
+// the size and modification time of the JSON file it was made from, and a
+// hash of the start and end of its contents, so the cache is ignored if the
+// JSON file has been changed by anything else.
+class MetadataCache
+{
+public:
+    // Prevent copying or assignment
+    MetadataCache(const MetadataCache &) = delete;
+    MetadataCache& operator=(const MetadataCache &) = delete;
+    ~MetadataCache();
+
+    // Return the cache filename for a JSON filename
+    static QString getCacheFileName(const QString &jsonFileName);
+
+    // Open the cache for a JSON file.
+    // Returns nullptr if there is no cache, it doesn't match the JSON file, or
+    // its columns aren't consistent with each other.
+    static std::unique_ptr<MetadataCache> open(const QString &jsonFileName);
+
+    // Write the cache for a JSON file, which must already have been written.
+    // getField is called for each field number from 0 to numberOfFields - 1.
+    static bool write(const QString &jsonFileName,
+                      const LdDecodeMetaData::VideoParameters &videoParameters,
+                      const LdDecodeMetaData::PcmAudioParameters &pcmAudioParameters,
+                      qint32 numberOfFields,
+                      const std::function<LdDecodeMetaData::Field(qint32)> &getField);
+
+    const LdDecodeMetaData::VideoParameters &getVideoParameters() const {
+        return videoParameters;
+    }
+    const LdDecodeMetaData::PcmAudioParameters &getPcmAudioParameters() const {
+        return pcmAudioParameters;
+    }
+    qint32 getNumberOfFields() const {
+        return numberOfFields;
+    }
+
+    // Decode the metadata for a field (numbered from 0)
+    LdDecodeMetaData::Field getField(qint32 fieldNumber) const;
+
+    // Get individual values for a field (numbered from 0), without decoding
+    // the rest of its metadata
+    bool getIsFirstField(qint32 fieldNumber) const;
+    qint32 getAudioSamples(qint32 fieldNumber) const;
+
+private:
+    MetadataCache() = default;
+
+    // The columns in the file
+    enum Column : quint32 {
+        SEQ_NO = 0,
+        IS_FIRST_FIELD,
+        SYNC_CONF,
+        MEDIAN_BURST_IRE,
+        FIELD_PHASE_ID,
+        AUDIO_SAMPLES,
+        PAD,
+        DISK_LOC,
+        FILE_LOC,
+        DECODE_FAULTS,
+        EFM_T_VALUES,
+        VITS_IN_USE,
+        VITS_WSNR,
+        VITS_BPSNR,
+        VBI_IN_USE,
+        VBI_DATA,
+        NTSC_IN_USE,
+        NTSC_IS_FM_CODE_DATA_VALID,
+        NTSC_FM_CODE_DATA,
+        NTSC_FIELD_FLAG,
+        NTSC_IS_VIDEO_ID_DATA_VALID,
+        NTSC_VIDEO_ID_DATA,
+        NTSC_WHITE_FLAG,
+        VITC_IN_USE,
+        VITC_DATA,
+        CC_IN_USE,
+        CC_DATA0,
+        CC_DATA1,
+        DROPOUT_INDEX,
+        DROPOUT_STARTX,
+        DROPOUT_ENDX,
+        DROPOUT_FIELDLINE,
+        NUM_COLUMNS
+    };
+
+    // Return the size of an entry in a column, as decoded by getField
+    static quint32 getElementSize(Column id);
+
+    // Return a pointer to an entry in a column
+    template <typename T>
+    const T *column(Column id, qint64 index) const {
+        return reinterpret_cast<const T *>(columns[id]) + index;
+    }
+
+    QFile file;
+    const uchar *mappedData = nullptr;
+    const uchar *columns[NUM_COLUMNS];
+
+    LdDecodeMetaData::VideoParameters videoParameters;
+    LdDecodeMetaData::PcmAudioParameters pcmAudioParameters;
+    qint32 numberOfFields = 0;
+};
+
+#endif // METADATACACHE_H
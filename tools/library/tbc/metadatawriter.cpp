@@ -0,0 +1,134 @@
+/************************************************************************
+
+    metadatawriter.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "metadatawriter.h"
+
+#include "jsonio.h"
+
+#include <QFile>
+#include <sstream>
+
+MetadataWriter::MetadataWriter()
+    : metaData(nullptr), numberOfFields(0)
+{
+}
+
+MetadataWriter::~MetadataWriter()
+{
+    // If close wasn't called, leave the partial file behind
+    if (writer) jsonFile.close();
+}
+
+QString MetadataWriter::getPartialFileName(const QString &fileName)
+{
+    return fileName + ".partial";
+}
+
+bool MetadataWriter::open(const QString &_fileName, const LdDecodeMetaData &_metaData)
+{
+    fileName = _fileName;
+    metaData = &_metaData;
+    numberOfFields = 0;
+
+    // Binary mode, so positions in the file can be used to seek back
+    jsonFile.open(getPartialFileName(fileName).toStdString(), std::ios::out | std::ios::trunc | std::ios::binary);
+    if (jsonFile.fail()) {
+        qCritical("Opening JSON output file failed");
+        return false;
+    }
+
+    writer.reset(new JsonWriter(jsonFile));
+
+    // Keep members in alphabetical order, as LdDecodeMetaData::write does.
+    // The fields come first, so they can be written before the parameters.
+    writer->beginObject();
+    writer->writeMember("fields");
+    writer->beginArray();
+
+    return writeTail();
+}
+
+bool MetadataWriter::writeField(const LdDecodeMetaData::Field &field)
+{
+    // Overwrite the old end of the file with the field
+    jsonFile.seekp(tailPosition);
+    writer->writeElement();
+    field.write(*writer);
+    numberOfFields++;
+
+    if (!writeTail()) {
+        qCritical() << "MetadataWriter::writeField(): Writing to the JSON output file failed";
+        return false;
+    }
+
+    return true;
+}
+
+// Write the end of the file after the fields written so far, and flush it
+bool MetadataWriter::writeTail()
+{
+    tailPosition = jsonFile.tellp();
+
+    // The parameters are written by a separate writer, since writer must stay
+    // inside the fields array. This gives an object containing them, whose
+    // opening brace is replaced by the end of the fields array.
+    std::ostringstream parametersStream;
+    JsonWriter parametersWriter(parametersStream);
+    parametersWriter.beginObject();
+    metaData->writeParameters(parametersWriter, numberOfFields);
+    parametersWriter.endObject();
+    const std::string parameters = parametersStream.str();
+
+    jsonFile << "]," << parameters.substr(1);
+
+    // The file never gets shorter, since each field is followed by a tail at
+    // least as long as the one it replaced, so it doesn't need truncating
+    jsonFile.flush();
+    return !jsonFile.fail();
+}
+
+bool MetadataWriter::close()
+{
+    // The file is already complete
+    writer.reset();
+
+    jsonFile.close();
+    if (jsonFile.fail()) {
+        qCritical("Writing JSON output file failed");
+        return false;
+    }
+
+    // Replace the output file with the finished one
+    const QString partialFileName = getPartialFileName(fileName);
+    if (QFile::exists(fileName) && !QFile::remove(fileName)) {
+        qCritical() << "Could not replace existing JSON file" << fileName;
+        return false;
+    }
+    if (!QFile::rename(partialFileName, fileName)) {
+        qCritical() << "Could not rename" << partialFileName << "to" << fileName;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,90 @@
+/************************************************************************
+
+    metadatawriter.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef METADATAWRITER_H
+#define METADATAWRITER_H
+
+#include <QString>
+#include <fstream>
+#include <memory>
+
+#include "lddecodemetadata.h"
+
+class JsonWriter;
+
+// Write JSON metadata incrementally, one field at a time.
+//
+// This produces the same format as LdDecodeMetaData::write, so tools that
+// process fields in order can write each one out once it's finished rather
+// than keeping them all until the end.
+//
+// Output goes to a file with ".partial" appended to the name, which is renamed
+// to the real name by close(). After each field, the end of the file (closing
+// the fields array, followed by the parameters) is rewritten with
+// numberOfSequentialFields set to the number of fields written so far, and the
+// file is flushed. If a run is interrupted, the partial file is a valid JSON
+// metadata file containing every field that was completed, unless it was
+// interrupted partway through writing a field.
+class MetadataWriter
+{
+public:
+    MetadataWriter();
+    ~MetadataWriter();
+
+    // Prevent copying or assignment
+    MetadataWriter(const MetadataWriter &) = delete;
+    MetadataWriter& operator=(const MetadataWriter &) = delete;
+
+    // Start writing a JSON file, with the parameters from metaData, which
+    // must remain valid until close() is called.
+    bool open(const QString &fileName, const LdDecodeMetaData &metaData);
+
+    // Append the next field
+    bool writeField(const LdDecodeMetaData::Field &field);
+
+    // Finish the file, and rename it into place
+    bool close();
+
+    // Return the number of fields written so far
+    qint32 getNumberOfFields() const {
+        return numberOfFields;
+    }
+
+    static QString getPartialFileName(const QString &fileName);
+
+private:
+    QString fileName;
+    const LdDecodeMetaData *metaData;
+    std::ofstream jsonFile;
+    std::unique_ptr<JsonWriter> writer;
+    qint32 numberOfFields;
+
+    // The position in jsonFile where the end of the file starts, which is
+    // where the next field will be written
+    std::streampos tailPosition;
+
+    bool writeTail();
+};
+
+#endif // METADATAWRITER_H
@@ -26,6 +26,11 @@
 
 #include <cstdio>
 
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <unistd.h>
+#endif
+
 // Class constructor
 SourceVideo::SourceVideo()
 {
@@ -36,6 +41,7 @@ SourceVideo::SourceVideo()
     fieldLength = -1;
     fieldByteLength = -1;
     fieldLineLength = -1;
+    mappedData = nullptr;
 
     // Set up the cache
     fieldCache.setMaxCost(100);
@@ -43,12 +49,14 @@ SourceVideo::SourceVideo()
 
 SourceVideo::~SourceVideo()
 {
-    if (isSourceVideoOpen) inputFile.close();
+    if (isSourceVideoOpen) close();
 }
 
 // Source Video file manipulation methods -----------------------------------------------------------------------------
 
 // Open an input video data file. If filename is "-", read from stdin.
+// If filename is a TBC patch file, open the TBC file it refers to and apply
+// the patch to the fields as they're read.
 // Returns true on success.
 bool SourceVideo::open(QString filename, qint32 _fieldLength, qint32 _fieldLineLength)
 {
@@ -65,6 +73,20 @@ bool SourceVideo::open(QString filename, qint32 _fieldLength, qint32 _fieldLineL
         return false;
     }
 
+    // Is this a patch file?
+    patch.clear();
+    if (filename != "-" && TbcPatch::isPatchFile(filename)) {
+        if (!patch.open(filename, fieldLength)) return false;
+
+        filename = patch.getBaseFilename();
+        if (TbcPatch::isPatchFile(filename)) {
+            qWarning() << "TBC patch file refers to another patch file" << filename << "- this isn't supported";
+            patch.clear();
+            return false;
+        }
+        qDebug() << "SourceVideo::open(): Applying" << patch.getNumberOfRuns() << "patch runs to" << filename;
+    }
+
     // Open the source video file
     inputFile.setFileName(filename);
     if (filename == "-") {
@@ -87,6 +109,18 @@ bool SourceVideo::open(QString filename, qint32 _fieldLength, qint32 _fieldLineL
         qint64 tAvailableFields = (inputFile.size() / fieldByteLength);
         availableFields = static_cast<qint32>(tAvailableFields);
         qDebug() << "SourceVideo::open(): Successful -" << availableFields << "fields available";
+
+        // Try to map the file into memory, so fields can be read without
+        // copying. If this fails (e.g. a large file on a 32-bit system), fall
+        // back to reading through QFile.
+        if (inputFile.size() > 0) {
+            mappedData = reinterpret_cast<const quint16 *>(inputFile.map(0, inputFile.size()));
+            if (mappedData == nullptr) {
+                qDebug() << "SourceVideo::open(): Could not memory-map input file, falling back to buffered reads";
+            } else {
+                qDebug() << "SourceVideo::open(): Input file is memory-mapped";
+            }
+        }
     }
 
     // Initialise cache
@@ -107,7 +141,12 @@ void SourceVideo::close()
     }
 
     qDebug() << "SourceVideo::close(): Called, closing the source video file and emptying the frame cache";
+    if (mappedData != nullptr) {
+        inputFile.unmap(reinterpret_cast<uchar *>(const_cast<quint16 *>(mappedData)));
+        mappedData = nullptr;
+    }
     inputFile.close();
+    patch.clear();
     isSourceVideoOpen = false;
     inputFilePos = -1;
 
@@ -133,11 +172,110 @@ qint32 SourceVideo::getFieldLength()
     return fieldLength;
 }
 
+// Returns true if the source video file is memory-mapped (and not patched), in
+// which case views returned by getVideoFieldView remain valid until the file
+// is closed
+bool SourceVideo::isMemoryMapped()
+{
+    return mappedData != nullptr && patch.isEmpty();
+}
+
 // Frame data retrieval methods ---------------------------------------------------------------------------------------
 
 // Method to retrieve a range of field lines from a single video field.
 // If startFieldLine and endFieldLine are both -1, read the whole field.
 SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine)
+{
+    // If the input is memory-mapped, copy directly from the mapping. Data
+    // owns its samples (and callers may modify them), so this can't avoid the
+    // copy -- callers that only read the field should use getVideoFieldView.
+    // Caching the copy wouldn't save any I/O, since the mapping is already
+    // backed by the OS page cache.
+    if (mappedData != nullptr) {
+        return getVideoFieldView(fieldNumber, startFieldLine, endFieldLine).toData();
+    }
+
+    const bool wholeField = (startFieldLine == -1 && endFieldLine == -1);
+
+    // Check the cache (we only cache whole fields)
+    if (wholeField && fieldCache.contains(fieldNumber - 1)) {
+        return *fieldCache.object(fieldNumber - 1);
+    }
+
+    qint64 requiredStartPosition, requiredReadLength;
+    getFieldRange(fieldNumber, startFieldLine, endFieldLine, requiredStartPosition, requiredReadLength);
+    readFieldRange(requiredStartPosition, requiredReadLength, outputFieldData);
+    applyPatch(fieldNumber, requiredStartPosition, outputFieldData);
+
+    if (wholeField) {
+        // Insert the field data into the cache
+        fieldCache.insert(fieldNumber - 1, new Data(outputFieldData), 1);
+    }
+
+    // Return the data
+    return outputFieldData;
+}
+
+// Method to retrieve a read-only view of a range of field lines from a single
+// video field, without copying the data if the input is memory-mapped.
+// If startFieldLine and endFieldLine are both -1, return the whole field.
+//
+// If the input is memory-mapped and not patched, this method does not modify
+// any state and may be called from multiple threads at once.
+SourceVideo::View SourceVideo::getVideoFieldView(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine)
+{
+    qint64 requiredStartPosition, requiredReadLength;
+    getFieldRange(fieldNumber, startFieldLine, endFieldLine, requiredStartPosition, requiredReadLength);
+
+    if (mappedData != nullptr) {
+        const quint16 *source = mappedData + (requiredStartPosition / 2);
+        const qint32 length = static_cast<qint32>(requiredReadLength / 2);
+
+        // Point directly into the mapping, unless the field needs patching
+        if (!patch.isFieldPatched(fieldNumber)) return View(source, length);
+
+        outputFieldData.resize(length);
+        std::copy(source, source + length, outputFieldData.begin());
+    } else {
+        // Read into the internal buffer
+        readFieldRange(requiredStartPosition, requiredReadLength, outputFieldData);
+    }
+
+    applyPatch(fieldNumber, requiredStartPosition, outputFieldData);
+    return View(outputFieldData.constData(), outputFieldData.size());
+}
+
+// Method to read a range of field lines from a single video field into
+// fieldData, reusing its allocation where possible.
+// If startFieldLine and endFieldLine are both -1, read the whole field.
+//
+// Unlike getVideoField, this does not use the field cache or the shared file
+// position, so it may be called from multiple threads at once (but not at the
+// same time as getVideoField or getVideoFieldView). Reads are
+// copied from the mapping if the input is memory-mapped, or made with
+// positional reads if the platform supports them; otherwise (e.g. when
+// reading from stdin) they are serialised internally.
+void SourceVideo::readVideoField(qint32 fieldNumber, Data &fieldData, qint32 startFieldLine, qint32 endFieldLine)
+{
+    qint64 requiredStartPosition, requiredReadLength;
+    getFieldRange(fieldNumber, startFieldLine, endFieldLine, requiredStartPosition, requiredReadLength);
+
+    if (mappedData != nullptr) {
+        // Copy directly from the mapping
+        const quint16 *source = mappedData + (requiredStartPosition / 2);
+        fieldData.resize(static_cast<qint32>(requiredReadLength / 2));
+        std::copy(source, source + fieldData.size(), fieldData.begin());
+    } else if (!readFieldRangePositional(requiredStartPosition, requiredReadLength, fieldData)) {
+        QMutexLocker locker(&readMutex);
+        readFieldRange(requiredStartPosition, requiredReadLength, fieldData);
+    }
+
+    applyPatch(fieldNumber, requiredStartPosition, fieldData);
+}
+
+// Compute and validate the byte position and length of a range of field lines
+void SourceVideo::getFieldRange(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine,
+                                qint64 &requiredStartPosition, qint64 &requiredReadLength) const
 {
     // Adjust the field number to index from zero
     fieldNumber--;
@@ -146,17 +284,10 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
     if (!isSourceVideoOpen) qFatal("Application requested TBC field before opening TBC file - Fatal error");
 
     // Calculate the position of the require field line data
-    qint64 requiredStartPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
-    qint64 requiredReadLength;
+    requiredStartPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
 
     if (startFieldLine == -1 && endFieldLine == -1) {
         // Read the whole field
-
-        // Check the cache (we only cache whole fields)
-        if (fieldCache.contains(fieldNumber)) {
-            return *fieldCache.object(fieldNumber);
-        }
-
         requiredReadLength = static_cast<qint64>(fieldByteLength);
     } else {
         // Read a range of lines
@@ -179,9 +310,22 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
             || requiredStartPosition + requiredReadLength > (static_cast<qint64>(fieldByteLength) * availableFields))) {
         qFatal("Application requested field line range that exceeds the boundaries of the input TBC file");
     }
+}
+
+// Apply the patch (if any) to data read from requiredStartPosition in a field
+void SourceVideo::applyPatch(qint32 fieldNumber, qint64 requiredStartPosition, Data &fieldData) const
+{
+    if (!patch.isFieldPatched(fieldNumber)) return;
+
+    const qint64 fieldStartPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber - 1);
+    patch.apply(fieldNumber, static_cast<qint32>((requiredStartPosition - fieldStartPosition) / 2), fieldData);
+}
 
+// Read a range of bytes from the input file into fieldData
+void SourceVideo::readFieldRange(qint64 requiredStartPosition, qint64 requiredReadLength, Data &fieldData)
+{
     // Resize the output buffer
-    outputFieldData.resize(static_cast<qint32>(requiredReadLength) / 2);
+    fieldData.resize(static_cast<qint32>(requiredReadLength) / 2);
 
     // Seek to the correct file position (if not already there)
     if (inputFilePos != requiredStartPosition) {
@@ -194,8 +338,8 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
                 // Seeking forwards -- try reading and discarding data instead
                 qint64 discardBytes = requiredStartPosition - inputFilePos;
                 while (discardBytes > 0) {
-                    qint64 readBytes = inputFile.read(reinterpret_cast<char *>(outputFieldData.data()),
-                                                      qMin(discardBytes, static_cast<qint64>(outputFieldData.size() * 2)));
+                    qint64 readBytes = inputFile.read(reinterpret_cast<char *>(fieldData.data()),
+                                                      qMin(discardBytes, static_cast<qint64>(fieldData.size() * 2)));
                     if (readBytes <= 0) {
                         qFatal("Could not seek or read forwards to required field position in input TBC file");
                     }
@@ -210,7 +354,7 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
     qint64 totalReceivedBytes = 0;
     qint64 receivedBytes = 0;
     do {
-        receivedBytes = inputFile.read(reinterpret_cast<char *>(outputFieldData.data()) + totalReceivedBytes,
+        receivedBytes = inputFile.read(reinterpret_cast<char *>(fieldData.data()) + totalReceivedBytes,
                                        requiredReadLength - totalReceivedBytes);
         if (receivedBytes > 0) {
             totalReceivedBytes += receivedBytes;
@@ -220,25 +364,37 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
 
     // Verify read was ok
     if (totalReceivedBytes != requiredReadLength) qFatal("Could not read field data from input TBC file");
-
-    if (startFieldLine == -1 && endFieldLine == -1) {
-        // Insert the field data into the cache
-        fieldCache.insert(fieldNumber, new Data(outputFieldData), 1);
-    }
-
-    // Return the data
-    return outputFieldData;
 }
 
+// Read a range of bytes from the input file into fieldData with positional
+// reads, which don't use or change the file position.
+// Returns false if positional reads aren't possible for this input.
+bool SourceVideo::readFieldRangePositional(qint64 requiredStartPosition, qint64 requiredReadLength, Data &fieldData) const
+{
+#ifdef Q_OS_UNIX
+    // Positional reads need a seekable file
+    if (availableFields == -1) return false;
+    const int fd = inputFile.handle();
+    if (fd == -1) return false;
 
+    fieldData.resize(static_cast<qint32>(requiredReadLength) / 2);
 
+    char *buffer = reinterpret_cast<char *>(fieldData.data());
+    qint64 totalReceivedBytes = 0;
+    while (totalReceivedBytes < requiredReadLength) {
+        const ssize_t receivedBytes = pread(fd, buffer + totalReceivedBytes,
+                                            static_cast<size_t>(requiredReadLength - totalReceivedBytes),
+                                            static_cast<off_t>(requiredStartPosition + totalReceivedBytes));
+        if (receivedBytes < 0 && errno == EINTR) continue;
+        if (receivedBytes <= 0) qFatal("Could not read field data from input TBC file");
+        totalReceivedBytes += receivedBytes;
+    }
 
-
-
-
-
-
-
-
-
-
+    return true;
+#else
+    Q_UNUSED(requiredStartPosition);
+    Q_UNUSED(requiredReadLength);
+    Q_UNUSED(fieldData);
+    return false;
+#endif
+}
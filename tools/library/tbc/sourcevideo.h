@@ -28,8 +28,13 @@
 #include <QFile>
 #include <QCache>
 #include <QDebug>
+#include <QMutex>
 #include <QVector>
 
+#include <algorithm>
+
+#include "tbcpatch.h"
+
 class SourceVideo
 {
 public:
@@ -39,6 +44,40 @@ public:
     // yourself).
     using Data = QVector<quint16>;
 
+    // A read-only view of timebase-corrected video samples, as returned by
+    // getVideoFieldView. If isMemoryMapped is true, this points directly into
+    // the mapped file and remains valid until the source is closed; otherwise
+    // it points into an internal buffer and is only valid until the next call
+    // to getVideoField or getVideoFieldView.
+    class View
+    {
+    public:
+        View() : viewData(nullptr), viewSize(0) {}
+        View(const quint16 *_viewData, qint32 _viewSize) : viewData(_viewData), viewSize(_viewSize) {}
+
+        const quint16 *data() const { return viewData; }
+        qint32 size() const { return viewSize; }
+        bool isEmpty() const { return viewSize == 0; }
+
+        const quint16 &operator[](qint32 i) const { return viewData[i]; }
+        const quint16 *begin() const { return viewData; }
+        const quint16 *end() const { return viewData + viewSize; }
+
+        // Return a view of part of this view
+        View mid(qint32 position, qint32 length) const { return View(viewData + position, length); }
+
+        // Copy the samples into a new Data vector
+        Data toData() const {
+            Data copy(viewSize);
+            std::copy(begin(), end(), copy.begin());
+            return copy;
+        }
+
+    private:
+        const quint16 *viewData;
+        qint32 viewSize;
+    };
+
     SourceVideo();
     ~SourceVideo();
 
@@ -52,11 +91,14 @@ public:
 
     // Field handling methods
     Data getVideoField(qint32 fieldNumber, qint32 startFieldLine = -1, qint32 endFieldLine = -1);
+    View getVideoFieldView(qint32 fieldNumber, qint32 startFieldLine = -1, qint32 endFieldLine = -1);
+    void readVideoField(qint32 fieldNumber, Data &fieldData, qint32 startFieldLine = -1, qint32 endFieldLine = -1);
 
     // Get and set methods
     bool isSourceValid();
     qint32 getNumberOfAvailableFields();
     qint32 getFieldLength();
+    bool isMemoryMapped();
 
 private:
     // File handling globals
@@ -68,10 +110,26 @@ private:
     qint32 fieldByteLength;
     qint32 fieldLineLength;
 
+    // Memory-mapped input (nullptr if the input isn't mapped)
+    const quint16 *mappedData;
+
+    // Replacement samples, if a patch file was opened
+    TbcPatch patch;
+
     Data outputFieldData;
 
+    // Guards inputFile and inputFilePos for readVideoField, when the input
+    // can't be read positionally
+    QMutex readMutex;
+
     // Field caching
     QCache<qint32, Data> fieldCache;
+
+    void getFieldRange(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine,
+                       qint64 &requiredStartPosition, qint64 &requiredReadLength) const;
+    void readFieldRange(qint64 requiredStartPosition, qint64 requiredReadLength, Data &fieldData);
+    bool readFieldRangePositional(qint64 requiredStartPosition, qint64 requiredReadLength, Data &fieldData) const;
+    void applyPatch(qint32 fieldNumber, qint64 requiredStartPosition, Data &fieldData) const;
 };
 
 #endif // SOURCEVIDEO_H
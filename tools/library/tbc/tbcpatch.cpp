@@ -0,0 +1,159 @@
+/************************************************************************
+
+    tbcpatch.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "tbcpatch.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cstring>
+
+const char TbcPatch::MAGIC[8] = { 'T', 'B', 'C', 'P', 'A', 'T', 'C', 'H' };
+
+bool TbcPatch::isPatchFile(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    char magic[sizeof(MAGIC)];
+    if (file.read(magic, sizeof(magic)) != sizeof(magic)) return false;
+    return memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool TbcPatch::open(const QString &filename, qint32 fieldLength)
+{
+    clear();
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open" << filename << "as TBC patch file";
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    // Read and check the header
+    char magic[sizeof(MAGIC)];
+    quint32 version, patchFieldLength, patchFieldWidth, baseFilenameLength;
+    if (stream.readRawData(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        qWarning() << filename << "is not a TBC patch file";
+        return false;
+    }
+    stream >> version >> patchFieldLength >> patchFieldWidth >> baseFilenameLength;
+    if (stream.status() != QDataStream::Ok || version != VERSION) {
+        qWarning() << "TBC patch file" << filename << "has an unsupported format version";
+        return false;
+    }
+    if (static_cast<qint32>(patchFieldLength) != fieldLength || patchFieldWidth == 0) {
+        qWarning() << "TBC patch file" << filename << "has a field length of" << patchFieldLength
+                   << "but the metadata specifies" << fieldLength;
+        return false;
+    }
+
+    QByteArray baseFilenameBytes(static_cast<qint32>(baseFilenameLength), '\0');
+    if (stream.readRawData(baseFilenameBytes.data(), baseFilenameBytes.size()) != baseFilenameBytes.size()) {
+        qWarning() << "TBC patch file" << filename << "is truncated";
+        return false;
+    }
+    baseFilename = QFileInfo(filename).absoluteDir().filePath(QString::fromUtf8(baseFilenameBytes));
+
+    // Read the records, merging them into a list of runs for each field
+    while (!stream.atEnd()) {
+        quint32 fieldNumber, fieldLine, startx, count;
+        stream >> fieldNumber >> fieldLine >> startx >> count;
+
+        const qint64 offset = (static_cast<qint64>(fieldLine) - 1) * patchFieldWidth + startx;
+        if (stream.status() != QDataStream::Ok || fieldNumber < 1 || fieldLine < 1 || startx >= patchFieldWidth
+            || offset + count > patchFieldLength) {
+            qWarning() << "TBC patch file" << filename << "contains an invalid record";
+            clear();
+            return false;
+        }
+
+        Run run;
+        run.offset = static_cast<qint32>(offset);
+        run.samples.resize(static_cast<qint32>(count));
+        for (quint16 &sample : run.samples) stream >> sample;
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "TBC patch file" << filename << "is truncated";
+            clear();
+            return false;
+        }
+
+        fieldRuns[static_cast<qint32>(fieldNumber)].append(run);
+        numberOfRuns++;
+    }
+
+    qDebug() << "TbcPatch::open(): Read" << numberOfRuns << "runs for" << fieldRuns.size() << "fields, applying to" << baseFilename;
+    return true;
+}
+
+void TbcPatch::clear()
+{
+    baseFilename.clear();
+    fieldRuns.clear();
+    numberOfRuns = 0;
+}
+
+QString TbcPatch::getBaseFilename() const
+{
+    return baseFilename;
+}
+
+bool TbcPatch::isEmpty() const
+{
+    return fieldRuns.isEmpty();
+}
+
+bool TbcPatch::isFieldPatched(qint32 fieldNumber) const
+{
+    return fieldRuns.contains(fieldNumber);
+}
+
+qint32 TbcPatch::getNumberOfRuns() const
+{
+    return numberOfRuns;
+}
+
+void TbcPatch::apply(qint32 fieldNumber, qint32 firstSample, QVector<quint16> &fieldData) const
+{
+    const auto it = fieldRuns.constFind(fieldNumber);
+    if (it == fieldRuns.constEnd()) return;
+
+    const qint32 endSample = firstSample + fieldData.size();
+    for (const Run &run : it.value()) {
+        // Copy the part of the run that overlaps fieldData
+        const qint32 start = std::max(run.offset, firstSample);
+        const qint32 end = std::min(run.offset + run.samples.size(), endSample);
+        if (start >= end) continue;
+
+        std::copy(run.samples.constBegin() + (start - run.offset), run.samples.constBegin() + (end - run.offset),
+                  fieldData.begin() + (start - firstSample));
+    }
+}
@@ -0,0 +1,93 @@
+/************************************************************************
+
+    tbcpatch.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef TBCPATCH_H
+#define TBCPATCH_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// A set of replacement samples for a TBC file.
+//
+// Tools that only change a small part of the video (such as
+// ld-dropout-correct) can write a patch file rather than a complete copy of
+// the TBC file. SourceVideo recognises a patch file when it is opened, and
+// reads the TBC file it refers to with the replacement samples applied.
+//
+// A patch file is little-endian, and starts with a header:
+//   char[8]    magic ("TBCPATCH")
+//   quint32    format version (1)
+//   quint32    number of samples per field
+//   quint32    number of samples per line
+//   quint32    length of the base filename in bytes
+//   char[]     base TBC filename, in UTF-8 (a relative path is relative to
+//              the directory containing the patch file)
+// This is followed by any number of records, in increasing field order:
+//   quint32    field number (from 1)
+//   quint32    field line (from 1)
+//   quint32    first sample within the line (from 0)
+//   quint32    number of samples
+//   quint16[]  replacement samples
+class TbcPatch
+{
+public:
+    TbcPatch() = default;
+
+    // Returns true if filename starts with the patch file magic
+    static bool isPatchFile(const QString &filename);
+
+    // Read a patch file for a TBC with fieldLength samples per field.
+    // Returns true on success.
+    bool open(const QString &filename, qint32 fieldLength);
+    void clear();
+
+    // Get the path of the TBC file the patch applies to
+    QString getBaseFilename() const;
+
+    bool isEmpty() const;
+    bool isFieldPatched(qint32 fieldNumber) const;
+    qint32 getNumberOfRuns() const;
+
+    // Apply the patch to part of a field. fieldData contains the field's
+    // samples starting from firstSample.
+    void apply(qint32 fieldNumber, qint32 firstSample, QVector<quint16> &fieldData) const;
+
+    static const char MAGIC[8];
+    static constexpr quint32 VERSION = 1;
+    static constexpr qint32 RECORD_HEADER_BYTES = 16;
+
+private:
+    // A run of replacement samples, starting at offset within the field
+    struct Run {
+        qint32 offset;
+        QVector<quint16> samples;
+    };
+
+    QString baseFilename;
+    QHash<qint32, QVector<Run>> fieldRuns;
+    qint32 numberOfRuns = 0;
+};
+
+#endif // TBCPATCH_H
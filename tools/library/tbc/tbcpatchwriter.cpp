@@ -0,0 +1,118 @@
+/************************************************************************
+
+    tbcpatchwriter.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "tbcpatchwriter.h"
+
+#include "tbcpatch.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+TbcPatchWriter::TbcPatchWriter()
+    : fieldLength(0), fieldWidth(0), numberOfRuns(0), numberOfSamples(0)
+{
+}
+
+bool TbcPatchWriter::open(QIODevice *device, const QString &patchFilename, const QString &baseFilename,
+                          qint32 _fieldLength, qint32 _fieldWidth)
+{
+    fieldLength = _fieldLength;
+    fieldWidth = _fieldWidth;
+    numberOfRuns = 0;
+    numberOfSamples = 0;
+
+    QString storedFilename = QFileInfo(baseFilename).absoluteFilePath();
+    if (patchFilename != "-") {
+        storedFilename = QFileInfo(patchFilename).absoluteDir().relativeFilePath(storedFilename);
+    }
+    const QByteArray storedFilenameBytes = storedFilename.toUtf8();
+
+    stream.setDevice(device);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream.writeRawData(TbcPatch::MAGIC, sizeof(TbcPatch::MAGIC));
+    stream << TbcPatch::VERSION << static_cast<quint32>(fieldLength) << static_cast<quint32>(fieldWidth)
+           << static_cast<quint32>(storedFilenameBytes.size());
+    stream.writeRawData(storedFilenameBytes.constData(), storedFilenameBytes.size());
+
+    return stream.status() == QDataStream::Ok;
+}
+
+bool TbcPatchWriter::writeField(qint32 fieldNumber, const QVector<quint16> &originalData, const QVector<quint16> &correctedData)
+{
+    // Unchanged samples shorter than a record header are cheaper to include
+    // in the surrounding run than to start a new record for
+    const qint32 mergeGap = TbcPatch::RECORD_HEADER_BYTES / 2;
+
+    const qint32 length = qMin(qMin(originalData.size(), correctedData.size()), fieldLength);
+    const quint16 *original = originalData.constData();
+    const quint16 *corrected = correctedData.constData();
+
+    for (qint32 lineStart = 0; lineStart < length; lineStart += fieldWidth) {
+        const qint32 lineEnd = qMin(lineStart + fieldWidth, length);
+
+        qint32 runStart = -1;
+        qint32 runEnd = -1;
+        for (qint32 i = lineStart; i < lineEnd; i++) {
+            if (original[i] == corrected[i]) continue;
+
+            if (runStart != -1 && i - runEnd >= mergeGap) {
+                // Too far from the current run - write it and start another
+                if (!writeRun(fieldNumber, (lineStart / fieldWidth) + 1, runStart - lineStart, corrected + runStart, runEnd - runStart)) return false;
+                runStart = -1;
+            }
+            if (runStart == -1) runStart = i;
+            runEnd = i + 1;
+        }
+
+        if (runStart != -1) {
+            if (!writeRun(fieldNumber, (lineStart / fieldWidth) + 1, runStart - lineStart, corrected + runStart, runEnd - runStart)) return false;
+        }
+    }
+
+    return true;
+}
+
+bool TbcPatchWriter::writeRun(qint32 fieldNumber, qint32 fieldLine, qint32 startx, const quint16 *samples, qint32 count)
+{
+    stream << static_cast<quint32>(fieldNumber) << static_cast<quint32>(fieldLine)
+           << static_cast<quint32>(startx) << static_cast<quint32>(count);
+    for (qint32 i = 0; i < count; i++) stream << samples[i];
+
+    numberOfRuns++;
+    numberOfSamples += count;
+
+    return stream.status() == QDataStream::Ok;
+}
+
+qint32 TbcPatchWriter::getNumberOfRuns() const
+{
+    return numberOfRuns;
+}
+
+qint64 TbcPatchWriter::getNumberOfSamples() const
+{
+    return numberOfSamples;
+}
@@ -0,0 +1,68 @@
+/************************************************************************
+
+    tbcpatchwriter.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef TBCPATCHWRITER_H
+#define TBCPATCHWRITER_H
+
+#include <QDataStream>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+
+// Write a TBC patch file (see tbcpatch.h), one field at a time.
+class TbcPatchWriter
+{
+public:
+    TbcPatchWriter();
+
+    // Prevent copying or assignment
+    TbcPatchWriter(const TbcPatchWriter &) = delete;
+    TbcPatchWriter& operator=(const TbcPatchWriter &) = delete;
+
+    // Start writing a patch for baseFilename to device, which must already be
+    // open. The base filename is stored relative to patchFilename's directory,
+    // or as an absolute path if patchFilename is "-".
+    bool open(QIODevice *device, const QString &patchFilename, const QString &baseFilename,
+              qint32 fieldLength, qint32 fieldWidth);
+
+    // Write records for the samples that differ between a field's original and
+    // corrected data. Fields must be written in increasing order.
+    bool writeField(qint32 fieldNumber, const QVector<quint16> &originalData, const QVector<quint16> &correctedData);
+
+    // Statistics
+    qint32 getNumberOfRuns() const;
+    qint64 getNumberOfSamples() const;
+
+private:
+    QDataStream stream;
+    qint32 fieldLength;
+    qint32 fieldWidth;
+
+    qint32 numberOfRuns;
+    qint64 numberOfSamples;
+
+    bool writeRun(qint32 fieldNumber, qint32 fieldLine, qint32 startx, const quint16 *samples, qint32 count);
+};
+
+#endif // TBCPATCHWRITER_H
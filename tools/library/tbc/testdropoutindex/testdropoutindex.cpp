@@ -0,0 +1,112 @@
+/************************************************************************
+
+    testdropoutindex.cpp
+
+    Unit tests for DropOutIndex
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+
+#include "dropoutindex.h"
+#include "dropouts.h"
+
+// Check whether (x, fieldLine) is in a dropout by scanning the whole list
+static bool scanContains(const DropOuts &dropOuts, qint32 x, qint32 fieldLine)
+{
+    for (qint32 i = 0; i < dropOuts.size(); i++) {
+        if (dropOuts.fieldLine(i) == fieldLine && x >= dropOuts.startx(i) && x <= dropOuts.endx(i)) return true;
+    }
+    return false;
+}
+
+// Check whether [startx, endx] overlaps a dropout by scanning the whole list
+static bool scanOverlaps(const DropOuts &dropOuts, qint32 startx, qint32 endx, qint32 fieldLine)
+{
+    for (qint32 i = 0; i < dropOuts.size(); i++) {
+        if (dropOuts.fieldLine(i) == fieldLine && endx >= dropOuts.startx(i) && dropOuts.endx(i) >= startx) return true;
+    }
+    return false;
+}
+
+// Compare the index against a linear scan for a set of dropouts
+static void testDropOuts(const DropOuts &dropOuts, qint32 width, qint32 height)
+{
+    const DropOutIndex index(dropOuts);
+    assert(index.empty() == dropOuts.empty());
+
+    // Lines outside the field, including ones beyond the last dropout
+    for (qint32 fieldLine = 0; fieldLine <= height + 2; fieldLine++) {
+        DropOutIndex::Cursor cursor(index, fieldLine);
+
+        for (qint32 x = -1; x <= width; x++) {
+            const bool expected = scanContains(dropOuts, x, fieldLine);
+            assert(index.contains(x, fieldLine) == expected);
+            assert(cursor.contains(x) == expected);
+            assert(index.overlaps(x, x + 3, fieldLine) == scanOverlaps(dropOuts, x, x + 3, fieldLine));
+        }
+
+        // Check the intervals are sorted and don't overlap
+        const DropOutIndex::Line line = index.getLine(fieldLine);
+        qint32 lastEndx = -1;
+        for (const DropOutIndex::Interval &interval : line) {
+            assert(interval.startx > lastEndx);
+            assert(interval.endx >= interval.startx);
+            lastEndx = interval.endx;
+        }
+    }
+}
+
+int main()
+{
+    // No dropouts
+    printf("Testing empty DropOuts\n");
+    testDropOuts(DropOuts(), 50, 10);
+
+    // Overlapping, adjacent and out-of-order dropouts, including line 0
+    printf("Testing overlapping DropOuts\n");
+    DropOuts dropOuts;
+    dropOuts.append(10, 20, 3);
+    dropOuts.append(15, 25, 3);
+    dropOuts.append(5, 8, 3);
+    dropOuts.append(26, 26, 3);
+    dropOuts.append(0, 0, 0);
+    dropOuts.append(40, 49, 7);
+    dropOuts.append(12, 14, 3);
+    testDropOuts(dropOuts, 50, 10);
+
+    // Random dropouts
+    printf("Testing random DropOuts\n");
+    std::mt19937 rng(42);
+    for (qint32 trial = 0; trial < 20; trial++) {
+        DropOuts randomDropOuts;
+        const qint32 count = rng() % 60;
+        for (qint32 i = 0; i < count; i++) {
+            const qint32 startx = rng() % 100;
+            const qint32 length = rng() % 10;
+            randomDropOuts.append(startx, startx + length, 1 + (rng() % 12));
+        }
+        testDropOuts(randomDropOuts, 110, 12);
+    }
+
+    printf("Tests passed\n");
+    return 0;
+}
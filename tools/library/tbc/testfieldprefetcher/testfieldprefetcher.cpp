@@ -0,0 +1,179 @@
+/************************************************************************
+
+    testfieldprefetcher.cpp
+
+    Unit tests for FieldPrefetcher
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+#include "fieldprefetcher.h"
+#include "sourcevideo.h"
+#include "tbcpatchwriter.h"
+
+static constexpr qint32 FIELD_WIDTH = 1024;
+static constexpr qint32 FIELD_HEIGHT = 32;
+static constexpr qint32 FIELD_LENGTH = FIELD_WIDTH * FIELD_HEIGHT;
+static constexpr qint32 NUM_FIELDS = 100;
+
+// Write fields to a file, returning true on success
+static bool writeFields(QFile &file, const QVector<SourceVideo::Data> &fields)
+{
+    for (const SourceVideo::Data &field : fields) {
+        const qint64 length = 2 * field.size();
+        if (file.write(reinterpret_cast<const char *>(field.constData()), length) != length) return false;
+    }
+    return true;
+}
+
+// Read all the fields through a prefetcher, forwards and then backwards
+static void checkPrefetcher(SourceVideo &sourceVideo, const QVector<SourceVideo::Data> &expected)
+{
+    // Use a buffer smaller than the input, so the ring wraps around
+    const qint32 bufferMegabytes = 1;
+    assert((bufferMegabytes * 1024 * 1024) / (FIELD_LENGTH * 2) < NUM_FIELDS);
+
+    FieldPrefetcher fieldPrefetcher(sourceVideo, bufferMegabytes, NUM_FIELDS);
+    fieldPrefetcher.start();
+
+    SourceVideo::Data readData;
+    for (qint32 fieldNumber = 1; fieldNumber <= NUM_FIELDS; fieldNumber++) {
+        assert(fieldPrefetcher.getVideoField(fieldNumber) == expected[fieldNumber - 1]);
+        fieldPrefetcher.readVideoField(fieldNumber, readData);
+        assert(readData == expected[fieldNumber - 1]);
+    }
+    for (qint32 fieldNumber = NUM_FIELDS; fieldNumber >= 1; fieldNumber--) {
+        fieldPrefetcher.readVideoField(fieldNumber, readData);
+        assert(readData == expected[fieldNumber - 1]);
+    }
+
+    fieldPrefetcher.stop();
+    assert(fieldPrefetcher.getHitCount() > 0);
+}
+
+int main()
+{
+    QTemporaryDir dir;
+    assert(dir.isValid());
+    bool b;
+
+    // Make some random fields
+    std::mt19937 rng(42);
+    QVector<SourceVideo::Data> fields(NUM_FIELDS);
+    for (SourceVideo::Data &field : fields) {
+        field.resize(FIELD_LENGTH);
+        for (quint16 &sample : field) sample = static_cast<quint16>(rng());
+    }
+
+    const QString tbcFilename = dir.filePath("input.tbc");
+    {
+        QFile file(tbcFilename);
+        b = file.open(QIODevice::WriteOnly);
+        assert(b);
+        b = writeFields(file, fields);
+        assert(b);
+    }
+
+    // An empty patch, which gives a seekable source that isn't mapped
+    const QString patchFilename = dir.filePath("input.tbcpatch");
+    {
+        QFile patchFile(patchFilename);
+        b = patchFile.open(QIODevice::WriteOnly);
+        assert(b);
+
+        TbcPatchWriter writer;
+        b = writer.open(&patchFile, patchFilename, tbcFilename, FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        for (qint32 fieldNumber = 1; fieldNumber <= NUM_FIELDS; fieldNumber++) {
+            b = writer.writeField(fieldNumber, fields[fieldNumber - 1], fields[fieldNumber - 1]);
+            assert(b);
+        }
+        patchFile.close();
+    }
+
+    // A plain file is only worth prefetching if it couldn't be mapped
+    printf("Reading file\n");
+    {
+        SourceVideo sourceVideo;
+        b = sourceVideo.open(tbcFilename, FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        assert(FieldPrefetcher::isUseful(sourceVideo) == !sourceVideo.isMemoryMapped());
+        checkPrefetcher(sourceVideo, fields);
+    }
+
+    // A patched file isn't mapped, so it is worth prefetching
+    printf("Reading patch\n");
+    {
+        SourceVideo sourceVideo;
+        b = sourceVideo.open(patchFilename, FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        assert(!sourceVideo.isMemoryMapped());
+        assert(FieldPrefetcher::isUseful(sourceVideo));
+        checkPrefetcher(sourceVideo, fields);
+    }
+
+#ifdef Q_OS_UNIX
+    // A pipe on stdin can only be read forwards, so it can't be prefetched.
+    // Read it in order, looking back at the previous field each time, as the
+    // pools do when they find the prefetcher isn't useful.
+    printf("Reading pipe\n");
+    {
+        int pipeFds[2];
+        b = pipe(pipeFds) == 0;
+        assert(b);
+        b = dup2(pipeFds[0], STDIN_FILENO) != -1;
+        assert(b);
+        close(pipeFds[0]);
+
+        std::thread writerThread([&]() {
+            QFile pipeFile;
+            bool ok = pipeFile.open(pipeFds[1], QIODevice::WriteOnly, QFileDevice::AutoCloseHandle);
+            assert(ok);
+            ok = writeFields(pipeFile, fields);
+            assert(ok);
+        });
+
+        SourceVideo sourceVideo;
+        b = sourceVideo.open("-", FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        assert(sourceVideo.getNumberOfAvailableFields() == -1);
+        assert(!FieldPrefetcher::isUseful(sourceVideo));
+
+        for (qint32 fieldNumber = 1; fieldNumber <= NUM_FIELDS; fieldNumber++) {
+            assert(sourceVideo.getVideoField(fieldNumber) == fields[fieldNumber - 1]);
+            if (fieldNumber > 1) assert(sourceVideo.getVideoField(fieldNumber - 1) == fields[fieldNumber - 2]);
+        }
+
+        writerThread.join();
+    }
+#endif
+
+    printf("Tests complete\n");
+    return 0;
+}
@@ -24,6 +24,10 @@
 
 #include <QCoreApplication>
 #include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
@@ -31,6 +35,8 @@
 
 #include "jsonio.h"
 #include "lddecodemetadata.h"
+#include "metadatacache.h"
+#include "metadatawriter.h"
 
 // Run unit tests for the JSON parser
 void testJsonReader()
@@ -227,6 +233,236 @@ void testVideoSystem() {
     assert(!b);
 }
 
+// Serialise a Field to JSON, for comparisons
+static std::string fieldToJson(const LdDecodeMetaData::Field &field)
+{
+    std::ostringstream output;
+    JsonWriter writer(output);
+    field.write(writer);
+    return output.str();
+}
+
+// Write a JSON file with the given number of fields
+static void writeTestMetadata(const QString &fileName, qint32 numFields)
+{
+    LdDecodeMetaData metaData;
+
+    LdDecodeMetaData::VideoParameters videoParameters;
+    videoParameters.system = PAL;
+    videoParameters.fieldWidth = 1135;
+    videoParameters.fieldHeight = 313;
+    videoParameters.sampleRate = 17734475.0;
+    videoParameters.white16bIre = 54016;
+    videoParameters.black16bIre = 16384;
+    metaData.setVideoParameters(videoParameters);
+
+    for (qint32 i = 0; i < numFields; i++) {
+        LdDecodeMetaData::Field field;
+        field.seqNo = i + 1;
+        field.isFirstField = (i % 2) == 0;
+        field.syncConf = 100 - i;
+        field.medianBurstIRE = 20.0 + (i * 0.125);
+        field.fieldPhaseID = (i % 8) + 1;
+        field.audioSamples = 882 + (i % 3);
+        field.fileLoc = i * 1000;
+        field.vbi.inUse = true;
+        field.vbi.vbiData = { i, 0x8ba000 + i, 0x8ba000 + i };
+        field.vitsMetrics.inUse = (i % 3) == 0;
+        field.vitsMetrics.wSNR = 40.0 + i;
+        field.vitsMetrics.bPSNR = 38.5;
+        for (qint32 j = 0; j < i % 4; j++) {
+            field.dropOuts.append(10 * j, (10 * j) + 5, 20 + j);
+        }
+        metaData.appendField(field);
+    }
+
+    bool b = metaData.write(fileName);
+    assert(b);
+}
+
+// Run unit tests for MetadataCache
+void testMetadataCache()
+{
+    std::cerr << "Testing MetadataCache\n";
+
+    QTemporaryDir dir;
+    assert(dir.isValid());
+    const QString jsonFileName = dir.filePath("test.tbc.json");
+    const QString cacheFileName = MetadataCache::getCacheFileName(jsonFileName);
+    bool b;
+
+    // By default, no cache should be written
+    writeTestMetadata(jsonFileName, 10);
+    assert(!QFile::exists(cacheFileName));
+    {
+        LdDecodeMetaData metaData;
+        b = metaData.read(jsonFileName);
+        assert(b);
+        assert(!QFile::exists(cacheFileName));
+    }
+
+    // Once enabled, writing the metadata should also write the cache
+    LdDecodeMetaData::setWriteCache(true);
+    writeTestMetadata(jsonFileName, 10);
+    assert(QFile::exists(cacheFileName));
+
+    // Read the JSON without a cache, then again using the cache
+    QFile::remove(cacheFileName);
+    LdDecodeMetaData jsonMetaData;
+    b = jsonMetaData.read(jsonFileName);
+    assert(b);
+    assert(QFile::exists(cacheFileName));
+
+    LdDecodeMetaData cacheMetaData;
+    b = cacheMetaData.read(jsonFileName);
+    assert(b);
+
+    // Check the two are the same
+    assert(cacheMetaData.getNumberOfFields() == jsonMetaData.getNumberOfFields());
+    assert(cacheMetaData.getNumberOfFrames() == jsonMetaData.getNumberOfFrames());
+    assert(cacheMetaData.getVideoParameters().fieldWidth == jsonMetaData.getVideoParameters().fieldWidth);
+    for (qint32 i = 1; i <= jsonMetaData.getNumberOfFields(); i++) {
+        assert(fieldToJson(cacheMetaData.getField(i)) == fieldToJson(jsonMetaData.getField(i)));
+        assert(cacheMetaData.getFieldPcmAudioStart(i) == jsonMetaData.getFieldPcmAudioStart(i));
+    }
+
+    // A cache whose columns don't match its header, or whose dropout index is
+    // out of range, should be ignored. Make a copy of the good cache, then
+    // overwrite a value in it at a byte position in the file.
+    //
+    // The header is 56 bytes, with the number of fields at 40. It's followed
+    // by the column table, with a 24-byte entry for each column, containing
+    // the element size at 4 and the column's offset in the file at 8.
+    const QString goodCacheFileName = dir.filePath("good.cache");
+    QFile::copy(cacheFileName, goodCacheFileName);
+    auto readCorruptCache = [&](qint64 position, auto value) {
+        QFile::remove(cacheFileName);
+        QFile::copy(goodCacheFileName, cacheFileName);
+        QFile cacheFile(cacheFileName);
+        bool b = cacheFile.open(QIODevice::ReadWrite);
+        assert(b);
+        cacheFile.seek(position);
+        cacheFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        cacheFile.close();
+
+        LdDecodeMetaData corruptMetaData;
+        b = corruptMetaData.read(jsonFileName);
+        assert(b);
+        assert(corruptMetaData.getNumberOfFields() == jsonMetaData.getNumberOfFields());
+        for (qint32 i = 1; i <= jsonMetaData.getNumberOfFields(); i++) {
+            assert(fieldToJson(corruptMetaData.getField(i)) == fieldToJson(jsonMetaData.getField(i)));
+        }
+    };
+    const qint64 columnTable = 56;
+    const qint64 columnEntrySize = 24;
+    const qint32 dropOutIndexColumn = 28;
+    readCorruptCache(40, static_cast<qint64>(11));
+    readCorruptCache(40, static_cast<qint64>(0x7fffffff00000000LL));
+    readCorruptCache(columnTable + 4, static_cast<quint32>(8));
+    {
+        QFile goodCacheFile(goodCacheFileName);
+        b = goodCacheFile.open(QIODevice::ReadOnly);
+        assert(b);
+        goodCacheFile.seek(columnTable + (dropOutIndexColumn * columnEntrySize) + 8);
+        qint64 dropOutIndexOffset;
+        goodCacheFile.read(reinterpret_cast<char *>(&dropOutIndexOffset), sizeof(dropOutIndexOffset));
+        readCorruptCache(dropOutIndexOffset + (5 * sizeof(quint64)), static_cast<quint64>(1000000));
+    }
+
+    // Updates and appends should work with cached metadata
+    LdDecodeMetaData::Vbi vbi;
+    vbi.inUse = true;
+    vbi.vbiData = { 1, 2, 3 };
+    cacheMetaData.updateFieldVbi(vbi, 3);
+    assert(cacheMetaData.getFieldVbi(3).vbiData[2] == 3);
+    cacheMetaData.appendField(cacheMetaData.getField(1));
+    assert(cacheMetaData.getNumberOfFields() == 11);
+    assert(cacheMetaData.getFieldVbi(3).vbiData[2] == 3);
+
+    // If the JSON changes, an old cache should be ignored
+    const QString savedCacheFileName = dir.filePath("saved.cache");
+    QFile::copy(cacheFileName, savedCacheFileName);
+    writeTestMetadata(jsonFileName, 4);
+    QFile::remove(cacheFileName);
+    QFile::copy(savedCacheFileName, cacheFileName);
+    LdDecodeMetaData changedMetaData;
+    b = changedMetaData.read(jsonFileName);
+    assert(b);
+    assert(changedMetaData.getNumberOfFields() == 4);
+
+    // The cache should also be ignored if the JSON is replaced with different
+    // contents of the same size and modification time (e.g. by cp -p)
+    {
+        const QDateTime modified = QFileInfo(jsonFileName).lastModified();
+        QFile jsonFile(jsonFileName);
+        b = jsonFile.open(QIODevice::ReadWrite);
+        assert(b);
+        QByteArray data = jsonFile.readAll();
+        const qint32 position = data.indexOf("\"syncConf\":100");
+        assert(position != -1);
+        data.replace(position, 14, "\"syncConf\":900");
+        jsonFile.seek(0);
+        jsonFile.write(data);
+        jsonFile.flush();
+        b = jsonFile.setFileTime(modified, QFileDevice::FileModificationTime);
+        assert(b);
+        jsonFile.close();
+        assert(QFileInfo(jsonFileName).lastModified() == modified);
+    }
+    LdDecodeMetaData copiedMetaData;
+    b = copiedMetaData.read(jsonFileName);
+    assert(b);
+    assert(copiedMetaData.getField(1).syncConf == 900);
+
+    LdDecodeMetaData::setWriteCache(false);
+}
+
+// Run unit tests for MetadataWriter
+void testMetadataWriter()
+{
+    std::cerr << "Testing MetadataWriter\n";
+
+    QTemporaryDir dir;
+    assert(dir.isValid());
+    const QString inputFileName = dir.filePath("input.tbc.json");
+    const QString outputFileName = dir.filePath("output.tbc.json");
+    bool b;
+
+    writeTestMetadata(inputFileName, 7);
+    LdDecodeMetaData inputMetaData;
+    b = inputMetaData.read(inputFileName);
+    assert(b);
+
+    // Write the fields one at a time. After each one, the partial file should
+    // be readable, containing the fields written so far.
+    MetadataWriter writer;
+    b = writer.open(outputFileName, inputMetaData);
+    assert(b);
+    for (qint32 i = 1; i <= inputMetaData.getNumberOfFields(); i++) {
+        b = writer.writeField(inputMetaData.getField(i));
+        assert(b);
+
+        LdDecodeMetaData partialMetaData;
+        b = partialMetaData.read(MetadataWriter::getPartialFileName(outputFileName));
+        assert(b);
+        assert(partialMetaData.getNumberOfFields() == i);
+        assert(fieldToJson(partialMetaData.getField(i)) == fieldToJson(inputMetaData.getField(i)));
+    }
+    assert(writer.getNumberOfFields() == 7);
+    b = writer.close();
+    assert(b);
+    assert(!QFile::exists(MetadataWriter::getPartialFileName(outputFileName)));
+
+    // Check we get the same metadata back
+    LdDecodeMetaData outputMetaData;
+    b = outputMetaData.read(outputFileName);
+    assert(b);
+    assert(outputMetaData.getNumberOfFields() == inputMetaData.getNumberOfFields());
+    for (qint32 i = 1; i <= inputMetaData.getNumberOfFields(); i++) {
+        assert(fieldToJson(outputMetaData.getField(i)) == fieldToJson(inputMetaData.getField(i)));
+    }
+}
+
 int main(int argc, char *argv[])
 {
     // Initialise Qt
@@ -263,6 +499,8 @@ int main(int argc, char *argv[])
         // Run unit tests
         testJsonReader();
         testVideoSystem();
+        testMetadataCache();
+        testMetadataWriter();
         return 0;
     }
     if (positionalArguments.count() > 2) {
@@ -0,0 +1,169 @@
+/************************************************************************
+
+    testtbcpatch.cpp
+
+    Unit tests for TbcPatch and TbcPatchWriter
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <cassert>
+#include <cstdio>
+#include <random>
+
+#include "sourcevideo.h"
+#include "tbcpatch.h"
+#include "tbcpatchwriter.h"
+
+static constexpr qint32 FIELD_WIDTH = 40;
+static constexpr qint32 FIELD_HEIGHT = 10;
+static constexpr qint32 FIELD_LENGTH = FIELD_WIDTH * FIELD_HEIGHT;
+static constexpr qint32 NUM_FIELDS = 6;
+
+// Write a TBC file containing fields, and return the filename
+static QString writeTbc(const QTemporaryDir &dir, const QVector<SourceVideo::Data> &fields)
+{
+    const QString filename = dir.filePath("base.tbc");
+    QFile file(filename);
+    bool b = file.open(QIODevice::WriteOnly);
+    assert(b);
+    for (const SourceVideo::Data &field : fields) {
+        file.write(reinterpret_cast<const char *>(field.constData()), 2 * field.size());
+    }
+    file.close();
+    return filename;
+}
+
+// Check every way of reading from a SourceVideo returns the expected data
+static void checkSourceVideo(SourceVideo &sourceVideo, const QVector<SourceVideo::Data> &expected)
+{
+    assert(sourceVideo.getNumberOfAvailableFields() == NUM_FIELDS);
+
+    for (qint32 fieldNumber = 1; fieldNumber <= NUM_FIELDS; fieldNumber++) {
+        const SourceVideo::Data &field = expected[fieldNumber - 1];
+
+        // Whole fields
+        assert(sourceVideo.getVideoField(fieldNumber) == field);
+        assert(sourceVideo.getVideoFieldView(fieldNumber).toData() == field);
+        SourceVideo::Data readData;
+        sourceVideo.readVideoField(fieldNumber, readData);
+        assert(readData == field);
+
+        // Ranges of lines
+        for (qint32 startLine = 1; startLine <= FIELD_HEIGHT; startLine += 3) {
+            const qint32 endLine = qMin(startLine + 2, FIELD_HEIGHT);
+            const SourceVideo::Data lines = field.mid((startLine - 1) * FIELD_WIDTH, (endLine - startLine + 1) * FIELD_WIDTH);
+
+            assert(sourceVideo.getVideoField(fieldNumber, startLine, endLine) == lines);
+            sourceVideo.readVideoField(fieldNumber, readData, startLine, endLine);
+            assert(readData == lines);
+        }
+    }
+}
+
+int main()
+{
+    QTemporaryDir dir;
+    assert(dir.isValid());
+    bool b;
+
+    // Make some random base fields
+    std::mt19937 rng(42);
+    QVector<SourceVideo::Data> baseFields(NUM_FIELDS);
+    for (SourceVideo::Data &field : baseFields) {
+        field.resize(FIELD_LENGTH);
+        for (quint16 &sample : field) sample = static_cast<quint16>(rng());
+    }
+    const QString baseFilename = writeTbc(dir, baseFields);
+
+    // Change some of the samples: a single sample, runs that are close enough
+    // to be merged, a run crossing a line boundary, a whole line, and a field
+    // with no changes
+    QVector<SourceVideo::Data> correctedFields = baseFields;
+    correctedFields[0][5] ^= 1;
+    for (qint32 i = 50; i < 55; i++) correctedFields[1][i] ^= 1;
+    for (qint32 i = 58; i < 60; i++) correctedFields[1][i] ^= 1;
+    for (qint32 i = 75; i < 90; i++) correctedFields[2][i] ^= 1;
+    for (qint32 i = 0; i < FIELD_WIDTH; i++) correctedFields[4][(FIELD_HEIGHT - 1) * FIELD_WIDTH + i] ^= 1;
+    correctedFields[5][0] ^= 1;
+    correctedFields[5][FIELD_LENGTH - 1] ^= 1;
+
+    // Write the patch
+    printf("Writing patch\n");
+    const QString patchFilename = dir.filePath("corrected.tbcpatch");
+    {
+        QFile patchFile(patchFilename);
+        b = patchFile.open(QIODevice::WriteOnly);
+        assert(b);
+
+        TbcPatchWriter writer;
+        b = writer.open(&patchFile, patchFilename, baseFilename, FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        for (qint32 fieldNumber = 1; fieldNumber <= NUM_FIELDS; fieldNumber++) {
+            b = writer.writeField(fieldNumber, baseFields[fieldNumber - 1], correctedFields[fieldNumber - 1]);
+            assert(b);
+        }
+
+        // 1 + 1 + 2 + 1 + 2 runs
+        assert(writer.getNumberOfRuns() == 7);
+        assert(writer.getNumberOfSamples() == 1 + 10 + 15 + FIELD_WIDTH + 2);
+        patchFile.close();
+    }
+
+    // Only the patch file should be recognised as one
+    assert(TbcPatch::isPatchFile(patchFilename));
+    assert(!TbcPatch::isPatchFile(baseFilename));
+
+    // Read the patch directly
+    printf("Reading patch\n");
+    TbcPatch patch;
+    b = patch.open(patchFilename, FIELD_LENGTH);
+    assert(b);
+    assert(patch.getNumberOfRuns() == 7);
+    assert(QFile(patch.getBaseFilename()).exists());
+    assert(!patch.isFieldPatched(4));
+    assert(patch.isFieldPatched(5));
+
+    // A patch for a different field length should be rejected
+    TbcPatch wrongPatch;
+    assert(!wrongPatch.open(patchFilename, FIELD_LENGTH + 1));
+
+    // The base file should read as before, and the patch file should read as
+    // the corrected data
+    printf("Reading base through SourceVideo\n");
+    {
+        SourceVideo sourceVideo;
+        b = sourceVideo.open(baseFilename, FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        checkSourceVideo(sourceVideo, baseFields);
+    }
+
+    printf("Reading patch through SourceVideo\n");
+    {
+        SourceVideo sourceVideo;
+        b = sourceVideo.open(patchFilename, FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        assert(!sourceVideo.isMemoryMapped());
+        checkSourceVideo(sourceVideo, correctedFields);
+    }
+
+    printf("Tests complete\n");
+    return 0;
+}
@@ -0,0 +1,63 @@
+/************************************************************************
+
+    vitsmetrics.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2020 Simon Inns
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef VITSMETRICS_H
+#define VITSMETRICS_H
+
+#include <QtGlobal>
+#include <QVector>
+
+#include "lddecodemetadata.h"
+#include "sourcevideo.h"
+
+// Measures the white SNR and black PSNR of a field from its vertical interval
+// test signals (VITS)
+class VitsMetrics
+{
+public:
+    explicit VitsMetrics(const LdDecodeMetaData::VideoParameters &_videoParameters);
+
+    // The range of field lines needed to measure a field (1-based, inclusive)
+    qint32 getStartFieldLine() const;
+    qint32 getEndFieldLine() const;
+
+    // Measure a field, updating fieldMetadata.vitsMetrics.
+    // sourceField contains the field's lines from sourceStartLine (1-based) onwards,
+    // which must include getStartFieldLine() to getEndFieldLine().
+    void measureField(const SourceVideo::Data &sourceField, qint32 sourceStartLine,
+                      qint32 fieldNumber, LdDecodeMetaData::Field &fieldMetadata) const;
+
+private:
+    LdDecodeMetaData::VideoParameters videoParameters;
+
+    QVector<double> getFieldLineSlice(const SourceVideo::Data &sourceField, qint32 sourceStartLine,
+                                      qint32 fieldLine, qint32 startUs, qint32 lengthUs) const;
+    static double calculateSnr(QVector<double> &data, bool usePsnr);
+    static double calcMean(QVector<double> &data);
+    static double calcStd(QVector<double> &data);
+    static double roundDouble(double in, qint32 decimalPlaces);
+};
+
+#endif // VITSMETRICS_H